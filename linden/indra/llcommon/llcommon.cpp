@@ -33,6 +33,7 @@
 
 #include "llcommon.h"
 #include "llthread.h"
+#include "lltracerecorder.h"
 
 //static
 BOOL LLCommon::sAprInitialized = FALSE;
@@ -48,6 +49,7 @@ void LLCommon::initClass()
 	}
 	LLTimer::initClass();
 	LLThreadSafeRefCount::initThreadSafeRefCount();
+	LLTraceRecorder::initClass();
 // 	LLWorkerThread::initClass();
 // 	LLFrameCallbackManager::initClass();
 }
@@ -57,6 +59,7 @@ void LLCommon::cleanupClass()
 {
 // 	LLFrameCallbackManager::cleanupClass();
 // 	LLWorkerThread::cleanupClass();
+	LLTraceRecorder::cleanupClass();
 	LLThreadSafeRefCount::cleanupThreadSafeRefCount();
 	LLTimer::cleanupClass();
 	if (sAprInitialized)
@@ -58,6 +58,7 @@
 #include "llsd.h"
 #include "llsdserialize.h"
 #include "llstl.h"
+#include "llthread.h"
 
 
 namespace {
@@ -346,12 +347,17 @@ namespace
 	typedef std::vector<LLError::Recorder*> Recorders;
 	typedef std::vector<LLError::CallSite*> CallSiteVector;
 
+	class AsyncLogWriter;
+
 	class Globals
 	{
 	public:
 		std::ostringstream messageStream;
 		bool messageStreamInUse;
 
+		AsyncLogWriter* asyncWriter;	// guarded by the LogLock
+		LLMutex* recorderMutex;			// created with the first writer thread
+
 		void addCallSite(LLError::CallSite&);
 		void invalidateCallSites();
 		
@@ -362,7 +368,9 @@ namespace
 		CallSiteVector callSites;
 
 		Globals()
-			:	messageStreamInUse(false)
+			:	messageStreamInUse(false),
+				asyncWriter(NULL),
+				recorderMutex(NULL)
 			{ }
 		
 	};
@@ -395,6 +403,23 @@ namespace
 		static Globals* globals = new Globals;		
 		return *globals;
 	}
+
+	// Held while the recorders are written to or changed. Only needed,
+	// and only exists, once a writer thread may be using them.
+	class RecorderLock
+	{
+	public:
+		RecorderLock() : mMutex(Globals::get().recorderMutex)
+		{
+			if (mMutex) mMutex->lock();
+		}
+		~RecorderLock()
+		{
+			if (mMutex) mMutex->unlock();
+		}
+	private:
+		LLMutex* mMutex;
+	};
 }
 
 namespace LLError
@@ -463,6 +488,7 @@ namespace LLError
 	{
 		Globals::get().invalidateCallSites();
 		
+		RecorderLock lock;
 		Settings*& p = getPtr();
 		delete p;
 		p = new Settings();
@@ -472,6 +498,7 @@ namespace LLError
 	{
 		Globals::get().invalidateCallSites();
 		
+		RecorderLock lock;
 		Settings*& p = getPtr();
 		Settings* originalSettings = p;
 		p = new Settings();
@@ -482,6 +509,7 @@ namespace LLError
 	{
 		Globals::get().invalidateCallSites();
 		
+		RecorderLock lock;
 		Settings*& p = getPtr();
 		delete p;
 		p = originalSettings;
@@ -741,6 +769,7 @@ namespace LLError
 			return;
 		}
 		Settings& s = Settings::get();
+		RecorderLock lock;
 		s.recorders.push_back(recorder);
 	}
 
@@ -751,6 +780,7 @@ namespace LLError
 			return;
 		}
 		Settings& s = Settings::get();
+		RecorderLock lock;
 		s.recorders.erase(
 			std::remove(s.recorders.begin(), s.recorders.end(), recorder),
 			s.recorders.end());
@@ -811,7 +841,10 @@ namespace LLError
 
 namespace
 {
-	void writeToRecorders(LLError::ELevel level, const std::string& message)
+	// time is the already formatted time of the message, or NULL to ask
+	// the time function now. Call with the RecorderLock held.
+	void writeToRecordersLocked(LLError::ELevel level, const std::string& message,
+								const std::string* time)
 	{
 		LLError::Settings& s = LLError::Settings::get();
 	
@@ -823,11 +856,11 @@ namespace
 		{
 			LLError::Recorder* r = *i;
 			
-			if (r->wantsTime()  &&  s.timeFunction != NULL)
+			if (r->wantsTime()  &&  (time ? !time->empty() : s.timeFunction != NULL))
 			{
 				if (messageWithTime.empty())
 				{
-					messageWithTime = s.timeFunction() + " " + message;
+					messageWithTime = (time ? *time : s.timeFunction()) + " " + message;
 				}
 				
 				r->recordMessage(level, messageWithTime);
@@ -838,6 +871,12 @@ namespace
 			}
 		}
 	}
+
+	void writeToRecorders(LLError::ELevel level, const std::string& message)
+	{
+		RecorderLock lock;
+		writeToRecordersLocked(level, message, NULL);
+	}
 }
 
 
@@ -930,6 +969,245 @@ namespace {
 			apr_thread_mutex_unlock(gLogMutexp);
 		}
 	}
+
+
+	// Takes formatted messages from the logging threads and writes them to
+	// the recorders, so slow recorders (files, the console) no longer run
+	// under the LogLock.
+	class AsyncLogWriter : public LLThread
+	{
+	public:
+		enum { MAX_PENDING = 4096 };
+
+		struct Message
+		{
+			LLError::ELevel mLevel;
+			std::string mTime;
+			std::string mText;
+		};
+		typedef std::vector<Message> MessageVector;
+
+		AsyncLogWriter();
+
+		// Call with the LogLock held. Returns false if the message was
+		// dropped because the writer is too far behind.
+		bool push(LLError::ELevel level, const std::string& message);
+
+		// Call with the LogLock and RecorderLock held.
+		void writeAllLocked();
+
+		// Call with neither lock held. Returns false if the LogLock could
+		// not be had.
+		bool writePending();
+
+		// Call with the LogLock held.
+		U32 getDroppedTotal() const { return mDroppedTotal; }
+
+	protected:
+		/*virtual*/ void run();
+		/*virtual*/ bool runCondition() { return mHasPending; }
+
+	private:
+		void write(const MessageVector& messages, U32 dropped);
+
+		MessageVector mPending;		// guarded by the LogLock
+		U32 mDropped;				// guarded by the LogLock
+		U32 mDroppedTotal;			// guarded by the LogLock
+		bool mHasPending;			// guarded by mRunCondition
+	};
+
+	AsyncLogWriter::AsyncLogWriter()
+		: LLThread("Log writer"),
+		  mDropped(0),
+		  mDroppedTotal(0),
+		  mHasPending(false)
+	{
+		mPending.reserve(MAX_PENDING);
+	}
+
+	bool AsyncLogWriter::push(LLError::ELevel level, const std::string& message)
+	{
+		if (mPending.size() >= MAX_PENDING)
+		{
+			++mDropped;
+			++mDroppedTotal;
+			return false;
+		}
+
+		LLError::Settings& s = LLError::Settings::get();
+		bool was_empty = mPending.empty();
+
+		mPending.push_back(Message());
+		Message& m = mPending.back();
+		m.mLevel = level;
+		m.mText = message;
+		if (s.timeFunction)
+		{
+			m.mTime = s.timeFunction();
+		}
+
+		if (was_empty)
+		{
+			lockData();
+			mHasPending = true;
+			mRunCondition->signal();
+			unlockData();
+		}
+		return true;
+	}
+
+	void AsyncLogWriter::write(const MessageVector& messages, U32 dropped)
+	{
+		for (MessageVector::const_iterator i = messages.begin(); i != messages.end(); ++i)
+		{
+			writeToRecordersLocked(i->mLevel, i->mText, &i->mTime);
+		}
+		if (dropped)
+		{
+			std::ostringstream out;
+			out << "WARNING: LLError: " << dropped
+				<< " log messages dropped, the log writer fell behind";
+			writeToRecordersLocked(LLError::LEVEL_WARN, out.str(), NULL);
+		}
+	}
+
+	void AsyncLogWriter::writeAllLocked()
+	{
+		MessageVector messages;
+		messages.swap(mPending);
+		mPending.reserve(MAX_PENDING);
+		U32 dropped = mDropped;
+		mDropped = 0;
+		write(messages, dropped);
+	}
+
+	bool AsyncLogWriter::writePending()
+	{
+		// Take the RecorderLock first so batches are written in the order
+		// they were taken. Logging an error takes the locks the other way
+		// round, which is safe because LogLock only ever tries to lock.
+		RecorderLock recorder_lock;
+
+		lockData();
+		mHasPending = false;
+		unlockData();
+
+		MessageVector messages;
+		U32 dropped;
+		{
+			LogLock lock;
+			if (!lock.ok())
+			{
+				lockData();
+				mHasPending = true;
+				unlockData();
+				return false;
+			}
+			messages.swap(mPending);
+			mPending.reserve(MAX_PENDING);
+			dropped = mDropped;
+			mDropped = 0;
+		}
+
+		write(messages, dropped);
+		return true;
+	}
+
+	void AsyncLogWriter::run()
+	{
+		while (1)
+		{
+			checkPause();
+			bool quitting = isQuitting();
+			if (!writePending())
+			{
+				ms_sleep(1);
+				continue;
+			}
+			if (quitting)
+			{
+				break;
+			}
+		}
+	}
+}
+
+namespace LLError
+{
+	void setAsyncLogging(bool async)
+	{
+		Globals& g = Globals::get();
+		if (async)
+		{
+			if (g.asyncWriter)
+			{
+				return;
+			}
+			if (!gLogMutexp)
+			{
+				llwarns << "APR not initialized, logging stays synchronous" << llendl;
+				return;
+			}
+			if (!g.recorderMutex)
+			{
+				// Never deleted: other threads may be about to lock it
+				g.recorderMutex = new LLMutex(NULL);
+			}
+
+			AsyncLogWriter* writer = new AsyncLogWriter;
+			writer->start();
+			while (1)
+			{
+				LogLock lock;
+				if (lock.ok())
+				{
+					g.asyncWriter = writer;
+					break;
+				}
+			}
+		}
+		else
+		{
+			AsyncLogWriter* writer = NULL;
+			while (1)
+			{
+				LogLock lock;
+				if (lock.ok())
+				{
+					writer = g.asyncWriter;
+					g.asyncWriter = NULL;
+					break;
+				}
+			}
+			// The writer thread writes whatever is still queued before
+			// it exits.
+			delete writer;
+		}
+	}
+
+	bool getAsyncLogging()
+	{
+		return Globals::get().asyncWriter != NULL;
+	}
+
+	void flushAsyncLog()
+	{
+		AsyncLogWriter* writer = Globals::get().asyncWriter;
+		if (writer)
+		{
+			while (!writer->writePending())
+			{
+				ms_sleep(1);
+			}
+		}
+	}
+
+	U32 asyncLogDroppedCount()
+	{
+		LogLock lock;
+		AsyncLogWriter* writer = Globals::get().asyncWriter;
+		return (lock.ok() && writer) ? writer->getDroppedTotal() : 0;
+	}
 }
 
 namespace LLError
@@ -1046,6 +1324,13 @@ namespace LLError
 
 		if (site.mLevel == LEVEL_ERROR)
 		{
+			if (g.asyncWriter)
+			{
+				// About to crash: get everything queued out first, in order
+				RecorderLock recorder_lock;
+				g.asyncWriter->writeAllLocked();
+			}
+
 			std::ostringstream fatalMessage;
 			fatalMessage << abbreviateFile(site.mFile)
 						<< "(" << site.mLine << ") : error";
@@ -1130,7 +1415,14 @@ namespace LLError
 		prefix << message;
 		message = prefix.str();
 		
-		writeToRecorders(site.mLevel, message);
+		if (g.asyncWriter && site.mLevel != LEVEL_ERROR)
+		{
+			g.asyncWriter->push(site.mLevel, message);
+		}
+		else
+		{
+			writeToRecorders(site.mLevel, message);
+		}
 		
 		if (site.mLevel == LEVEL_ERROR  &&  s.crashFunction)
 		{
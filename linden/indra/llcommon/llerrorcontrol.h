@@ -129,6 +129,19 @@ namespace LLError
 	std::string logFileName();
 		// returns name of current logging file, empty string if none
 
+	void setAsyncLogging(bool);
+		// When on, messages are queued for a writer thread rather than
+		// written to the recorders by the thread that logged them. Errors
+		// are still written at once, after everything queued before them.
+		// If the writer falls too far behind, messages are dropped and a
+		// warning saying how many is logged. Needs APR initialized.
+		// Call from the main thread, as with the functions below.
+	bool getAsyncLogging();
+	void flushAsyncLog();
+		// blocks until everything queued so far has been written
+	U32 asyncLogDroppedCount();
+		// messages dropped since asynchronous logging was turned on
+
 
 	/*
 		Utilities for use by the unit tests of LLError itself.
@@ -34,6 +34,7 @@
 #include "llfasttimer.h"
 
 #include "llprocessor.h"
+#include "llformat.h"
 
 
 #if LL_WINDOWS
@@ -53,6 +54,7 @@
 LLFastTimer::EFastTimerType LLFastTimer::sCurType = LLFastTimer::FTM_OTHER;
 int LLFastTimer::sCurDepth = 0;
 U64 LLFastTimer::sStart[LLFastTimer::FTM_MAX_DEPTH];
+U64 LLFastTimer::sChildTime[LLFastTimer::FTM_MAX_DEPTH];
 U64 LLFastTimer::sCounter[LLFastTimer::FTM_NUM_TYPES];
 U64 LLFastTimer::sCountHistory[LLFastTimer::FTM_HISTORY_NUM][LLFastTimer::FTM_NUM_TYPES];
 U64 LLFastTimer::sCountAverage[LLFastTimer::FTM_NUM_TYPES];
@@ -63,6 +65,7 @@ S32 LLFastTimer::sCurFrameIndex = -1;
 S32 LLFastTimer::sLastFrameIndex = -1;
 int LLFastTimer::sPauseHistory = 0;
 int LLFastTimer::sResetHistory = 0;
+U16 LLFastTimer::sTraceName[LLFastTimer::FTM_NUM_TYPES];
 
 F64 LLFastTimer::sCPUClockFrequency = 0.0;
 
@@ -200,3 +203,23 @@ void LLFastTimer::reset()
 }
 
 //////////////////////////////////////////////////////////////////////////////
+
+//static
+void LLFastTimer::setTraceName(EFastTimerType type, const std::string& name)
+{
+	sTraceName[type] = LLTraceRecorder::registerName(name);
+}
+
+//static
+void LLFastTimer::initTraceNames()
+{
+	for (S32 i=0; i<FTM_NUM_TYPES; i++)
+	{
+		if (!sTraceName[i])
+		{
+			sTraceName[i] = LLTraceRecorder::registerName(llformat("Fast Timer %d", i));
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
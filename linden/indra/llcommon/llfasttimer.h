@@ -35,6 +35,8 @@
 
 #define FAST_TIMER_ON 1
 
+#include "lltracerecorder.h"
+
 U64 get_cpu_clock_count();
 
 class LLFastTimer
@@ -209,14 +211,20 @@ public:
 		U64 cpu_clocks = get_cpu_clock_count();
 
 		sStart[sCurDepth] = cpu_clocks;
+		sChildTime[sCurDepth] = 0;
 		sCurDepth++;
+
+		mTraced = LLTraceRecorder::isRecording();
+		if (mTraced)
+		{
+			LLTraceRecorder::begin(sTraceName[type]);
+		}
 #endif
 	};
 	~LLFastTimer()
 	{
 #if FAST_TIMER_ON
 		U64 end,delta;
-		int i;
 
 		// These don't get counted, because they use CPU clockticks
 		//gTimerBins[gCurTimerBin]++;
@@ -225,20 +233,31 @@ public:
 
 		sCurDepth--;
 		delta = end - sStart[sCurDepth];
-		sCounter[mType] += delta;
+		// Count our own time only; nested timers report theirs
+		sCounter[mType] += delta - sChildTime[sCurDepth];
 		sCalls[mType]++;
-		// Subtract delta from parents
-		for (i=0; i<sCurDepth; i++)
-			sStart[i] += delta;
+		// Charge the whole span to the parent's children
+		if (sCurDepth > 0)
+			sChildTime[sCurDepth - 1] += delta;
+
+		if (mTraced)
+		{
+			LLTraceRecorder::end(sTraceName[mType]);
+		}
 #endif
 	}
 
 	static void reset();
 	static U64 countsPerSecond();
 
+	// Names used for these timers in LLTraceRecorder sessions.
+	static void setTraceName(EFastTimerType type, const std::string& name);
+	static void initTraceNames();	// names any timer still without one
+
 public:
 	static int sCurDepth;
 	static U64 sStart[FTM_MAX_DEPTH];
+	static U64 sChildTime[FTM_MAX_DEPTH];	// time spent in timers nested at each depth
 	static U64 sCounter[FTM_NUM_TYPES];
 	static U64 sCalls[FTM_NUM_TYPES];
 	static U64 sCountAverage[FTM_NUM_TYPES];
@@ -251,9 +270,11 @@ public:
 	static int sResetHistory;
 	static F64 sCPUClockFrequency;
     static U64 sClockResolution;
+	static U16 sTraceName[FTM_NUM_TYPES];
 	
 private:
 	EFastTimerType mType;
+	bool mTraced;
 };
 
 
@@ -0,0 +1,245 @@
+/** 
+ * @file lllogindex.cpp
+ * @brief Sidecar offset/time index for append-only line logs
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lllogindex.h"
+
+//static
+std::string LLLogIndex::indexFileName(const std::string& log_path)
+{
+	std::string path = log_path;
+	if (path.size() > 4 && path.compare(path.size() - 4, 4, ".txt") == 0)
+	{
+		path.erase(path.size() - 4);
+	}
+	return path + ".idx";
+}
+
+//static
+U32 LLLogIndex::recordCount(LLFILE* fp)
+{
+	if (fseek(fp, 0, SEEK_END))
+	{
+		return 0;
+	}
+	long size = ftell(fp);
+	return size > 0 ? (U32)(size / sizeof(Record)) : 0;
+}
+
+//static
+bool LLLogIndex::readRecord(LLFILE* fp, U32 i, Record& rec)
+{
+	return !fseek(fp, (long)(i * sizeof(Record)), SEEK_SET)
+		&& fread(&rec, sizeof(rec), 1, fp) == 1;
+}
+
+//static
+bool LLLogIndex::writeRecords(LLFILE* fp, const std::vector<Record>& records)
+{
+	if (records.empty())
+	{
+		return true;
+	}
+	return fwrite(&records[0], sizeof(Record), records.size(), fp) == records.size();
+}
+
+//static
+bool LLLogIndex::sync(const std::string& log_path, U32& end, U32& last_time)
+{
+	end = 0;
+	last_time = 0;
+
+	std::string idx_path = indexFileName(log_path);
+
+	llstat log_stat;
+	if (LLFile::stat(log_path, &log_stat))
+	{
+		// No log (any more), so any index left behind is stale
+		if (LLFile::isfile(idx_path))
+		{
+			LLFile::remove(idx_path);
+		}
+		return true;
+	}
+	U32 log_size = (U32)log_stat.st_size;
+
+	const char* idx_mode = "ab";
+	LLFILE* idx = LLFile::fopen(idx_path, "rb");		/*Flawfinder: ignore*/
+	if (idx)
+	{
+		fseek(idx, 0, SEEK_END);
+		long idx_size = ftell(idx);
+		Record rec;
+		if (idx_size > 0
+			&& idx_size % sizeof(rec) == 0
+			&& readRecord(idx, (U32)(idx_size / sizeof(rec)) - 1, rec)
+			&& rec.mEnd <= log_size)
+		{
+			end = rec.mEnd;
+			last_time = rec.mTime;
+		}
+		else if (idx_size != 0)
+		{
+			// Corrupt, or the log was truncated or replaced: rebuild
+			idx_mode = "wb";
+		}
+		fclose(idx);
+	}
+
+	if (end == log_size && idx_mode[0] == 'a')
+	{
+		return true;
+	}
+
+	LLFILE* log = LLFile::fopen(log_path, "rb");		/*Flawfinder: ignore*/
+	if (!log)
+	{
+		return false;
+	}
+	idx = LLFile::fopen(idx_path, idx_mode);		/*Flawfinder: ignore*/
+	if (!idx)
+	{
+		fclose(log);
+		return false;
+	}
+
+	std::vector<Record> records;
+	if (!fseek(log, end, SEEK_SET))
+	{
+		char buffer[4096];		/*Flawfinder: ignore*/
+		U32 pos = end;
+		size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), log)) > 0)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (buffer[i] == '\n')
+				{
+					Record rec;
+					rec.mEnd = pos + (U32)i + 1;
+					rec.mTime = last_time;
+					records.push_back(rec);
+				}
+			}
+			pos += (U32)count;
+
+			if (records.size() >= 1024)
+			{
+				writeRecords(idx, records);
+				end = records.back().mEnd;
+				records.clear();
+			}
+		}
+	}
+	if (!records.empty())
+	{
+		writeRecords(idx, records);
+		end = records.back().mEnd;
+	}
+
+	// Anything past end is an unterminated last line; writers close it
+	// off before appending and readers leave it alone.
+	fclose(idx);
+	fclose(log);
+	return true;
+}
+
+//static
+U32 LLLogIndex::findRecallStart(const std::string& log_path, U32 end, U32 recall_size)
+{
+	// Walk back from the newest line to the first one that starts inside
+	// the last recall_size bytes.
+	U32 threshold = end > recall_size ? end - recall_size : 0;
+	U32 start = end;
+	LLFILE* idx = LLFile::fopen(indexFileName(log_path), "rb");		/*Flawfinder: ignore*/
+	if (idx)
+	{
+		for (U32 i = recordCount(idx); i > 0; --i)
+		{
+			U32 line_start = 0;
+			Record rec;
+			if (i > 1)
+			{
+				if (!readRecord(idx, i - 2, rec))
+				{
+					break;
+				}
+				line_start = rec.mEnd;
+			}
+			if (line_start < threshold && start != end)
+			{
+				break;
+			}
+			start = line_start;
+		}
+		fclose(idx);
+	}
+	return start;
+}
+
+//static
+void LLLogIndex::readLines(const std::string& log_path, U32 start, U32 end, std::vector<std::string>& lines)
+{
+	if (end <= start)
+	{
+		return;
+	}
+	LLFILE* fp = LLFile::fopen(log_path, "rb");		/*Flawfinder: ignore*/
+	if (!fp)
+	{
+		return;
+	}
+	if (!fseek(fp, start, SEEK_SET))
+	{
+		std::string buffer(end - start, '\0');
+		buffer.resize(fread(&buffer[0], 1, buffer.size(), fp));
+
+		std::string::size_type pos = 0;
+		while (pos < buffer.size())
+		{
+			std::string::size_type eol = buffer.find('\n', pos);
+			if (eol == std::string::npos)
+			{
+				eol = buffer.size();
+			}
+			std::string::size_type len = eol - pos;
+			if (len && buffer[pos + len - 1] == '\r')
+			{
+				--len;
+			}
+			lines.push_back(buffer.substr(pos, len));
+			pos = eol + 1;
+		}
+	}
+	fclose(fp);
+}
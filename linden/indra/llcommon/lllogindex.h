@@ -0,0 +1,80 @@
+/** 
+ * @file lllogindex.h
+ * @brief Sidecar offset/time index for append-only line logs
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLOGINDEX_H
+#define LL_LLLOGINDEX_H
+
+#include <string>
+#include <vector>
+
+#include "llfile.h"
+
+// Each <name>.txt log can have a <name>.idx next to it holding one record
+// per logged line: the file offset just past the line's newline and the
+// UTC time it was logged. Line i therefore spans [end(i-1), end(i)) and
+// times never decrease, so readers seek straight to the bytes they need.
+// Lines the index does not cover (written by an older viewer, or lost to
+// a crash between the log and index writes) are added by the next sync(),
+// stamped with the last known time.
+//
+// Records are two U32s in host byte order; the files never leave the
+// machine that wrote them.
+class LLLogIndex
+{
+public:
+	struct Record
+	{
+		U32 mEnd;
+		U32 mTime;
+	};
+
+	static std::string indexFileName(const std::string& log_path);
+
+	static U32 recordCount(LLFILE* fp);
+	static bool readRecord(LLFILE* fp, U32 i, Record& rec);
+	static bool writeRecords(LLFILE* fp, const std::vector<Record>& records);
+
+	// Brings the index of log_path up to date with the log and returns the
+	// end offset and time of its last complete line. Returns false if the
+	// index can not be written, in which case callers should scan the log.
+	static bool sync(const std::string& log_path, U32& end, U32& last_time);
+
+	// Offset of the oldest line that starts within recall_size bytes of
+	// end. The newest line is always included, however long.
+	static U32 findRecallStart(const std::string& log_path, U32 end, U32 recall_size);
+
+	// Appends the lines stored in [start, end) of the log, without their
+	// line endings.
+	static void readLines(const std::string& log_path, U32 start, U32 end, std::vector<std::string>& lines);
+};
+
+#endif // LL_LLLOGINDEX_H
@@ -31,7 +31,10 @@
 
 #include "linden_common.h"
 #include "llqueuedthread.h"
+#include "llqueuedthreadpool.h"
 #include "llstl.h"
+#include "lltimer.h"
+#include "lltracerecorder.h"
 
 //============================================================================
 
@@ -40,8 +43,10 @@ LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded) :
 	LLThread(name),
 	mThreaded(threaded),
 	mIdleThread(TRUE),
-	mNextHandle(0)
+	mNextHandle(0),
+	mPool(NULL)
 {
+	mTraceName = LLTraceRecorder::registerName(name + " request");
 	if (mThreaded)
 	{
 		start();
@@ -59,6 +64,12 @@ void LLQueuedThread::shutdown()
 {
 	setQuitting();
 
+	if (mPool)
+	{
+		// Blocks until no pool worker is inside processNextRequest()
+		mPool->removeQueue(this);
+	}
+
 	unpause(); // MAIN THREAD
 	if (mThreaded)
 	{
@@ -114,7 +125,15 @@ S32 LLQueuedThread::updateQueue(U32 max_time_ms)
 	S32 pending = 1;
 
 	// Frame Update
-	if (mThreaded)
+	if (mPool)
+	{
+		pending = getPending();
+		if (pending > 0)
+		{
+			mPool->wake();
+		}
+	}
+	else if (mThreaded)
 	{
 		pending = getPending();
 		unpause();
@@ -134,7 +153,11 @@ S32 LLQueuedThread::updateQueue(U32 max_time_ms)
 void LLQueuedThread::incQueue()
 {
 	// Something has been added to the queue
-	if (!isPaused())
+	if (mPool)
+	{
+		mPool->wake();
+	}
+	else if (!isPaused())
 	{
 		if (mThreaded)
 		{
@@ -154,6 +177,35 @@ S32 LLQueuedThread::getPending()
 	return res;
 }
 
+// May be called from any thread
+bool LLQueuedThread::getTopPriority(U32& priority)
+{
+	bool res = false;
+	lockData();
+	if (!mRequestQueue.empty())
+	{
+		priority = (*mRequestQueue.begin())->getPriority();
+		res = true;
+	}
+	unlockData();
+	return res;
+}
+
+LLQueuedThread::QueueStats LLQueuedThread::getStats()
+{
+	lockData();
+	QueueStats res = mStats;
+	unlockData();
+	return res;
+}
+
+void LLQueuedThread::resetStats()
+{
+	lockData();
+	mStats = QueueStats();
+	unlockData();
+}
+
 // MAIN thread
 void LLQueuedThread::waitOnPending()
 {
@@ -165,7 +217,7 @@ void LLQueuedThread::waitOnPending()
 		{
 			break;
 		}
-		if (mThreaded)
+		if (mThreaded || mPool)
 		{
 			yield();
 		}
@@ -186,6 +238,14 @@ void LLQueuedThread::printQueueStats()
 	{
 		llinfos << "Queued Thread Idle" << llendl;
 	}
+	if (mStats.mProcessed > 0)
+	{
+		llinfos << llformat("%s: processed:%d avg latency:%.2fms max latency:%.2fms max depth:%d",
+							mName.c_str(), mStats.mProcessed,
+							(F64)mStats.mTotalLatency / (F64)mStats.mProcessed * .001,
+							(F64)mStats.mMaxLatency * .001,
+							mStats.mMaxDepth) << llendl;
+	}
 	unlockData();
 }
 
@@ -212,8 +272,10 @@ bool LLQueuedThread::addRequest(QueuedRequest* req)
 	
 	lockData();
 	req->setStatus(STATUS_QUEUED);
+	req->mQueuedTime = LLTimer::getTotalTime();
 	mRequestQueue.insert(req);
 	mRequestHash.insert(req);
+	mStats.mMaxDepth = llmax(mStats.mMaxDepth, (S32)mRequestQueue.size());
 #if _DEBUG
 // 	llinfos << llformat("LLQueuedThread::Added req [%08d]",handle) << llendl;
 #endif
@@ -253,7 +315,7 @@ bool LLQueuedThread::waitForResult(LLQueuedThread::handle_t handle, bool auto_co
 		}
 		unlockData();
 		
-		if (!done && mThreaded)
+		if (!done && (mThreaded || mPool))
 		{
 			yield();
 		}
@@ -420,6 +482,11 @@ S32 LLQueuedThread::processNextRequest()
 	if (req)
 	{
 		req->setStatus(STATUS_INPROGRESS);
+
+		U64 latency = LLTimer::getTotalTime() - req->mQueuedTime;
+		mStats.mProcessed++;
+		mStats.mTotalLatency += latency;
+		mStats.mMaxLatency = llmax(mStats.mMaxLatency, latency);
 	}
 	unlockData();
 
@@ -429,6 +496,7 @@ S32 LLQueuedThread::processNextRequest()
 	if (req)
 	{
 		// process request
+		LLTraceZone trace_zone(mTraceName);
 		bool complete = req->processRequest();
 
 		if (complete)
@@ -451,6 +519,7 @@ S32 LLQueuedThread::processNextRequest()
 		{
 			lockData();
 			req->setStatus(STATUS_QUEUED);
+			req->mQueuedTime = LLTimer::getTotalTime();
 			mRequestQueue.insert(req);
 			U32 priority = req->getPriority();
 			unlockData();
@@ -530,7 +599,8 @@ LLQueuedThread::QueuedRequest::QueuedRequest(LLQueuedThread::handle_t handle, U3
 	LLSimpleHashEntry<LLQueuedThread::handle_t>(handle),
 	mStatus(STATUS_UNKNOWN),
 	mPriority(priority),
-	mFlags(flags)
+	mFlags(flags),
+	mQueuedTime(0)
 {
 }
 
@@ -43,12 +43,15 @@
 #include "llthread.h"
 #include "llsimplehash.h"
 
+class LLQueuedThreadPool;
+
 //============================================================================
 // Note: ~LLQueuedThread is O(N) N=# of queued threads, assumed to be small
 //   It is assumed that LLQueuedThreads are rarely created/destroyed.
 
 class LLQueuedThread : public LLThread
 {
+	friend class LLQueuedThreadPool;
 	//------------------------------------------------------------------------
 public:
 	enum priority_t {
@@ -137,6 +140,18 @@ public:
 		LLAtomic32<status_t> mStatus;
 		U32 mPriority;
 		U32 mFlags;
+		U64 mQueuedTime; // usec, when last (re)inserted into the queue
+	};
+
+	// Per-queue scheduling statistics, latency is time spent queued
+	// before being picked up for processing.
+	struct QueueStats
+	{
+		QueueStats() : mProcessed(0), mTotalLatency(0), mMaxLatency(0), mMaxDepth(0) {}
+		U32 mProcessed;
+		U64 mTotalLatency; // usec
+		U64 mMaxLatency; // usec
+		S32 mMaxDepth;
 	};
 
 protected:
@@ -174,6 +189,7 @@ protected:
 	bool addRequest(QueuedRequest* req);
 	S32  processNextRequest(void);
 	void incQueue();
+	bool getTopPriority(U32& priority); // false if the queue is empty
 
 public:
 	bool waitForResult(handle_t handle, bool auto_complete = true);
@@ -185,7 +201,11 @@ public:
 	void printQueueStats();
 
 	S32 getPending();
-	bool getThreaded() { return mThreaded ? true : false; }
+	bool getThreaded() { return (mThreaded || mPool) ? true : false; }
+	bool getPooled() { return mPool != NULL; }
+
+	QueueStats getStats();
+	void resetStats();
 
 	// Request accessors
 	status_t getRequestStatus(handle_t handle);
@@ -212,6 +232,10 @@ protected:
 	request_hash_t mRequestHash;
 
 	handle_t mNextHandle;
+
+	LLQueuedThreadPool* mPool; // if set, requests are run by the pool instead of our own thread
+	QueueStats mStats;
+	U16 mTraceName; // LLTraceRecorder zone for processing one request
 };
 
 #endif // LL_LLQUEUEDTHREAD_H
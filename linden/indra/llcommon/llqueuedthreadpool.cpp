@@ -0,0 +1,277 @@
+/** 
+ * @file llqueuedthreadpool.cpp
+ * @brief Shared worker threads that service several LLQueuedThread request queues
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llqueuedthreadpool.h"
+
+//============================================================================
+
+LLQueuedThreadPool::Worker::Worker(const std::string& name, LLQueuedThreadPool* pool)
+	: LLThread(name),
+	  mPool(pool)
+{
+}
+
+// WORKER THREAD
+// virtual
+void LLQueuedThreadPool::Worker::run()
+{
+	while (!isQuitting())
+	{
+		if (!mPool->processNext() && !mPool->waitForWork())
+		{
+			break;
+		}
+	}
+	llinfos << "LLQueuedThreadPool " << mName << " EXITING." << llendl;
+}
+
+//============================================================================
+
+// MAIN THREAD
+LLQueuedThreadPool::LLQueuedThreadPool(const std::string& name, S32 num_threads)
+	: mName(name),
+	  mNextQueue(0),
+	  mWorkSignal(false),
+	  mQuitting(false)
+{
+	mCondition = new LLCondition(NULL);
+	num_threads = llmax(num_threads, 1);
+	for (S32 i = 0; i < num_threads; ++i)
+	{
+		Worker* worker = new Worker(llformat("%s %d", name.c_str(), i), this);
+		mWorkers.push_back(worker);
+		worker->start();
+	}
+}
+
+// MAIN THREAD
+LLQueuedThreadPool::~LLQueuedThreadPool()
+{
+	shutdown();
+	delete mCondition;
+}
+
+// MAIN THREAD
+void LLQueuedThreadPool::shutdown()
+{
+	mCondition->lock();
+	if (!mQueues.empty())
+	{
+		llwarns << "LLQueuedThreadPool " << mName << " shut down with "
+				<< mQueues.size() << " queues attached" << llendl;
+	}
+	mQuitting = true;
+	mCondition->broadcast();
+	mCondition->unlock();
+
+	// LLThread::shutdown() sets quitting and waits for run() to return
+	for (std::vector<Worker*>::iterator iter = mWorkers.begin();
+		 iter != mWorkers.end(); ++iter)
+	{
+		(*iter)->shutdown();
+	}
+	for_each(mWorkers.begin(), mWorkers.end(), DeletePointer());
+	mWorkers.clear();
+
+	// Any queues still attached fall back to running on the main thread
+	mCondition->lock();
+	for (queue_list_t::iterator iter = mQueues.begin(); iter != mQueues.end(); ++iter)
+	{
+		iter->mQueue->mPool = NULL;
+	}
+	mQueues.clear();
+	mCondition->unlock();
+}
+
+// MAIN THREAD
+void LLQueuedThreadPool::addQueue(LLQueuedThread* queue, S32 max_concurrent)
+{
+	llassert_always(!queue->mThreaded);
+	llassert_always(!queue->mPool);
+
+	mCondition->lock();
+	mQueues.push_back(QueueEntry(queue, llmax(max_concurrent, 1)));
+	queue->mPool = this;
+	mWorkSignal = true;
+	mCondition->broadcast();
+	mCondition->unlock();
+}
+
+// MAIN THREAD
+void LLQueuedThreadPool::removeQueue(LLQueuedThread* queue)
+{
+	mCondition->lock();
+	QueueEntry* entry = findEntry(queue);
+	if (!entry)
+	{
+		mCondition->unlock();
+		return;
+	}
+	entry->mRemoving = true;
+	while (entry->mActive > 0)
+	{
+		mCondition->unlock();
+		ms_sleep(1);
+		mCondition->lock();
+		entry = findEntry(queue);
+	}
+	for (queue_list_t::iterator iter = mQueues.begin(); iter != mQueues.end(); ++iter)
+	{
+		if (iter->mQueue == queue)
+		{
+			mQueues.erase(iter);
+			break;
+		}
+	}
+	queue->mPool = NULL;
+	mCondition->unlock();
+}
+
+// Any thread
+void LLQueuedThreadPool::wake()
+{
+	mCondition->lock();
+	mWorkSignal = true;
+	mCondition->broadcast();
+	mCondition->unlock();
+}
+
+LLQueuedThreadPool::QueueEntry* LLQueuedThreadPool::findEntry(LLQueuedThread* queue)
+{
+	for (queue_list_t::iterator iter = mQueues.begin(); iter != mQueues.end(); ++iter)
+	{
+		if (iter->mQueue == queue)
+		{
+			return &(*iter);
+		}
+	}
+	return NULL;
+}
+
+// WORKER THREAD
+bool LLQueuedThreadPool::processNext()
+{
+	LLQueuedThread* queue = NULL;
+
+	mCondition->lock();
+	if (mQuitting)
+	{
+		mCondition->unlock();
+		return false;
+	}
+	// Pick the queue whose head request is in the highest priority lane.
+	// Lock order is pool then queue; queues never call wake() with their
+	// data lock held.
+	U32 num_queues = mQueues.size();
+	U32 best_lane = 0;
+	U32 best_index = 0;
+	for (U32 i = 0; i < num_queues; ++i)
+	{
+		U32 index = (mNextQueue + i) % num_queues;
+		QueueEntry& entry = mQueues[index];
+		if (entry.mRemoving || entry.mActive >= entry.mMaxConcurrent)
+		{
+			continue;
+		}
+		U32 priority;
+		if (!entry.mQueue->getTopPriority(priority))
+		{
+			continue;
+		}
+		U32 lane = priority & LLQueuedThread::PRIORITY_HIGHBITS;
+		if (!queue || lane > best_lane)
+		{
+			queue = entry.mQueue;
+			best_lane = lane;
+			best_index = index;
+		}
+	}
+	if (queue)
+	{
+		mQueues[best_index].mActive++;
+		mNextQueue = (best_index + 1) % num_queues;
+	}
+	mCondition->unlock();
+
+	if (!queue)
+	{
+		return false;
+	}
+
+	queue->mIdleThread = FALSE;
+	S32 pending = queue->processNextRequest();
+	if (pending == 0)
+	{
+		queue->mIdleThread = TRUE;
+	}
+
+	mCondition->lock();
+	QueueEntry* entry = findEntry(queue);
+	llassert_always(entry);
+	entry->mActive--;
+	mCondition->unlock();
+
+	return true;
+}
+
+// WORKER THREAD
+bool LLQueuedThreadPool::waitForWork()
+{
+	mCondition->lock();
+	if (!mWorkSignal && !mQuitting)
+	{
+		mCondition->wait();
+	}
+	mWorkSignal = false;
+	bool res = !mQuitting;
+	mCondition->unlock();
+	return res;
+}
+
+// MAIN THREAD
+void LLQueuedThreadPool::printStats()
+{
+	mCondition->lock();
+	llinfos << "LLQueuedThreadPool " << mName << ": " << mWorkers.size()
+			<< " threads, " << mQueues.size() << " queues" << llendl;
+	for (queue_list_t::iterator iter = mQueues.begin(); iter != mQueues.end(); ++iter)
+	{
+		LLQueuedThread::QueueStats stats = iter->mQueue->getStats();
+		F64 avg_latency = stats.mProcessed ? (F64)stats.mTotalLatency / (F64)stats.mProcessed * .001 : 0.0;
+		llinfos << llformat("  %s: limit:%d active:%d pending:%d processed:%d avg latency:%.2fms max latency:%.2fms max depth:%d",
+							iter->mQueue->mName.c_str(), iter->mMaxConcurrent, iter->mActive,
+							iter->mQueue->getPending(), stats.mProcessed, avg_latency,
+							(F64)stats.mMaxLatency * .001, stats.mMaxDepth) << llendl;
+	}
+	mCondition->unlock();
+}
@@ -0,0 +1,120 @@
+/** 
+ * @file llqueuedthreadpool.h
+ * @brief Shared worker threads that service several LLQueuedThread request queues
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLQUEUEDTHREADPOOL_H
+#define LL_LLQUEUEDTHREADPOOL_H
+
+#include <string>
+#include <vector>
+
+#include "llqueuedthread.h"
+
+//============================================================================
+// A fixed set of worker threads shared by several LLQueuedThread queues.
+//
+// A queue constructed with threaded == false can be handed to addQueue();
+// from then on its requests are run by whichever pool worker is free
+// instead of on the main thread in update(). Idle workers always take the
+// request in the highest priority lane (PRIORITY_HIGHBITS) across all
+// attached queues, round-robin between queues within a lane, so one busy
+// queue can not starve the others and no core sits idle while any queue
+// has work.
+//
+// Each queue has a concurrency limit: the number of workers allowed inside
+// its processNextRequest() at once. A limit of 1 keeps the single consumer
+// behaviour the queue had on its own thread.
+//
+// Queues that rely on thread affinity (startThread()/threadedUpdate()
+// owning per-thread resources, e.g. LLTextureFetch's curl handle) must
+// keep their own thread; the pool never calls those hooks.
+
+class LLQueuedThreadPool
+{
+public:
+	LLQueuedThreadPool(const std::string& name, S32 num_threads);
+	~LLQueuedThreadPool();
+
+	// MAIN THREAD
+	void addQueue(LLQueuedThread* queue, S32 max_concurrent = 1);
+	// Blocks until no worker is processing a request from queue.
+	void removeQueue(LLQueuedThread* queue);
+	void shutdown();
+
+	// Any thread. Called by attached queues when requests are added.
+	void wake();
+
+	S32 getNumThreads() const { return (S32)mWorkers.size(); }
+	void printStats();
+
+private:
+	// No copy constructor or copy assignment
+	LLQueuedThreadPool(const LLQueuedThreadPool&);
+	LLQueuedThreadPool& operator=(const LLQueuedThreadPool&);
+
+	class Worker : public LLThread
+	{
+	public:
+		Worker(const std::string& name, LLQueuedThreadPool* pool);
+	private:
+		/*virtual*/ void run(void);
+		LLQueuedThreadPool* mPool;
+	};
+	friend class Worker;
+
+	struct QueueEntry
+	{
+		QueueEntry(LLQueuedThread* queue, S32 max_concurrent)
+			: mQueue(queue), mMaxConcurrent(max_concurrent), mActive(0), mRemoving(false)
+		{}
+		LLQueuedThread* mQueue;
+		S32 mMaxConcurrent;
+		S32 mActive;		// workers currently inside mQueue->processNextRequest()
+		bool mRemoving;
+	};
+	typedef std::vector<QueueEntry> queue_list_t;
+
+	// WORKER THREADS
+	bool processNext(); // returns false if no queue had work
+	bool waitForWork(); // returns false once the pool is shutting down
+	QueueEntry* findEntry(LLQueuedThread* queue); // mCondition must be locked
+
+	std::string mName;
+	LLCondition* mCondition; // guards everything below
+	queue_list_t mQueues;
+	U32 mNextQueue; // round-robin start for ties within a lane
+	bool mWorkSignal;
+	bool mQuitting;
+
+	std::vector<Worker*> mWorkers;
+};
+
+#endif // LL_LLQUEUEDTHREADPOOL_H
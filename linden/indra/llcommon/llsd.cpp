@@ -37,6 +37,9 @@
 #include "../llmath/llmath.h"
 #include "llformat.h"
 #include "llsdserialize.h"
+#include "llthread.h"
+
+#include "apr_atomic.h"
 
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 #define NAME_UNNAMED_NAMESPACE
@@ -77,7 +80,14 @@ protected:
 		//	 finally initialized.
 		
 	virtual ~Impl();
-	
+
+public:
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+		///< Impls come from the thread's open LLSDArena if there is one,
+		//   otherwise from the heap
+
+protected:
 	bool shared() const							{ return mUseCount > 1; }
 	
 public:
@@ -557,6 +567,177 @@ namespace
 	}
 }
 
+//
+// LLSDArena
+//
+
+class LLSDArena
+	/**< Bump allocator backing LLSDArenaScope. Only the thread that opened
+		 the scope allocates from it, but the values may be released from
+		 anywhere, so the live count is atomic. The scope itself holds one
+		 reference.
+	*/
+{
+public:
+	LLSDArena();
+
+	void* allocate(size_t size);
+	void release();
+
+	static LLSDArena* current();
+
+	static LLSDArena* volatile sCurrent;
+	static volatile U32 sOwnerThread;
+
+private:
+	~LLSDArena();
+
+	enum
+	{
+		BLOCK_SIZE = 16384,
+		MAX_ALLOCATION = BLOCK_SIZE / 4
+	};
+
+	std::vector<U8*> mBlocks;
+	U8* mNext;
+	size_t mLeft;
+	volatile apr_uint32_t mRefs;
+};
+
+LLSDArena* volatile LLSDArena::sCurrent = NULL;
+volatile U32 LLSDArena::sOwnerThread = 0;
+
+LLSDArena::LLSDArena()
+	: mNext(NULL), mLeft(0)
+{
+	apr_atomic_set32(&mRefs, 1);
+}
+
+LLSDArena::~LLSDArena()
+{
+	for (std::vector<U8*>::iterator it = mBlocks.begin(); it != mBlocks.end(); ++it)
+	{
+		delete[] *it;
+	}
+}
+
+void* LLSDArena::allocate(size_t size)
+{
+	if (size > MAX_ALLOCATION)
+	{
+		return NULL;
+	}
+	// keep every allocation aligned for the F64 and pointer members
+	size = (size + sizeof(F64) - 1) & ~(sizeof(F64) - 1);
+	if (size > mLeft)
+	{
+		mNext = new U8[BLOCK_SIZE];
+		mLeft = BLOCK_SIZE;
+		mBlocks.push_back(mNext);
+	}
+	void* ptr = mNext;
+	mNext += size;
+	mLeft -= size;
+	apr_atomic_inc32(&mRefs);
+	return ptr;
+}
+
+void LLSDArena::release()
+{
+	if (apr_atomic_dec32(&mRefs) == 0)
+	{
+		delete this;
+	}
+}
+
+// static
+LLSDArena* LLSDArena::current()
+{
+	LLSDArena* arena = sCurrent;
+	if (arena && sOwnerThread == LLThread::currentID())
+	{
+		return arena;
+	}
+	return NULL;
+}
+
+
+LLSDArenaScope::LLSDArenaScope()
+	: mArena(NULL)
+{
+	LLSDArena* arena = new LLSDArena;
+	if (apr_atomic_casptr((volatile void**)&LLSDArena::sCurrent, arena, NULL) == NULL)
+	{
+		LLSDArena::sOwnerThread = LLThread::currentID();
+		mArena = arena;
+	}
+	else
+	{
+		// nested, or another thread has it
+		arena->release();
+	}
+}
+
+LLSDArenaScope::~LLSDArenaScope()
+{
+	if (mArena)
+	{
+		LLSDArena::sOwnerThread = 0;
+		apr_atomic_casptr((volatile void**)&LLSDArena::sCurrent, NULL, mArena);
+		mArena->release();
+	}
+}
+
+
+#ifdef NAME_UNNAMED_NAMESPACE
+namespace LLSDUnnamedNamespace 
+#else
+namespace 
+#endif
+{
+	// Prefixed to every Impl so operator delete knows where it came from.
+	union ImplHeader
+	{
+		LLSDArena* mArena;
+		F64 mAlign;
+	};
+}
+
+// static
+void* LLSD::Impl::operator new(size_t size)
+{
+	size_t total = sizeof(ImplHeader) + size;
+	LLSDArena* arena = LLSDArena::current();
+	void* block = arena ? arena->allocate(total) : NULL;
+	if (!block)
+	{
+		arena = NULL;
+		block = ::operator new(total);
+	}
+	ImplHeader* header = (ImplHeader*)block;
+	header->mArena = arena;
+	return header + 1;
+}
+
+// static
+void LLSD::Impl::operator delete(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+	ImplHeader* header = (ImplHeader*)ptr - 1;
+	if (header->mArena)
+	{
+		header->mArena->release();
+	}
+	else
+	{
+		::operator delete(header);
+	}
+}
+
+
 LLSD::Impl::Impl()
 	: mUseCount(0)
 {
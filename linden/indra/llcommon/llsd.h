@@ -344,6 +344,36 @@ private:
 	//@}
 };
 
+class LLSDArena;
+
+/**
+ * @class LLSDArenaScope
+ * @brief While one is alive, LLSD values created on its thread are carved
+ * out of a shared arena rather than allocated one at a time.
+ *
+ * Meant to wrap the parse of large, short lived trees such as capability
+ * responses. The values keep their normal semantics and may outlive the
+ * scope; the arena itself is freed once the last value allocated from it
+ * is gone, so holding on to a small piece of a tree keeps all of it alive.
+ * Only one thread at a time can have an arena open. Scopes nested in an
+ * open one, or opened while another thread holds the arena, just use the
+ * normal allocator.
+ */
+class LLSDArenaScope
+{
+public:
+	LLSDArenaScope();
+	~LLSDArenaScope();
+
+	bool isActive() const { return mArena != NULL; }
+
+private:
+	LLSDArenaScope(const LLSDArenaScope&);
+	LLSDArenaScope& operator=(const LLSDArenaScope&);
+
+	LLSDArena* mArena;	// NULL if this scope did not get the arena
+};
+
 struct llsd_select_bool : public std::unary_function<LLSD, LLSD::Boolean>
 {
 	LLSD::Boolean operator()(const LLSD& sd) const
@@ -317,7 +317,9 @@ S32 LLSDParser::parse(std::istream& istr, LLSD& data, S32 max_bytes)
 {
 	mCheckLimits = (LLSDSerialize::SIZE_UNLIMITED == max_bytes) ? false : true;
 	mMaxBytesLeft = max_bytes;
-	return doParse(istr, data);
+	S32 count = doParse(istr, data);
+	mKeys.clear();
+	return count;
 }
 
 
@@ -326,7 +328,14 @@ S32 LLSDParser::parseLines(std::istream& istr, LLSD& data)
 {
 	mCheckLimits = false;
 	mParseLines = true;
-	return doParse(istr, data);
+	S32 count = doParse(istr, data);
+	mKeys.clear();
+	return count;
+}
+
+const std::string& LLSDParser::internKey(const std::string& key) const
+{
+	return *mKeys.insert(key).first;
 }
 
 
@@ -695,7 +704,7 @@ S32 LLSDNotationParser::parseMap(std::istream& istr, LLSD& map) const
 					// There must be a value for every key, thus
 					// child_count must be greater than 0.
 					parse_count += count;
-					map.insert(name, child);
+					map.insert(internKey(name), child);
 				}
 				else
 				{
@@ -1130,7 +1139,7 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map) const
 			// There must be a value for every key, thus child_count
 			// must be greater than 0.
 			parse_count += child_count;
-			map.insert(name, child);
+			map.insert(internKey(name), child);
 		}
 		else
 		{
@@ -36,6 +36,7 @@
 #define LL_LLSDSERIALIZE_H
 
 #include <iosfwd>
+#include <set>
 #include "llsd.h"
 #include "llmemory.h"
 
@@ -199,6 +200,17 @@ protected:
 	 */
 	void account(S32 bytes) const;
 
+	/**
+	 * @brief Returns a shared copy of a map key seen during this parse.
+	 *
+	 * Map keys repeat heavily in large documents. Inserting the
+	 * returned string lets the maps share one key buffer where the
+	 * string implementation allows it.
+	 * @param key The key as read from the stream.
+	 * @return Returns the interned key.
+	 */
+	const std::string& internKey(const std::string& key) const;
+
 protected:
 	/**
 	 * @brief boolean to set if byte counts should be checked during parsing.
@@ -214,6 +226,11 @@ protected:
 	 * @brief Use line-based reading to get text
 	 */
 	bool mParseLines;
+
+	/**
+	 * @brief Map keys seen during the current parse.
+	 */
+	mutable std::set<std::string> mKeys;
 };
 
 /** 
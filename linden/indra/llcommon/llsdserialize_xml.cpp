@@ -321,6 +321,8 @@ private:
 	
 	std::string mCurrentKey;		// Current XML <tag>
 	std::string mCurrentContent;	// String data between <tag> and </tag>
+
+	std::set<std::string> mKeys;	// Map keys seen, shared between maps
 };
 
 
@@ -515,6 +517,7 @@ void LLSDXMLParser::Impl::reset()
 #else
 	mCurrentKey = std::string();
 #endif
+	mKeys.clear();
 
 	
 	XML_ParserReset(mParser, "utf-8");
@@ -708,7 +711,7 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 			return;
 	
 		case ELEMENT_KEY:
-			mCurrentKey = mCurrentContent;
+			mCurrentKey = *mKeys.insert(mCurrentContent).first;
 			return;
 			
 		default:
@@ -37,6 +37,7 @@
 #include "llthread.h"
 
 #include "lltimer.h"
+#include "lltracerecorder.h"
 
 #if LL_LINUX || LL_SOLARIS
 #include <sched.h>
@@ -75,9 +76,13 @@ void *APR_THREAD_FUNC LLThread::staticRun(apr_thread_t *apr_threadp, void *datap
 	// Create a thread local APRFile pool.
 	LLVolatileAPRPool::createLocalAPRFilePool();
 
+	LLTraceRecorder::setThreadName(threadp->mName);
+
 	// Run the user supplied function
 	threadp->run();
 
+	LLTraceRecorder::releaseThread();
+
 	llinfos << "LLThread::staticRun() Exiting: " << threadp->mName << llendl;
 	
 	// We're done with the run function, this thread is done executing now.
@@ -0,0 +1,674 @@
+/** 
+ * @file lltracerecorder.cpp
+ * @brief Per-thread timeline recorder with binary trace files and Chrome trace export
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltracerecorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "llapr.h"
+#include "llfasttimer.h"
+#include "llformat.h"
+#include "llthread.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// Trace file layout, all values little endian:
+//   header: U32 magic, U32 version, U64 clock counts per second
+//   then a sequence of records, each starting with a U8 tag:
+//   'N' name:   U16 id, U16 length, characters
+//   'T' thread: U32 thread id, U16 length, characters
+//   'E' events: U32 thread id, U32 count, count * (U64 time, U16 name, U8 type)
+
+static const U32 TRACE_MAGIC = 0x52544c4c; // "LLTR"
+static const U32 TRACE_VERSION = 1;
+
+static void write_u8(std::ostream& ostr, U8 v)
+{
+	ostr.put((char)v);
+}
+
+static void write_u16(std::ostream& ostr, U16 v)
+{
+	write_u8(ostr, (U8)(v & 0xff));
+	write_u8(ostr, (U8)(v >> 8));
+}
+
+static void write_u32(std::ostream& ostr, U32 v)
+{
+	write_u16(ostr, (U16)(v & 0xffff));
+	write_u16(ostr, (U16)(v >> 16));
+}
+
+static void write_u64(std::ostream& ostr, U64 v)
+{
+	write_u32(ostr, (U32)(v & 0xffffffff));
+	write_u32(ostr, (U32)(v >> 32));
+}
+
+static void write_string(std::ostream& ostr, const std::string& str)
+{
+	U16 len = (U16)llmin(str.size(), (size_t)0xffff);
+	write_u16(ostr, len);
+	ostr.write(str.data(), len);
+}
+
+static bool read_u8(std::istream& istr, U8& v)
+{
+	int c = istr.get();
+	v = (U8)c;
+	return c != EOF;
+}
+
+static bool read_u16(std::istream& istr, U16& v)
+{
+	U8 lo, hi;
+	if (!read_u8(istr, lo) || !read_u8(istr, hi)) return false;
+	v = (U16)(lo | (hi << 8));
+	return true;
+}
+
+static bool read_u32(std::istream& istr, U32& v)
+{
+	U16 lo, hi;
+	if (!read_u16(istr, lo) || !read_u16(istr, hi)) return false;
+	v = (U32)lo | ((U32)hi << 16);
+	return true;
+}
+
+static bool read_u64(std::istream& istr, U64& v)
+{
+	U32 lo, hi;
+	if (!read_u32(istr, lo) || !read_u32(istr, hi)) return false;
+	v = (U64)lo | ((U64)hi << 32);
+	return true;
+}
+
+static bool read_string(std::istream& istr, std::string& str)
+{
+	U16 len;
+	if (!read_u16(istr, len)) return false;
+	str.resize(len);
+	if (len)
+	{
+		istr.read(&str[0], len);
+	}
+	return istr.good() || (len == 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Single producer (the owning thread), single consumer (flush() on the
+// main thread) ring of events.
+class LLTraceBuffer
+{
+public:
+	enum { CAPACITY = 16384 };	// must be a power of two
+
+	struct Event
+	{
+		U64 mTime;
+		U16 mName;
+		U8 mType;
+	};
+
+	LLTraceBuffer(U32 id)
+		: mID(id), mHead(0), mTail(0), mDropped(0), mNameDirty(false), mExited(false),
+		  mEvents(NULL), mOpen(0), mSuppressed(0)
+	{
+	}
+
+	~LLTraceBuffer()
+	{
+		delete[] mEvents;
+	}
+
+	void push(U16 name, U8 type)
+	{
+		U32 head = mHead;
+		if (type == LLTraceRecorder::EVENT_BEGIN)
+		{
+			// A begin needs room for itself, its end, and the ends of the
+			// zones already open. Once a begin is dropped, its end and
+			// everything nested inside it are dropped too.
+			if (mSuppressed || head - (U32)mTail + mOpen + 2 > CAPACITY)
+			{
+				mSuppressed++;
+				mDropped++;
+				return;
+			}
+			mOpen++;
+		}
+		else if (mSuppressed)
+		{
+			mSuppressed--;
+			mDropped++;
+			return;
+		}
+		else
+		{
+			if (mOpen)
+			{
+				mOpen--;
+			}
+			if (head - (U32)mTail >= CAPACITY)
+			{
+				mDropped++;
+				return;
+			}
+		}
+
+		if (!mEvents)
+		{
+			mEvents = new Event[CAPACITY];
+		}
+		Event& event = mEvents[head & (CAPACITY - 1)];
+		event.mTime = get_cpu_clock_count();
+		event.mName = name;
+		event.mType = type;
+		mHead = head + 1;
+	}
+
+	void drain(std::ostream& ostr)
+	{
+		U32 head = mHead;
+		U32 tail = mTail;
+		if (head == tail)
+		{
+			return;
+		}
+		write_u8(ostr, 'E');
+		write_u32(ostr, mID);
+		write_u32(ostr, head - tail);
+		for ( ; tail != head; ++tail)
+		{
+			const Event& event = mEvents[tail & (CAPACITY - 1)];
+			write_u64(ostr, event.mTime);
+			write_u16(ostr, event.mName);
+			write_u8(ostr, event.mType);
+		}
+		mTail = head;
+	}
+
+	void discard()
+	{
+		mTail = (U32)mHead;
+	}
+
+	U32 mID;
+	LLAtomicU32 mHead;
+	LLAtomicU32 mTail;
+	LLAtomicU32 mDropped;
+
+	// Guarded by sMutex
+	std::string mThreadName;
+	bool mNameDirty;
+	bool mExited;
+
+private:
+	Event* mEvents;
+
+	// Owning thread only
+	U32 mOpen;			// recorded begins still waiting for their end
+	U32 mSuppressed;	// depth of zones being dropped
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// statics
+
+volatile bool LLTraceRecorder::sRecording = false;
+
+static LLMutex* sMutex = NULL;			// guards everything below
+static apr_pool_t* sPool = NULL;
+static apr_threadkey_t* sBufferKey = NULL;
+static std::vector<std::string> sNames;
+static std::map<std::string, U16> sNameIDs;
+static std::vector<LLTraceBuffer*> sBuffers;
+static U32 sNextThreadID = 1;
+static U32 sDroppedByExited = 0;		// events dropped by threads already gone
+static std::ofstream* sOutput = NULL;
+static U32 sNamesWritten = 0;
+
+//////////////////////////////////////////////////////////////////////////////
+
+//static
+void LLTraceRecorder::initClass()
+{
+	if (sMutex)
+	{
+		return;
+	}
+	apr_pool_create(&sPool, NULL);
+	sMutex = new LLMutex(sPool);
+	if (apr_threadkey_private_create(&sBufferKey, NULL, sPool) != APR_SUCCESS)
+	{
+		llwarns << "LLTraceRecorder: unable to create thread key, tracing disabled" << llendl;
+		sBufferKey = NULL;
+	}
+	// id 0 is never handed out, it marks an unnamed zone
+	sNames.push_back("(unnamed)");
+}
+
+//static
+void LLTraceRecorder::cleanupClass()
+{
+	if (!sMutex)
+	{
+		return;
+	}
+	stopSession();
+	for (std::vector<LLTraceBuffer*>::iterator it = sBuffers.begin(); it != sBuffers.end(); ++it)
+	{
+		delete *it;
+	}
+	sBuffers.clear();
+	sNames.clear();
+	sNameIDs.clear();
+	if (sBufferKey)
+	{
+		apr_threadkey_private_delete(sBufferKey);
+		sBufferKey = NULL;
+	}
+	delete sMutex;
+	sMutex = NULL;
+	apr_pool_destroy(sPool);
+	sPool = NULL;
+}
+
+//static
+U16 LLTraceRecorder::registerName(const std::string& name)
+{
+	if (!sMutex)
+	{
+		return 0;
+	}
+	LLMutexLock lock(sMutex);
+	std::map<std::string, U16>::iterator it = sNameIDs.find(name);
+	if (it != sNameIDs.end())
+	{
+		return it->second;
+	}
+	if (sNames.size() > 0xffff)
+	{
+		return 0;
+	}
+	U16 id = (U16)sNames.size();
+	sNames.push_back(name);
+	sNameIDs[name] = id;
+	return id;
+}
+
+//static
+LLTraceBuffer* LLTraceRecorder::getThreadBuffer()
+{
+	if (!sBufferKey)
+	{
+		return NULL;
+	}
+	void* data = NULL;
+	apr_threadkey_private_get(&data, sBufferKey);
+	if (!data)
+	{
+		LLMutexLock lock(sMutex);
+		LLTraceBuffer* buffer = new LLTraceBuffer(sNextThreadID++);
+		sBuffers.push_back(buffer);
+		apr_threadkey_private_set(buffer, sBufferKey);
+		data = buffer;
+	}
+	return (LLTraceBuffer*)data;
+}
+
+//static
+void LLTraceRecorder::setThreadName(const std::string& name)
+{
+	LLTraceBuffer* buffer = getThreadBuffer();
+	if (buffer)
+	{
+		LLMutexLock lock(sMutex);
+		buffer->mThreadName = name;
+		buffer->mNameDirty = true;
+	}
+}
+
+//static
+void LLTraceRecorder::releaseThread()
+{
+	if (!sBufferKey)
+	{
+		return;
+	}
+	void* data = NULL;
+	apr_threadkey_private_get(&data, sBufferKey);
+	if (!data)
+	{
+		return;
+	}
+	apr_threadkey_private_set(NULL, sBufferKey);
+
+	LLTraceBuffer* buffer = (LLTraceBuffer*)data;
+	LLMutexLock lock(sMutex);
+	if (sOutput)
+	{
+		// flush() writes out what is left and frees it
+		buffer->mExited = true;
+	}
+	else
+	{
+		sBuffers.erase(std::find(sBuffers.begin(), sBuffers.end(), buffer));
+		delete buffer;
+	}
+}
+
+//static
+void LLTraceRecorder::record(U16 name_id, EEventType type)
+{
+	LLTraceBuffer* buffer = getThreadBuffer();
+	if (buffer)
+	{
+		buffer->push(name_id, (U8)type);
+	}
+}
+
+//static
+bool LLTraceRecorder::startSession(const std::string& filename)
+{
+	if (!sMutex || sOutput)
+	{
+		return false;
+	}
+	std::ofstream* output = new std::ofstream(filename.c_str(), std::ios::out | std::ios::binary);
+	if (!output->is_open())
+	{
+		llwarns << "LLTraceRecorder: unable to open " << filename << llendl;
+		delete output;
+		return false;
+	}
+	write_u32(*output, TRACE_MAGIC);
+	write_u32(*output, TRACE_VERSION);
+	write_u64(*output, LLFastTimer::countsPerSecond());
+
+	LLFastTimer::initTraceNames();
+
+	{
+		LLMutexLock lock(sMutex);
+		sOutput = output;
+		sNamesWritten = 0;
+		sDroppedByExited = 0;
+		for (std::vector<LLTraceBuffer*>::iterator it = sBuffers.begin(); it != sBuffers.end(); ++it)
+		{
+			(*it)->discard();
+			(*it)->mDropped = 0;
+			(*it)->mNameDirty = true;
+		}
+	}
+	sRecording = true;
+	llinfos << "LLTraceRecorder: recording to " << filename << llendl;
+	return true;
+}
+
+//static
+void LLTraceRecorder::stopSession()
+{
+	if (!sOutput)
+	{
+		return;
+	}
+	sRecording = false;
+	flush();
+
+	U32 dropped = 0;
+	{
+		LLMutexLock lock(sMutex);
+		dropped = sDroppedByExited;
+		for (std::vector<LLTraceBuffer*>::iterator it = sBuffers.begin(); it != sBuffers.end(); ++it)
+		{
+			dropped += (*it)->mDropped;
+		}
+		sOutput->close();
+		delete sOutput;
+		sOutput = NULL;
+	}
+	llinfos << "LLTraceRecorder: session closed, " << dropped << " events dropped" << llendl;
+}
+
+//static
+void LLTraceRecorder::flush()
+{
+	if (!sOutput)
+	{
+		return;
+	}
+	LLMutexLock lock(sMutex);
+	std::ostream& ostr = *sOutput;
+
+	for ( ; sNamesWritten < sNames.size(); ++sNamesWritten)
+	{
+		write_u8(ostr, 'N');
+		write_u16(ostr, (U16)sNamesWritten);
+		write_string(ostr, sNames[sNamesWritten]);
+	}
+
+	for (std::vector<LLTraceBuffer*>::iterator it = sBuffers.begin(); it != sBuffers.end(); )
+	{
+		LLTraceBuffer* buffer = *it;
+		if (buffer->mNameDirty)
+		{
+			write_u8(ostr, 'T');
+			write_u32(ostr, buffer->mID);
+			write_string(ostr, buffer->mThreadName);
+			buffer->mNameDirty = false;
+		}
+		buffer->drain(ostr);
+
+		if (buffer->mExited)
+		{
+			sDroppedByExited += buffer->mDropped;
+			delete buffer;
+			it = sBuffers.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	struct TraceEvent
+	{
+		U64 mTime;
+		U32 mThread;
+		U16 mName;
+		U8 mType;
+	};
+
+	std::string json_escape(const std::string& str)
+	{
+		std::string out;
+		for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+		{
+			char c = *it;
+			if (c == '"' || c == '\\')
+			{
+				out += '\\';
+				out += c;
+			}
+			else if ((U8)c < 0x20)
+			{
+				out += llformat("\\u%04x", (U32)(U8)c);
+			}
+			else
+			{
+				out += c;
+			}
+		}
+		return out;
+	}
+}
+
+//static
+bool LLTraceRecorder::convertToChromeTrace(const std::string& trace_filename, const std::string& json_filename)
+{
+	std::ifstream istr(trace_filename.c_str(), std::ios::in | std::ios::binary);
+	if (!istr.is_open())
+	{
+		llwarns << "LLTraceRecorder: unable to open " << trace_filename << llendl;
+		return false;
+	}
+
+	U32 magic = 0, version = 0;
+	U64 counts_per_second = 0;
+	if (!read_u32(istr, magic) || !read_u32(istr, version) || !read_u64(istr, counts_per_second)
+		|| magic != TRACE_MAGIC || version != TRACE_VERSION || !counts_per_second)
+	{
+		llwarns << "LLTraceRecorder: " << trace_filename << " is not a trace file" << llendl;
+		return false;
+	}
+
+	// Names can be defined after the events that use them, so read
+	// everything before writing.
+	std::map<U16, std::string> names;
+	std::map<U32, std::string> threads;
+	std::vector<TraceEvent> events;
+	U8 tag;
+	while (read_u8(istr, tag))
+	{
+		bool ok = true;
+		if (tag == 'N')
+		{
+			U16 id;
+			ok = read_u16(istr, id) && read_string(istr, names[id]);
+		}
+		else if (tag == 'T')
+		{
+			U32 id;
+			ok = read_u32(istr, id) && read_string(istr, threads[id]);
+		}
+		else if (tag == 'E')
+		{
+			U32 thread, count;
+			ok = read_u32(istr, thread) && read_u32(istr, count);
+			for (U32 i = 0; ok && i < count; i++)
+			{
+				TraceEvent event;
+				event.mThread = thread;
+				ok = read_u64(istr, event.mTime) && read_u16(istr, event.mName) && read_u8(istr, event.mType);
+				if (ok)
+				{
+					events.push_back(event);
+				}
+			}
+		}
+		else
+		{
+			ok = false;
+		}
+		if (!ok)
+		{
+			// A session cut short still converts up to the damage
+			llwarns << "LLTraceRecorder: " << trace_filename << " is truncated or corrupt" << llendl;
+			break;
+		}
+	}
+
+	std::ofstream ostr(json_filename.c_str());
+	if (!ostr.is_open())
+	{
+		llwarns << "LLTraceRecorder: unable to open " << json_filename << llendl;
+		return false;
+	}
+
+	// Skip begins and ends that lost their partner, e.g. zones that were
+	// open when the session started or stopped.
+	std::vector<bool> matched(events.size(), false);
+	std::map<U32, std::vector<size_t> > open_zones;
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		std::vector<size_t>& stack = open_zones[events[i].mThread];
+		if (events[i].mType == EVENT_BEGIN)
+		{
+			stack.push_back(i);
+		}
+		else if (!stack.empty() && events[stack.back()].mName == events[i].mName)
+		{
+			matched[stack.back()] = true;
+			matched[i] = true;
+			stack.pop_back();
+		}
+	}
+
+	U64 start = 0;
+	bool have_start = false;
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		if (matched[i] && (!have_start || events[i].mTime < start))
+		{
+			start = events[i].mTime;
+			have_start = true;
+		}
+	}
+
+	ostr << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (std::map<U32, std::string>::iterator it = threads.begin(); it != threads.end(); ++it)
+	{
+		if (!first) ostr << ",\n";
+		first = false;
+		ostr << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it->first
+			 << ",\"args\":{\"name\":\"" << json_escape(it->second) << "\"}}";
+	}
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		if (!matched[i])
+		{
+			continue;
+		}
+		const TraceEvent* it = &events[i];
+		if (!first) ostr << ",\n";
+		first = false;
+		F64 usec = (F64)(it->mTime - start) * 1000000.0 / (F64)counts_per_second;
+		std::map<U16, std::string>::iterator name = names.find(it->mName);
+		ostr << "{\"name\":\"" << json_escape(name != names.end() ? name->second : llformat("zone %d", it->mName))
+			 << "\",\"ph\":\"" << (it->mType == EVENT_BEGIN ? "B" : "E")
+			 << "\",\"ts\":" << llformat("%.3f", usec)
+			 << ",\"pid\":1,\"tid\":" << it->mThread << "}";
+	}
+	ostr << "\n]}\n";
+
+	return ostr.good();
+}
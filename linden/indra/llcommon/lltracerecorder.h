@@ -0,0 +1,121 @@
+/** 
+ * @file lltracerecorder.h
+ * @brief Per-thread timeline recorder with binary trace files and Chrome trace export
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRACERECORDER_H
+#define LL_LLTRACERECORDER_H
+
+#include <string>
+
+class LLTraceBuffer;
+
+// Records begin/end events from any thread into per-thread ring buffers.
+// Recording a zone is O(1) and takes no lock: each thread writes only to
+// its own buffer, and the main thread drains all of them into the session
+// file in flush(). Zone names are registered at run time.
+//
+// The session file is a compact binary stream; convertToChromeTrace()
+// turns it into the JSON read by chrome://tracing.
+class LLTraceRecorder
+{
+public:
+	enum EEventType
+	{
+		EVENT_BEGIN = 0,
+		EVENT_END = 1
+	};
+
+	static void initClass();
+	static void cleanupClass();
+
+	// Returns the id for name, registering it on first use. Thread safe.
+	static U16 registerName(const std::string& name);
+
+	// Names the calling thread in the trace. Thread safe.
+	static void setThreadName(const std::string& name);
+
+	// Frees the calling thread's buffer once its events are written.
+	// Call before a thread exits.
+	static void releaseThread();
+
+	static bool isRecording() { return sRecording; }
+
+	// O(1), lock free. The event storage is allocated on the first event.
+	// When the thread's buffer is full, whole zones are dropped, so every
+	// recorded begin keeps its end.
+	static void begin(U16 name_id) { record(name_id, EVENT_BEGIN); }
+	static void end(U16 name_id) { record(name_id, EVENT_END); }
+
+	// Main thread only.
+	static bool startSession(const std::string& filename);
+	static void stopSession();
+	static void flush();	// call once per frame while recording
+
+	static bool convertToChromeTrace(const std::string& trace_filename, const std::string& json_filename);
+
+private:
+	static void record(U16 name_id, EEventType type);
+	static LLTraceBuffer* getThreadBuffer();
+
+private:
+	static volatile bool sRecording;
+};
+
+// Records a zone for the lifetime of the object when a session is open.
+class LLTraceZone
+{
+public:
+	LLTraceZone(U16 name_id)
+		: mNameID(name_id), mActive(LLTraceRecorder::isRecording())
+	{
+		if (mActive)
+		{
+			LLTraceRecorder::begin(mNameID);
+		}
+	}
+	~LLTraceZone()
+	{
+		if (mActive)
+		{
+			LLTraceRecorder::end(mNameID);
+		}
+	}
+
+private:
+	U16 mNameID;
+	bool mActive;
+};
+
+#define LL_TRACE_ZONE(name) \
+	static U16 trace_zone_id = LLTraceRecorder::registerName(name); \
+	LLTraceZone trace_zone(trace_zone_id)
+
+#endif // LL_LLTRACERECORDER_H
@@ -37,6 +37,7 @@
 #include "llmath.h"
 #include "v4coloru.h"
 #include "llmemtype.h"
+#include "llsys.h"
 
 #include "llimagebmp.h"
 #include "llimagetga.h"
@@ -58,6 +59,7 @@ LLMutex* LLImage::sMutex = NULL;
 void LLImage::initClass(const bool& useDSO)
 {
 	sMutex = new LLMutex(NULL);
+	LLImageRaw::setUseSIMD(gSysCPU.hasSSE2());
 	if (useDSO)
 	{
 		LLImageJ2C::openDSO();
@@ -248,6 +250,14 @@ U8* LLImageBase::allocateDataSize(S32 width, S32 height, S32 ncomponents, S32 si
 
 S32 LLImageRaw::sGlobalRawMemory = 0;
 S32 LLImageRaw::sRawImageCount = 0;
+bool LLImageRaw::sUseSIMD = false;
+
+//static
+void LLImageRaw::setUseSIMD(bool use_simd)
+{
+	sUseSIMD = use_simd && isSSE2Compiled();
+	llinfos << "LLImageRaw SIMD scaling: " << (sUseSIMD ? "SSE2" : "disabled") << llendl;
+}
 
 LLImageRaw::LLImageRaw()
 	: LLImageBase()
@@ -482,7 +492,7 @@ void LLImageRaw::contractToPowerOfTwo(S32 max_dim, BOOL scale_image)
 	scale( new_width, new_height, scale_image );
 }
 
-void LLImageRaw::biasedScaleToPowerOfTwo(S32 max_dim)
+void LLImageRaw::biasedScaleToPowerOfTwo(S32 max_dim, EScaleFilter filter)
 {
 	// Strong bias towards rounding down (to save bandwidth)
 	// No bias would mean THRESHOLD == 1.5f;
@@ -509,7 +519,7 @@ void LLImageRaw::biasedScaleToPowerOfTwo(S32 max_dim)
 	S32 new_height = ( (F32)getHeight() / smaller_h > THRESHOLD ) ? larger_h : smaller_h;
 
 
-	scale( new_width, new_height );
+	scale( new_width, new_height, TRUE, filter );
 }
 
 
@@ -878,7 +888,158 @@ BOOL LLImageRaw::scaleDownWithoutBlending( S32 new_width, S32 new_height)
 	return TRUE ;
 }
 
-BOOL LLImageRaw::scale( S32 new_width, S32 new_height, BOOL scale_image_data )
+//----------------------------------------------------------------------------
+// Separable resampling filters used by scale() for anything but the box filter.
+
+namespace
+{
+	// Input span and weights for one output pixel
+	struct ResampleContrib
+	{
+		S32 mFirst;
+		S32 mCount;
+		S32 mWeightOffset;
+	};
+
+	F32 resample_support(LLImageRaw::EScaleFilter filter)
+	{
+		return (LLImageRaw::SCALE_FILTER_LANCZOS == filter) ? 3.f : 1.f;
+	}
+
+	F32 resample_weight(LLImageRaw::EScaleFilter filter, F32 x)
+	{
+		x = fabsf(x);
+		if (LLImageRaw::SCALE_FILTER_LANCZOS == filter)
+		{
+			if (x < 1.0e-5f)
+			{
+				return 1.f;
+			}
+			if (x >= 3.f)
+			{
+				return 0.f;
+			}
+			F32 pix = F_PI * x;
+			return 3.f * sinf(pix) * sinf(pix / 3.f) / (pix * pix);
+		}
+		return llmax(0.f, 1.f - x);
+	}
+
+	// Builds the contributions of in_len input pixels to each of out_len
+	// output pixels. When minifying the kernel is widened by the ratio so
+	// every input pixel contributes.
+	void resample_build(LLImageRaw::EScaleFilter filter, S32 in_len, S32 out_len,
+						std::vector<ResampleContrib>& contribs, std::vector<F32>& weights)
+	{
+		const F32 ratio = F32(in_len) / out_len;
+		const F32 kernel_scale = llmax(ratio, 1.f);
+		const F32 support = resample_support(filter) * kernel_scale;
+
+		contribs.resize(out_len);
+		weights.clear();
+		for (S32 x = 0; x < out_len; x++)
+		{
+			const F32 center = (x + 0.5f) * ratio;
+			S32 first = llmax(0, llfloor(center - support));
+			S32 last = llmin(in_len - 1, llceil(center + support));
+
+			ResampleContrib& contrib = contribs[x];
+			contrib.mWeightOffset = weights.size();
+			F32 total = 0.f;
+			for (S32 i = first; i <= last; i++)
+			{
+				F32 w = resample_weight(filter, (i + 0.5f - center) / kernel_scale);
+				weights.push_back(w);
+				total += w;
+			}
+			if (total == 0.f)
+			{
+				// Degenerate span, fall back to the nearest pixel
+				weights.resize(contrib.mWeightOffset);
+				first = llclamp(llfloor(center), 0, in_len - 1);
+				last = first;
+				weights.push_back(1.f);
+				total = 1.f;
+			}
+			contrib.mFirst = first;
+			contrib.mCount = last - first + 1;
+
+			const F32 norm = 1.f / total;
+			for (S32 i = 0; i < contrib.mCount; i++)
+			{
+				weights[contrib.mWeightOffset + i] *= norm;
+			}
+		}
+	}
+
+	inline U8 resample_clamp(F32 v)
+	{
+		return (U8)llclamp(llround(v), 0, 255);
+	}
+
+	void resample_filtered(const U8* in, S32 in_width, S32 in_height,
+						   U8* out, S32 out_width, S32 out_height,
+						   S32 components, LLImageRaw::EScaleFilter filter)
+	{
+		std::vector<ResampleContrib> contribs;
+		std::vector<F32> weights;
+
+		// Vertical: one output row is a weighted sum of whole input rows,
+		// which keeps the memory access linear.
+		const S32 in_row_len = in_width * components;
+		std::vector<U8> temp_buffer(in_row_len * out_height);
+		std::vector<F32> accum(in_row_len);
+		resample_build(filter, in_height, out_height, contribs, weights);
+		for (S32 y = 0; y < out_height; y++)
+		{
+			const ResampleContrib& contrib = contribs[y];
+			std::fill(accum.begin(), accum.end(), 0.f);
+			for (S32 k = 0; k < contrib.mCount; k++)
+			{
+				const F32 w = weights[contrib.mWeightOffset + k];
+				const U8* row = in + (contrib.mFirst + k) * in_row_len;
+				for (S32 i = 0; i < in_row_len; i++)
+				{
+					accum[i] += row[i] * w;
+				}
+			}
+			U8* dst = &temp_buffer[0] + y * in_row_len;
+			for (S32 i = 0; i < in_row_len; i++)
+			{
+				dst[i] = resample_clamp(accum[i]);
+			}
+		}
+
+		// Horizontal
+		resample_build(filter, in_width, out_width, contribs, weights);
+		for (S32 y = 0; y < out_height; y++)
+		{
+			const U8* src_row = &temp_buffer[0] + y * in_row_len;
+			U8* dst = out + y * out_width * components;
+			for (S32 x = 0; x < out_width; x++)
+			{
+				const ResampleContrib& contrib = contribs[x];
+				F32 sum[4] = { 0.f, 0.f, 0.f, 0.f };
+				const U8* src = src_row + contrib.mFirst * components;
+				for (S32 k = 0; k < contrib.mCount; k++)
+				{
+					const F32 w = weights[contrib.mWeightOffset + k];
+					for (S32 c = 0; c < components; c++)
+					{
+						sum[c] += src[c] * w;
+					}
+					src += components;
+				}
+				for (S32 c = 0; c < components; c++)
+				{
+					*dst++ = resample_clamp(sum[c]);
+				}
+			}
+		}
+	}
+}
+
+BOOL LLImageRaw::scale( S32 new_width, S32 new_height, BOOL scale_image_data, EScaleFilter filter )
 {
 	LLMemType mt1((LLMemType::EMemType)mMemType);
 	llassert((1 == getComponents()) || (3 == getComponents()) || (4 == getComponents()) );
@@ -893,7 +1054,17 @@ BOOL LLImageRaw::scale( S32 new_width, S32 new_height, BOOL scale_image_data )
 
 	// Reallocate the data buffer.
 
-	if (scale_image_data)
+	if (scale_image_data && filter != SCALE_FILTER_BOX)
+	{
+		S32 old_data_size = old_width * old_height * getComponents();
+		llassert_always(old_data_size > 0);
+		std::vector<U8> old_buffer(getData(), getData() + old_data_size);
+
+		U8* new_buffer = allocateDataSize(new_width, new_height, getComponents());
+		resample_filtered(&old_buffer[0], old_width, old_height,
+						  new_buffer, new_width, new_height, getComponents(), filter);
+	}
+	else if (scale_image_data)
 	{
 		S32 temp_data_size = old_width * new_height * getComponents();
 		llassert_always(temp_data_size > 0);
@@ -952,6 +1123,12 @@ void LLImageRaw::copyLineScaled( U8* in, U8* out, S32 in_pixel_len, S32 out_pixe
 	const S32 components = getComponents();
 	llassert( components >= 1 && components <= 4 );
 
+	if (sUseSIMD && 4 == components)
+	{
+		copyLineScaled4SSE2(in, out, in_pixel_len, out_pixel_len, in_pixel_step, out_pixel_step);
+		return;
+	}
+
 	const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
 	const F32 norm_factor = 1.f / ratio;
 
@@ -168,6 +168,14 @@ protected:
 	/*virtual*/ ~LLImageRaw();
 	
 public:
+	// Resampling filters for scale()
+	enum EScaleFilter
+	{
+		SCALE_FILTER_BOX = 0,	// area average; fast, default
+		SCALE_FILTER_BILINEAR,	// triangle filter, widened when minifying
+		SCALE_FILTER_LANCZOS	// 3-lobe Lanczos; sharpest, slowest
+	};
+
 	LLImageRaw();
 	LLImageRaw(U16 width, U16 height, S8 components);
 	LLImageRaw(U8 *data, U16 width, U16 height, S8 components);
@@ -190,8 +198,8 @@ public:
 
 	void expandToPowerOfTwo(S32 max_dim = MAX_IMAGE_SIZE, BOOL scale_image = TRUE);
 	void contractToPowerOfTwo(S32 max_dim = MAX_IMAGE_SIZE, BOOL scale_image = TRUE);
-	void biasedScaleToPowerOfTwo(S32 max_dim = MAX_IMAGE_SIZE);
-	BOOL scale( S32 new_width, S32 new_height, BOOL scale_image = TRUE );
+	void biasedScaleToPowerOfTwo(S32 max_dim = MAX_IMAGE_SIZE, EScaleFilter filter = SCALE_FILTER_BOX);
+	BOOL scale( S32 new_width, S32 new_height, BOOL scale_image = TRUE, EScaleFilter filter = SCALE_FILTER_BOX );
 	BOOL scaleDownWithoutBlending( S32 new_width, S32 new_height) ;
 
 	// Fill the buffer with a constant color
@@ -239,6 +247,10 @@ protected:
 	void copyLineScaled( U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step );
 	void compositeRowScaled4onto3( U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len );
 
+	// SSE2 version of the box filter inner loop for 4 component images,
+	// see llimage_sse2.cpp
+	static void copyLineScaled4SSE2( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step );
+
 	U8	fastFractionalMult(U8 a,U8 b);
 
 	void setDataAndSize(U8 *data, S32 width, S32 height, S8 components) ;
@@ -246,6 +258,16 @@ protected:
 public:
 	static S32 sGlobalRawMemory;
 	static S32 sRawImageCount;
+
+	// Use the SIMD inner loops when the CPU and build support them.
+	// Set from LLImage::initClass() according to gSysCPU.
+	static void setUseSIMD(bool use_simd);
+	static bool getUseSIMD() { return sUseSIMD; }
+	// Whether llimage_sse2.cpp was built with SSE2 code generation
+	static bool isSSE2Compiled();
+
+private:
+	static bool sUseSIMD;
 };
 
 // Compressed representation of image.
@@ -294,6 +316,8 @@ public:
 	virtual BOOL decode(LLImageRaw* raw_image, F32 decode_time) = 0;  
 	// Subclasses that can handle more than 4 channels should override this function.
 	virtual BOOL decodeChannels(LLImageRaw* raw_image, F32 decode_time, S32 first_channel, S32 max_channel);
+	// Codecs that keep decoder state between decodeChannels() calls free it here.
+	virtual void releaseDecodeCache() {}
 
 	virtual BOOL encode(const LLImageRaw* raw_image, F32 encode_time) = 0;
 
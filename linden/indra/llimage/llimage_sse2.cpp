@@ -0,0 +1,146 @@
+/** 
+ * @file llimage_sse2.cpp
+ * @brief SSE2 inner loops for LLImageRaw
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+// Visual Studio required settings for this file:
+// Code Generation: SSE2
+//
+// Like llviewerjointmesh_sse2.cpp this is the only file in llimage built
+// with SSE2 code generation, and it is only called after LLImage::initClass()
+// has checked gSysCPU.hasSSE2(). Keep file-level statics out of it.
+
+#include "linden_common.h"
+
+#include "llimage.h"
+
+#include "llmath.h"
+
+#if defined(__SSE2__) || (LL_MSVC && (_M_IX86_FP >= 2 || defined(_M_X64)))
+#define LL_IMAGE_SSE2 1
+#include <emmintrin.h>
+#else
+#define LL_IMAGE_SSE2 0
+#endif
+
+//static
+bool LLImageRaw::isSSE2Compiled()
+{
+	return LL_IMAGE_SSE2 ? true : false;
+}
+
+#if LL_IMAGE_SSE2
+
+// One RGBA pixel widened to four floats
+inline __m128 load_pixel4(const U8* p, __m128i zero)
+{
+	S32 packed;
+	memcpy(&packed, p, sizeof(S32));		/* Flawfinder: ignore */
+	__m128i v = _mm_cvtsi32_si128(packed);
+	v = _mm_unpacklo_epi8(v, zero);
+	v = _mm_unpacklo_epi16(v, zero);
+	return _mm_cvtepi32_ps(v);
+}
+
+// Rounds like llround() (floor(x + 0.5)) for the non-negative values we
+// produce and packs back to four bytes with saturation.
+inline void store_pixel4(U8* p, __m128 v)
+{
+	__m128i i = _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+	i = _mm_packs_epi32(i, i);
+	i = _mm_packus_epi16(i, i);
+	S32 packed = _mm_cvtsi128_si32(i);
+	memcpy(p, &packed, sizeof(S32));		/* Flawfinder: ignore */
+}
+
+// Same area-average filter as LLImageRaw::copyLineScaled(), with the four
+// channels of a pixel processed in one register.
+//static
+void LLImageRaw::copyLineScaled4SSE2( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step )
+{
+	const S32 COMPONENTS = 4;
+	const __m128i zero = _mm_setzero_si128();
+
+	const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+	const __m128 norm_factor = _mm_set1_ps(1.f / ratio);
+
+	const S32 in_stride = in_pixel_step * COMPONENTS;
+	const S32 out_stride = out_pixel_step * COMPONENTS;
+
+	for( S32 x = 0; x < out_pixel_len; x++ )
+	{
+		// Avoid floating point accumulation error... don't just add ratio each time.  JC
+		const F32 sample0 = x * ratio;
+		const F32 sample1 = (x+1) * ratio;
+		const S32 index0 = llfloor(sample0);			// left integer (floor)
+		const S32 index1 = llfloor(sample1);			// right integer (floor)
+		const F32 fract0 = 1.f - (sample0 - F32(index0));	// spill over on left
+		const F32 fract1 = sample1 - F32(index1);			// spill-over on right
+
+		U8* outp = out + x * out_stride;
+		if( index0 == index1 )
+		{
+			// Interval is embedded in one input pixel
+			memcpy(outp, in + index0 * in_stride, COMPONENTS);		/* Flawfinder: ignore */
+			continue;
+		}
+
+		// Left straddle
+		__m128 sum = _mm_mul_ps(load_pixel4(in + index0 * in_stride, zero), _mm_set1_ps(fract0));
+
+		// Central interval
+		const U8* inp = in + (index0 + 1) * in_stride;
+		for( S32 u = index0 + 1; u < index1; u++ )
+		{
+			sum = _mm_add_ps(sum, load_pixel4(inp, zero));
+			inp += in_stride;
+		}
+
+		// Right straddle
+		// Watch out for reading off of end of input array.
+		if( fract1 && index1 < in_pixel_len )
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(load_pixel4(in + index1 * in_stride, zero), _mm_set1_ps(fract1)));
+		}
+
+		store_pixel4(outp, _mm_mul_ps(sum, norm_factor));
+	}
+}
+
+#else // LL_IMAGE_SSE2
+
+//static
+void LLImageRaw::copyLineScaled4SSE2( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step )
+{
+	// setUseSIMD() never enables this path without SSE2 code generation
+	llerrs << "LLImageRaw::copyLineScaled4SSE2 called in a build without SSE2" << llendl;
+}
+
+#endif // LL_IMAGE_SSE2
@@ -232,6 +232,15 @@ void LLImageJ2C::resetLastError()
 	mLastError.clear();
 }
 
+// virtual
+void LLImageJ2C::releaseDecodeCache()
+{
+	if (mImpl)
+	{
+		mImpl->releaseDecodeCache();
+	}
+}
+
 //virtual
 void LLImageJ2C::setLastError(const std::string& message, const std::string& filename)
 {
@@ -55,6 +55,7 @@ public:
 	/*virtual*/ S32 calcDataSize(S32 discard_level = 0);
 	/*virtual*/ S32 calcDiscardLevelBytes(S32 bytes);
 	/*virtual*/ S8  getRawDiscardLevel();
+	/*virtual*/ void releaseDecodeCache();
 	// Override these so that we don't try to set a global variable from a DLL
 	/*virtual*/ void resetLastError();
 	/*virtual*/ void setLastError(const std::string& message, const std::string& filename = std::string());
@@ -118,6 +119,9 @@ protected:
 	virtual BOOL decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count) = 0;
 	virtual BOOL encodeImpl(LLImageJ2C &base, const LLImageRaw &raw_image, const char* comment_text, F32 encode_time=0.0,
 							BOOL reversible=FALSE) = 0;
+	// Drop any decoder state kept around between decodeImpl() calls on the
+	// same data (e.g. the decoded codestream held for a later aux channel).
+	virtual void releaseDecodeCache() {}
 
 	friend class LLImageJ2C;
 };
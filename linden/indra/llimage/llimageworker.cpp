@@ -157,6 +157,11 @@ bool LLImageDecodeThread::ImageRequest::processRequest()
 		done = mFormattedImage->decodeChannels(mDecodedImageAux, decode_time_slice, 4, 4); // 1ms
 		mDecodedAux = done;
 	}
+	if (done && mFormattedImage.notNull())
+	{
+		// Nothing more will be decoded from this data by this request
+		mFormattedImage->releaseDecodeCache();
+	}
 
 	return done;
 }
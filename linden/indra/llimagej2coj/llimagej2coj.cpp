@@ -100,22 +100,35 @@ void info_callback(const char* msg, void*)
 LLImageJ2COJ::LLImageJ2COJ() : LLImageJ2CImpl()
 {
 	mRawImagep=NULL;
+	mDecodedImage = NULL;
+	mDecodedData = NULL;
+	mDecodedDataSize = 0;
+	mDecodedDiscard = -1;
 }
 
 
 LLImageJ2COJ::~LLImageJ2COJ()
 {
+	releaseDecodeCache();
 }
 
-
-BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count)
+// virtual
+void LLImageJ2COJ::releaseDecodeCache()
 {
-	//
-	// FIXME: Get the comment field out of the texture
-	//
-
-	LLTimer decode_timer;
+	if (mDecodedImage)
+	{
+		opj_image_destroy(mDecodedImage);
+		mDecodedImage = NULL;
+	}
+	mDecodedData = NULL;
+	mDecodedDataSize = 0;
+	mDecodedDiscard = -1;
+}
 
+// Runs the OpenJPEG decoder over the whole codestream held by base.
+// Returns NULL on failure.
+static opj_image_t* decode_codestream(LLImageJ2C &base, S8 discard_level)
+{
 	opj_dparameters_t parameters;	/* decompression parameters */
 	opj_event_mgr_t event_mgr;		/* event manager */
 	opj_image_t *image = NULL;
@@ -133,7 +146,7 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 	/* set decoding parameters to default values */
 	opj_set_default_decoder_parameters(&parameters);
 
-	parameters.cp_reduce = base.getRawDiscardLevel();
+	parameters.cp_reduce = discard_level;
 
 	/* decode the code-stream */
 	/* ---------------------- */
@@ -164,6 +177,38 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 		opj_destroy_decompress(dinfo);
 	}
 
+	return image;
+}
+
+
+BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count)
+{
+	//
+	// FIXME: Get the comment field out of the texture
+	//
+
+	LLTimer decode_timer;
+
+	opj_image_t *image = NULL;
+	S8 discard_level = base.getRawDiscardLevel();
+
+	if (mDecodedImage
+		&& mDecodedData == base.getData()
+		&& mDecodedDataSize == base.getDataSize()
+		&& mDecodedDiscard == discard_level)
+	{
+		// The previous call decoded this exact codestream and left channels
+		// behind (typically the aux channel), so take them from that decode
+		// instead of running the whole wavelet decode again.
+		image = mDecodedImage;
+		mDecodedImage = NULL;
+	}
+	else
+	{
+		releaseDecodeCache();
+		image = decode_codestream(base, discard_level);
+	}
+
 	// The image decode failed if the return was NULL or the component
 	// count was zero.  The latter is just a sanity check before we
 	// dereference the array.
@@ -189,7 +234,7 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 	// sometimes we get bad data out of the cache - check to see if the decode succeeded
 	for (S32 i = 0; i < img_components; i++)
 	{
-		if (image->comps[i].factor != base.getRawDiscardLevel())
+		if (image->comps[i].factor != discard_level)
 		{
 			// if we didn't get the discard level we're expecting, fail
 			if (image) //anyway somthing odd with the image, better check than crash
@@ -258,10 +303,20 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 		}
 	}
 
-	/* free image data structure */
-	if (image)
+	if (first_channel + channels < img_components)
+	{
+		// Channels remain that the caller may ask for next; hold on to the
+		// decoded image until then.
+		mDecodedImage = image;
+		mDecodedData = base.getData();
+		mDecodedDataSize = base.getDataSize();
+		mDecodedDiscard = discard_level;
+	}
+	else
 	{
+		/* free image data structure */
 		opj_image_destroy(image);
+		releaseDecodeCache();
 	}
 
 	return TRUE; // done
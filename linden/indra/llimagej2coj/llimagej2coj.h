@@ -35,6 +35,8 @@
 
 #include "llimagej2c.h"
 
+struct opj_image;
+
 class LLImageJ2COJ : public LLImageJ2CImpl
 {	
 public:
@@ -46,6 +48,7 @@ protected:
 	/*virtual*/ BOOL decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count);
 	/*virtual*/ BOOL encodeImpl(LLImageJ2C &base, const LLImageRaw &raw_image, const char* comment_text, F32 encode_time=0.0,
 								BOOL reversible = FALSE);
+	/*virtual*/ void releaseDecodeCache();
 	int ceildivpow2(int a, int b)
 	{
 		// Divide a by b to the power of 2 and round upwards.
@@ -54,6 +57,13 @@ protected:
 
 	// Temporary variables for in-progress decodes...
 	LLImageRaw *mRawImagep;
+
+	// Last decoded codestream, kept while it still has channels the caller
+	// has not asked for yet, keyed on the data it was decoded from.
+	struct opj_image* mDecodedImage;
+	const U8* mDecodedData;
+	S32 mDecodedDataSize;
+	S8 mDecodedDiscard;
 };
 
 #endif
@@ -316,6 +316,53 @@ S32 LLCamera::AABBInFrustumNoFarClip(const LLVector3 &center, const LLVector3& r
 	return result;
 }
 
+S32 LLCamera::AABBInFrustumNoFarClip(const LLVector3 &center, const LLVector3& radius, U8& plane_hint)
+{
+	// Test the plane that rejected this box last time first.
+	if (plane_hint < mPlaneCount && plane_hint != 5)
+	{
+		const frustum_plane& fp = mAgentPlanes[plane_hint];
+		LLVector3 n = LLVector3(fp.p);
+		LLVector3 rscale(fp.mask & 1 ? radius.mV[VX] : -radius.mV[VX],
+						 fp.mask & 2 ? radius.mV[VY] : -radius.mV[VY],
+						 fp.mask & 4 ? radius.mV[VZ] : -radius.mV[VZ]);
+		if (n * (center - rscale) > -fp.p.mV[3])
+		{
+			return 0;
+		}
+	}
+
+	S32 result = 2;
+
+	for (U32 i = 0; i < mPlaneCount; i++)
+	{
+		if (i == 5)
+		{
+			continue;
+		}
+
+		const frustum_plane& fp = mAgentPlanes[i];
+		LLVector3 n = LLVector3(fp.p);
+		float d = fp.p.mV[3];
+		LLVector3 rscale(fp.mask & 1 ? radius.mV[VX] : -radius.mV[VX],
+						 fp.mask & 2 ? radius.mV[VY] : -radius.mV[VY],
+						 fp.mask & 4 ? radius.mV[VZ] : -radius.mV[VZ]);
+
+		if (n * (center - rscale) > -d)
+		{
+			plane_hint = (U8) i;
+			return 0;
+		}
+
+		if (n * (center + rscale) > -d)
+		{
+			result = 1;
+		}
+	}
+
+	return result;
+}
+
 int LLCamera::sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius) 
 {
 	LLVector3 dist = sphere_center-mFrustCenter;
@@ -187,6 +187,10 @@ public:
 	S32 sphereInFrustumFull(const LLVector3 &center, const F32 radius) const { return sphereInFrustum(center, radius); }
 	S32 AABBInFrustum(const LLVector3 &center, const LLVector3& radius);
 	S32 AABBInFrustumNoFarClip(const LLVector3 &center, const LLVector3& radius);
+	// Same as above, but tests plane_hint first and stores the plane that
+	// rejected the box there.  Boxes tested every frame tend to be rejected
+	// by the same plane, so this usually costs a single plane test.
+	S32 AABBInFrustumNoFarClip(const LLVector3 &center, const LLVector3& radius, U8& plane_hint);
 
 	//does a quick 'n dirty sphere-sphere check
 	S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius); 
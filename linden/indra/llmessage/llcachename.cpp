@@ -63,6 +63,17 @@ const U32 PENDING_TIMEOUT_SECS = 5 * 60;
 // File version number
 const S32 CN_FILE_VERSION = 2;
 
+// Binary cache file header. The magic doubles as a byte order check
+// since the records are stored in native byte order.
+const U32 CN_BINARY_MAGIC = 0x434e4c4c; // 'LLNC'
+const U32 CN_BINARY_VERSION = 1;
+
+// Binary record flags
+const U8 CN_BINARY_FLAG_GROUP = 0x01;
+
+// We'll expire entries more than a week old
+const U32 CN_EXPIRE_SECS = 7 * 60 * 60 * 24;
+
 // Globals
 LLCacheName* gCacheName = NULL;
 
@@ -102,9 +113,6 @@ public:
 	PendingReply(const LLUUID& id, const LLHost& host)
 		: mID(id), mCallback(0), mHost(host)
 	{ }
-
-	void done()			{ mID.setNull(); }
-	bool isDone() const	{ return mID.isNull() != FALSE; }
 };
 
 class ReplySender
@@ -187,7 +195,8 @@ void ReplySender::flush()
 
 
 typedef std::set<LLUUID>					AskQueue;
-typedef std::vector<PendingReply>			ReplyQueue;
+typedef std::multimap<LLUUID, PendingReply>	ReplyQueue;
+typedef std::set<LLUUID>					ReadySet;
 typedef std::map<LLUUID,U32>				PendingQueue;
 typedef std::map<LLUUID, LLCacheNameEntry*> Cache;
 typedef std::vector<LLCacheNameCallback>	Observers;
@@ -209,7 +218,11 @@ public:
 		// UUIDs that have been requested but are not in cache yet.
 
 	ReplyQueue			mReplyQueue;
-		// requests awaiting replies from us
+		// requests awaiting replies from us, keyed by the UUID they wait on
+
+	ReadySet			mReadyReplies;
+		// UUIDs in mReplyQueue whose names have arrived since the
+		// last processPendingReplies()
 
 	Observers			mObservers;
 
@@ -222,6 +235,8 @@ public:
 	void processPendingReplies();
 	void sendRequest(const char* msg_name, const AskQueue& queue);
 	bool isRequestPending(const LLUUID& id);
+	void addReply(const PendingReply& reply);
+	void markReplyReady(const LLUUID& id);
 
 	// Message system callbacks.
 	void processUUIDRequest(LLMessageSystem* msg, bool isGroup);
@@ -303,15 +318,14 @@ void LLCacheName::removeObserver(LLCacheNameCallback callback)
 
 void LLCacheName::cancelCallback(const LLUUID& id, LLCacheNameCallback callback, void* user_data)
 {
-	ReplyQueue::iterator it = impl.mReplyQueue.begin();
-	ReplyQueue::iterator end = impl.mReplyQueue.end();
+	std::pair<ReplyQueue::iterator, ReplyQueue::iterator> range =
+		impl.mReplyQueue.equal_range(id);
 	
-	for(; it != end; ++it)
+	for(ReplyQueue::iterator it = range.first; it != range.second; ++it)
 	{
-		const PendingReply& reply = (*it);
+		const PendingReply& reply = it->second;
 
 		if ((callback == reply.mCallback)
-			&& (id == reply.mID)
 			&& (user_data == reply.mData) )
 		{
 			impl.mReplyQueue.erase(it);
@@ -354,8 +368,7 @@ void LLCacheName::importFile(LLFILE* fp)
 
 	// We'll expire entries more than a week old
 	U32 now = (U32)time(NULL);
-	const U32 SECS_PER_DAY = 60 * 60 * 24;
-	U32 delete_before_time = now - (7 * SECS_PER_DAY);
+	U32 delete_before_time = now - CN_EXPIRE_SECS;
 
 	while(!feof(fp))
 	{
@@ -405,8 +418,7 @@ bool LLCacheName::importFile(std::istream& istr)
 
 	// We'll expire entries more than a week old
 	U32 now = (U32)time(NULL);
-	const U32 SECS_PER_DAY = 60 * 60 * 24;
-	U32 delete_before_time = now - (7 * SECS_PER_DAY);
+	U32 delete_before_time = now - CN_EXPIRE_SECS;
 
 	// iterate over the agents
 	S32 count = 0;
@@ -487,6 +499,218 @@ void LLCacheName::exportFile(std::ostream& ostr)
 	LLSDSerialize::toPrettyXML(data, ostr);
 }
 
+// Binary layout, all integers in native byte order:
+//   U32 magic, U32 version, U32 count
+//   count records of:
+//     U8[16] id, U32 ctime, U8 flags,
+//     U8 length + bytes for first/group name, U8 length + bytes for last name
+// Names are bounded by the DB_*_BUF_SIZE limits, so a U8 length suffices.
+namespace
+{
+	class BinaryReader
+	{
+	public:
+		BinaryReader(const U8* data, S32 size)
+			: mCur(data), mEnd(data + size), mOk(data != NULL && size >= 0)
+		{ }
+
+		bool ok() const { return mOk; }
+
+		void read(void* dest, S32 bytes)
+		{
+			if(!mOk || (mEnd - mCur) < bytes)
+			{
+				mOk = false;
+				return;
+			}
+			memcpy(dest, mCur, bytes);		/* Flawfinder: ignore */
+			mCur += bytes;
+		}
+
+		U32 readU32()
+		{
+			U32 value = 0;
+			read(&value, sizeof(U32));
+			return value;
+		}
+
+		U8 readU8()
+		{
+			U8 value = 0;
+			read(&value, sizeof(U8));
+			return value;
+		}
+
+		void readString(std::string& str)
+		{
+			U8 length = readU8();
+			if(!mOk || (mEnd - mCur) < length)
+			{
+				mOk = false;
+				return;
+			}
+			str.assign((const char*)mCur, length);
+			mCur += length;
+		}
+
+	private:
+		const U8* mCur;
+		const U8* mEnd;
+		bool mOk;
+	};
+
+	void write_u32(std::ostream& ostr, U32 value)
+	{
+		ostr.write((const char*)&value, sizeof(U32));
+	}
+
+	void write_string(std::ostream& ostr, const std::string& str)
+	{
+		U8 length = (U8)llmin((S32)str.size(), 255);
+		ostr.put((char)length);
+		ostr.write(str.data(), length);
+	}
+}
+
+bool LLCacheName::importBinary(const U8* data, S32 size)
+{
+	BinaryReader reader(data, size);
+	U32 magic = reader.readU32();
+	U32 version = reader.readU32();
+	U32 entries = reader.readU32();
+	if(!reader.ok()
+	   || magic != CN_BINARY_MAGIC
+	   || version != CN_BINARY_VERSION)
+	{
+		llwarns << "Ignoring unrecognized binary name cache" << llendl;
+		return false;
+	}
+
+	U32 now = (U32)time(NULL);
+	U32 delete_before_time = now - CN_EXPIRE_SECS;
+
+	S32 agent_count = 0;
+	S32 group_count = 0;
+	LLUUID id;
+	for(U32 i = 0; i < entries; ++i)
+	{
+		reader.read(id.mData, UUID_BYTES);
+		U32 ctime = reader.readU32();
+		U8 flags = reader.readU8();
+		std::string first;
+		std::string last;
+		reader.readString(first);
+		reader.readString(last);
+		if(!reader.ok())
+		{
+			llwarns << "Truncated binary name cache, loaded " << i
+					<< " of " << entries << " entries" << llendl;
+			break;
+		}
+		if(ctime < delete_before_time || id.isNull()) continue;
+
+		LLCacheNameEntry*& entry = impl.mCache[id];
+		if(!entry)
+		{
+			entry = new LLCacheNameEntry();
+		}
+		entry->mCreateTime = ctime;
+		if(flags & CN_BINARY_FLAG_GROUP)
+		{
+			entry->mIsGroup = true;
+			entry->mGroupName = first;
+			++group_count;
+		}
+		else
+		{
+			entry->mIsGroup = false;
+			entry->mFirstName = first;
+			entry->mLastName = last;
+			++agent_count;
+		}
+	}
+
+	llinfos << "LLCacheName loaded " << agent_count << " agent names and "
+			<< group_count << " group names" << llendl;
+	return true;
+}
+
+bool LLCacheName::importBinaryFile(std::istream& istr)
+{
+	istr.seekg(0, std::ios::end);
+	std::streamoff size = istr.tellg();
+	istr.seekg(0, std::ios::beg);
+	if(size <= 0 || !istr.good())
+	{
+		return false;
+	}
+
+	// One read for the whole file, then parse from memory.
+	std::vector<U8> buffer((size_t)size);
+	istr.read((char*)&buffer[0], size);
+	if(istr.gcount() != size)
+	{
+		return false;
+	}
+	return importBinary(&buffer[0], (S32)size);
+}
+
+void LLCacheName::exportBinaryFile(std::ostream& ostr)
+{
+	// Count first so the header can be written up front.
+	U32 entries = 0;
+	Cache::iterator iter = impl.mCache.begin();
+	Cache::iterator end = impl.mCache.end();
+	for( ; iter != end; ++iter)
+	{
+		LLCacheNameEntry* entry = iter->second;
+		if(!entry
+		   || (std::string::npos != entry->mFirstName.find('?'))
+		   || (std::string::npos != entry->mGroupName.find('?')))
+		{
+			continue;
+		}
+		if((!entry->mFirstName.empty() && !entry->mLastName.empty())
+		   || (entry->mIsGroup && !entry->mGroupName.empty()))
+		{
+			++entries;
+		}
+	}
+
+	write_u32(ostr, CN_BINARY_MAGIC);
+	write_u32(ostr, CN_BINARY_VERSION);
+	write_u32(ostr, entries);
+
+	for(iter = impl.mCache.begin(); iter != end; ++iter)
+	{
+		// Same filtering as exportFile(); only write valid data.
+		LLCacheNameEntry* entry = iter->second;
+		if(!entry
+		   || (std::string::npos != entry->mFirstName.find('?'))
+		   || (std::string::npos != entry->mGroupName.find('?')))
+		{
+			continue;
+		}
+
+		if(!entry->mFirstName.empty() && !entry->mLastName.empty())
+		{
+			ostr.write((const char*)iter->first.mData, UUID_BYTES);
+			write_u32(ostr, entry->mCreateTime);
+			ostr.put((char)0);
+			write_string(ostr, entry->mFirstName);
+			write_string(ostr, entry->mLastName);
+		}
+		else if(entry->mIsGroup && !entry->mGroupName.empty())
+		{
+			ostr.write((const char*)iter->first.mData, UUID_BYTES);
+			write_u32(ostr, entry->mCreateTime);
+			ostr.put((char)CN_BINARY_FLAG_GROUP);
+			write_string(ostr, entry->mGroupName);
+			write_string(ostr, LLStringUtil::null);
+		}
+	}
+}
+
 
 BOOL LLCacheName::getName(const LLUUID& id, std::string& first, std::string& last)
 {
@@ -596,7 +820,7 @@ void LLCacheName::get(const LLUUID& id, BOOL is_group, LLCacheNameCallback callb
 				impl.mAskNameQueue.insert(id);
 			}
 		}
-		impl.mReplyQueue.push_back(PendingReply(id, callback, user_data));
+		impl.addReply(PendingReply(id, callback, user_data));
 	}
 }
 
@@ -683,6 +907,7 @@ void LLCacheName::dumpStats()
 			<< " AskGroup=" << impl.mAskGroupQueue.size()
 			<< " Pending=" << impl.mPendingQueue.size()
 			<< " Reply=" << impl.mReplyQueue.size()
+			<< " ReadyReply=" << impl.mReadyReplies.size()
 			<< " Observers=" << impl.mObservers.size()
 			<< llendl;
 }
@@ -695,58 +920,105 @@ std::string LLCacheName::getDefaultName()
 
 void LLCacheName::Impl::processPendingAsks()
 {
+	// Names may have arrived through another request since they were
+	// queued; don't spend packet space asking for them again.
+	for(AskQueue::iterator it = mAskNameQueue.begin(); it != mAskNameQueue.end(); )
+	{
+		AskQueue::iterator cur = it++;
+		if(mCache.find(*cur) != mCache.end())
+		{
+			mAskNameQueue.erase(cur);
+		}
+	}
+	for(AskQueue::iterator it = mAskGroupQueue.begin(); it != mAskGroupQueue.end(); )
+	{
+		AskQueue::iterator cur = it++;
+		LLCacheNameEntry* entry = get_ptr_in_map(mCache, *cur);
+		if(entry && !entry->mGroupName.empty())
+		{
+			mAskGroupQueue.erase(cur);
+		}
+	}
+
 	sendRequest(_PREHASH_UUIDNameRequest, mAskNameQueue);
 	sendRequest(_PREHASH_UUIDGroupNameRequest, mAskGroupQueue);
 	mAskNameQueue.clear();
 	mAskGroupQueue.clear();
 }
 
+void LLCacheName::Impl::addReply(const PendingReply& reply)
+{
+	mReplyQueue.insert(std::make_pair(reply.mID, reply));
+}
+
+void LLCacheName::Impl::markReplyReady(const LLUUID& id)
+{
+	if(mReplyQueue.find(id) != mReplyQueue.end())
+	{
+		mReadyReplies.insert(id);
+	}
+}
+
 void LLCacheName::Impl::processPendingReplies()
 {
-	ReplyQueue::iterator it = mReplyQueue.begin();
-	ReplyQueue::iterator end = mReplyQueue.end();
+	if(mReadyReplies.empty())
+	{
+		return;
+	}
+
+	// Pull out only the replies whose names have arrived, so the cost
+	// is proportional to the answers rather than to everything waiting.
+	// Callbacks may re-enter get() or cancelCallback(), so work on a copy.
+	ReplyQueue ready;
+	ReadySet ready_ids;
+	ready_ids.swap(mReadyReplies);
+	for(ReadySet::iterator id_it = ready_ids.begin(); id_it != ready_ids.end(); ++id_it)
+	{
+		std::pair<ReplyQueue::iterator, ReplyQueue::iterator> range =
+			mReplyQueue.equal_range(*id_it);
+		ready.insert(range.first, range.second);
+		mReplyQueue.erase(range.first, range.second);
+	}
+
+	ReplyQueue::iterator it = ready.begin();
+	ReplyQueue::iterator end = ready.end();
 	
 	// First call all the callbacks, because they might send messages.
 	for(; it != end; ++it)
 	{
-		LLCacheNameEntry* entry = get_ptr_in_map(mCache, it->mID);
+		const PendingReply& reply = it->second;
+		LLCacheNameEntry* entry = get_ptr_in_map(mCache, reply.mID);
 		if(!entry) continue;
 
-		if (it->mCallback)
+		if (reply.mCallback)
 		{
 			if (!entry->mIsGroup)
 			{
-				(it->mCallback)(it->mID,
+				(reply.mCallback)(reply.mID,
 					entry->mFirstName, entry->mLastName,
-					FALSE, it->mData);
+					FALSE, reply.mData);
 			}
 			else {
-				(it->mCallback)(it->mID,
+				(reply.mCallback)(reply.mID,
 					entry->mGroupName, "",
-					TRUE, it->mData);
+					TRUE, reply.mData);
 			}
 		}
 	}
 
 	// Forward on all replies, if needed.
 	ReplySender sender(mMsg);
-	for (it = mReplyQueue.begin(); it != end; ++it)
+	for (it = ready.begin(); it != end; ++it)
 	{
-		LLCacheNameEntry* entry = get_ptr_in_map(mCache, it->mID);
+		const PendingReply& reply = it->second;
+		LLCacheNameEntry* entry = get_ptr_in_map(mCache, reply.mID);
 		if(!entry) continue;
 
-		if (it->mHost.isOk())
+		if (reply.mHost.isOk())
 		{
-			sender.send(it->mID, *entry, it->mHost);
+			sender.send(reply.mID, *entry, reply.mHost);
 		}
-
-		it->done();
 	}
-
-	mReplyQueue.erase(
-		remove_if(mReplyQueue.begin(), mReplyQueue.end(),
-			std::mem_fun_ref(&PendingReply::isDone)),
-		mReplyQueue.end());
 }
 
 
@@ -862,7 +1134,7 @@ void LLCacheName::Impl::processUUIDRequest(LLMessageSystem* msg, bool isGroup)
 				}
 			}
 			
-			mReplyQueue.push_back(PendingReply(id, fromHost));
+			addReply(PendingReply(id, fromHost));
 		}
 	}
 }
@@ -884,6 +1156,7 @@ void LLCacheName::Impl::processUUIDReply(LLMessageSystem* msg, bool isGroup)
 		}
 
 		mPendingQueue.erase(id);
+		markReplyReady(id);
 
 		entry->mIsGroup = isGroup;
 		entry->mCreateTime = (U32)time(NULL);
@@ -71,6 +71,13 @@ public:
 	bool importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// Compact binary cache format. The buffer is position independent
+	// so it may come straight from a single read or a memory mapped
+	// file. Returns false if the data is not a valid binary cache.
+	bool importBinary(const U8* data, S32 size);
+	bool importBinaryFile(std::istream& istr);
+	void exportBinaryFile(std::ostream& ostr);
+
 	// If available, copies the first and last name into the strings provided.
 	// first must be at least DB_FIRST_NAME_BUF_SIZE characters.
 	// last must be at least DB_LAST_NAME_BUF_SIZE characters.
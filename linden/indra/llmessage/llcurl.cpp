@@ -148,7 +148,12 @@ void LLCurl::Responder::completedRaw(
 {
 	LLSD content;
 	LLBufferStream istr(channels, buffer.get());
-	LLSDSerialize::fromXML(content, istr);
+	{
+		// Capability responses (inventory fetches, event polls) can be
+		// large trees that are dropped right after completed() returns.
+		LLSDArenaScope arena;
+		LLSDSerialize::fromXML(content, istr);
+	}
 	completed(status, reason, content);
 }
 
@@ -0,0 +1,474 @@
+/** 
+ * @file llflexiblesolver.cpp
+ * @brief Section physics for flexible objects, scalar and batched
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llflexiblesolver.h"
+
+//----------------------------------------------------------------------------
+
+LLFlexibleSolverInput::LLFlexibleSolverInput()
+:	mNumSections(1),
+	mSectionLength(1.f),
+	mTensionFactor(0.f),
+	mMomentum(0.f),
+	mGravityStep(0.f),
+	mMaxAngle(0.f),
+	mHasWind(FALSE),
+	mWindFactor(0.f)
+{
+}
+
+void LLFlexibleSolverInput::setCoefficients(const LLFlexibleObjectData& attributes, F32 dt)
+{
+	// Coefficients which are constant across sections
+	mTensionFactor = attributes.getTension() * 0.1f;
+	mTensionFactor = mTensionFactor*(1 - pow(0.85f, dt*30));
+	if ( mTensionFactor > FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE )
+	{
+		mTensionFactor = FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE;
+	}
+
+	F32 friction_coeff = (attributes.getAirFriction()*2+1);
+	friction_coeff = pow(10.f, friction_coeff*dt);
+	friction_coeff = (friction_coeff > 1) ? friction_coeff : 1;
+	mMomentum = 1.0f / friction_coeff;
+
+	mHasWind = attributes.getWindSensitivity() > 0.001f;
+	mWindFactor = (attributes.getWindSensitivity()*0.1f) * mSectionLength * dt;
+	mMaxAngle = atan(mSectionLength*2.f);
+
+	F32 force_factor = mSectionLength * dt;
+	mGravityStep = attributes.getGravity() * force_factor;
+	mUserForceStep = attributes.getUserForce() * force_factor;
+}
+
+//----------------------------------------------------------------------------
+
+// Clamps the bend between a section and its parent to max_angle and puts
+// the section back at section_length from its parent. segment_rotation
+// accumulates down the chain. Both solvers go through here so they can
+// only differ in how the forces are summed.
+static inline void constrain_section(const LLVector3& parent_position, const LLVector3& parent_direction,
+									 F32 section_length, F32 max_angle,
+									 LLVector3& position, LLVector3& direction,
+									 LLQuaternion& segment_rotation, F32& angle, LLVector3& axis)
+{
+	LLQuaternion deltaRotation;
+
+	direction = position - parent_position;
+	direction.normVec();
+	deltaRotation.shortestArc( parent_direction, direction );
+
+	deltaRotation.getAngleAxis(&angle, axis);
+	if (angle > F_PI) angle -= 2.f*F_PI;
+	if (angle < -F_PI) angle += 2.f*F_PI;
+	if (angle > max_angle)
+	{
+		//angle = 0.5f*(angle+max_angle);
+		deltaRotation.setQuat(max_angle, axis);
+	} else if (angle < -max_angle)
+	{
+		//angle = 0.5f*(angle-max_angle);
+		deltaRotation.setQuat(-max_angle, axis);
+	}
+	segment_rotation = segment_rotation * deltaRotation;
+
+	direction = (parent_direction * deltaRotation);
+	position = parent_position + direction * section_length;
+}
+
+// Calculate derivatives (not necessary until normals are automagically generated)
+static void update_derivatives(LLFlexibleObjectSection* sections, S32 num_sections, F32 section_length)
+{
+	F32 inv_section_length = 1.f / section_length;
+
+	sections[0].mdPosition = (sections[1].mPosition - sections[0].mPosition) * inv_section_length;
+	// i = 1..NumSections-1
+	S32 i;
+	for (i=1; i<num_sections; ++i)
+	{
+		// Quadratic numerical derivative of position
+
+		// f(-L1) = aL1^2 - bL1 + c = f1
+		// f(0)   =               c = f2
+		// f(L2)  = aL2^2 + bL2 + c = f3
+		// f = ax^2 + bx + c
+		// d/dx f = 2ax + b
+		// d/dx f(0) = b
+
+		// c = f2
+		// a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
+		// b = (f3-c-aL2^2)/L2
+
+		LLVector3 a = (sections[i-1].mPosition-sections[i].mPosition +
+					sections[i+1].mPosition-sections[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
+		LLVector3 b = (sections[i+1].mPosition-sections[i].mPosition - a*(section_length*section_length));
+		b *= inv_section_length;
+
+		sections[i].mdPosition = b;
+	}
+
+	// i = NumSections
+	sections[i].mdPosition = (sections[i].mPosition - sections[i-1].mPosition) * inv_section_length;
+}
+
+//static
+void LLFlexibleSolver::integrate(LLFlexibleSolverInput& input, LLFlexibleObjectSection* sections)
+{
+	const S32 num_sections = input.mNumSections;
+	const F32 section_length = input.mSectionLength;
+
+	sections[0].mPosition = input.mAnchorPosition;
+	sections[0].mDirection = input.mAnchorDirection;
+	sections[0].mRotation = input.mAnchorRotation;
+
+	LLQuaternion parentSegmentRotation = input.mAnchorRotation;
+
+	for (S32 i=1; i<=num_sections; ++i)
+	{
+		LLFlexibleObjectSection& section = sections[i];
+
+		//---------------------------------------------------
+		// save value of position as lastPosition
+		//---------------------------------------------------
+		LLVector3 lastPosition = section.mPosition;
+
+		//------------------------------------------------------------------------------------------
+		// gravity
+		//------------------------------------------------------------------------------------------
+		section.mPosition.mV[VZ] -= input.mGravityStep;
+
+		//------------------------------------------------------------------------------------------
+		// wind force
+		//------------------------------------------------------------------------------------------
+		if (input.mHasWind)
+		{
+			section.mPosition += input.mWind[i];
+		}
+
+		//------------------------------------------------------------------------------------------
+		// user-defined force
+		//------------------------------------------------------------------------------------------
+		section.mPosition += input.mUserForceStep;
+
+		//---------------------------------------------------
+		// tension (rigidity, stiffness)
+		//---------------------------------------------------
+		const LLVector3& parentSectionPosition = sections[i-1].mPosition;
+		const LLVector3& parentDirection = sections[i-1].mDirection;
+		const LLVector3& parentSectionVector = (i == 1) ? sections[0].mDirection : sections[i-2].mDirection;
+
+		LLVector3 currentVector = section.mPosition - parentSectionPosition;
+
+		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
+		LLVector3 tensionForce = difference * input.mTensionFactor;
+
+		section.mPosition += tensionForce;
+
+		//------------------------------------------------------------------------------------------
+		// inertia
+		//------------------------------------------------------------------------------------------
+		section.mPosition += section.mVelocity * input.mMomentum;
+
+		//------------------------------------------------------------------------------------------
+		// clamp length & rotation
+		//------------------------------------------------------------------------------------------
+		F32 angle;
+		LLVector3 axis;
+		constrain_section(parentSectionPosition, parentDirection, section_length, input.mMaxAngle,
+						  section.mPosition, section.mDirection, parentSegmentRotation, angle, axis);
+		section.mRotation = parentSegmentRotation;
+
+		if (i > 1)
+		{
+			// Propogate half the rotation up to the parent
+			LLQuaternion halfDeltaRotation(angle/2, axis);
+			sections[i-1].mRotation = sections[i-1].mRotation * halfDeltaRotation;
+		}
+
+		//------------------------------------------------------------------------------------------
+		// calculate velocity
+		//------------------------------------------------------------------------------------------
+		section.mVelocity = section.mPosition - lastPosition;
+		if (section.mVelocity.magVecSquared() > 1.f)
+		{
+			section.mVelocity.normVec();
+		}
+	}
+
+	update_derivatives(sections, num_sections, section_length);
+
+	input.mEndRotation = parentSegmentRotation;
+}
+
+//----------------------------------------------------------------------------
+
+LLFlexibleSolverBatch::LLFlexibleSolverBatch()
+{
+}
+
+void LLFlexibleSolverBatch::clear()
+{
+	mObjects.clear();
+	for (S32 i = 0; i <= FLEXIBLE_OBJECT_MAX_SECTIONS; ++i)
+	{
+		mGroups[i].mObjects.clear();
+	}
+}
+
+S32 LLFlexibleSolverBatch::add(const LLFlexibleSolverInput& input, LLFlexibleObjectSection* sections)
+{
+	S32 group = 0;
+	while ((1 << group) < input.mNumSections)
+	{
+		++group;
+	}
+	llassert(group <= FLEXIBLE_OBJECT_MAX_SECTIONS && (1 << group) == input.mNumSections);
+
+	S32 handle = (S32)mObjects.size();
+	mObjects.push_back(Object());
+	mObjects.back().mInput = input;
+	mObjects.back().mSections = sections;
+	mGroups[group].mObjects.push_back(handle);
+	return handle;
+}
+
+void LLFlexibleSolverBatch::solve()
+{
+	for (S32 i = 0; i <= FLEXIBLE_OBJECT_MAX_SECTIONS; ++i)
+	{
+		mGroups[i].solve(mObjects);
+	}
+}
+
+void LLFlexibleSolverBatch::Group::solve(std::vector<Object>& objects)
+{
+	const S32 lanes = (S32)mObjects.size();
+	if (!lanes)
+	{
+		return;
+	}
+	const S32 num_sections = objects[mObjects[0]].mInput.mNumSections;
+	const S32 count = (num_sections+1) * lanes;
+
+	mSectionLength.resize(lanes);
+	mTensionFactor.resize(lanes);
+	mMomentum.resize(lanes);
+	mGravityStep.resize(lanes);
+	mMaxAngle.resize(lanes);
+	mForceX.resize(lanes);
+	mForceY.resize(lanes);
+	mForceZ.resize(lanes);
+	mSegmentRotation.resize(lanes);
+
+	mPosX.resize(count);
+	mPosY.resize(count);
+	mPosZ.resize(count);
+	mVelX.resize(count);
+	mVelY.resize(count);
+	mVelZ.resize(count);
+	mDirX.resize(count);
+	mDirY.resize(count);
+	mDirZ.resize(count);
+	mWindX.resize(count);
+	mWindY.resize(count);
+	mWindZ.resize(count);
+	mRotation.resize(count);
+
+	S32 l, i;
+
+	// Gather
+	for (l = 0; l < lanes; ++l)
+	{
+		const Object& object = objects[mObjects[l]];
+		const LLFlexibleSolverInput& input = object.mInput;
+
+		mSectionLength[l] = input.mSectionLength;
+		mTensionFactor[l] = input.mTensionFactor;
+		mMomentum[l] = input.mMomentum;
+		mGravityStep[l] = input.mGravityStep;
+		mMaxAngle[l] = input.mMaxAngle;
+		mForceX[l] = input.mUserForceStep.mV[VX];
+		mForceY[l] = input.mUserForceStep.mV[VY];
+		mForceZ[l] = input.mUserForceStep.mV[VZ];
+		mSegmentRotation[l] = input.mAnchorRotation;
+
+		for (i = 0; i <= num_sections; ++i)
+		{
+			const LLFlexibleObjectSection& section = object.mSections[i];
+			const LLVector3& position = i ? section.mPosition : input.mAnchorPosition;
+			const LLVector3& direction = i ? section.mDirection : input.mAnchorDirection;
+			const LLVector3& wind = (i && input.mHasWind) ? input.mWind[i] : LLVector3::zero;
+			const S32 k = i*lanes + l;
+
+			mPosX[k] = position.mV[VX];
+			mPosY[k] = position.mV[VY];
+			mPosZ[k] = position.mV[VZ];
+			mVelX[k] = section.mVelocity.mV[VX];
+			mVelY[k] = section.mVelocity.mV[VY];
+			mVelZ[k] = section.mVelocity.mV[VZ];
+			mDirX[k] = direction.mV[VX];
+			mDirY[k] = direction.mV[VY];
+			mDirZ[k] = direction.mV[VZ];
+			mWindX[k] = wind.mV[VX];
+			mWindY[k] = wind.mV[VY];
+			mWindZ[k] = wind.mV[VZ];
+			mRotation[k] = i ? section.mRotation : input.mAnchorRotation;
+		}
+	}
+
+	// Sections have to be walked root to tip, but each one can be stepped
+	// for every lane at once.
+	for (i = 1; i <= num_sections; ++i)
+	{
+		const S32 cur = i*lanes;
+		const S32 parent = (i-1)*lanes;
+		// The first section is pulled toward the anchor direction, the
+		// rest toward their grandparent's.
+		const S32 grand = (i > 1 ? i-2 : 0)*lanes;
+
+		F32* px = &mPosX[cur];
+		F32* py = &mPosY[cur];
+		F32* pz = &mPosZ[cur];
+		F32* vx = &mVelX[cur];
+		F32* vy = &mVelY[cur];
+		F32* vz = &mVelZ[cur];
+		const F32* wx = &mWindX[cur];
+		const F32* wy = &mWindY[cur];
+		const F32* wz = &mWindZ[cur];
+		const F32* ppx = &mPosX[parent];
+		const F32* ppy = &mPosY[parent];
+		const F32* ppz = &mPosZ[parent];
+		const F32* gdx = &mDirX[grand];
+		const F32* gdy = &mDirY[grand];
+		const F32* gdz = &mDirZ[grand];
+
+		// Gravity, wind, user force, tension and inertia, in the same
+		// order as the scalar solver. Velocity is still last frame's;
+		// it becomes the new velocity below, so stash the old position
+		// in it for now.
+		for (l = 0; l < lanes; ++l)
+		{
+			F32 x = px[l];
+			F32 y = py[l];
+			F32 z = pz[l];
+			F32 len = mSectionLength[l];
+			F32 t = mTensionFactor[l];
+			F32 m = mMomentum[l];
+
+			z -= mGravityStep[l];
+			x += wx[l];
+			y += wy[l];
+			z += wz[l];
+			x += mForceX[l];
+			y += mForceY[l];
+			z += mForceZ[l];
+			x += (gdx[l]*len - (x - ppx[l])) * t;
+			y += (gdy[l]*len - (y - ppy[l])) * t;
+			z += (gdz[l]*len - (z - ppz[l])) * t;
+			x += vx[l]*m;
+			y += vy[l]*m;
+			z += vz[l]*m;
+
+			vx[l] = px[l];
+			vy[l] = py[l];
+			vz[l] = pz[l];
+			px[l] = x;
+			py[l] = y;
+			pz[l] = z;
+		}
+
+		// Length and bend constraint
+		for (l = 0; l < lanes; ++l)
+		{
+			LLVector3 parent_position(ppx[l], ppy[l], ppz[l]);
+			LLVector3 parent_direction(mDirX[parent+l], mDirY[parent+l], mDirZ[parent+l]);
+			LLVector3 position(px[l], py[l], pz[l]);
+			LLVector3 direction;
+			F32 angle;
+			LLVector3 axis;
+
+			constrain_section(parent_position, parent_direction, mSectionLength[l], mMaxAngle[l],
+							  position, direction, mSegmentRotation[l], angle, axis);
+			mRotation[cur+l] = mSegmentRotation[l];
+
+			if (i > 1)
+			{
+				// Propogate half the rotation up to the parent
+				LLQuaternion halfDeltaRotation(angle/2, axis);
+				mRotation[parent+l] = mRotation[parent+l] * halfDeltaRotation;
+			}
+
+			LLVector3 velocity = position - LLVector3(vx[l], vy[l], vz[l]);
+			if (velocity.magVecSquared() > 1.f)
+			{
+				velocity.normVec();
+			}
+
+			px[l] = position.mV[VX];
+			py[l] = position.mV[VY];
+			pz[l] = position.mV[VZ];
+			vx[l] = velocity.mV[VX];
+			vy[l] = velocity.mV[VY];
+			vz[l] = velocity.mV[VZ];
+			mDirX[cur+l] = direction.mV[VX];
+			mDirY[cur+l] = direction.mV[VY];
+			mDirZ[cur+l] = direction.mV[VZ];
+		}
+	}
+
+	// Scatter
+	for (l = 0; l < lanes; ++l)
+	{
+		Object& object = objects[mObjects[l]];
+		LLFlexibleObjectSection* sections = object.mSections;
+
+		for (i = 0; i <= num_sections; ++i)
+		{
+			const S32 k = i*lanes + l;
+			LLFlexibleObjectSection& section = sections[i];
+
+			section.mPosition.setVec(mPosX[k], mPosY[k], mPosZ[k]);
+			section.mDirection.setVec(mDirX[k], mDirY[k], mDirZ[k]);
+			section.mRotation = mRotation[k];
+			if (i)
+			{
+				// the anchor's velocity is not simulated
+				section.mVelocity.setVec(mVelX[k], mVelY[k], mVelZ[k]);
+			}
+		}
+
+		update_derivatives(sections, num_sections, mSectionLength[l]);
+		object.mInput.mEndRotation = mSegmentRotation[l];
+	}
+}
@@ -0,0 +1,161 @@
+/** 
+ * @file llflexiblesolver.h
+ * @brief Section physics for flexible objects, scalar and batched
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFLEXIBLESOLVER_H
+#define LL_LLFLEXIBLESOLVER_H
+
+#include <vector>
+
+#include "v2math.h"
+#include "v3math.h"
+#include "llquaternion.h"
+#include "llprimitive.h"
+
+const S32 FLEXIBLE_OBJECT_MAX_NODES = (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1;
+
+struct LLFlexibleObjectSection
+{
+	// Input parameters
+	LLVector2		mScale;
+	LLQuaternion	mAxisRotation;
+	// Simulated state
+	LLVector3		mPosition;
+	LLVector3		mVelocity;
+	LLVector3		mDirection;
+	LLQuaternion	mRotation;
+	// Derivatives (Not all currently used, will come back with LLVolume changes to automagically generate normals)
+	LLVector3		mdPosition;
+	//LLMatrix4		mRotScale;
+	//LLMatrix4		mdRotScale;
+};
+
+//----------------------------------------------------------------------------
+// Everything one simulation step of one flexible object needs, with the
+// per-frame coefficients already folded in. Filled in on the main thread;
+// the solvers below touch nothing else, so they do not depend on the
+// agent, the region or the frame timer.
+
+struct LLFlexibleSolverInput
+{
+	LLFlexibleSolverInput();
+
+	// Derives the step coefficients from the object's flexible parameters
+	// for a step of dt seconds. mSectionLength must be set first.
+	void setCoefficients(const LLFlexibleObjectData& attributes, F32 dt);
+
+	LLVector3		mAnchorPosition;
+	LLVector3		mAnchorDirection;
+	LLQuaternion	mAnchorRotation;
+	S32				mNumSections;		// 1..(1<<FLEXIBLE_OBJECT_MAX_SECTIONS)
+	F32				mSectionLength;
+	F32				mTensionFactor;
+	F32				mMomentum;
+	F32				mGravityStep;		// gravity * section length * dt
+	LLVector3		mUserForceStep;		// user force * section length * dt
+	F32				mMaxAngle;
+	// When mHasWind is TRUE the caller fills mWind[i] with the wind
+	// velocity at section i (after gravity) times mWindFactor.
+	// Index 0 is unused.
+	BOOL			mHasWind;
+	F32				mWindFactor;
+	LLVector3		mWind[FLEXIBLE_OBJECT_MAX_NODES];
+
+	// Output: rotation of the last simulated section.
+	LLQuaternion	mEndRotation;
+};
+
+class LLFlexibleSolver
+{
+public:
+	// Simulates one step of one object in place. sections holds
+	// input.mNumSections+1 entries; section 0 is reset to the anchor.
+	static void integrate(LLFlexibleSolverInput& input, LLFlexibleObjectSection* sections);
+};
+
+//----------------------------------------------------------------------------
+// Steps many flexible objects at once. Objects with the same number of
+// sections are grouped and their state is copied into per-component
+// arrays with one lane per object, so the force accumulation for a given
+// section runs as one tight loop over every object in the group. The
+// length and angle constraint still runs lane by lane. Results are written
+// back to the section arrays passed to add() by solve(); the end rotation
+// of each object is available from getEndRotation() afterwards.
+//
+// Produces the same trajectories as LLFlexibleSolver::integrate(), up to
+// floating point reordering.
+
+class LLFlexibleSolverBatch
+{
+public:
+	LLFlexibleSolverBatch();
+
+	void clear();
+	// Returns the handle for getEndRotation(). input is copied; sections
+	// must stay valid until solve() returns.
+	S32 add(const LLFlexibleSolverInput& input, LLFlexibleObjectSection* sections);
+	void solve();
+
+	S32 getCount() const						{ return (S32)mObjects.size(); }
+	const LLQuaternion& getEndRotation(S32 handle) const	{ return mObjects[handle].mInput.mEndRotation; }
+
+private:
+	struct Object
+	{
+		LLFlexibleSolverInput mInput;
+		LLFlexibleObjectSection* mSections;
+	};
+
+	// Per-section arrays are indexed [section * lanes + lane].
+	struct Group
+	{
+		void solve(std::vector<Object>& objects);
+
+		std::vector<S32> mObjects;		// lane -> index into the batch's mObjects
+
+		// Per lane constants
+		std::vector<F32> mSectionLength, mTensionFactor, mMomentum, mGravityStep, mMaxAngle;
+		std::vector<F32> mForceX, mForceY, mForceZ;
+
+		// Per section state
+		std::vector<F32> mPosX, mPosY, mPosZ;
+		std::vector<F32> mVelX, mVelY, mVelZ;
+		std::vector<F32> mDirX, mDirY, mDirZ;
+		std::vector<F32> mWindX, mWindY, mWindZ;
+		std::vector<LLQuaternion> mRotation;
+		std::vector<LLQuaternion> mSegmentRotation;	// per lane
+	};
+
+	std::vector<Object> mObjects;
+	Group mGroups[FLEXIBLE_OBJECT_MAX_SECTIONS+1];	// indexed by log2(sections)
+};
+
+#endif // LL_LLFLEXIBLESOLVER_H
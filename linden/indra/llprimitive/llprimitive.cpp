@@ -219,6 +219,7 @@ void LLPrimitive::init_primitive(LLPCode p_code)
 			delete [] mTextureList;
 		}
 		mTextureList = new LLTextureEntry[mNumTEs];
+		mLastTEBlob.clear();
 	}
 
 	mPrimitiveCode = p_code;
@@ -246,6 +247,7 @@ const LLTextureEntry * LLPrimitive::getTE(const U8 te_num) const
 //===============================================================
 void LLPrimitive::setNumTEs(const U8 num_tes)
 {
+	mLastTEBlob.clear();
 	if (num_tes == mNumTEs)
 	{
 		return;
@@ -291,6 +293,7 @@ void LLPrimitive::setNumTEs(const U8 num_tes)
 //===============================================================
 void  LLPrimitive::setAllTETextures(const LLUUID &tex_id)
 {
+	mLastTEBlob.clear();
 	U8 i;
 
 	for (i = 0; i < mNumTEs; i++)
@@ -302,11 +305,13 @@ void  LLPrimitive::setAllTETextures(const LLUUID &tex_id)
 //===============================================================
 void LLPrimitive::setTE(const U8 index, const LLTextureEntry &te)
 {
+	mLastTEBlob.clear();
 	mTextureList[index] = te;
 }
 
 S32  LLPrimitive::setTETexture(const U8 te, const LLUUID &tex_id)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -319,6 +324,7 @@ S32  LLPrimitive::setTETexture(const U8 te, const LLUUID &tex_id)
 
 S32  LLPrimitive::setTEColor(const U8 te, const LLColor4 &color)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -331,6 +337,7 @@ S32  LLPrimitive::setTEColor(const U8 te, const LLColor4 &color)
 
 S32  LLPrimitive::setTEColor(const U8 te, const LLColor3 &color)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -343,6 +350,7 @@ S32  LLPrimitive::setTEColor(const U8 te, const LLColor3 &color)
 
 S32  LLPrimitive::setTEAlpha(const U8 te, const F32 alpha)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -356,6 +364,7 @@ S32  LLPrimitive::setTEAlpha(const U8 te, const F32 alpha)
 //===============================================================
 S32  LLPrimitive::setTEScale(const U8 te, const F32 s, const F32 t)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -371,6 +380,7 @@ S32  LLPrimitive::setTEScale(const U8 te, const F32 s, const F32 t)
 // voodoo related to texture coords
 S32 LLPrimitive::setTEScaleS(const U8 te, const F32 s)
 {
+	mLastTEBlob.clear();
 	if (te >= mNumTEs)
 	{
 		llwarns << "Setting nonexistent face" << llendl;
@@ -387,6 +397,7 @@ S32 LLPrimitive::setTEScaleS(const U8 te, const F32 s)
 // voodoo related to texture coords
 S32 LLPrimitive::setTEScaleT(const U8 te, const F32 t)
 {
+	mLastTEBlob.clear();
 	if (te >= mNumTEs)
 	{
 		llwarns << "Setting nonexistent face" << llendl;
@@ -402,6 +413,7 @@ S32 LLPrimitive::setTEScaleT(const U8 te, const F32 t)
 //===============================================================
 S32  LLPrimitive::setTEOffset(const U8 te, const F32 s, const F32 t)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -417,6 +429,7 @@ S32  LLPrimitive::setTEOffset(const U8 te, const F32 s, const F32 t)
 // voodoo related to texture coords
 S32 LLPrimitive::setTEOffsetS(const U8 te, const F32 s)
 {
+	mLastTEBlob.clear();
 	if (te >= mNumTEs)
 	{
 		llwarns << "Setting nonexistent face" << llendl;
@@ -433,6 +446,7 @@ S32 LLPrimitive::setTEOffsetS(const U8 te, const F32 s)
 // voodoo related to texture coords
 S32 LLPrimitive::setTEOffsetT(const U8 te, const F32 t)
 {
+	mLastTEBlob.clear();
 	if (te >= mNumTEs)
 	{
 		llwarns << "Setting nonexistent face" << llendl;
@@ -448,6 +462,7 @@ S32 LLPrimitive::setTEOffsetT(const U8 te, const F32 t)
 //===============================================================
 S32  LLPrimitive::setTERotation(const U8 te, const F32 r)
 {
+	mLastTEBlob.clear();
      // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -462,6 +477,7 @@ S32  LLPrimitive::setTERotation(const U8 te, const F32 r)
 //===============================================================
 S32  LLPrimitive::setTEBumpShinyFullbright(const U8 te, const U8 bump)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -474,6 +490,7 @@ S32  LLPrimitive::setTEBumpShinyFullbright(const U8 te, const U8 bump)
 
 S32  LLPrimitive::setTEMediaTexGen(const U8 te, const U8 media)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -486,6 +503,7 @@ S32  LLPrimitive::setTEMediaTexGen(const U8 te, const U8 media)
 
 S32  LLPrimitive::setTEBumpmap(const U8 te, const U8 bump)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -498,6 +516,7 @@ S32  LLPrimitive::setTEBumpmap(const U8 te, const U8 bump)
 
 S32  LLPrimitive::setTEBumpShiny(const U8 te, const U8 bump_shiny)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -510,6 +529,7 @@ S32  LLPrimitive::setTEBumpShiny(const U8 te, const U8 bump_shiny)
 
 S32  LLPrimitive::setTETexGen(const U8 te, const U8 texgen)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -522,6 +542,7 @@ S32  LLPrimitive::setTETexGen(const U8 te, const U8 texgen)
 
 S32  LLPrimitive::setTEShiny(const U8 te, const U8 shiny)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -534,6 +555,7 @@ S32  LLPrimitive::setTEShiny(const U8 te, const U8 shiny)
 
 S32  LLPrimitive::setTEFullbright(const U8 te, const U8 fullbright)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -546,6 +568,7 @@ S32  LLPrimitive::setTEFullbright(const U8 te, const U8 fullbright)
 
 S32  LLPrimitive::setTEMediaFlags(const U8 te, const U8 media_flags)
 {
+	mLastTEBlob.clear();
     // if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -558,6 +581,7 @@ S32  LLPrimitive::setTEMediaFlags(const U8 te, const U8 media_flags)
 
 S32 LLPrimitive::setTEGlow(const U8 te, const F32 glow)
 {
+	mLastTEBlob.clear();
 	// if we're asking for a non-existent face, return null
 	if (te >= mNumTEs)
 	{
@@ -988,6 +1012,7 @@ void LLPrimitive::setTEArrays(const U8 size,
 							  const F32* scale_s,
 							  const F32* scale_t)
 {
+	mLastTEBlob.clear();
 	S32 cur_size = size;
 	if (cur_size > getNumTEs())
 	{
@@ -1131,96 +1156,220 @@ S32 LLPrimitive::unpackTEField(U8 *cur_ptr, U8 *buffer_end, U8 *data_ptr, U8 dat
 }
 
 
+//============================================================================
+// LLTEContents
+
+namespace
+{
+	struct LLTEField
+	{
+		size_t				mOffset;	// into LLTEContents::Face
+		U8					mSize;
+		EMsgVariableType	mType;
+	};
+
+	// In wire order
+	const LLTEField TE_FIELDS[] =
+	{
+		{ offsetof(LLTEContents::Face, mImageID),		UUID_BYTES,	MVT_LLUUID },
+		{ offsetof(LLTEContents::Face, mColor),			4,			MVT_U8 },
+		{ offsetof(LLTEContents::Face, mScaleS),		4,			MVT_F32 },
+		{ offsetof(LLTEContents::Face, mScaleT),		4,			MVT_F32 },
+		{ offsetof(LLTEContents::Face, mOffsetS),		2,			MVT_S16Array },
+		{ offsetof(LLTEContents::Face, mOffsetT),		2,			MVT_S16Array },
+		{ offsetof(LLTEContents::Face, mRotation),		2,			MVT_S16Array },
+		{ offsetof(LLTEContents::Face, mBump),			1,			MVT_U8 },
+		{ offsetof(LLTEContents::Face, mMediaFlags),	1,			MVT_U8 },
+		{ offsetof(LLTEContents::Face, mGlow),			1,			MVT_U8 }
+	};
+	const S32 TE_FIELD_COUNT = sizeof(TE_FIELDS) / sizeof(TE_FIELDS[0]);
+}
+
+// Copies size bytes of a value starting at pos, zero filling whatever lies
+// past the end of the buffer.
+static inline void read_te_value(U8* value, const U8* buffer, S32 buffer_size, S32 pos, S32 size)
+{
+	S32 available = llclamp(buffer_size - pos, 0, size);
+	if (available)
+	{
+		memcpy(value, buffer + pos, available);	/* Flawfinder: ignore */
+	}
+	if (available < size)
+	{
+		memset(value + available, 0, size - available);
+	}
+}
+
+void LLTEContents::unpack(const U8* buffer, S32 size, U8 face_count)
+{
+	mFaceCount = llmin(face_count, (U8)MAX_TES);
+
+	const S32 stride = sizeof(Face);
+	U8 value[UUID_BYTES];
+	S32 pos = 0;
+
+	for (S32 field = 0; field < TE_FIELD_COUNT; field++)
+	{
+		const LLTEField& info = TE_FIELDS[field];
+		U8* dest = (U8*)mFaces + info.mOffset;
+
+		// Default value, for every face
+		read_te_value(value, buffer, size, pos, info.mSize);
+		pos += info.mSize;
+		htonmemcpy(dest, value, info.mType, info.mSize);
+		for (S32 face = 1; face < mFaceCount; face++)
+		{
+			// Already unswizzled
+			memcpy(dest + face*stride, dest, info.mSize);	/* Flawfinder: ignore */
+		}
+
+		// Exceptions, up to the 0 terminator
+		while (pos < size && buffer[pos] != 0)
+		{
+			U64 faces = 0;
+			while (pos < size && (buffer[pos] & 0x80))
+			{
+				faces |= buffer[pos++] & 0x7F;
+				faces = faces << 7;
+			}
+			if (pos < size)
+			{
+				faces |= buffer[pos];
+			}
+			pos++;
+
+			read_te_value(value, buffer, size, pos, info.mSize);
+			pos += info.mSize;
+
+			for (S32 face = 0; faces && face < mFaceCount; face++, faces >>= 1)
+			{
+				if (faces & 0x01)
+				{
+					htonmemcpy(dest + face*stride, value, info.mType, info.mSize);
+				}
+			}
+		}
+
+		// Terminator
+		pos++;
+	}
+}
+
+S32 LLTEContents::pack(U8* buffer) const
+{
+	if (!mFaceCount)
+	{
+		return 0;
+	}
+
+	const S32 stride = sizeof(Face);
+	const S32 last_face_index = mFaceCount - 1;
+	U8* cur_ptr = buffer;
+
+	for (S32 field = 0; field < TE_FIELD_COUNT; field++)
+	{
+		const LLTEField& info = TE_FIELDS[field];
+		const U8* data = (const U8*)mFaces + info.mOffset;
+
+		if (field)
+		{
+			*cur_ptr++ = 0;
+		}
+
+		// The last face's value is the default...
+		htonmemcpy(cur_ptr, data + last_face_index*stride, info.mType, info.mSize);
+		cur_ptr += info.mSize;
+
+		// ...and every other distinct value goes out once, with the mask of
+		// the faces that use it, the same way packTEField() does.
+		for (S32 face_index = last_face_index - 1; face_index >= 0; face_index--)
+		{
+			const U8* value = data + face_index*stride;
+			BOOL already_sent = FALSE;
+			S32 i;
+			for (i = face_index + 1; i <= last_face_index; i++)
+			{
+				if (!memcmp(value, data + i*stride, info.mSize))
+				{
+					already_sent = TRUE;
+					break;
+				}
+			}
+			if (already_sent)
+			{
+				continue;
+			}
+
+			U64 exception_faces = 0;
+			for (i = face_index; i >= 0; i--)
+			{
+				if (!memcmp(value, data + i*stride, info.mSize))
+				{
+					exception_faces |= ((U64)1 << i);
+				}
+			}
+
+			if (exception_faces >= (0x1 << 7))
+			{
+				if (exception_faces >= (0x1 << 14))
+				{
+					if (exception_faces >= (0x1 << 21))
+					{
+						if (exception_faces >= (0x1 << 28))
+						{
+							*cur_ptr++ = (U8)(((exception_faces >> 28) & 0x7F) | 0x80);
+						}
+						*cur_ptr++ = (U8)(((exception_faces >> 21) & 0x7F) | 0x80);
+					}
+					*cur_ptr++ = (U8)(((exception_faces >> 14) & 0x7F) | 0x80);
+				}
+				*cur_ptr++ = (U8)(((exception_faces >> 7) & 0x7F) | 0x80);
+			}
+			*cur_ptr++ = (U8)(exception_faces & 0x7F);
+
+			htonmemcpy(cur_ptr, value, info.mType, info.mSize);
+			cur_ptr += info.mSize;
+		}
+	}
+
+	return (S32)(cur_ptr - buffer);
+}
+
 // Pack information about all texture entries into container:
 // { TextureEntry Variable 2 }
 // Includes information about image ID, color, scale S,T, offset S,T and rotation
 BOOL LLPrimitive::packTEMessage(LLMessageSystem *mesgsys, int shield) const
 {
-	const U32 MAX_TES = 32;
-
-	U8     image_ids[MAX_TES*16];
-	U8     colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
-	
-	const U32 MAX_TE_BUFFER = 4096;
-	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
-	
-	S32 last_face_index = getNumTEs() - 1;
+	LLTEContents contents;
+	U8 packed_buffer[LLTEContents::MAX_TE_BUFFER];
 
-        LLUUID client_tag = LLUUID("cc7a030f-282f-c165-44d2-b5ee572e72bf");//Imprudence
-	if (shield == 2)client_tag = LLUUID("c228d1cf-4b5d-4ba8-84f4-899a0796aa97");//IMG_DEFAULT_AVATAR
+	getTEContents(contents);
 
-	if (last_face_index > -1)
+	if (shield)
 	{
-		// ...if we hit the front, send one image id
-		S8 face_index;
-		LLColor4U coloru;
-		for (face_index = 0; face_index <= last_face_index; face_index++)
+		LLUUID client_tag = LLUUID("cc7a030f-282f-c165-44d2-b5ee572e72bf");//Imprudence
+		if (shield == 2)client_tag = LLUUID("c228d1cf-4b5d-4ba8-84f4-899a0796aa97");//IMG_DEFAULT_AVATAR
+
+		// Directly sending image_ids is not safe!
+		for (S32 face_index = 0; face_index < contents.mFaceCount; face_index++)
 		{
-			// Directly sending image_ids is not safe!
-			if(shield && !(face_index == 20 || face_index == 8 || face_index == 9 || face_index == 10 || face_index == 11 || face_index == 18 || face_index == 19))
+			if(!(face_index == 20 || face_index == 8 || face_index == 9 || face_index == 10 || face_index == 11 || face_index == 18 || face_index == 19))
 			{
+				U8* image_id = contents.mFaces[face_index].mImageID;
 				S8 f_f_i = face_index;
 				if(face_index == 0)f_f_i = 64;
 				if(face_index == 5)f_f_i = 9;
 				if(face_index == 6)f_f_i = 10;
 				if(face_index == 3)f_f_i = 11;
-				if(f_f_i == face_index)memcpy(&image_ids[face_index*16],LLUUID("c228d1cf-4b5d-4ba8-84f4-899a0796aa97").mData,16);
-				else if(f_f_i == 64)memcpy(&image_ids[face_index*16],client_tag.mData,16);
-				else memcpy(&image_ids[face_index*16],LLUUID("4934f1bf-3b1f-cf4f-dbdf-a72550d05bc6").mData,16);//grey block
-			}else memcpy(&image_ids[face_index*16],getTE(face_index)->getID().mData,16);	/* Flawfinder: ignore */ 
-
-			// Cast LLColor4 to LLColor4U
-			coloru.setVec( getTE(face_index)->getColor() );
-
-			// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
-			// as all zeros.  However, the subtraction and addition must be done in unsigned
-			// byte space, not in float space, otherwise off-by-one errors occur. JC
-			colors[4*face_index]     = 255 - coloru.mV[0];
-			colors[4*face_index + 1] = 255 - coloru.mV[1];
-			colors[4*face_index + 2] = 255 - coloru.mV[2];
-			colors[4*face_index + 3] = 255 - coloru.mV[3];
-
-			const LLTextureEntry* te = getTE(face_index);
-			scale_s[face_index] = (F32) te->mScaleS;
-			scale_t[face_index] = (F32) te->mScaleT;
-			offset_s[face_index] = (S16) llround((llclamp(te->mOffsetS,-1.0f,1.0f) * (F32)0x7FFF)) ;
-			offset_t[face_index] = (S16) llround((llclamp(te->mOffsetT,-1.0f,1.0f) * (F32)0x7FFF)) ;
-			image_rot[face_index] = (S16) llround(((fmod(te->mRotation, F_TWO_PI)/F_TWO_PI) * TEXTURE_ROTATION_PACK_FACTOR));
-			bump[face_index] = te->getBumpShinyFullbright();
-			media_flags[face_index] = te->getMediaTexGen();
-			glow[face_index] = (U8) llround((llclamp(te->getGlow(), 0.0f, 1.0f) * (F32)0xFF));
+				if(f_f_i == face_index)memcpy(image_id,LLUUID("c228d1cf-4b5d-4ba8-84f4-899a0796aa97").mData,16);
+				else if(f_f_i == 64)memcpy(image_id,client_tag.mData,16);
+				else memcpy(image_id,LLUUID("4934f1bf-3b1f-cf4f-dbdf-a72550d05bc6").mData,16);//grey block
+			}
 		}
+	}
 
-		cur_ptr += packTEField(cur_ptr, (U8 *)image_ids, sizeof(LLUUID),last_face_index, MVT_LLUUID);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)colors, 4 ,last_face_index, MVT_U8);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)scale_s, 4 ,last_face_index, MVT_F32);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)scale_t, 4 ,last_face_index, MVT_F32);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)offset_s, 2 ,last_face_index, MVT_S16Array);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)offset_t, 2 ,last_face_index, MVT_S16Array);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)image_rot, 2 ,last_face_index, MVT_S16Array);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)bump, 1 ,last_face_index, MVT_U8);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)media_flags, 1 ,last_face_index, MVT_U8);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)glow, 1 ,last_face_index, MVT_U8);
-	}
-   	mesgsys->addBinaryDataFast(_PREHASH_TextureEntry, packed_buffer, (S32)(cur_ptr - packed_buffer));
+	S32 size = contents.pack(packed_buffer);
+   	mesgsys->addBinaryDataFast(_PREHASH_TextureEntry, packed_buffer, size);
 
 	return FALSE;
 }
@@ -1228,79 +1377,13 @@ BOOL LLPrimitive::packTEMessage(LLMessageSystem *mesgsys, int shield) const
 
 BOOL LLPrimitive::packTEMessage(LLDataPacker &dp) const
 {
-	const U32 MAX_TES = 32;
-
-	U8     image_ids[MAX_TES*16];
-	U8     colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
-	
-	const U32 MAX_TE_BUFFER = 4096;
-	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
-	
-	S32 last_face_index = getNumTEs() - 1;
-	
-	if (last_face_index > -1)
-	{
-		// ...if we hit the front, send one image id
-		S8 face_index;
-		LLColor4U coloru;
-		for (face_index = 0; face_index <= last_face_index; face_index++)
-		{
-			// Directly sending image_ids is not safe!
-			memcpy(&image_ids[face_index*16],getTE(face_index)->getID().mData,16);	/* Flawfinder: ignore */ 
-
-			// Cast LLColor4 to LLColor4U
-			coloru.setVec( getTE(face_index)->getColor() );
-
-			// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
-			// as all zeros.  However, the subtraction and addition must be done in unsigned
-			// byte space, not in float space, otherwise off-by-one errors occur. JC
-			colors[4*face_index]     = 255 - coloru.mV[0];
-			colors[4*face_index + 1] = 255 - coloru.mV[1];
-			colors[4*face_index + 2] = 255 - coloru.mV[2];
-			colors[4*face_index + 3] = 255 - coloru.mV[3];
-
-			const LLTextureEntry* te = getTE(face_index);
-			scale_s[face_index] = (F32) te->mScaleS;
-			scale_t[face_index] = (F32) te->mScaleT;
-			offset_s[face_index] = (S16) llround((llclamp(te->mOffsetS,-1.0f,1.0f) * (F32)0x7FFF)) ;
-			offset_t[face_index] = (S16) llround((llclamp(te->mOffsetT,-1.0f,1.0f) * (F32)0x7FFF)) ;
-			image_rot[face_index] = (S16) llround(((fmod(te->mRotation, F_TWO_PI)/F_TWO_PI) * TEXTURE_ROTATION_PACK_FACTOR));
-			bump[face_index] = te->getBumpShinyFullbright();
-			media_flags[face_index] = te->getMediaTexGen();
-            glow[face_index] = (U8) llround((llclamp(te->getGlow(), 0.0f, 1.0f) * (F32)0xFF));
-		}
+	LLTEContents contents;
+	U8 packed_buffer[LLTEContents::MAX_TE_BUFFER];
+
+	getTEContents(contents);
+	S32 size = contents.pack(packed_buffer);
 
-		cur_ptr += packTEField(cur_ptr, (U8 *)image_ids, sizeof(LLUUID),last_face_index, MVT_LLUUID);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)colors, 4 ,last_face_index, MVT_U8);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)scale_s, 4 ,last_face_index, MVT_F32);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)scale_t, 4 ,last_face_index, MVT_F32);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)offset_s, 2 ,last_face_index, MVT_S16Array);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)offset_t, 2 ,last_face_index, MVT_S16Array);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)image_rot, 2 ,last_face_index, MVT_S16Array);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)bump, 1 ,last_face_index, MVT_U8);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)media_flags, 1 ,last_face_index, MVT_U8);
-		*cur_ptr++ = 0;
-		cur_ptr += packTEField(cur_ptr, (U8 *)glow, 1 ,last_face_index, MVT_U8);
-	}
-
-	dp.packBinaryData(packed_buffer, (S32)(cur_ptr - packed_buffer), "TextureEntry");
+	dp.packBinaryData(packed_buffer, size, "TextureEntry");
 	return FALSE;
 }
 
@@ -1312,28 +1395,8 @@ S32 LLPrimitive::unpackTEMessage(LLMessageSystem *mesgsys, char *block_name)
 S32 LLPrimitive::unpackTEMessage(LLMessageSystem *mesgsys, char *block_name, const S32 block_num)
 {
 	// use a negative block_num to indicate a single-block read (a non-variable block)
-	S32 retval = 0;
-	const U32 MAX_TES = 32;
-
-	// Avoid construction of 32 UUIDs per call. JC
-
-	U8     image_data[MAX_TES*16];
-	U8	  colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
-	
-	const U32 MAX_TE_BUFFER = 4096;
-	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
-
-	U32 size;
-	U32 face_count = 0;
+	U8 packed_buffer[LLTEContents::MAX_TE_BUFFER];
+	S32 size;
 
 	if (block_num < 0)
 	{
@@ -1344,156 +1407,121 @@ S32 LLPrimitive::unpackTEMessage(LLMessageSystem *mesgsys, char *block_name, con
 		size = mesgsys->getSizeFast(block_name, block_num, _PREHASH_TextureEntry);
 	}
 
-	if (size == 0)
+	if (size <= 0)
 	{
-		return retval;
+		return 0;
 	}
+	size = llmin(size, (S32)LLTEContents::MAX_TE_BUFFER);
 
 	if (block_num < 0)
 	{
-		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, 0, MAX_TE_BUFFER);
+		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, 0, LLTEContents::MAX_TE_BUFFER);
 	}
 	else
 	{
-		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, block_num, MAX_TE_BUFFER);
-	}
-
-	face_count = getNumTEs();
-
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_data, 16, face_count, MVT_LLUUID);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)colors, 4, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_s, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_t, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_s, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_t, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_rot, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)bump, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)media_flags, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)glow, 1, face_count, MVT_U8);
-	
-	LLColor4 color;
-	LLColor4U coloru;
-	for (U32 i = 0; i < face_count; i++)
-	{
-		retval |= setTETexture(i, ((LLUUID*)image_data)[i]);
-		retval |= setTEScale(i, scale_s[i], scale_t[i]);
-		retval |= setTEOffset(i, (F32)offset_s[i] / (F32)0x7FFF, (F32) offset_t[i] / (F32) 0x7FFF);
-		retval |= setTERotation(i, ((F32)image_rot[i] / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI);
-		retval |= setTEBumpShinyFullbright(i, bump[i]);
-		retval |= setTEMediaTexGen(i, media_flags[i]);
-		retval |= setTEGlow(i, (F32)glow[i] / (F32)0xFF);
-		coloru = LLColor4U(colors + 4*i);
-
-		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
-		// as all zeros.  However, the subtraction and addition must be done in unsigned
-		// byte space, not in float space, otherwise off-by-one errors occur. JC
-		color.mV[VRED]		= F32(255 - coloru.mV[VRED])   / 255.f;
-		color.mV[VGREEN]	= F32(255 - coloru.mV[VGREEN]) / 255.f;
-		color.mV[VBLUE]		= F32(255 - coloru.mV[VBLUE])  / 255.f;
-		color.mV[VALPHA]	= F32(255 - coloru.mV[VALPHA]) / 255.f;
-
-		retval |= setTEColor(i, color);
+		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, block_num, LLTEContents::MAX_TE_BUFFER);
 	}
 
-	return retval;
+	return unpackTEBlob(packed_buffer, size);
 }
 
 S32 LLPrimitive::unpackTEMessage(LLDataPacker &dp)
 {
-	// use a negative block_num to indicate a single-block read (a non-variable block)
-	S32 retval = 0;
-	const U32 MAX_TES = 32;
-
-	// Avoid construction of 32 UUIDs per call
-	static LLUUID image_ids[MAX_TES];
-
-	U8     image_data[MAX_TES*16];
-	U8	   colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
-
-	const U32 MAX_TE_BUFFER = 4096;
-	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
-
+	U8 packed_buffer[LLTEContents::MAX_TE_BUFFER];
 	S32 size;
-	U32 face_count = 0;
 
 	if (!dp.unpackBinaryData(packed_buffer, size, "TextureEntry"))
 	{
-		retval = TEM_INVALID;
 		llwarns << "Bad texture entry block!  Abort!" << llendl;
-		return retval;
+		return TEM_INVALID;
 	}
 
 	if (size == 0)
 	{
-		return retval;
+		return 0;
 	}
 
-	face_count = getNumTEs();
-	U32 i;
+	return unpackTEBlob(packed_buffer, size);
+}
 
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_data, 16, face_count, MVT_LLUUID);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)colors, 4, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_s, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_t, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_s, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_t, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_rot, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)bump, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)media_flags, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)glow, 1, face_count, MVT_U8);
-
-	for (i = 0; i < face_count; i++)
-	{
-		memcpy(image_ids[i].mData,&image_data[i*16],16);	/* Flawfinder: ignore */ 	
+S32 LLPrimitive::unpackTEBlob(const U8* buffer, S32 size)
+{
+	// Most object updates resend texture entries that have not changed.
+	// Any setTE* clears mLastTEBlob, so a match means the faces still hold
+	// exactly what this blob decodes to.
+	if (size == (S32)mLastTEBlob.size() && size > 0 && !memcmp(&mLastTEBlob[0], buffer, size))
+	{
+		return 0;
 	}
-	
-	LLColor4 color;
+
+	LLTEContents contents;
+	contents.unpack(buffer, size, getNumTEs());
+	S32 retval = applyTEContents(contents);
+
+	mLastTEBlob.assign(buffer, buffer + size);
+	return retval;
+}
+
+void LLPrimitive::getTEContents(LLTEContents& contents) const
+{
+	contents.mFaceCount = llmin(getNumTEs(), (U8)LLTEContents::MAX_TES);
+
 	LLColor4U coloru;
-	for (i = 0; i < face_count; i++)
+	for (U8 face_index = 0; face_index < contents.mFaceCount; face_index++)
+	{
+		const LLTextureEntry* te = getTE(face_index);
+		LLTEContents::Face& face = contents.mFaces[face_index];
+
+		memcpy(face.mImageID, te->getID().mData, UUID_BYTES);	/* Flawfinder: ignore */
+
+		// Cast LLColor4 to LLColor4U
+		coloru.setVec( te->getColor() );
+
+		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
+		// as all zeros.  However, the subtraction and addition must be done in unsigned
+		// byte space, not in float space, otherwise off-by-one errors occur. JC
+		face.mColor[0] = 255 - coloru.mV[0];
+		face.mColor[1] = 255 - coloru.mV[1];
+		face.mColor[2] = 255 - coloru.mV[2];
+		face.mColor[3] = 255 - coloru.mV[3];
+
+		face.mScaleS = (F32) te->mScaleS;
+		face.mScaleT = (F32) te->mScaleT;
+		face.mOffsetS = (S16) llround((llclamp(te->mOffsetS,-1.0f,1.0f) * (F32)0x7FFF)) ;
+		face.mOffsetT = (S16) llround((llclamp(te->mOffsetT,-1.0f,1.0f) * (F32)0x7FFF)) ;
+		face.mRotation = (S16) llround(((fmod(te->mRotation, F_TWO_PI)/F_TWO_PI) * TEXTURE_ROTATION_PACK_FACTOR));
+		face.mBump = te->getBumpShinyFullbright();
+		face.mMediaFlags = te->getMediaTexGen();
+		face.mGlow = (U8) llround((llclamp(te->getGlow(), 0.0f, 1.0f) * (F32)0xFF));
+	}
+}
+
+S32 LLPrimitive::applyTEContents(const LLTEContents& contents)
+{
+	S32 retval = 0;
+	LLUUID image_id;
+	LLColor4 color;
+
+	for (U8 i = 0; i < contents.mFaceCount; i++)
 	{
-		retval |= setTETexture(i, image_ids[i]);
-		retval |= setTEScale(i, scale_s[i], scale_t[i]);
-		retval |= setTEOffset(i, (F32)offset_s[i] / (F32)0x7FFF, (F32) offset_t[i] / (F32) 0x7FFF);
-		retval |= setTERotation(i, ((F32)image_rot[i] / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI);
-		retval |= setTEBumpShinyFullbright(i, bump[i]);
-		retval |= setTEMediaTexGen(i, media_flags[i]);
-		retval |= setTEGlow(i, (F32)glow[i] / (F32)0xFF);
-		coloru = LLColor4U(colors + 4*i);
+		const LLTEContents::Face& face = contents.mFaces[i];
+
+		memcpy(image_id.mData, face.mImageID, UUID_BYTES);	/* Flawfinder: ignore */
+		retval |= setTETexture(i, image_id);
+		retval |= setTEScale(i, face.mScaleS, face.mScaleT);
+		retval |= setTEOffset(i, (F32)face.mOffsetS / (F32)0x7FFF, (F32) face.mOffsetT / (F32) 0x7FFF);
+		retval |= setTERotation(i, ((F32)face.mRotation / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI);
+		retval |= setTEBumpShinyFullbright(i, face.mBump);
+		retval |= setTEMediaTexGen(i, face.mMediaFlags);
+		retval |= setTEGlow(i, (F32)face.mGlow / (F32)0xFF);
 
 		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
 		// as all zeros.  However, the subtraction and addition must be done in unsigned
 		// byte space, not in float space, otherwise off-by-one errors occur. JC
-		color.mV[VRED]		= F32(255 - coloru.mV[VRED])   / 255.f;
-		color.mV[VGREEN]	= F32(255 - coloru.mV[VGREEN]) / 255.f;
-		color.mV[VBLUE]		= F32(255 - coloru.mV[VBLUE])  / 255.f;
-		color.mV[VALPHA]	= F32(255 - coloru.mV[VALPHA]) / 255.f;
+		color.mV[VRED]		= F32(255 - face.mColor[VRED])   / 255.f;
+		color.mV[VGREEN]	= F32(255 - face.mColor[VGREEN]) / 255.f;
+		color.mV[VBLUE]		= F32(255 - face.mColor[VBLUE])  / 255.f;
+		color.mV[VALPHA]	= F32(255 - face.mColor[VALPHA]) / 255.f;
 
 		retval |= setTEColor(i, color);
 	}
@@ -1503,6 +1531,7 @@ S32 LLPrimitive::unpackTEMessage(LLDataPacker &dp)
 
 void LLPrimitive::setTextureList(LLTextureEntry *listp)
 {
+	mLastTEBlob.clear();
 	LLTextureEntry* old_texture_list = mTextureList;
 	mTextureList = listp;
  	delete[] old_texture_list;
@@ -266,6 +266,45 @@ public:
 };
 
 
+//-------------------------------------------------
+// Texture entries of one object as they travel in the TextureEntry field:
+// one Face per texture entry, in wire units (255 - color, 16 bit offsets
+// and rotation, 8 bit glow). The blob holds ten fields in a fixed order,
+// each a default value for every face followed by (face bitmask, value)
+// exceptions and a 0 terminator.
+//-------------------------------------------------
+struct LLTEContents
+{
+	enum
+	{
+		MAX_TES = 32,
+		MAX_TE_BUFFER = 4096
+	};
+
+	struct Face
+	{
+		U8		mImageID[UUID_BYTES];
+		U8		mColor[4];
+		F32		mScaleS;
+		F32		mScaleT;
+		S16		mOffsetS;
+		S16		mOffsetT;
+		S16		mRotation;
+		U8		mBump;
+		U8		mMediaFlags;
+		U8		mGlow;
+	};
+
+	// Decodes every field in one pass straight into mFaces. Bytes past
+	// size read as zero. Faces past MAX_TES are dropped.
+	void unpack(const U8* buffer, S32 size, U8 face_count);
+	// Returns the number of bytes written; buffer holds MAX_TE_BUFFER.
+	S32 pack(U8* buffer) const;
+
+	U8		mFaceCount;
+	Face	mFaces[MAX_TES];
+};
+
 
 class LLPrimitive : public LLXform
 {
@@ -336,6 +375,10 @@ public:
 					  const F32* scale_s,
 					  const F32* scale_t);
 	void copyTEs(const LLPrimitive *primitive);
+	void getTEContents(LLTEContents& contents) const;
+	S32 applyTEContents(const LLTEContents& contents);
+	// Per-field codec. The TE messages go through LLTEContents instead;
+	// these remain as the reference encoding.
 	S32 packTEField(U8 *cur_ptr, U8 *data_ptr, U8 data_size, U8 last_face_index, EMsgVariableType type) const;
 	S32 unpackTEField(U8 *cur_ptr, U8 *buffer_end, U8 *data_ptr, U8 data_size, U8 face_count, EMsgVariableType type);
 	BOOL packTEMessage(LLMessageSystem *mesgsys, int shield = 0) const;
@@ -343,6 +386,9 @@ public:
 	S32 unpackTEMessage(LLMessageSystem *mesgsys, char *block_name);
 	S32 unpackTEMessage(LLMessageSystem *mesgsys, char *block_name, const S32 block_num); // Variable num of blocks
 	BOOL unpackTEMessage(LLDataPacker &dp);
+	// Skips decoding when buffer matches the last blob applied and no
+	// texture entry was set since.
+	S32 unpackTEBlob(const U8* buffer, S32 size);
 	
 #ifdef CHECK_FOR_FINITE
 	inline void setPosition(const LLVector3& pos);
@@ -418,6 +464,7 @@ protected:
 	U8					mMaterial;			// Material code
 	U8					mNumTEs;			// # of faces on the primitve	
 	U32 				mMiscFlags;			// home for misc bools
+	std::vector<U8>		mLastTEBlob;		// last TextureEntry applied, cleared by any setTE*
 
 	static LLVolumeMgr* sVolumeManager;
 };
@@ -141,6 +141,12 @@ LLFont::LLFont()
 
 	mRenderGlyphCount = 0;
 	mAddGlyphCount = 0;
+	mBitmapGeneration = 0;
+
+	for (S32 i = 0; i < NUM_GLYPH_PAGES; i++)
+	{
+		mGlyphPages[i] = NULL;
+	}
 
 	mPointSize = 0;
 }
@@ -155,6 +161,10 @@ LLFont::~LLFont()
 
 	// Delete glyph info
 	std::for_each(mCharGlyphInfoMap.begin(), mCharGlyphInfoMap.end(), DeletePairedPointer());
+	for (S32 i = 0; i < NUM_GLYPH_PAGES; i++)
+	{
+		delete [] mGlyphPages[i];
+	}
 
 	// mFontBitmapCachep will be cleaned up by LLPointer destructor.
 }
@@ -248,6 +258,7 @@ BOOL LLFont::loadFace(const std::string& filename, const F32 point_size, const F
 
 	mName = filename;
 	mPointSize = point_size;
+	mBitmapGeneration++;
 
 	return TRUE;
 }
@@ -264,6 +275,7 @@ void LLFont::resetBitmapCache()
 		iter->second->mMetricsValid = FALSE;
 	}
 	mFontBitmapCachep->reset();
+	mBitmapGeneration++;
 
 	// Add the empty glyph`5
 	addGlyph(0, 0);
@@ -271,6 +283,12 @@ void LLFont::resetBitmapCache()
 
 LLFontGlyphInfo* LLFont::getGlyphInfo(const llwchar wch) const
 {
+	if (wch < 0x10000)
+	{
+		LLFontGlyphInfo** page = mGlyphPages[wch >> GLYPH_PAGE_BITS];
+		return page ? page[wch & (GLYPH_PAGE_SIZE - 1)] : NULL;
+	}
+
 	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
 	if (iter != mCharGlyphInfoMap.end())
 	{
@@ -325,8 +343,8 @@ BOOL LLFont::addChar(const llwchar wch) const
 		}
 	}
 	
-	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
-	if (iter == mCharGlyphInfoMap.end() || !(iter->second->mIsRendered))
+	const LLFontGlyphInfo* gi = getGlyphInfo(wch);
+	if (!gi || !gi->mIsRendered)
 	{
 		BOOL result = addGlyph(wch, glyph_index);
 		return result;
@@ -346,6 +364,17 @@ void LLFont::insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const
 	{
 		mCharGlyphInfoMap[wch] = gi;
 	}
+
+	if (wch < 0x10000)
+	{
+		LLFontGlyphInfo**& page = mGlyphPages[wch >> GLYPH_PAGE_BITS];
+		if (!page)
+		{
+			page = new LLFontGlyphInfo*[GLYPH_PAGE_SIZE];
+			memset(page, 0, GLYPH_PAGE_SIZE * sizeof(LLFontGlyphInfo*));
+		}
+		page[wch & (GLYPH_PAGE_SIZE - 1)] = gi;
+	}
 }
 
 BOOL LLFont::addGlyphFromFont(const LLFont *fontp, const llwchar wch, const U32 glyph_index) const
@@ -493,16 +522,12 @@ F32 LLFont::getXAdvance(const llwchar wch) const
 		fontp->renderGlyph(glyph_index);
 
 		// Create the entry if it's not there
-		char_glyph_info_map_t::iterator iter2 = mCharGlyphInfoMap.find(wch);
-		if (iter2 == mCharGlyphInfoMap.end())
+		gi = getGlyphInfo(wch);
+		if (!gi)
 		{
 			gi = new LLFontGlyphInfo(glyph_index);
 			insertGlyphInfo(wch, gi);
 		}
-		else
-		{
-			gi = iter2->second;
-		}
 		
 		gi->mWidth = fontp->mFTFace->glyph->bitmap.width;
 		gi->mHeight = fontp->mFTFace->glyph->bitmap.rows;
@@ -515,7 +540,7 @@ F32 LLFont::getXAdvance(const llwchar wch) const
 	}
 	else
 	{
-		gi = get_if_there(mCharGlyphInfoMap, (llwchar)0, (LLFontGlyphInfo*)NULL);
+		gi = getGlyphInfo(0);
 		if (gi)
 		{
 			return gi->mXAdvance;
@@ -549,10 +574,15 @@ F32 LLFont::getXKerning(const llwchar char_left, const llwchar char_right) const
 		return 0.0;
 
 	llassert(!mIsFallback);
-	LLFontGlyphInfo* left_glyph_info = get_if_there(mCharGlyphInfoMap, char_left, (LLFontGlyphInfo*)NULL);
+	if (!FT_HAS_KERNING(mFTFace))
+	{
+		return 0.0;
+	}
+
+	LLFontGlyphInfo* left_glyph_info = getGlyphInfo(char_left);
 	U32 left_glyph = left_glyph_info ? left_glyph_info->mGlyphIndex : 0;
 	// Kern this puppy.
-	LLFontGlyphInfo* right_glyph_info = get_if_there(mCharGlyphInfoMap, char_right, (LLFontGlyphInfo*)NULL);
+	LLFontGlyphInfo* right_glyph_info = getGlyphInfo(char_right);
 	U32 right_glyph = right_glyph_info ? right_glyph_info->mGlyphIndex : 0;
 
 	FT_Vector  delta;
@@ -151,6 +151,9 @@ public:
 	F32 getXKerning(const llwchar char_left, const llwchar char_right) const; // Get the kerning between the two characters
 	virtual void reset() = 0;
 
+	// Bumped whenever glyph bitmap positions or metrics may have changed
+	U32 getBitmapGeneration() const				{ return mBitmapGeneration; }
+
 protected:
 	virtual BOOL hasGlyph(const llwchar wch) const;		// Has a glyph for this character
 	virtual BOOL addChar(const llwchar wch) const;		// Add a new character to the font if necessary
@@ -181,6 +184,18 @@ protected:
 	typedef std::map<llwchar, LLFontGlyphInfo*> char_glyph_info_map_t;
 	mutable char_glyph_info_map_t mCharGlyphInfoMap; // Information about glyph location in bitmap
 
+	// Flat lookup table over the Basic Multilingual Plane, allocated a page
+	// at a time, mirroring mCharGlyphInfoMap (which owns the glyph infos).
+	enum
+	{
+		GLYPH_PAGE_BITS = 8,
+		GLYPH_PAGE_SIZE = 1 << GLYPH_PAGE_BITS,
+		NUM_GLYPH_PAGES = 0x10000 >> GLYPH_PAGE_BITS
+	};
+	mutable LLFontGlyphInfo** mGlyphPages[NUM_GLYPH_PAGES];
+
+	mutable U32 mBitmapGeneration;
+
 	BOOL mValid;
 	void setSubImageLuminanceAlpha(const U32 x,
 								   const U32 y,
@@ -54,6 +54,9 @@ BOOL LLFontGL::sDisplayFont = TRUE ;
 std::string LLFontGL::sAppDir;
 
 LLColor4 LLFontGL::sShadowColor(0.f, 0.f, 0.f, 1.f);
+U32 LLFontGL::sRunCacheHits = 0;
+U32 LLFontGL::sRunCacheMisses = 0;
+U32 LLFontGL::sGlyphQuads = 0;
 LLFontRegistry* LLFontGL::sFontRegistry = NULL;
 
 LLCoordFont LLFontGL::sCurOrigin;
@@ -68,6 +71,9 @@ const F32 PIXEL_CORRECTION_DISTANCE = 0.01f;
 const F32 PAD_UVY = 0.5f; // half of vertical padding between glyphs in the glyph texture
 const F32 DROP_SHADOW_SOFT_STRENGTH = 0.3f;
 
+// When a font holds more runs than this, the least recently drawn half goes
+const U32 MAX_CACHED_RUNS = 512;
+
 F32 llfont_round_x(F32 x)
 {
 	//return llfloor((x-LLFontGL::sCurOrigin.mX)/LLFontGL::sScaleX+0.5f)*LLFontGL::sScaleX+LLFontGL::sCurOrigin.mX;
@@ -114,7 +120,11 @@ U8 LLFontGL::getStyleFromString(const std::string &style)
 }
 
 LLFontGL::LLFontGL()
-	: LLFont()
+	: LLFont(),
+	  mRunCacheGeneration(0),
+	  mRunCacheTick(0),
+	  mRunCacheScaleX(sScaleX),
+	  mRunCacheScaleY(sScaleY)
 {
 	clearEmbeddedChars();
 }
@@ -272,6 +282,7 @@ void LLFontGL::destroyAllGL()
 void LLFontGL::destroyGL()
 {
 	mFontBitmapCachep->destroyGL();
+	clearTextRuns();
 }
 
 
@@ -465,31 +476,6 @@ S32 LLFontGL::render(const LLWString &wstr,
 		break;
 	}
 
-	switch (halign)
-	{
-	case LEFT:
-		break;
-	case RIGHT:
-	  	cur_x -= llmin(scaled_max_pixels, llround(getWidthF32(wstr.c_str(), 0, length) * sScaleX));
-		break;
-	case HCENTER:
-	    cur_x -= llmin(scaled_max_pixels, llround(getWidthF32(wstr.c_str(), 0, length) * sScaleX)) / 2;
-		break;
-	default:
-		break;
-	}
-
-	cur_render_y = cur_y;
-	cur_render_x = cur_x;
-
-	F32 start_x = cur_x;
-
-	F32 inv_width = 1.f / mFontBitmapCachep->getBitmapWidth();
-	F32 inv_height = 1.f / mFontBitmapCachep->getBitmapHeight();
-
-	const S32 LAST_CHARACTER = LLFont::LAST_CHAR_FULL;
-
-
 	BOOL draw_ellipses = FALSE;
 	if (use_ellipses && halign == LEFT)
 	{
@@ -503,6 +489,50 @@ S32 LLFontGL::render(const LLWString &wstr,
 		}
 	}
 
+	F32 start_x;
+
+	if (!use_embedded || mEmbeddedChars.empty())
+	{
+		// Plain text: draw the cached layout
+		F32 base_x = floorf(cur_x);
+		F32 base_y = floorf(cur_y);
+		const text_run_t& run = getTextRun(wstr, begin_offset, length, style, halign, scaled_max_pixels,
+										   cur_x - base_x, cur_y - base_y);
+		drawTextRun(run, base_x, base_y, color, style, drop_shadow_strength);
+
+		start_x = base_x + run.mStartX;
+		cur_x = base_x + run.mEndX;
+		cur_y = base_y + run.mEndY;
+		chars_drawn = run.mCharsDrawn;
+
+		// Skip the per-character loop below
+		length = 0;
+	}
+	else
+	{
+		switch (halign)
+		{
+		case LEFT:
+			break;
+		case RIGHT:
+			cur_x -= llmin(scaled_max_pixels, llround(getWidthF32(wstr.c_str() + begin_offset, 0, length) * sScaleX));
+			break;
+		case HCENTER:
+			cur_x -= llmin(scaled_max_pixels, llround(getWidthF32(wstr.c_str() + begin_offset, 0, length) * sScaleX)) / 2;
+			break;
+		default:
+			break;
+		}
+		start_x = cur_x;
+	}
+
+	cur_render_y = cur_y;
+	cur_render_x = cur_x;
+
+	F32 inv_width = 1.f / mFontBitmapCachep->getBitmapWidth();
+	F32 inv_height = 1.f / mFontBitmapCachep->getBitmapHeight();
+
+	const S32 LAST_CHARACTER = LLFont::LAST_CHAR_FULL;
 
 	// Remember last-used texture to avoid unnecesssary bind calls.
 	LLImageGL *last_bound_texture = NULL;
@@ -682,6 +712,199 @@ S32 LLFontGL::render(const LLWString &wstr,
 	return chars_drawn;
 }
 
+bool LLFontGL::run_key_t::operator<(const run_key_t& rhs) const
+{
+	if (mLength != rhs.mLength) return mLength < rhs.mLength;
+	if (mMaxPixels != rhs.mMaxPixels) return mMaxPixels < rhs.mMaxPixels;
+	if (mFracX != rhs.mFracX) return mFracX < rhs.mFracX;
+	if (mFracY != rhs.mFracY) return mFracY < rhs.mFracY;
+	if (mStyle != rhs.mStyle) return mStyle < rhs.mStyle;
+	if (mHAlign != rhs.mHAlign) return mHAlign < rhs.mHAlign;
+	return mText < rhs.mText;
+}
+
+const LLFontGL::text_run_t& LLFontGL::getTextRun(const LLWString& wstr, S32 begin_offset, S32 length,
+												 U8 style, HAlign halign, S32 scaled_max_pixels,
+												 F32 frac_x, F32 frac_y) const
+{
+	if (mRunCacheGeneration != mBitmapGeneration
+		|| mRunCacheScaleX != sScaleX
+		|| mRunCacheScaleY != sScaleY)
+	{
+		// Glyphs moved in the bitmaps or the UI was rescaled
+		clearTextRuns();
+		mRunCacheGeneration = mBitmapGeneration;
+		mRunCacheScaleX = sScaleX;
+		mRunCacheScaleY = sScaleY;
+	}
+
+	run_key_t key;
+	key.mLength = llmax(length, 0);
+	if (key.mLength > 0 && begin_offset < (S32)wstr.length())
+	{
+		key.mText = wstr.substr(begin_offset, key.mLength + 1);
+	}
+	key.mMaxPixels = scaled_max_pixels;
+	key.mFracX = frac_x;
+	key.mFracY = frac_y;
+	key.mStyle = style;
+	key.mHAlign = (U8)halign;
+
+	run_cache_t::iterator iter = mRunCache.find(key);
+	if (iter != mRunCache.end())
+	{
+		sRunCacheHits++;
+		iter->second.mLastUsed = ++mRunCacheTick;
+		return iter->second;
+	}
+	sRunCacheMisses++;
+
+	if (mRunCache.size() >= MAX_CACHED_RUNS)
+	{
+		// Drop the runs that were drawn least recently
+		std::vector<U32> ages;
+		ages.reserve(mRunCache.size());
+		for (iter = mRunCache.begin(); iter != mRunCache.end(); ++iter)
+		{
+			ages.push_back(iter->second.mLastUsed);
+		}
+		std::nth_element(ages.begin(), ages.begin() + ages.size() / 2, ages.end());
+		U32 cutoff = ages[ages.size() / 2];
+		for (iter = mRunCache.begin(); iter != mRunCache.end(); )
+		{
+			if (iter->second.mLastUsed < cutoff)
+			{
+				mRunCache.erase(iter++);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	text_run_t& run = mRunCache[key];
+	layoutTextRun(run, wstr, begin_offset, key.mLength, halign, scaled_max_pixels, frac_x, frac_y);
+	run.mLastUsed = ++mRunCacheTick;
+	return run;
+}
+
+void LLFontGL::layoutTextRun(text_run_t& run, const LLWString& wstr, S32 begin_offset, S32 length,
+							 HAlign halign, S32 scaled_max_pixels, F32 frac_x, F32 frac_y) const
+{
+	F32 cur_x = frac_x;
+	F32 cur_y = frac_y;
+
+	switch (halign)
+	{
+	case LEFT:
+		break;
+	case RIGHT:
+	  	cur_x -= llmin(scaled_max_pixels, llround(getWidthF32(wstr.c_str() + begin_offset, 0, length) * sScaleX));
+		break;
+	case HCENTER:
+	    cur_x -= llmin(scaled_max_pixels, llround(getWidthF32(wstr.c_str() + begin_offset, 0, length) * sScaleX)) / 2;
+		break;
+	default:
+		break;
+	}
+
+	run.mGlyphs.clear();
+	run.mStartX = cur_x;
+	run.mCharsDrawn = 0;
+
+	F32 start_x = cur_x;
+	F32 inv_width = 1.f / mFontBitmapCachep->getBitmapWidth();
+	F32 inv_height = 1.f / mFontBitmapCachep->getBitmapHeight();
+
+	const S32 LAST_CHARACTER = LLFont::LAST_CHAR_FULL;
+
+	for (S32 i = begin_offset; i < begin_offset + length; i++)
+	{
+		llwchar wch = wstr[i];
+		if (!hasGlyph(wch))
+		{
+			addChar(wch);
+		}
+
+		const LLFontGlyphInfo* fgi = getGlyphInfo(wch);
+		if (!fgi)
+		{
+			llerrs << "Missing Glyph Info" << llendl;
+			break;
+		}
+
+		if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
+		{
+			// Not enough room for this character.
+			break;
+		}
+
+		run_glyph_t glyph;
+		glyph.mUVRect = LLRectf((fgi->mXBitmapOffset) * inv_width,
+								(fgi->mYBitmapOffset + fgi->mHeight + PAD_UVY) * inv_height,
+								(fgi->mXBitmapOffset + fgi->mWidth) * inv_width,
+								(fgi->mYBitmapOffset - PAD_UVY) * inv_height);
+		// snap glyph origin to whole screen pixel
+		glyph.mScreenRect = LLRectf(llround(cur_x + (F32)fgi->mXBearing),
+									llround(cur_y + (F32)fgi->mYBearing),
+									llround(cur_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
+									llround(cur_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
+		glyph.mBitmapNum = fgi->mBitmapNum;
+		run.mGlyphs.push_back(glyph);
+
+		run.mCharsDrawn++;
+		cur_x += fgi->mXAdvance;
+		cur_y += fgi->mYAdvance;
+
+		llwchar next_char = wstr[i+1];
+		if (next_char && (next_char < LAST_CHARACTER))
+		{
+			// Kern this puppy.
+			if (!hasGlyph(next_char))
+			{
+				addChar(next_char);
+			}
+			cur_x += getXKerning(wch, next_char);
+		}
+
+		// Round after kerning, see render()
+		cur_x = (F32)llfloor(cur_x + 0.5f);
+	}
+
+	run.mEndX = cur_x;
+	run.mEndY = cur_y;
+}
+
+void LLFontGL::drawTextRun(const text_run_t& run, F32 base_x, F32 base_y,
+						   const LLColor4& color, U8 style, F32 drop_shadow_strength) const
+{
+	LLImageGL* last_bound_texture = NULL;
+	gGL.begin(LLRender::QUADS);
+	for (std::vector<run_glyph_t>::const_iterator iter = run.mGlyphs.begin();
+		 iter != run.mGlyphs.end(); ++iter)
+	{
+		// Binding flushes, so the quads go out in one batch per bitmap
+		LLImageGL* image_gl = mFontBitmapCachep->getImageGL(iter->mBitmapNum);
+		if (last_bound_texture != image_gl)
+		{
+			gGL.getTexUnit(0)->bind(image_gl);
+			last_bound_texture = image_gl;
+		}
+
+		LLRectf screen_rect = iter->mScreenRect;
+		screen_rect.translate(base_x, base_y);
+		emitGlyph(screen_rect, iter->mUVRect, color, style, drop_shadow_strength);
+	}
+	gGL.end();
+	sGlyphQuads += run.mGlyphs.size();
+}
+
+void LLFontGL::clearTextRuns() const
+{
+	mRunCache.clear();
+}
+
 
 S32 LLFontGL::getWidth(const std::string& utf8text) const
 {
@@ -1109,11 +1332,18 @@ void LLFontGL::renderQuad(const LLRectf& screen_rect, const LLRectf& uv_rect, F3
 }
 
 void LLFontGL::drawGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_strength) const
+{
+	gGL.begin(LLRender::QUADS);
+	emitGlyph(screen_rect, uv_rect, color, style, drop_shadow_strength);
+	gGL.end();
+	sGlyphQuads++;
+}
+
+void LLFontGL::emitGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_strength) const
 {
 	F32 slant_offset;
 	slant_offset = ((style & ITALIC) ? ( -mAscender * 0.2f) : 0.f);
 
-	gGL.begin(LLRender::QUADS);
 	{
 		//FIXME: bold and drop shadow are mutually exclusive only for convenience
 		//Allow both when we need them.
@@ -1179,7 +1409,6 @@ void LLFontGL::drawGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, con
 		}
 
 	}
-	gGL.end();
 }
 
 std::string LLFontGL::nameFromFont(const LLFontGL* fontp)
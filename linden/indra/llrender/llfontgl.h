@@ -221,6 +221,59 @@ protected:
 	void clearEmbeddedChars();
 	void renderQuad(const LLRectf& screen_rect, const LLRectf& uv_rect, F32 slant_amt) const;
 	void drawGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_fade) const;
+	// As drawGlyph(), inside an already open gGL.begin(LLRender::QUADS)
+	void emitGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_fade) const;
+
+	// Text run cache. A run is a string laid out once with a given style,
+	// alignment and clip width; its quads are stored relative to the whole
+	// pixel part of the pen position, so the same run can be drawn again
+	// anywhere with the same sub-pixel offset without touching the glyph
+	// tables or kerning. Runs with embedded characters are never cached.
+	struct run_glyph_t
+	{
+		LLRectf mScreenRect;
+		LLRectf mUVRect;
+		S32 mBitmapNum;
+	};
+
+	struct run_key_t
+	{
+		LLWString mText;	// the drawn characters plus the one after (kerning)
+		S32 mLength;
+		S32 mMaxPixels;
+		F32 mFracX;
+		F32 mFracY;
+		U8 mStyle;
+		U8 mHAlign;
+
+		bool operator<(const run_key_t& rhs) const;
+	};
+
+	struct text_run_t
+	{
+		std::vector<run_glyph_t> mGlyphs;
+		F32 mStartX;
+		F32 mEndX;
+		F32 mEndY;
+		S32 mCharsDrawn;
+		U32 mLastUsed;
+	};
+	typedef std::map<run_key_t, text_run_t> run_cache_t;
+
+	const text_run_t& getTextRun(const LLWString& wstr, S32 begin_offset, S32 length,
+								 U8 style, HAlign halign, S32 scaled_max_pixels,
+								 F32 frac_x, F32 frac_y) const;
+	void layoutTextRun(text_run_t& run, const LLWString& wstr, S32 begin_offset, S32 length,
+					   HAlign halign, S32 scaled_max_pixels, F32 frac_x, F32 frac_y) const;
+	void drawTextRun(const text_run_t& run, F32 base_x, F32 base_y,
+					 const LLColor4& color, U8 style, F32 drop_shadow_strength) const;
+	void clearTextRuns() const;
+
+	mutable run_cache_t mRunCache;
+	mutable U32 mRunCacheGeneration;
+	mutable U32 mRunCacheTick;
+	mutable F32 mRunCacheScaleX;
+	mutable F32 mRunCacheScaleY;
 
 public:
 	static F32 sVertDPI;
@@ -241,6 +294,11 @@ public:
 
 	static LLColor4 sShadowColor;
 
+	// Render statistics, reset by the caller
+	static U32 sRunCacheHits;
+	static U32 sRunCacheMisses;
+	static U32 sGlyphQuads;
+
 	friend class LLTextBillboard;
 	friend class LLHUDText;
 
@@ -75,7 +75,7 @@ inline BOOL LLKeywordToken::isTail(const llwchar* s) const
 	return res;
 }
 
-LLKeywords::LLKeywords() : mLoaded(FALSE)
+LLKeywords::LLKeywords() : mLoaded(FALSE), mWordTableDirty(FALSE)
 {
 }
 
@@ -237,10 +237,15 @@ void LLKeywords::addToken(LLKeywordToken::TOKEN_TYPE type,
 	LLWString key = utf8str_to_wstring(key_in);
 	LLWString tool_tip = utf8str_to_wstring(tool_tip_in);
 	LLWString delimiter = utf8str_to_wstring(delimiter_in);
+	// The rules changed, so the next update has to relex everything.
+	mLastText.clear();
+	mLastSegments.clear();
+
 	switch(type)
 	{
 	case LLKeywordToken::WORD:
 		mWordTokenMap[key] = new LLKeywordToken(type, color, key, tool_tip, delimiter);
+		mWordTableDirty = TRUE;
 		break;
 
 	case LLKeywordToken::LINE:
@@ -270,33 +275,240 @@ LLColor3 LLKeywords::readColor( const std::string& s )
 	return LLColor3( r, g, b );
 }
 
+static inline U32 hash_word(const llwchar* word, S32 len)
+{
+	// FNV-1a
+	U32 hash = 2166136261U;
+	for (S32 i = 0; i < len; i++)
+	{
+		hash = (hash ^ (U32)word[i]) * 16777619U;
+	}
+	return hash;
+}
+
+void LLKeywords::rebuildWordTable()
+{
+	// Open addressing, kept at most half full so probe runs stay short.
+	U32 size = 16;
+	while (size < 2 * mWordTokenMap.size())
+	{
+		size <<= 1;
+	}
+	mWordTable.assign(size, (LLKeywordToken*)NULL);
+
+	U32 mask = size - 1;
+	for (word_token_map_t::iterator iter = mWordTokenMap.begin();
+		 iter != mWordTokenMap.end(); ++iter)
+	{
+		const LLWString& word = iter->first;
+		U32 slot = hash_word(word.c_str(), word.size()) & mask;
+		while (mWordTable[slot])
+		{
+			slot = (slot + 1) & mask;
+		}
+		mWordTable[slot] = iter->second;
+	}
+	mWordTableDirty = FALSE;
+}
+
+LLKeywordToken* LLKeywords::findWord(const llwchar* word, S32 len) const
+{
+	if (mWordTable.empty())
+	{
+		return NULL;
+	}
+	U32 mask = mWordTable.size() - 1;
+	for (U32 slot = hash_word(word, len) & mask; ; slot = (slot + 1) & mask)
+	{
+		LLKeywordToken* token = mWordTable[slot];
+		if (!token)
+		{
+			return NULL;
+		}
+		if (token->getLength() == len && token->isHead(word))
+		{
+			return token;
+		}
+	}
+}
+
+// Index of the segment containing pos.
+static S32 segment_at(const std::vector<LLTextSegment*>& seg_list, S32 pos)
+{
+	LLTextSegment tseg(pos);
+	std::vector<LLTextSegment*>::const_iterator iter =
+		std::upper_bound(seg_list.begin(), seg_list.end(), &tseg, LLTextSegment::compare());
+	return (iter - seg_list.begin()) - 1;
+}
+
+// True if the lexer that produced seg_list started a fresh line at pos, i.e.
+// no token (a comment or string spanning lines) runs over the newline before it.
+static BOOL is_clean_line_start(const std::vector<LLTextSegment*>& seg_list, S32 pos)
+{
+	if (pos <= 0)
+	{
+		return TRUE;
+	}
+	return seg_list[segment_at(seg_list, pos - 1)]->getToken() == NULL;
+}
+
+static S32 line_start(const llwchar* base, S32 pos)
+{
+	while (pos > 0 && base[pos - 1] != '\n')
+	{
+		pos--;
+	}
+	return pos;
+}
+
 // Walk through a string, applying the rules specified by the keyword token list and
 // create a list of color segments.
 void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWString& wtext, const LLColor4 &defaultColor)
 {
 	std::for_each(seg_list->begin(), seg_list->end(), DeletePointer());
 	seg_list->clear();
+	mLastText.clear();
+	mLastSegments.clear();
 
 	if( wtext.empty() )
 	{
 		return;
 	}
 	
+	if (mWordTableDirty)
+	{
+		rebuildWordTable();
+	}
+
 	S32 text_len = wtext.size();
 
 	seg_list->push_back( new LLTextSegment( LLColor3(defaultColor), 0, text_len ) ); 
 
+	lexSegments(seg_list, wtext, 0, defaultColor, NULL, 0, 0);
+
+	mLastText = wtext;
+	mLastSegments = *seg_list;
+	mLastDefaultColor = defaultColor;
+}
+
+// Like findSegments(), but assumes seg_list still holds the segments built for
+// the previous text and only relexes the lines that changed. Lexing restarts
+// at the first damaged line and stops at the first line past the damage where
+// the old lexer was also at a clean line start; the old segments from there on
+// are shifted into place instead of being rebuilt.
+void LLKeywords::updateSegments(std::vector<LLTextSegment *>* seg_list, const LLWString& wtext, const LLColor4 &defaultColor)
+{
+	if (mLastText.empty() || wtext.empty() || defaultColor != mLastDefaultColor
+		|| *seg_list != mLastSegments)
+	{
+		// First pass, or someone else touched the segments.
+		findSegments(seg_list, wtext, defaultColor);
+		return;
+	}
+
+	const llwchar* base = wtext.c_str();
+	const llwchar* old_base = mLastText.c_str();
+	S32 text_len = wtext.size();
+	S32 old_len = mLastText.size();
+	S32 min_len = llmin(text_len, old_len);
+
+	// Damaged range is [prefix, text_len - suffix) in the new text.
+	S32 prefix = 0;
+	while (prefix < min_len && base[prefix] == old_base[prefix])
+	{
+		prefix++;
+	}
+	if (prefix == text_len && text_len == old_len)
+	{
+		// Nothing changed.
+		return;
+	}
+	S32 suffix = 0;
+	while (suffix < min_len - prefix
+		   && base[text_len - 1 - suffix] == old_base[old_len - 1 - suffix])
+	{
+		suffix++;
+	}
+	S32 delta = text_len - old_len;
+
+	if (mWordTableDirty)
+	{
+		rebuildWordTable();
+	}
+
+	std::vector<LLTextSegment*> old_segs;
+	old_segs.swap(mLastSegments);
+	S32 num_old = old_segs.size();
+
+	// Back up to a line the old lexer entered fresh, skipping over any
+	// comment or string that was still open at the start of the damaged line.
+	S32 restart = line_start(base, prefix);
+	while (!is_clean_line_start(old_segs, restart))
+	{
+		restart = line_start(base, old_segs[segment_at(old_segs, restart - 1)]->getStart());
+	}
+
+	// Keep every old segment that ends before the restart point.
+	S32 head = restart < old_len ? segment_at(old_segs, restart) : num_old;
+	seg_list->assign(old_segs.begin(), old_segs.begin() + head);
+	if (head > 0 && !seg_list->back()->getToken())
+	{
+		// Relex into the default segment in front of the restart point.
+		seg_list->back()->setEnd(text_len);
+	}
+	else
+	{
+		S32 fill_start = head > 0 ? seg_list->back()->getEnd() : 0;
+		seg_list->push_back( new LLTextSegment( defaultColor, fill_start, text_len ) );
+	}
+
+	S32 stop = lexSegments(seg_list, wtext, restart, defaultColor, &old_segs, text_len - suffix, delta);
+
+	// Old segments from the convergence point on are still valid.
+	S32 tail = segment_at(old_segs, stop - delta - 1) + 1;
+	seg_list->back()->setEnd(tail < num_old ? old_segs[tail]->getStart() + delta : text_len);
+	for (S32 i = tail; i < num_old; i++)
+	{
+		LLTextSegment* seg = old_segs[i];
+		seg->setStart(seg->getStart() + delta);
+		seg->setEnd(seg->getEnd() + delta);
+		seg_list->push_back(seg);
+	}
+	for (S32 i = head; i < tail; i++)
+	{
+		delete old_segs[i];
+	}
+
+	mLastText = wtext;
+	mLastSegments = *seg_list;
+}
+
+// Lexes wtext from the line starting at start, adding segments to seg_list.
+// If old_segs is set, stops at the first line start past damage_end that was
+// also a clean line start in old_segs (delta characters earlier) and returns
+// its position; otherwise lexes to the end and returns the text length.
+S32 LLKeywords::lexSegments(std::vector<LLTextSegment *>* seg_list, const LLWString& wtext, S32 start, const LLColor4 &defaultColor,
+							const std::vector<LLTextSegment *>* old_segs, S32 damage_end, S32 delta)
+{
+	S32 text_len = wtext.size();
+
 	const llwchar* base = wtext.c_str();
-	const llwchar* cur = base;
+	const llwchar* first = base + start;
+	const llwchar* cur = first;
 	const llwchar* line = NULL;
 
 	while( *cur )
 	{
-		if( *cur == '\n' || cur == base )
+		if( *cur == '\n' || cur == first )
 		{
 			if( *cur == '\n' )
 			{
 				cur++;
+				S32 pos = cur - base;
+				if( old_segs && pos > damage_end && is_clean_line_start(*old_segs, pos - delta) )
+				{
+					return pos;
+				}
 				if( !*cur || *cur == '\n' )
 				{
 					continue;
@@ -501,11 +713,9 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 				S32 seg_len = p - cur;
 				if( seg_len > 0 )
 				{
-					LLWString word( cur, 0, seg_len );
-					word_token_map_t::iterator map_iter = mWordTokenMap.find(word);
-					if( map_iter != mWordTokenMap.end() )
+					LLKeywordToken* cur_token = findWord( cur, seg_len );
+					if( cur_token )
 					{
-						LLKeywordToken* cur_token = map_iter->second;
 						S32 seg_start = cur - base;
 						S32 seg_end = seg_start + seg_len;
 
@@ -527,6 +737,7 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 			}
 		}
 	}
+	return text_len;
 }
 
 void LLKeywords::insertSegment(std::vector<LLTextSegment*>* seg_list, LLTextSegment* new_segment, S32 text_len, const LLColor4 &defaultColor )
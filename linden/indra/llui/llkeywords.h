@@ -36,9 +36,11 @@
 
 #include "llstring.h"
 #include "v3color.h"
+#include "v4color.h"
 #include <map>
 #include <list>
 #include <deque>
+#include <vector>
 
 class LLTextSegment;
 
@@ -90,6 +92,9 @@ public:
 	BOOL		isLoaded() const	{ return mLoaded; }
 
 	void		findSegments(std::vector<LLTextSegment *> *seg_list, const LLWString& text, const LLColor4 &defaultColor );
+	// Incremental version of findSegments() for a seg_list it built earlier;
+	// only the lines around the edit are relexed.
+	void		updateSegments(std::vector<LLTextSegment *> *seg_list, const LLWString& text, const LLColor4 &defaultColor );
 
 	// Add the token as described
 	void addToken(LLKeywordToken::TOKEN_TYPE type,
@@ -110,12 +115,25 @@ public:
 private:
 	LLColor3	readColor(const std::string& s);
 	void		insertSegment(std::vector<LLTextSegment *> *seg_list, LLTextSegment* new_segment, S32 text_len, const LLColor4 &defaultColor);
+	S32			lexSegments(std::vector<LLTextSegment *> *seg_list, const LLWString& text, S32 start, const LLColor4 &defaultColor,
+							const std::vector<LLTextSegment *> *old_segs, S32 damage_end, S32 delta);
+	void		rebuildWordTable();
+	LLKeywordToken* findWord(const llwchar* word, S32 len) const;
 
 	BOOL		mLoaded;
 	word_token_map_t mWordTokenMap;
 	typedef std::deque<LLKeywordToken*> token_list_t;
 	token_list_t mLineTokenList;
 	token_list_t mDelimiterTokenList;
+
+	// Hash table over mWordTokenMap so words can be looked up in place
+	std::vector<LLKeywordToken*> mWordTable;
+	BOOL		mWordTableDirty;
+
+	// Text and segments from the last pass, for updateSegments()
+	LLWString	mLastText;
+	std::vector<LLTextSegment *> mLastSegments;
+	LLColor4	mLastDefaultColor;
 };
 
 #endif  // LL_LLKEYWORDS_H
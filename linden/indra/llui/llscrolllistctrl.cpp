@@ -96,6 +96,46 @@ struct SortScrollListItem
 	const sort_order_t& mSortOrders;
 };
 
+// Same ordering as SortScrollListItem, but over row indices into a table of
+// sort keys pulled out of the cells once, instead of converting both cell
+// values to strings on every comparison.
+struct SortScrollListKeys
+{
+	typedef std::vector<std::pair<S32, BOOL> > sort_order_t;
+
+	SortScrollListKeys(const std::vector<std::string>& keys, const std::vector<U8>& has_key, const sort_order_t& sort_orders)
+	:	mKeys(keys),
+		mHasKey(has_key),
+		mSortOrders(sort_orders)
+	{}
+
+	bool operator()(S32 row1, S32 row2) const
+	{
+		S32 num_orders = mSortOrders.size();
+		S32 sort_result = 0;
+		for (S32 i = num_orders - 1; i >= 0; --i)
+		{
+			S32 key1 = row1 * num_orders + i;
+			S32 key2 = row2 * num_orders + i;
+			if (mHasKey[key1] && mHasKey[key2])
+			{
+				S32 order = mSortOrders[i].second ? 1 : -1;
+				sort_result = order * LLStringUtil::compareDict(mKeys[key1], mKeys[key2]);
+				if (sort_result != 0)
+				{
+					break;
+				}
+			}
+		}
+
+		return sort_result < 0;
+	}
+
+	const std::vector<std::string>& mKeys;
+	const std::vector<U8>& mHasKey;
+	const sort_order_t& mSortOrders;
+};
+
 
 //
 // LLScrollListIcon
@@ -599,6 +639,9 @@ LLScrollListCtrl::LLScrollListCtrl(const std::string& name, const LLRect& rect,
 	mSorted(TRUE),
 	mDirty(FALSE),
 	mOriginalSelection(-1),
+	mNumSortedItems(0),
+	mFirstColumnSorted(TRUE),
+	mContentWidthsDirty(TRUE),
 	mDrewSelected(FALSE)
 {
 	mItemListRect.setOriginAndSize(
@@ -709,6 +752,9 @@ void LLScrollListCtrl::clearRows()
 
 	mScrollLines = 0;
 	mLastSelected = NULL;
+	mNumSortedItems = 0;
+	mFirstColumnSorted = TRUE;
+	mContentWidthsDirty = TRUE;
 	updateLayout();
 	mDirty = FALSE; 
 }
@@ -852,7 +898,7 @@ void LLScrollListCtrl::updateLayout()
 	mScrollbar->setDocSize( getItemCount() );
 	mScrollbar->setVisible(scrollbar_visible);
 
-	dirtyColumns();
+	dirtyColumnLayout();
 }
 
 // Attempt to size the control to show all items.
@@ -888,6 +934,7 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 		case ADD_TOP:
 			mItemList.push_front(item);
 			setSorted(FALSE);
+			mFirstColumnSorted = FALSE;
 			break;
 	
 		case ADD_SORTED:
@@ -896,26 +943,38 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 				std::vector<sort_column_t> single_sort_column;
 				single_sort_column.push_back(std::make_pair(0, TRUE));
 
-				mItemList.push_back(item);
-				std::stable_sort(
-					mItemList.begin(), 
-					mItemList.end(), 
-					SortScrollListItem(single_sort_column));
+				if (mFirstColumnSorted)
+				{
+					// same place a stable sort would put it: after any equal items
+					mItemList.insert(
+						std::upper_bound(mItemList.begin(), mItemList.end(), item, SortScrollListItem(single_sort_column)),
+						item);
+				}
+				else
+				{
+					mItemList.push_back(item);
+					sortItemList(single_sort_column, 0);
+					mFirstColumnSorted = TRUE;
+				}
 				
 				// ADD_SORTED just sorts by first column...
 				// this might not match user sort criteria, so flag list as being in unsorted state
 				setSorted(FALSE);
+				mFirstColumnSorted = TRUE;
 				break;
 			}	
 		case ADD_BOTTOM:
 			mItemList.push_back(item);
-			setSorted(FALSE);
+			// rows already in order stay that way, so the next sort only has to merge this one in
+			mSorted = FALSE;
+			mFirstColumnSorted = FALSE;
 			break;
 	
 		default:
 			llassert(0);
 			mItemList.push_back(item);
 			setSorted(FALSE);
+			mFirstColumnSorted = FALSE;
 			break;
 		}
 	
@@ -930,6 +989,7 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 		}
 
 		updateLineHeightInsert(item);
+		updateContentWidthsInsert(item);
 
 		updateLayout();
 	}
@@ -940,11 +1000,11 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 // NOTE: This is *very* expensive for large lists, especially when we are dirtying the list every frame
 //  while receiving a long list of names.
 // *TODO: Use bookkeeping to make this an incramental cost with item additions
+const S32 HEADING_TEXT_PADDING = 25;
+const S32 COLUMN_TEXT_PADDING = 10;
+
 void LLScrollListCtrl::calcColumnWidths()
 {
-	const S32 HEADING_TEXT_PADDING = 25;
-	const S32 COLUMN_TEXT_PADDING = 10;
-
 	mMaxContentWidth = 0;
 
 	S32 max_item_width = 0;
@@ -969,20 +1029,47 @@ void LLScrollListCtrl::calcColumnWidths()
 		column->setWidth(new_width);
 
 		// update max content width for this column, by looking at all items
-		column->mMaxContentWidth = column->mHeader ? LLFontGL::getFontSansSerifSmall()->getWidth(column->mLabel) + mColumnPadding + HEADING_TEXT_PADDING : 0;
-		item_list::iterator iter;
-		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+		// (added items are folded in as they arrive by updateContentWidthsInsert())
+		if (mContentWidthsDirty)
 		{
-			LLScrollListCell* cellp = (*iter)->getColumn(column->mIndex);
-			if (!cellp) continue;
+			column->mMaxContentWidth = column->mHeader ? LLFontGL::getFontSansSerifSmall()->getWidth(column->mLabel) + mColumnPadding + HEADING_TEXT_PADDING : 0;
+			item_list::iterator iter;
+			for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+			{
+				LLScrollListCell* cellp = (*iter)->getColumn(column->mIndex);
+				if (!cellp) continue;
 
-			column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(cellp->getValue().asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+				column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(cellp->getValue().asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+			}
 		}
 
 		max_item_width += column->mMaxContentWidth;
 	}
 
 	mMaxContentWidth = max_item_width;
+	mContentWidthsDirty = FALSE;
+}
+
+// when the only change to content widths is from an insert, we needn't scan the entire list
+void LLScrollListCtrl::updateContentWidthsInsert(LLScrollListItem* itemp)
+{
+	if (mContentWidthsDirty)
+	{
+		// a full rescan is pending anyway
+		return;
+	}
+
+	ordered_columns_t::iterator column_itor;
+	for (column_itor = mColumnsIndexed.begin(); column_itor != mColumnsIndexed.end(); ++column_itor)
+	{
+		LLScrollListColumn* column = *column_itor;
+		if (!column) continue;
+
+		LLScrollListCell* cellp = itemp->getColumn(column->mIndex);
+		if (!cellp) continue;
+
+		column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(cellp->getValue().asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+	}
 }
 
 const S32 SCROLL_LIST_ROW_PAD = 2;
@@ -1199,6 +1286,8 @@ void LLScrollListCtrl::swapWithNext(S32 index)
 		// At end of list, doesn't do anything
 		return;
 	}
+	mNumSortedItems = 0;
+	mFirstColumnSorted = FALSE;
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index + 1];
 	mItemList[index + 1] = cur_itemp;
@@ -1211,6 +1300,8 @@ void LLScrollListCtrl::swapWithPrevious(S32 index)
 	{
 		// At beginning of list, don't do anything
 	}
+	mNumSortedItems = 0;
+	mFirstColumnSorted = FALSE;
 
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index - 1];
@@ -1728,17 +1819,18 @@ void LLScrollListCtrl::drawItems()
 		
 		mDrewSelected = FALSE;
 
-		S32 line = 0;
 		S32 max_columns = 0;
 
 		LLColor4 highlight_color = LLColor4::white;
 		F32 type_ahead_timeout = LLUI::sConfigGroup->getF32("TypeAheadTimeout");
 		highlight_color.mV[VALPHA] = clamp_rescale(mSearchTimer.getElapsedTimeF32(), type_ahead_timeout * 0.7f, type_ahead_timeout, 0.4f, 0.f);
 
-		item_list::iterator iter;
-		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+		// only visit the rows that are on screen
+		S32 first_line = llmax(mScrollLines, 0);
+		S32 last_line = llmin(mScrollLines + num_page_lines, (S32)mItemList.size());
+		for (S32 line = first_line; line < last_line; line++)
 		{
-			LLScrollListItem* item = *iter;
+			LLScrollListItem* item = mItemList[line];
 			
 			item_rect.setOriginAndSize( 
 				x, 
@@ -1758,36 +1850,32 @@ void LLScrollListCtrl::drawItems()
 			LLColor4 fg_color;
 			LLColor4 bg_color(LLColor4::transparent);
 
-			if( mScrollLines <= line && line < mScrollLines + num_page_lines )
+			fg_color = (item->getEnabled() ? mFgUnselectedColor : mFgDisabledColor);
+			if( item->getSelected() && mCanSelect)
 			{
-				fg_color = (item->getEnabled() ? mFgUnselectedColor : mFgDisabledColor);
-				if( item->getSelected() && mCanSelect)
-				{
-					bg_color = mBgSelectedColor;
-					fg_color = (item->getEnabled() ? mFgSelectedColor : mFgDisabledColor);
-				}
-				else if (mHighlightedItem == line && mCanSelect)
-				{
-					bg_color = mHighlightedColor;
-				}
-				else 
+				bg_color = mBgSelectedColor;
+				fg_color = (item->getEnabled() ? mFgSelectedColor : mFgDisabledColor);
+			}
+			else if (mHighlightedItem == line && mCanSelect)
+			{
+				bg_color = mHighlightedColor;
+			}
+			else 
+			{
+				if (mDrawStripes && (line % 2 == 0) && (max_columns > 1))
 				{
-					if (mDrawStripes && (line % 2 == 0) && (max_columns > 1))
-					{
-						bg_color = mBgStripeColor;
-					}
+					bg_color = mBgStripeColor;
 				}
+			}
 
-				if (!item->getEnabled())
-				{
-					bg_color = mBgReadOnlyColor;
-				}
+			if (!item->getEnabled())
+			{
+				bg_color = mBgReadOnlyColor;
+			}
 
-				item->draw(item_rect, fg_color, bg_color, highlight_color, mColumnPadding);
+			item->draw(item_rect, fg_color, bg_color, highlight_color, mColumnPadding);
 
-				cur_y -= mLineHeight;
-			}
-			line++;
+			cur_y -= mLineHeight;
 		}
 	}
 }
@@ -1800,7 +1888,7 @@ void LLScrollListCtrl::draw()
 	// if user specifies sort, make sure it is maintained
 	if (needsSorting() && !isSorted())
 	{
-		sortItems();
+		sortAppendedItems();
 	}
 
 	if (mNeedsScroll)
@@ -2564,6 +2652,9 @@ BOOL LLScrollListCtrl::setSort(S32 column_idx, BOOL ascending)
 
 	sort_column_t new_sort_column(column_idx, ascending);
 
+	// whatever order the items were in no longer counts
+	mNumSortedItems = 0;
+
 	if (mSortColumns.empty())
 	{
 		mSortColumns.push_back(new_sort_column);
@@ -2613,13 +2704,20 @@ void  LLScrollListCtrl::sortByColumnIndex(U32 column, BOOL ascending)
 
 void LLScrollListCtrl::sortItems()
 {
-	// do stable sort to preserve any previous sorts
-	std::stable_sort(
-		mItemList.begin(), 
-		mItemList.end(), 
-		SortScrollListItem(mSortColumns));
+	// callers may have edited cells in place, so sort everything
+	sortItemList(mSortColumns, 0);
 
 	setSorted(TRUE);
+	mFirstColumnSorted = FALSE;
+}
+
+void LLScrollListCtrl::sortAppendedItems()
+{
+	// rows appended since the last sort just get merged in
+	sortItemList(mSortColumns, mNumSortedItems);
+
+	setSorted(TRUE);
+	mFirstColumnSorted = FALSE;
 }
 
 // for one-shot sorts, does not save sort column/order
@@ -2628,14 +2726,90 @@ void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 	std::vector<std::pair<S32, BOOL> > sort_column;
 	sort_column.push_back(std::make_pair(column, ascending));
 
-	// do stable sort to preserve any previous sorts
-	std::stable_sort(
-		mItemList.begin(), 
-		mItemList.end(), 
-		SortScrollListItem(sort_column));
+	sortItemList(sort_column, 0);
+	mNumSortedItems = 0;
+	mFirstColumnSorted = FALSE;
+}
+
+// Stable sort of mItemList, done on a permutation of row indices so each
+// cell value is converted to a sort key once rather than once per comparison.
+// The first num_sorted items must already be in order; the rest are sorted
+// and then merged in, which gives the same result as sorting everything.
+void LLScrollListCtrl::sortItemList(const std::vector<sort_column_t>& sort_orders, S32 num_sorted)
+{
+	S32 num_items = mItemList.size();
+	S32 num_orders = sort_orders.size();
+	num_sorted = llclamp(num_sorted, 0, num_items);
+	if (num_items - num_sorted < 1 || num_orders == 0)
+	{
+		return;
+	}
+
+	std::vector<std::string> keys(num_items * num_orders);
+	std::vector<U8> has_key(num_items * num_orders, FALSE);
+	for (S32 row = 0; row < num_items; row++)
+	{
+		for (S32 i = 0; i < num_orders; i++)
+		{
+			const LLScrollListCell* cellp = mItemList[row]->getColumn(sort_orders[i].first);
+			if (cellp)
+			{
+				keys[row * num_orders + i] = cellp->getValue().asString();
+				has_key[row * num_orders + i] = TRUE;
+			}
+		}
+	}
+
+	std::vector<S32> order(num_items);
+	for (S32 row = 0; row < num_items; row++)
+	{
+		order[row] = row;
+	}
+
+	SortScrollListKeys compare(keys, has_key, sort_orders);
+	std::stable_sort(order.begin() + num_sorted, order.end(), compare);
+	if (num_sorted > 0)
+	{
+		std::inplace_merge(order.begin(), order.begin() + num_sorted, order.end(), compare);
+	}
+
+	item_list sorted_list;
+	for (S32 row = 0; row < num_items; row++)
+	{
+		sorted_list.push_back(mItemList[order[row]]);
+	}
+	mItemList.swap(sorted_list);
 }
 
 void LLScrollListCtrl::dirtyColumns() 
+{ 
+	// cell contents may have changed, so widths and order need a full pass
+	mContentWidthsDirty = TRUE;
+	mNumSortedItems = 0;
+	mFirstColumnSorted = FALSE;
+
+	dirtyColumnLayout();
+}
+
+void LLScrollListCtrl::dirtyItem(LLScrollListItem* itemp)
+{
+	// usually the row that was just appended, outside the sorted prefix
+	if (mItemList.empty() || mItemList.back() != itemp)
+	{
+		mNumSortedItems = 0;
+	}
+	else
+	{
+		mNumSortedItems = llmin(mNumSortedItems, (S32)mItemList.size() - 1);
+	}
+	mSorted = FALSE;
+	mFirstColumnSorted = FALSE;
+
+	updateContentWidthsInsert(itemp);
+	dirtyColumnLayout();
+}
+
+void LLScrollListCtrl::dirtyColumnLayout() 
 { 
 	mColumnsDirty = TRUE; 
 
@@ -3212,6 +3386,8 @@ void LLScrollListCtrl::clearColumns()
 	}
 	mColumns.clear();
 	mSortColumns.clear();
+	mNumSortedItems = 0;
+	mContentWidthsDirty = TRUE;
 	mTotalStaticColumnWidth = 0;
 	mTotalColumnPadding = 0;
 }
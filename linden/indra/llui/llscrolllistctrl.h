@@ -568,8 +568,18 @@ public:
 	void			sortOnce(S32 column, BOOL ascending);
 
 	// manually call this whenever editing list items in place to flag need for resorting
-	void			setSorted(BOOL sorted) { mSorted = sorted; }
+	void			setSorted(BOOL sorted)
+	{
+		mSorted = sorted;
+		mNumSortedItems = sorted ? (S32)mItemList.size() : 0;
+		if (!sorted)
+		{
+			// edited cells may be out of column 0 order too
+			mFirstColumnSorted = FALSE;
+		}
+	}
 	void			dirtyColumns(); // some operation has potentially affected column layout or ordering
+	void			dirtyItem(LLScrollListItem* itemp); // cells of a single item changed; cheaper than dirtyColumns()
 
 protected:
 	// "Full" interface: use this when you're creating a list that has one or more of the following:
@@ -598,6 +608,8 @@ private:
 	void			drawItems();
 	void			updateLineHeight();
 	void            updateLineHeightInsert(LLScrollListItem* item);
+	void			updateContentWidthsInsert(LLScrollListItem* item);
+	void			dirtyColumnLayout();
 	void			reportInvalidInput();
 	BOOL			isRepeatedChars(const LLWString& string) const;
 	void			selectItem(LLScrollListItem* itemp, BOOL single_select = TRUE);
@@ -676,6 +688,15 @@ private:
 
 	typedef std::pair<S32, BOOL> sort_column_t;
 	std::vector<sort_column_t>	mSortColumns;
+	void			sortItemList(const std::vector<sort_column_t>& sort_orders, S32 num_sorted);
+	// like sortItems(), but trusts the first mNumSortedItems rows to be in order
+	void			sortAppendedItems();
+
+	// Bookkeeping so that appending rows to a long list costs O(rows added)
+	// instead of a full resort and a full rescan of cell widths.
+	S32				mNumSortedItems;		// leading items already in mSortColumns order
+	BOOL			mFirstColumnSorted;		// items are in ascending column 0 order, as ADD_SORTED leaves them
+	BOOL			mContentWidthsDirty;	// column mMaxContentWidth needs a full rescan
 
 	// HACK:  Did we draw one selected item this frame?
 	BOOL mDrewSelected;
@@ -290,6 +290,10 @@ LLTextEditor::LLTextEditor(
 	mLastSelectionX(-1),
 	mLastSelectionY(-1),
 	mReflowNeeded(FALSE),
+	mReflowDirtyStart(S32_MAX),
+	mReflowDirtyEnd(0),
+	mReflowDelta(0),
+	mReflowFull(FALSE),
 	mScrollNeeded(FALSE)
 {
 	mSourceID.generate();
@@ -392,20 +396,72 @@ void LLTextEditor::updateLineStartList(S32 startpos)
 	S32 seg_idx = 0;
 	S32 seg_offset = 0;
 
+	// Lines starting after the edited text keep their breaks; keep them
+	// around in case wrapping falls back in step with one of them.
+	BOOL can_resync = !mReflowFull && mReflowDirtyStart != S32_MAX && startpos <= mReflowDirtyStart;
+	line_list_t old_lines;
+
 	if (!mLineStartList.empty())
 	{
-		getSegmentAndOffset(startpos, &seg_idx, &seg_offset);
-		line_info t(seg_idx, seg_offset);
-		line_list_t::iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), t, line_info_compare());
-		if (iter != mLineStartList.begin()) --iter;
-		seg_idx = iter->mSegment;
-		seg_offset = iter->mOffset;
+		// Find the last line starting at or before startpos. Line starts
+		// before it are unaffected, so search by position; segments may
+		// have been rebuilt since the last reflow.
+		line_list_t::iterator iter = mLineStartList.begin();
+		line_list_t::iterator lo = iter + 1;
+		line_list_t::iterator hi = mLineStartList.end();
+		while (lo < hi)
+		{
+			line_list_t::iterator mid = lo + (hi - lo) / 2;
+			if (mid->mPos <= startpos)
+			{
+				iter = mid;
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		if (mWordWrap && iter != mLineStartList.begin())
+		{
+			// An edit at the start of a line can pull words back up
+			--iter;
+		}
+		getSegmentAndOffset(iter->mPos, &seg_idx, &seg_offset);
+		if (can_resync)
+		{
+			old_lines.assign(iter + 1, mLineStartList.end());
+		}
 		mLineStartList.erase(iter, mLineStartList.end());
 	}
+
+	line_list_t::const_iterator old_iter = old_lines.begin();
 	
 	while( seg_idx < seg_num )
 	{
-		mLineStartList.push_back(line_info(seg_idx,seg_offset));
+		S32 line_pos = mSegments[seg_idx]->getStart() + seg_offset;
+		if (line_pos >= mReflowDirtyEnd && old_iter != old_lines.end())
+		{
+			// Unchanged text from here on: if the old layout also started a
+			// line here, every following break is still right, just moved.
+			S32 old_pos = line_pos - mReflowDelta;
+			while (old_iter != old_lines.end() && old_iter->mPos < old_pos)
+			{
+				++old_iter;
+			}
+			if (old_iter != old_lines.end() && old_iter->mPos == old_pos)
+			{
+				for ( ; old_iter != old_lines.end(); ++old_iter)
+				{
+					S32 pos = old_iter->mPos + mReflowDelta;
+					getSegmentAndOffset(pos, &seg_idx, &seg_offset);
+					mLineStartList.push_back(line_info(seg_idx, seg_offset, pos));
+				}
+				break;
+			}
+		}
+
+		mLineStartList.push_back(line_info(seg_idx,seg_offset,line_pos));
 		BOOL line_ended = FALSE;
 		S32 start_x = mShowLineNumbers ? UI_TEXTEDITOR_LINE_NUMBER_MARGIN : 0;
 		S32 line_width = start_x;
@@ -466,6 +522,11 @@ void LLTextEditor::updateLineStartList(S32 startpos)
 	
 	unbindEmbeddedChars(mGLFont);
 
+	mReflowDirtyStart = S32_MAX;
+	mReflowDirtyEnd = 0;
+	mReflowDelta = 0;
+	mReflowFull = FALSE;
+
 	mScrollbar->setDocSize( getLineCount() );
 
 	if (mHideScrollbarForShortDocs)
@@ -483,6 +544,33 @@ void LLTextEditor::updateLineStartList(S32 startpos)
 	}
 }
 
+void LLTextEditor::noteTextChange(S32 pos, S32 removed, S32 inserted)
+{
+	if (mReflowDirtyStart == S32_MAX)
+	{
+		mReflowDirtyStart = pos;
+		mReflowDirtyEnd = pos + inserted;
+		mReflowDelta = inserted - removed;
+		return;
+	}
+
+	// Carry the end of the dirty range along with the text after it
+	S32 dirty_end = mReflowDirtyEnd;
+	if (dirty_end >= pos + removed)
+	{
+		dirty_end += inserted - removed;
+	}
+	else if (dirty_end > pos)
+	{
+		// It was inside the removed text
+		dirty_end = pos;
+	}
+
+	mReflowDirtyStart = llmin(mReflowDirtyStart, pos);
+	mReflowDirtyEnd = llmax(dirty_end, pos + inserted);
+	mReflowDelta += inserted - removed;
+}
+
 ////////////////////////////////////////////////////////////
 // LLTextEditor
 // Public methods
@@ -524,7 +612,7 @@ void LLTextEditor::setText(const LLStringExplicit &utf8str)
 	setCursorPos(0);
 	deselect();
 
-	needsReflow();
+	needsFullReflow();
 
 	resetDirty();
 }
@@ -541,7 +629,7 @@ void LLTextEditor::setWText(const LLWString &wtext)
 	setCursorPos(0);
 	deselect();
 
-	needsReflow();
+	needsFullReflow();
 
 	resetDirty();
 }
@@ -579,7 +667,7 @@ void LLTextEditor::setWordWrap(BOOL b)
 	setCursorPos(0);
 	deselect();
 	
-	needsReflow();
+	needsFullReflow();
 }
 
 
@@ -3201,7 +3289,9 @@ void LLTextEditor::draw()
 	// do on-demand reflow 
 	if (mReflowNeeded)
 	{
-		updateLineStartList();
+		// Only re-wrap from the first edited line unless layout changed
+		BOOL full = mReflowFull || mReflowDirtyStart == S32_MAX;
+		updateLineStartList(full ? 0 : llmin(mReflowDirtyStart, getLength()));
 		mReflowNeeded = FALSE;
 	}
 
@@ -3557,7 +3647,7 @@ void LLTextEditor::reshape(S32 width, S32 height, BOOL called_from_parent)
 	// up-to-date mTextRect
 	updateTextRect();
 	
-	needsReflow();
+	needsFullReflow();
 
 	// propagate shape information to scrollbar
 	mScrollbar->setDocSize( getLineCount() );
@@ -3830,12 +3920,15 @@ S32 LLTextEditor::insertStringNoUndo(const S32 pos, const LLWString &wstr)
 
 	mWText.insert(pos, wstr);
 	mTextIsUpToDate = FALSE;
+	noteTextChange(pos, 0, insert_len);
 
 	if ( truncate() )
 	{
 		// The user's not getting everything he's hoping for
 		make_ui_sound("UISndBadKeystroke");
 		insert_len = mWText.length() - old_len;
+		// truncate() cut the end off
+		noteTextChange(mWText.length(), old_len + (S32)wstr.length() - (S32)mWText.length(), 0);
 	}
 
 	return insert_len;
@@ -3845,6 +3938,7 @@ S32 LLTextEditor::removeStringNoUndo(S32 pos, S32 length)
 {
 	mWText.erase(pos, length);
 	mTextIsUpToDate = FALSE;
+	noteTextChange(pos, length, 0);
 	return -length;	// This will be wrong if someone calls removeStringNoUndo with an excessive length
 }
 
@@ -3856,6 +3950,7 @@ S32 LLTextEditor::overwriteCharNoUndo(S32 pos, llwchar wc)
 	}
 	mWText[pos] = wc;
 	mTextIsUpToDate = FALSE;
+	noteTextChange(pos, 1, 1);
 	return 1;
 }
 
@@ -3957,7 +4052,7 @@ void LLTextEditor::updateSegments()
 	if (mKeywords.isLoaded())
 	{
 		// HACK:  No non-ascii keywords for now
-		mKeywords.findSegments(&mSegments, mWText, mDefaultColor);
+		mKeywords.updateSegments(&mSegments, mWText, mDefaultColor);
 	}
 	else if (mAllowEmbeddedItems)
 	{
@@ -4223,7 +4318,7 @@ BOOL LLTextEditor::importBuffer(const char* buffer, S32 length )
 	setCursorPos(0);
 	deselect();
 
-	needsReflow();
+	needsFullReflow();
 	return success;
 }
 
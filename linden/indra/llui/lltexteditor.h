@@ -275,6 +275,7 @@ protected:
 	void			drawPreeditMarker();
 
 	void			updateLineStartList(S32 startpos = 0);
+	void			noteTextChange(S32 pos, S32 removed, S32 inserted);
 	void			updateScrollFromCursor();
 	void			updateTextRect();
 	const LLRect&	getTextRect() const { return mTextRect; }
@@ -456,6 +457,12 @@ private:
 		// cursor might have moved, need to scroll
 		mScrollNeeded = TRUE;
 	}
+	// Layout parameters changed, so no existing line break can be reused
+	void			needsFullReflow()
+	{
+		mReflowFull = TRUE;
+		needsReflow();
+	}
 	void			needsScroll() { mScrollNeeded = TRUE; }
 
 	//
@@ -496,9 +503,10 @@ private:
 	// List of offsets and segment index of the start of each line.  Always has at least one node (0).
 	struct line_info
 	{
-		line_info(S32 segment, S32 offset) : mSegment(segment), mOffset(offset) {}
+		line_info(S32 segment, S32 offset, S32 pos = 0) : mSegment(segment), mOffset(offset), mPos(pos) {}
 		S32 mSegment;
 		S32 mOffset;
+		S32 mPos;		// character position, as of the last reflow
 	};
 	struct line_info_compare
 	{
@@ -515,6 +523,14 @@ private:
 	typedef std::vector<line_info> line_list_t;
 	line_list_t mLineStartList;
 	BOOL			mReflowNeeded;
+	// Text touched since the last reflow: [mReflowDirtyStart, mReflowDirtyEnd)
+	// in current positions (start is S32_MAX if nothing was recorded). Text
+	// after it is unchanged but has moved by mReflowDelta characters, so once
+	// wrapping reaches an old line start again the remaining lines are reused.
+	S32				mReflowDirtyStart;
+	S32				mReflowDirtyEnd;
+	S32				mReflowDelta;
+	BOOL			mReflowFull;
 	BOOL			mScrollNeeded;
 
 	LLFrameTimer	mKeystrokeTimer;
@@ -565,6 +581,7 @@ public:
 
 	S32					getStart() const					{ return mStart; }
 	S32					getEnd() const						{ return mEnd; }
+	void				setStart( S32 start )				{ mStart = start; }
 	void				setEnd( S32 end )					{ mEnd = end; }
 	const LLColor4&		getColor() const					{ return mStyle->getColor(); }
 	void 				setColor(const LLColor4 &color)		{ mStyle->setColor(color); }
@@ -79,27 +79,39 @@ const char* gErrorText[LSERROR_EOF] = 	/*Flawfinder: ignore*/
 	"Bytecode verification failed"
 };
 
+void LLScriptGenerateErrorText::write(LLFILE *fp, S32 line, S32 col, const char* kind, const char* text)
+{
+	if (mLog)
+	{
+		mLog->append(llformat("(%d, %d) : %s : %s\n", line, col, kind, text));
+	}
+	else
+	{
+		fprintf(fp, "(%d, %d) : %s : %s\n", line, col, kind, text);
+	}
+}
+
 void LLScriptGenerateErrorText::writeWarning(LLFILE *fp, LLScriptFilePosition *pos, LSCRIPTWarnings warning)
 {
-	fprintf(fp, "(%d, %d) : WARNING : %s\n", pos->mLineNumber, pos->mColumnNumber, gWarningText[warning]);
+	write(fp, pos->mLineNumber, pos->mColumnNumber, "WARNING", gWarningText[warning]);
 	mTotalWarnings++;
 }
 
 void LLScriptGenerateErrorText::writeWarning(LLFILE *fp, S32 line, S32 col, LSCRIPTWarnings warning)
 {
-	fprintf(fp, "(%d, %d) : WARNING : %s\n", line, col, gWarningText[warning]);
+	write(fp, line, col, "WARNING", gWarningText[warning]);
 	mTotalWarnings++;
 }
 
 void LLScriptGenerateErrorText::writeError(LLFILE *fp, LLScriptFilePosition *pos, LSCRIPTErrors error)
 {
-	fprintf(fp, "(%d, %d) : ERROR : %s\n", pos->mLineNumber, pos->mColumnNumber, gErrorText[error]);
+	write(fp, pos->mLineNumber, pos->mColumnNumber, "ERROR", gErrorText[error]);
 	mTotalErrors++;
 }
 
 void LLScriptGenerateErrorText::writeError(LLFILE *fp, S32 line, S32 col, LSCRIPTErrors error)
 {
-	fprintf(fp, "(%d, %d) : ERROR : %s\n", line, col, gErrorText[error]);
+	write(fp, line, col, "ERROR", gErrorText[error]);
 	mTotalErrors++;
 }
 
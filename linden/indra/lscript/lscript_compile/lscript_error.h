@@ -134,11 +134,15 @@ typedef enum e_lscript_errors
 class LLScriptGenerateErrorText
 {
 public:
-	LLScriptGenerateErrorText() { init(); }
+	LLScriptGenerateErrorText() : mLog(NULL) { init(); }
 	~LLScriptGenerateErrorText() {}
 
 	void init() { mTotalErrors = 0; mTotalWarnings = 0; }
 
+	// When set, errors and warnings are appended to log instead of
+	// being written to the stream passed in.
+	void setLog(std::string* log) { mLog = log; }
+
 	void writeWarning(LLFILE *fp, LLScriptFilePosition *pos, LSCRIPTWarnings warning);
 	void writeWarning(LLFILE *fp, S32 line, S32 col, LSCRIPTWarnings warning);
 	void writeError(LLFILE *fp, LLScriptFilePosition *pos, LSCRIPTErrors error);
@@ -149,6 +153,11 @@ public:
 
 	S32 mTotalErrors;
 	S32 mTotalWarnings;
+
+private:
+	void write(LLFILE *fp, S32 line, S32 col, const char* kind, const char* text);
+
+	std::string* mLog;
 };
 
 std::string getLScriptErrorString(LSCRIPTErrors error);
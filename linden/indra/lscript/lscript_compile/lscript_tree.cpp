@@ -4012,6 +4012,346 @@ S32 LLScriptExpression::getSize()
 	return 0;
 }
 
+// Constant folding for LSCP_TO_STACK when the script is compiled with
+// optimization on. Integer and float expressions made only of literals are
+// evaluated here exactly as the LSL2 interpreter would, and pushed as a
+// single literal. Anything that would fault or is undefined at run time
+// (division by zero, out of range shifts and casts, non-finite results)
+// is left for the interpreter.
+class LLScriptFoldedConstant
+{
+public:
+	LLScriptFoldedConstant() : mType(LST_NULL), mInteger(0), mFP(0.f) {}
+
+	F32 getFloat() const { return (mType == LST_INTEGER) ? (F32)mInteger : mFP; }
+
+	LSCRIPTType	mType;
+	S32			mInteger;
+	F32			mFP;
+};
+
+static BOOL fold_constant(LLScriptExpression *expr, LLScriptFoldedConstant &result);
+
+static BOOL fold_integer_operation(LSCRIPTExpressionType op, S32 lside, S32 rside, S32 &result)
+{
+	switch(op)
+	{
+	case LET_PLUS:
+		result = (S32)((U32)lside + (U32)rside);
+		return TRUE;
+	case LET_MINUS:
+		result = (S32)((U32)lside - (U32)rside);
+		return TRUE;
+	case LET_TIMES:
+		result = (S32)((U32)lside * (U32)rside);
+		return TRUE;
+	case LET_DIVIDE:
+		if (!rside)
+		{
+			return FALSE;
+		}
+		// matches the interpreter's special case for division by -1
+		result = (rside == -1) ? (S32)(0U - (U32)lside) : lside / rside;
+		return TRUE;
+	case LET_MOD:
+		if (!rside)
+		{
+			return FALSE;
+		}
+		result = (rside == -1 || rside == 1) ? 0 : lside % rside;
+		return TRUE;
+	case LET_EQUALITY:
+		result = (lside == rside);
+		return TRUE;
+	case LET_NOT_EQUALS:
+		result = (lside != rside);
+		return TRUE;
+	case LET_LESS_EQUALS:
+		result = (lside <= rside);
+		return TRUE;
+	case LET_GREATER_EQUALS:
+		result = (lside >= rside);
+		return TRUE;
+	case LET_LESS_THAN:
+		result = (lside < rside);
+		return TRUE;
+	case LET_GREATER_THAN:
+		result = (lside > rside);
+		return TRUE;
+	case LET_BIT_AND:
+		result = lside & rside;
+		return TRUE;
+	case LET_BIT_OR:
+		result = lside | rside;
+		return TRUE;
+	case LET_BIT_XOR:
+		result = lside ^ rside;
+		return TRUE;
+	case LET_BOOLEAN_AND:
+		result = (lside && rside);
+		return TRUE;
+	case LET_BOOLEAN_OR:
+		result = (lside || rside);
+		return TRUE;
+	case LET_SHIFT_LEFT:
+		if (rside < 0 || rside > 31)
+		{
+			return FALSE;
+		}
+		result = (S32)((U32)lside << rside);
+		return TRUE;
+	case LET_SHIFT_RIGHT:
+		if (rside < 0 || rside > 31)
+		{
+			return FALSE;
+		}
+		result = lside >> rside;
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+static BOOL fold_float_operation(LSCRIPTExpressionType op, F32 lside, F32 rside, LLScriptFoldedConstant &result)
+{
+	result.mType = LST_FLOATINGPOINT;
+	switch(op)
+	{
+	case LET_PLUS:
+		result.mFP = lside + rside;
+		break;
+	case LET_MINUS:
+		result.mFP = lside - rside;
+		break;
+	case LET_TIMES:
+		result.mFP = lside * rside;
+		break;
+	case LET_DIVIDE:
+		if (!rside)
+		{
+			return FALSE;
+		}
+		result.mFP = lside / rside;
+		break;
+	default:
+		result.mType = LST_INTEGER;
+		switch(op)
+		{
+		case LET_EQUALITY:
+			result.mInteger = (lside == rside);
+			break;
+		case LET_NOT_EQUALS:
+			result.mInteger = (lside != rside);
+			break;
+		case LET_LESS_EQUALS:
+			result.mInteger = (lside <= rside);
+			break;
+		case LET_GREATER_EQUALS:
+			result.mInteger = (lside >= rside);
+			break;
+		case LET_LESS_THAN:
+			result.mInteger = (lside < rside);
+			break;
+		case LET_GREATER_THAN:
+			result.mInteger = (lside > rside);
+			break;
+		default:
+			return FALSE;
+		}
+		return TRUE;
+	}
+	return llfinite(result.mFP);
+}
+
+static BOOL fold_binary(LSCRIPTExpressionType op, LLScriptExpression *left, LLScriptExpression *right, LLScriptFoldedConstant &result)
+{
+	LLScriptFoldedConstant lside, rside;
+	if (!fold_constant(left, lside) || !fold_constant(right, rside))
+	{
+		return FALSE;
+	}
+	if (lside.mType == LST_INTEGER && rside.mType == LST_INTEGER)
+	{
+		result.mType = LST_INTEGER;
+		return fold_integer_operation(op, lside.mInteger, rside.mInteger, result.mInteger);
+	}
+	return fold_float_operation(op, lside.getFloat(), rside.getFloat(), result);
+}
+
+static BOOL fold_constant(LLScriptExpression *expr, LLScriptFoldedConstant &result)
+{
+	switch(expr->mType)
+	{
+	case LET_CONSTANT:
+		{
+			LLScriptConstant *constant = ((LLScriptConstantExpression *)expr)->mConstant;
+			if (constant->mType == LST_INTEGER)
+			{
+				result.mType = LST_INTEGER;
+				result.mInteger = ((LLScriptConstantInteger *)constant)->mValue;
+				return TRUE;
+			}
+			if (constant->mType == LST_FLOATINGPOINT)
+			{
+				result.mType = LST_FLOATINGPOINT;
+				result.mFP = ((LLScriptConstantFloat *)constant)->mValue;
+				return llfinite(result.mFP);
+			}
+			return FALSE;
+		}
+	case LET_PARENTHESIS:
+		return fold_constant(((LLScriptParenthesis *)expr)->mExpression, result);
+	case LET_UNARY_MINUS:
+		if (!fold_constant(((LLScriptUnaryMinus *)expr)->mExpression, result))
+		{
+			return FALSE;
+		}
+		if (result.mType == LST_INTEGER)
+		{
+			result.mInteger = (S32)(0U - (U32)result.mInteger);
+		}
+		else
+		{
+			result.mFP = -result.mFP;
+		}
+		return TRUE;
+	case LET_BIT_NOT:
+		if (!fold_constant(((LLScriptBitNot *)expr)->mExpression, result) || result.mType != LST_INTEGER)
+		{
+			return FALSE;
+		}
+		result.mInteger = ~result.mInteger;
+		return TRUE;
+	case LET_BOOLEAN_NOT:
+		if (!fold_constant(((LLScriptBooleanNot *)expr)->mExpression, result) || result.mType != LST_INTEGER)
+		{
+			return FALSE;
+		}
+		result.mInteger = !result.mInteger;
+		return TRUE;
+	case LET_CAST:
+		{
+			LLScriptTypeCast *cast = (LLScriptTypeCast *)expr;
+			if (!fold_constant(cast->mExpression, result))
+			{
+				return FALSE;
+			}
+			if (cast->mType->mType == LST_FLOATINGPOINT)
+			{
+				result.mFP = result.getFloat();
+				result.mType = LST_FLOATINGPOINT;
+				return TRUE;
+			}
+			if (cast->mType->mType == LST_INTEGER)
+			{
+				if (result.mType == LST_FLOATINGPOINT)
+				{
+					// out of range conversions are undefined, leave them to the interpreter
+					if (!(result.mFP > -2147483648.f && result.mFP < 2147483648.f))
+					{
+						return FALSE;
+					}
+					result.mInteger = (S32)result.mFP;
+					result.mType = LST_INTEGER;
+				}
+				return TRUE;
+			}
+			return FALSE;
+		}
+	case LET_EQUALITY:
+		return fold_binary(expr->mType, ((LLScriptEquality *)expr)->mLeftSide, ((LLScriptEquality *)expr)->mRightSide, result);
+	case LET_NOT_EQUALS:
+		return fold_binary(expr->mType, ((LLScriptNotEquals *)expr)->mLeftSide, ((LLScriptNotEquals *)expr)->mRightSide, result);
+	case LET_LESS_EQUALS:
+		return fold_binary(expr->mType, ((LLScriptLessEquals *)expr)->mLeftSide, ((LLScriptLessEquals *)expr)->mRightSide, result);
+	case LET_GREATER_EQUALS:
+		return fold_binary(expr->mType, ((LLScriptGreaterEquals *)expr)->mLeftSide, ((LLScriptGreaterEquals *)expr)->mRightSide, result);
+	case LET_LESS_THAN:
+		return fold_binary(expr->mType, ((LLScriptLessThan *)expr)->mLeftSide, ((LLScriptLessThan *)expr)->mRightSide, result);
+	case LET_GREATER_THAN:
+		return fold_binary(expr->mType, ((LLScriptGreaterThan *)expr)->mLeftSide, ((LLScriptGreaterThan *)expr)->mRightSide, result);
+	case LET_PLUS:
+		return fold_binary(expr->mType, ((LLScriptPlus *)expr)->mLeftSide, ((LLScriptPlus *)expr)->mRightSide, result);
+	case LET_MINUS:
+		return fold_binary(expr->mType, ((LLScriptMinus *)expr)->mLeftSide, ((LLScriptMinus *)expr)->mRightSide, result);
+	case LET_TIMES:
+		return fold_binary(expr->mType, ((LLScriptTimes *)expr)->mLeftSide, ((LLScriptTimes *)expr)->mRightSide, result);
+	case LET_DIVIDE:
+		return fold_binary(expr->mType, ((LLScriptDivide *)expr)->mLeftSide, ((LLScriptDivide *)expr)->mRightSide, result);
+	case LET_MOD:
+		return fold_binary(expr->mType, ((LLScriptMod *)expr)->mLeftSide, ((LLScriptMod *)expr)->mRightSide, result);
+	case LET_BIT_AND:
+		return fold_binary(expr->mType, ((LLScriptBitAnd *)expr)->mLeftSide, ((LLScriptBitAnd *)expr)->mRightSide, result);
+	case LET_BIT_OR:
+		return fold_binary(expr->mType, ((LLScriptBitOr *)expr)->mLeftSide, ((LLScriptBitOr *)expr)->mRightSide, result);
+	case LET_BIT_XOR:
+		return fold_binary(expr->mType, ((LLScriptBitXor *)expr)->mLeftSide, ((LLScriptBitXor *)expr)->mRightSide, result);
+	case LET_BOOLEAN_AND:
+		return fold_binary(expr->mType, ((LLScriptBooleanAnd *)expr)->mLeftSide, ((LLScriptBooleanAnd *)expr)->mRightSide, result);
+	case LET_BOOLEAN_OR:
+		return fold_binary(expr->mType, ((LLScriptBooleanOr *)expr)->mLeftSide, ((LLScriptBooleanOr *)expr)->mRightSide, result);
+	case LET_SHIFT_LEFT:
+		return fold_binary(expr->mType, ((LLScriptShiftLeft *)expr)->mLeftSide, ((LLScriptShiftLeft *)expr)->mRightSide, result);
+	case LET_SHIFT_RIGHT:
+		return fold_binary(expr->mType, ((LLScriptShiftRight *)expr)->mLeftSide, ((LLScriptShiftRight *)expr)->mRightSide, result);
+	default:
+		return FALSE;
+	}
+}
+
+// Pushes expr as one literal if it folds to a value of its own type.
+static BOOL push_folded_constant(LLScriptExpression *expr, LLScriptByteCodeChunk *chunk)
+{
+	if (!gScriptp->mOptimize)
+	{
+		return FALSE;
+	}
+	LLScriptFoldedConstant value;
+	if (!fold_constant(expr, value) || value.mType != expr->mReturnType)
+	{
+		return FALSE;
+	}
+	if (value.mType == LST_INTEGER)
+	{
+		chunk->addByte(LSCRIPTOpCodes[LOPC_PUSHARGI]);
+		chunk->addInteger(value.mInteger);
+	}
+	else
+	{
+		chunk->addByte(LSCRIPTOpCodes[LOPC_PUSHARGF]);
+		chunk->addFloat(value.mFP);
+	}
+	return TRUE;
+}
+
+// Pushes a vector or rotation initializer whose components all fold as
+// one PUSHARGV/PUSHARGQ literal. Components go out in the order the
+// interpreter reads them back: s, z, y, x.
+static BOOL push_folded_initializer(LLScriptExpression **components, S32 count, LLScriptByteCodeChunk *chunk)
+{
+	if (!gScriptp->mOptimize)
+	{
+		return FALSE;
+	}
+	F32 values[4];
+	S32 i;
+	for (i = 0; i < count; i++)
+	{
+		LLScriptFoldedConstant value;
+		if (!fold_constant(components[i], value))
+		{
+			return FALSE;
+		}
+		values[i] = value.getFloat();
+	}
+	chunk->addByte(LSCRIPTOpCodes[(count == 4) ? LOPC_PUSHARGQ : LOPC_PUSHARGV]);
+	for (i = count - 1; i >= 0; i--)
+	{
+		chunk->addFloat(values[i]);
+	}
+	return TRUE;
+}
+
 void LLScriptExpression::gonext(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePass pass, LSCRIPTPruneType ptype, BOOL &prunearg, LLScriptScope *scope, LSCRIPTType &type, LSCRIPTType basetype, U64 &count, LLScriptByteCodeChunk *chunk, LLScriptByteCodeChunk *heap, S32 stacksize, LLScriptScopeEntry *entry, S32 entrycount, LLScriptLibData **ldata)
 {
 	if (gErrorToText.getErrors())
@@ -5662,6 +6002,10 @@ void LLScriptEquality::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompile
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -5722,6 +6066,10 @@ void LLScriptNotEquals::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompil
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -5799,6 +6147,10 @@ void LLScriptLessEquals::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompi
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -5867,6 +6219,10 @@ void LLScriptGreaterEquals::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCo
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -5933,6 +6289,10 @@ void LLScriptLessThan::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompile
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -5999,6 +6359,10 @@ void LLScriptGreaterThan::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTComp
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6059,6 +6423,10 @@ void LLScriptPlus::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePass
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6119,6 +6487,10 @@ void LLScriptMinus::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePas
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6179,6 +6551,10 @@ void LLScriptTimes::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePas
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6239,6 +6615,10 @@ void LLScriptDivide::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePa
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6299,6 +6679,10 @@ void LLScriptMod::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePass
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6357,6 +6741,10 @@ void LLScriptBitAnd::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePa
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6413,6 +6801,10 @@ void LLScriptBitOr::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePas
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6469,6 +6861,10 @@ void LLScriptBitXor::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePa
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6525,6 +6921,10 @@ void LLScriptBooleanAnd::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompi
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6587,6 +6987,10 @@ void LLScriptBooleanOr::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompil
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6647,6 +7051,10 @@ void LLScriptShiftLeft::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompil
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6704,6 +7112,10 @@ void LLScriptShiftRight::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompi
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mRightSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			mLeftSide->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
@@ -6789,6 +7201,10 @@ void LLScriptUnaryMinus::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompi
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mExpression->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			U8 typebyte = LSCRIPTTypeByte[mLeftType];
@@ -6842,6 +7258,10 @@ void LLScriptBooleanNot::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompi
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mExpression->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			chunk->addByte(LSCRIPTOpCodes[LOPC_BOOLNOT]);
@@ -6892,6 +7312,10 @@ void LLScriptBitNot::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePa
 		}
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mExpression->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			chunk->addByte(LSCRIPTOpCodes[LOPC_BITNOT]);
@@ -7157,6 +7581,10 @@ void LLScriptTypeCast::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompile
 		mReturnType = mLeftType = type;
 		break;
 	case LSCP_TO_STACK:
+		if (push_folded_constant(this, chunk))
+		{
+			break;
+		}
 		{
 			mExpression->recurse(fp, tabs, tabsize, pass, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 			chunk->addByte(LSCRIPTOpCodes[LOPC_CAST]);
@@ -7239,6 +7667,13 @@ void LLScriptVectorInitializer::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRI
 		}
 		break;
 	case LSCP_TO_STACK:
+		{
+			LLScriptExpression *components[3] = { mExpression1, mExpression2, mExpression3 };
+			if (push_folded_initializer(components, 3, chunk))
+			{
+				break;
+			}
+		}
 		pass = LSCP_TO_STACK;
 		mExpression1->recurse(fp, tabs, tabsize, LSCP_TO_STACK, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 		if (mExpression1->mReturnType != LST_FLOATINGPOINT)
@@ -7367,6 +7802,13 @@ void LLScriptQuaternionInitializer::recurse(LLFILE *fp, S32 tabs, S32 tabsize, L
 		}
 		break;
 	case LSCP_TO_STACK:
+		{
+			LLScriptExpression *components[4] = { mExpression1, mExpression2, mExpression3, mExpression4 };
+			if (push_folded_initializer(components, 4, chunk))
+			{
+				break;
+			}
+		}
 		pass = LSCP_TO_STACK;
 		mExpression1->recurse(fp, tabs, tabsize, LSCP_TO_STACK, ptype, prunearg, scope, type, basetype, count, chunk, heap, stacksize, entry, entrycount, NULL);
 		if (mExpression1->mReturnType != LST_FLOATINGPOINT)
@@ -10572,7 +11014,8 @@ S32 LLScriptScript::getSize()
 LLScriptScript::LLScriptScript(LLScritpGlobalStorage *globals, 
 							   LLScriptState *states) :
     LLScriptFilePosition(0, 0),
-	mStates(states), mGlobalScope(NULL), mGlobals(NULL), mGlobalFunctions(NULL), mGodLike(FALSE)
+	mStates(states), mGlobalScope(NULL), mGlobals(NULL), mGlobalFunctions(NULL), mGodLike(FALSE),
+	mOptimize(FALSE), mBytecodeBuffer(NULL)
 {
 	const char DEFAULT_BYTECODE_FILENAME[] = "lscript.lso";
 
@@ -10807,10 +11250,21 @@ void LLScriptScript::recurse(LLFILE *fp, S32 tabs, S32 tabsize, LSCRIPTCompilePa
 
 			// now, put it all together and spit it out
 			// we need 
-			LLFILE* bcfp = LLFile::fopen(mBytecodeDest, "wb");		/*Flawfinder: ignore*/
-			
-			code->build(fp, bcfp);
-			fclose(bcfp);
+			if (mBytecodeBuffer)
+			{
+				code->build(fp, NULL);
+				if (code->mCompleteCode)
+				{
+					mBytecodeBuffer->assign(code->mCompleteCode, code->mCompleteCode + code->mTotalSize);
+				}
+			}
+			else
+			{
+				LLFILE* bcfp = LLFile::fopen(mBytecodeDest, "wb");		/*Flawfinder: ignore*/
+
+				code->build(fp, bcfp);
+				fclose(bcfp);
+			}
 									   
 			delete code;
 		}
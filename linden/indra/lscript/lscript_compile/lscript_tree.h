@@ -2288,6 +2288,9 @@ public:
 	S32 getSize();
 
 	void setBytecodeDest(const char* dst_filename);
+	// When set, LSCP_EMIT_BYTE_CODE fills buffer instead of writing the
+	// bytecode destination file.
+	void setBytecodeBuffer(std::vector<U8>* buffer) { mBytecodeBuffer = buffer; }
 
 	void setClassName(const char* class_name);
 	const char* getClassName() {return mClassName;}
@@ -2297,9 +2300,11 @@ public:
 	LLScriptGlobalVariable	*mGlobals;
 	LLScriptGlobalFunctions	*mGlobalFunctions;
 	BOOL					mGodLike;
+	BOOL					mOptimize;	// fold constant expressions when emitting byte code
 
 private:
 	std::string mBytecodeDest;
+	std::vector<U8>* mBytecodeBuffer;
 	char mClassName[MAX_STRING];
 };
 
@@ -33,9 +33,22 @@
 #ifndef LL_LSCRIPT_RT_INTERFACE_H
 #define LL_LSCRIPT_RT_INTERFACE_H
 
+// The compiler keeps its parse state in globals and is not reentrant.
+// Compiles take a lock, so they run one at a time and never in parallel;
+// call lscript_compile_init() on the main thread before compiling from
+// any other thread.
+void lscript_compile_init();
+void lscript_compile_cleanup();
+
 BOOL lscript_compile(char *filename, BOOL compile_to_mono, BOOL is_god_like = FALSE);
 BOOL lscript_compile(const char* src_filename, const char* dst_filename,
 					 const char* err_filename, BOOL compile_to_mono, const char* class_name, BOOL is_god_like = FALSE);
+// Compiles source to LSL2 bytecode without touching the disk. errors
+// receives one line per error or warning, in the format of the .out file.
+// optimize folds constant integer, float, vector and rotation expressions
+// into literals.
+BOOL lscript_compile(const std::string& source, std::vector<U8>& bytecode,
+					 std::string& errors, BOOL is_god_like = FALSE, BOOL optimize = FALSE);
 void lscript_run(const std::string& filename, BOOL b_debug);
 
 
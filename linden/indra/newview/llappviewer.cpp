@@ -90,10 +90,14 @@
 #include "llnotify.h"
 #include "llviewerkeyboard.h"
 #include "lllfsthread.h"
+#include "lllogchat.h"
 #include "llworkerthread.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
+#include "lscript_rt_interface.h"
+#include "llqueuedthreadpool.h"
+#include "lltracerecorder.h"
 
 // The files below handle dependencies from cleanup.
 #include "llkeyframemotion.h"
@@ -438,6 +442,29 @@ static void settings_to_globals()
 	ViewerTime::sUseUTCTime = gSavedSettings.getBOOL("UseUTCTime");
 }
 
+// Starts or stops the trace session when TraceRecording changes, and
+// writes out the events recorded since the last frame.
+static void update_trace_session()
+{
+	static std::string trace_filename;
+
+	BOOL wanted = gSavedSettings.getBOOL("TraceRecording");
+	if (wanted && !LLTraceRecorder::isRecording())
+	{
+		trace_filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "viewer.trace");
+		if (!LLTraceRecorder::startSession(trace_filename))
+		{
+			gSavedSettings.setBOOL("TraceRecording", FALSE);
+		}
+	}
+	else if (!wanted && LLTraceRecorder::isRecording())
+	{
+		LLTraceRecorder::stopSession();
+		LLTraceRecorder::convertToChromeTrace(trace_filename, trace_filename + ".json");
+	}
+	LLTraceRecorder::flush();
+}
+
 static void settings_modify()
 {
 	LLRenderTarget::sUseFBO				= gSavedSettings.getBOOL("RenderUseFBO");
@@ -540,6 +567,7 @@ const std::string LLAppViewer::sCrashSettingsName = "CrashSettings";
 LLTextureCache* LLAppViewer::sTextureCache = NULL; 
 LLImageDecodeThread* LLAppViewer::sImageDecodeThread = NULL; 
 LLTextureFetch* LLAppViewer::sTextureFetch = NULL; 
+LLQueuedThreadPool* LLAppViewer::sQueuedThreadPool = NULL;
 
 LLAppViewer::LLAppViewer() : 
 	mMarkerFile(),
@@ -656,6 +684,8 @@ bool LLAppViewer::init()
 		LLError::setPrintLocation(true);
 	}
 
+	LLError::setAsyncLogging(gSavedSettings.getBOOL("AsyncLogging"));
+
 	// ZWAGOTH: This resolves a bunch of skin updating problems and makes skinning
 	// SIGNIFICANLTLY easier. User colors > skin colors > default skin colors.
 	// This also will get rid of the Invalid control... spam when a skin doesn't have that color
@@ -912,11 +942,14 @@ bool LLAppViewer::mainLoop()
 	LLTimer debugTime;
 	LLViewerJoystick* joystick(LLViewerJoystick::getInstance());
 	joystick->setNeedsReset(true);
+
+	LLTraceRecorder::setThreadName("Main");
  	
 	// Handle messages
 	while (!LLApp::isExiting())
 	{
 		LLFastTimer::reset(); // Should be outside of any timer instances
+		update_trace_session();
 		try
 		{
 			LLFastTimer t(LLFastTimer::FTM_FRAME);
@@ -1192,6 +1225,9 @@ bool LLAppViewer::cleanup()
 
 	release_start_screen(); // just in case
 
+	// Drain the log writer thread; everything below is logged synchronously.
+	LLError::setAsyncLogging(false);
+
 	LLError::logToFixedBuffer(NULL);
 
 	llinfos << "Cleaning Up" << llendflush;
@@ -1470,6 +1506,12 @@ bool LLAppViewer::cleanup()
 	sTextureCache->shutdown();
 	sTextureFetch->shutdown();
 	sImageDecodeThread->shutdown();
+	if (sQueuedThreadPool)
+	{
+		sQueuedThreadPool->printStats();
+		delete sQueuedThreadPool;
+		sQueuedThreadPool = NULL;
+	}
 	delete sTextureCache;
     sTextureCache = NULL;
 	delete sTextureFetch;
@@ -1489,8 +1531,10 @@ bool LLAppViewer::cleanup()
 	
 	// This should eventually be done in LLAppViewer
 	LLImage::cleanupClass();
+	lscript_compile_cleanup();
 	LLVFSThread::cleanupClass();
 	LLLFSThread::cleanupClass();
+	LLLogChat::cleanupClass();
 
 	llinfos << "VFS Thread finished" << llendflush;
 
@@ -1575,12 +1619,29 @@ bool LLAppViewer::initThreads()
 
 	LLVFSThread::initClass(enable_threads && false);
 	LLLFSThread::initClass(enable_threads && false);
+	// Chat and IM transcripts are batched and written in the background
+	LLLogChat::initClass(enable_threads);
+
+	// Texture cache and image decode requests share one pool of workers
+	// instead of a thread each. Texture fetch keeps its own thread since
+	// its curl handles must stay on the thread that created them.
+	S32 pool_size = gSavedSettings.getS32("QueuedThreadPoolSize");
+	bool use_pool = enable_threads && pool_size > 0;
 
 	// Image decoding
-	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
-	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
+	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && !use_pool);
+	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && !use_pool);
+	if (use_pool)
+	{
+		sQueuedThreadPool = new LLQueuedThreadPool("QueuedThreadPool", pool_size);
+		// Decode requests are independent of each other; cache requests
+		// share the header file and stay single consumer.
+		sQueuedThreadPool->addQueue(sImageDecodeThread, llmax(pool_size, 1));
+		sQueuedThreadPool->addQueue(sTextureCache, 1);
+	}
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(), sImageDecodeThread, enable_threads && true);
 	LLImage::initClass(gSavedSettings.getBOOL("UseKDUIfAvailable"));
+	lscript_compile_init();
 
 	// *FIX: no error handling here!
 	return true;
@@ -3260,6 +3321,15 @@ void LLAppViewer::loadNameCache()
 {
 	if (!gCacheName) return;
 
+	std::string binary_cache;
+	binary_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache.bin");
+	llifstream binary_file(binary_cache, std::ios::binary);
+	if(binary_file.is_open())
+	{
+		if(gCacheName->importBinaryFile(binary_file)) return;
+	}
+
+	// Fall back to the XML cache written by older viewers.
 	std::string name_cache;
 	name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache");
 	llifstream cache_file(name_cache);
@@ -3283,11 +3353,11 @@ void LLAppViewer::saveNameCache()
 	if (!gCacheName) return;
 
 	std::string name_cache;
-	name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache");
-	llofstream cache_file(name_cache);
+	name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache.bin");
+	llofstream cache_file(name_cache, std::ios::binary);
 	if(cache_file.is_open())
 	{
-		gCacheName->exportFile(cache_file);
+		gCacheName->exportBinaryFile(cache_file);
 	}
 }
 
@@ -3574,6 +3644,11 @@ void LLAppViewer::idle()
 	// dead objects.
 	//
 
+	{
+		// Send edits queued by manipulator drags this frame
+		LLSelectMgr::getInstance()->sendPendingUpdates();
+	}
+
 	{
 		gFrameStats.start(LLFrameStats::UPDATE_EFFECTS);
 		LLSelectMgr::getInstance()->updateEffects();
@@ -36,6 +36,7 @@
 class LLTextureCache;
 class LLImageDecodeThread;
 class LLTextureFetch;
+class LLQueuedThreadPool;
 class LLWatchdogTimeout;
 class LLCommandLineParser;
 
@@ -215,6 +216,7 @@ private:
 	static LLTextureCache* sTextureCache; 
 	static LLImageDecodeThread* sImageDecodeThread; 
 	static LLTextureFetch* sTextureFetch;
+	static LLQueuedThreadPool* sQueuedThreadPool; // NULL if each queue has its own thread
 
 	S32 mNumSessions;
 
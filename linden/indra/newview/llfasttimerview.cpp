@@ -253,6 +253,10 @@ LLFastTimerView::LLFastTimerView(const std::string& name, const LLRect& rect)
 			llassert(level < FTV_DISPLAY_NUM);
 			ft_display_table[i].desc = text;
 			ft_display_table[i].level = level;
+			if (ft_display_table[i].timer < LLFastTimer::FTM_NUM_TYPES)
+			{
+				LLFastTimer::setTraceName((LLFastTimer::EFastTimerType)ft_display_table[i].timer, text);
+			}
 			if (level > 0)
 			{
 				ft_display_table[i].parent = pidx[level-1];
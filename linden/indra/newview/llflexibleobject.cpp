@@ -51,6 +51,8 @@
 #include "llvoavatar.h"
 
 /*static*/ F32 LLVolumeImplFlexible::sUpdateFactor = 1.0f;
+/*static*/ LLVolumeImplFlexible::batch_queue_t LLVolumeImplFlexible::sBatchQueue;
+/*static*/ LLFlexibleSolverBatch LLVolumeImplFlexible::sSolverBatch;
 
 // LLFlexibleObjectData::pack/unpack now in llprimitive.cpp
 
@@ -68,6 +70,7 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
 	mSimulateRes = 0;
 	mFrameNum = 0;
 	mRenderRes = 1;
+	mBatchState = BATCH_NONE;
 
 	if(mVO->mDrawable.notNull())
 	{
@@ -75,6 +78,15 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
 	}
 }//-----------------------------------------------
 
+LLVolumeImplFlexible::~LLVolumeImplFlexible()
+{
+	// Entries that were stepped on their own may still be in the queue
+	if (!sBatchQueue.empty())
+	{
+		sBatchQueue.erase(std::remove(sBatchQueue.begin(), sBatchQueue.end(), this), sBatchQueue.end());
+	}
+}
+
 LLVector3 LLVolumeImplFlexible::getFramePosition() const
 {
 	return mVO->getRenderPosition();
@@ -320,6 +332,7 @@ BOOL LLVolumeImplFlexible::doIdleUpdate(LLAgent &agent, LLWorld &world, const F6
 	if (force_update)
 	{
 		gPipeline.markRebuild(mVO->mDrawable, LLDrawable::REBUILD_POSITION, FALSE);
+		queueBatchUpdate();
 	}
 	else if	(mVO->mDrawable->isVisible() &&
 		!mVO->mDrawable->isState(LLDrawable::IN_REBUILD_Q1) &&
@@ -343,41 +356,29 @@ BOOL LLVolumeImplFlexible::doIdleUpdate(LLAgent &agent, LLWorld &world, const F6
 		if ((LLDrawable::getCurrentFrame()+id)%update_period == 0)
 		{
 			gPipeline.markRebuild(mVO->mDrawable, LLDrawable::REBUILD_POSITION, FALSE);
+			queueBatchUpdate();
 		}
 	}
 	
 	return force_update;
 }
 
-inline S32 log2(S32 x)
+void LLVolumeImplFlexible::queueBatchUpdate()
 {
-	S32 ret = 0;
-	while (x > 1)
+	if (mBatchState == BATCH_NONE)
 	{
-		++ret;
-		x >>= 1;
+		mBatchState = BATCH_QUEUED;
+		sBatchQueue.push_back(this);
 	}
-	return ret;
 }
 
-void LLVolumeImplFlexible::doFlexibleUpdate()
+// Samples everything the solver needs from the object and the region.
+// Restarts the step timer.
+void LLVolumeImplFlexible::setupSolverInput(LLFlexibleSolverInput& input)
 {
-	LLVolume* volume = mVO->getVolume();
-	LLPath *path = &volume->getPath();
-	if (mSimulateRes == 0)
-	{
-		mVO->markForUpdate(TRUE);
-		if (!doIdleUpdate(gAgent, *LLWorld::getInstance(), 0.0))
-		{
-			return;	// we did not get updated or initialized, proceeding without can be dangerous
-		}
-	}
-
-	llassert_always(mInitialized);
-	
 	S32 num_sections = 1 << mSimulateRes;
 
-    F32 secondsThisFrame = mTimer.getElapsedTimeAndResetF32();
+	F32 secondsThisFrame = mTimer.getElapsedTimeAndResetF32();
 	if (secondsThisFrame > 0.2f)
 	{
 		secondsThisFrame = 0.2f;
@@ -385,201 +386,114 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 
 	LLVector3 BasePosition = getFramePosition();
 	LLQuaternion BaseRotation = getFrameRotation();
-	LLQuaternion parentSegmentRotation = BaseRotation;
-	LLVector3 anchorDirectionRotated = LLVector3::z_axis * parentSegmentRotation;
+	LLVector3 anchorDirectionRotated = LLVector3::z_axis * BaseRotation;
 	LLVector3 anchorScale = mVO->mDrawable->getScale();
-	
-	F32 section_length = anchorScale.mV[VZ] / (F32)num_sections;
-	F32 inv_section_length = 1.f / section_length;
 
-	S32 i;
+	input.mNumSections = num_sections;
+	input.mSectionLength = anchorScale.mV[VZ] / (F32)num_sections;
 
 	// ANCHOR position is offset from BASE position (centroid) by half the length
-	LLVector3 AnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
-	
-	mSection[0].mPosition = AnchorPosition;
-	mSection[0].mDirection = anchorDirectionRotated;
-	mSection[0].mRotation = BaseRotation;
+	input.mAnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
+	input.mAnchorDirection = anchorDirectionRotated;
+	input.mAnchorRotation = BaseRotation;
 
-	LLQuaternion deltaRotation;
+	input.setCoefficients(*mAttributes, secondsThisFrame);
 
-	LLVector3 lastPosition;
-
-	// Coefficients which are constant across sections
-	F32 t_factor = mAttributes->getTension() * 0.1f;
-	t_factor = t_factor*(1 - pow(0.85f, secondsThisFrame*30));
-	if ( t_factor > FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE )
+	LLViewerRegion* region = gAgent.getRegion();
+	if (!region)
 	{
-		t_factor = FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE;
+		input.mHasWind = FALSE;
 	}
-
-	F32 friction_coeff = (mAttributes->getAirFriction()*2+1);
-	friction_coeff = pow(10.f, friction_coeff*secondsThisFrame);
-	friction_coeff = (friction_coeff > 1) ? friction_coeff : 1;
-	F32 momentum = 1.0f / friction_coeff;
-
-	F32 wind_factor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
-	F32 max_angle = atan(section_length*2.f);
-
-	F32 force_factor = section_length * secondsThisFrame;
-
-	// Update simulated sections
-	for (i=1; i<=num_sections; ++i)
+	if (input.mHasWind)
 	{
-		LLVector3 parentSectionVector;
-		LLVector3 parentSectionPosition;
-		LLVector3 parentDirection;
-
-		//---------------------------------------------------
-		// save value of position as lastPosition
-		//---------------------------------------------------
-		lastPosition = mSection[i].mPosition;
-
-		//------------------------------------------------------------------------------------------
-		// gravity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition.mV[2] -= mAttributes->getGravity() * force_factor;
-
-		//------------------------------------------------------------------------------------------
-		// wind force
-		//------------------------------------------------------------------------------------------
-		if (mAttributes->getWindSensitivity() > 0.001f)
+		for (S32 i = 1; i <= num_sections; ++i)
 		{
-			mSection[i].mPosition += gAgent.getRegion()->mWind.getVelocity( mSection[i].mPosition ) * wind_factor;
+			// Sampled where the wind is applied, after gravity
+			LLVector3 position = mSection[i].mPosition;
+			position.mV[VZ] -= input.mGravityStep;
+			input.mWind[i] = region->mWind.getVelocity(position) * input.mWindFactor;
 		}
+	}
+}
 
-		//------------------------------------------------------------------------------------------
-		// user-defined force
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mAttributes->getUserForce() * force_factor;
+//static
+void LLVolumeImplFlexible::updateClass()
+{
+	if (sBatchQueue.empty())
+	{
+		return;
+	}
+
+	LLFastTimer ftm(LLFastTimer::FTM_FLEXIBLE_UPDATE);
 
-		//---------------------------------------------------
-		// tension (rigidity, stiffness)
-		//---------------------------------------------------
-		parentSectionPosition = mSection[i-1].mPosition;
-		parentDirection = mSection[i-1].mDirection;
+	sSolverBatch.clear();
 
-		if ( i == 1 )
+	// Compact the queue down to the objects actually stepped, in handle order
+	S32 count = 0;
+	for (batch_queue_t::iterator iter = sBatchQueue.begin(); iter != sBatchQueue.end(); ++iter)
+	{
+		LLVolumeImplFlexible* flex = *iter;
+		if (flex->mBatchState != BATCH_QUEUED)
 		{
-			parentSectionVector = mSection[0].mDirection;
+			// Already stepped on its own by doFlexibleUpdate(), or queued twice
+			continue;
 		}
-		else
+		if (!flex->mInitialized || flex->mVO->isDead() || flex->mVO->mDrawable.isNull())
 		{
-			parentSectionVector = mSection[i-2].mDirection;
+			flex->mBatchState = BATCH_NONE;
+			continue;
 		}
 
-		LLVector3 currentVector = mSection[i].mPosition - parentSectionPosition;
-
-		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
-		LLVector3 tensionForce = difference * t_factor;
-
-		mSection[i].mPosition += tensionForce;
+		LLFlexibleSolverInput input;
+		flex->setupSolverInput(input);
+		sSolverBatch.add(input, flex->mSection);
+		flex->mBatchState = BATCH_SIMULATED;
+		sBatchQueue[count++] = flex;
+	}
 
-		//------------------------------------------------------------------------------------------
-		// sphere collision, currently not used
-		//------------------------------------------------------------------------------------------
-		/*if ( mAttributes->mUsingCollisionSphere )
-		{
-			LLVector3 vectorToCenterOfCollisionSphere = mCollisionSpherePosition - mSection[i].mPosition;
-			if ( vectorToCenterOfCollisionSphere.magVecSquared() < mCollisionSphereRadius * mCollisionSphereRadius )
-			{
-				F32 distanceToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere.magVec();
-				F32 penetration = mCollisionSphereRadius - distanceToCenterOfCollisionSphere;
-
-				LLVector3 normalToCenterOfCollisionSphere;
-				
-				if ( distanceToCenterOfCollisionSphere > 0.0f )
-				{
-					normalToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere / distanceToCenterOfCollisionSphere;
-				}
-				else // rare
-				{
-					normalToCenterOfCollisionSphere = LLVector3::x_axis; // arbitrary
-				}
-
-				// push the position out to the surface of the collision sphere
-				mSection[i].mPosition -= normalToCenterOfCollisionSphere * penetration;
-			}
-		}*/
-
-		//------------------------------------------------------------------------------------------
-		// inertia
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mSection[i].mVelocity * momentum;
-
-		//------------------------------------------------------------------------------------------
-		// clamp length & rotation
-		//------------------------------------------------------------------------------------------
-		mSection[i].mDirection = mSection[i].mPosition - parentSectionPosition;
-		mSection[i].mDirection.normVec();
-		deltaRotation.shortestArc( parentDirection, mSection[i].mDirection );
-
-		F32 angle;
-		LLVector3 axis;
-		deltaRotation.getAngleAxis(&angle, axis);
-		if (angle > F_PI) angle -= 2.f*F_PI;
-		if (angle < -F_PI) angle += 2.f*F_PI;
-		if (angle > max_angle)
-		{
-			//angle = 0.5f*(angle+max_angle);
-			deltaRotation.setQuat(max_angle, axis);
-		} else if (angle < -max_angle)
-		{
-			//angle = 0.5f*(angle-max_angle);
-			deltaRotation.setQuat(-max_angle, axis);
-		}
-		LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
-		parentSegmentRotation = segment_rotation;
+	sSolverBatch.solve();
 
-		mSection[i].mDirection = (parentDirection * deltaRotation);
-		mSection[i].mPosition = parentSectionPosition + mSection[i].mDirection * section_length;
-		mSection[i].mRotation = segment_rotation;
+	for (S32 i = 0; i < count; ++i)
+	{
+		sBatchQueue[i]->mLastSegmentRotation = sSolverBatch.getEndRotation(i);
+	}
+	sBatchQueue.clear();
+}
 
-		if (i > 1)
-		{
-			// Propogate half the rotation up to the parent
-			LLQuaternion halfDeltaRotation(angle/2, axis);
-			mSection[i-1].mRotation = mSection[i-1].mRotation * halfDeltaRotation;
-		}
+inline S32 log2(S32 x)
+{
+	S32 ret = 0;
+	while (x > 1)
+	{
+		++ret;
+		x >>= 1;
+	}
+	return ret;
+}
 
-		//------------------------------------------------------------------------------------------
-		// calculate velocity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mVelocity = mSection[i].mPosition - lastPosition;
-		if (mSection[i].mVelocity.magVecSquared() > 1.f)
+void LLVolumeImplFlexible::doFlexibleUpdate()
+{
+	LLVolume* volume = mVO->getVolume();
+	LLPath *path = &volume->getPath();
+	if (mSimulateRes == 0)
+	{
+		mVO->markForUpdate(TRUE);
+		if (!doIdleUpdate(gAgent, *LLWorld::getInstance(), 0.0))
 		{
-			mSection[i].mVelocity.normVec();
+			return;	// we did not get updated or initialized, proceeding without can be dangerous
 		}
 	}
 
-	// Calculate derivatives (not necessary until normals are automagically generated)
-	mSection[0].mdPosition = (mSection[1].mPosition - mSection[0].mPosition) * inv_section_length;
-	// i = 1..NumSections-1
-	for (i=1; i<num_sections; ++i)
+	llassert_always(mInitialized);
+	
+	if (mBatchState != BATCH_SIMULATED)
 	{
-		// Quadratic numerical derivative of position
-
-		// f(-L1) = aL1^2 - bL1 + c = f1
-		// f(0)   =               c = f2
-		// f(L2)  = aL2^2 + bL2 + c = f3
-		// f = ax^2 + bx + c
-		// d/dx f = 2ax + b
-		// d/dx f(0) = b
-
-		// c = f2
-		// a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
-		// b = (f3-c-aL2^2)/L2
-
-		LLVector3 a = (mSection[i-1].mPosition-mSection[i].mPosition +
-					mSection[i+1].mPosition-mSection[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
-		LLVector3 b = (mSection[i+1].mPosition-mSection[i].mPosition - a*(section_length*section_length));
-		b *= inv_section_length;
-
-		mSection[i].mdPosition = b;
+		LLFlexibleSolverInput input;
+		setupSolverInput(input);
+		LLFlexibleSolver::integrate(input, mSection);
+		mLastSegmentRotation = input.mEndRotation;
 	}
-
-	// i = NumSections
-	mSection[i].mdPosition = (mSection[i].mPosition - mSection[i-1].mPosition) * inv_section_length;
+	mBatchState = BATCH_NONE;
 
 	// Create points
 	S32 num_render_sections = 1<<mRenderRes;
@@ -590,6 +504,7 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 	}
 
 	LLPath::PathPt *new_point;
+	S32 i;
 
 	LLFlexibleObjectSection newSection[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
 	remapSections(mSection, mSimulateRes, newSection, mRenderRes);
@@ -629,8 +544,6 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 		new_point->mScale = newSection[i].mScale;
 		new_point->mTexT = ((F32)i)/(num_render_sections);
 	}
-
-	mLastSegmentRotation = parentSegmentRotation;
 }
 
 void LLVolumeImplFlexible::preRebuild()
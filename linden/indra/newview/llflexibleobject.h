@@ -44,6 +44,7 @@
 #define LL_LLFLEXIBLEOBJECT_H
 
 #include "llmemory.h"
+#include "llflexiblesolver.h"
 #include "llprimitive.h"
 #include "llvovolume.h"
 #include "llwind.h"
@@ -53,24 +54,7 @@ const F32	FLEXIBLE_OBJECT_TIMESLICE		= 0.003f;
 const U32	FLEXIBLE_OBJECT_MAX_LOD			= 10;
 
 // See llprimitive.h for LLFlexibleObjectData and DEFAULT/MIN/MAX values 
-
-//-------------------------------------------------------------------
-
-struct LLFlexibleObjectSection
-{
-	// Input parameters
-	LLVector2		mScale;
-	LLQuaternion	mAxisRotation;
-	// Simulated state
-	LLVector3		mPosition;
-	LLVector3		mVelocity;
-	LLVector3		mDirection;
-	LLQuaternion	mRotation;
-	// Derivatives (Not all currently used, will come back with LLVolume changes to automagically generate normals)
-	LLVector3		mdPosition;
-	//LLMatrix4		mRotScale;
-	//LLMatrix4		mdRotScale;
-};
+// See llflexiblesolver.h for LLFlexibleObjectSection and the section physics
 
 //---------------------------------------------------------
 // The LLVolumeImplFlexible class 
@@ -79,6 +63,12 @@ class LLVolumeImplFlexible : public LLVolumeInterface
 {
 	public:
 		LLVolumeImplFlexible(LLViewerObject* volume, LLFlexibleObjectData* attributes);
+		~LLVolumeImplFlexible();
+
+		// Steps every flexible object that doIdleUpdate() scheduled for a
+		// rebuild this frame in one batch. Called by the pipeline before it
+		// works through the build queues.
+		static void updateClass();
 
 		// Implements LLVolumeInterface
 		U32 getID() const { return mID; }
@@ -136,10 +126,20 @@ class LLVolumeImplFlexible : public LLVolumeInterface
 		F32							mCollisionSphereRadius;
 		U32							mID;
 
+		enum EBatchState
+		{
+			BATCH_NONE,
+			BATCH_QUEUED,		// in sBatchQueue, waiting for updateClass()
+			BATCH_SIMULATED		// stepped by updateClass(), path not yet rebuilt
+		};
+		EBatchState					mBatchState;
+
 		//--------------------------------------
 		// private methods
 		//--------------------------------------
 		void setAttributesOfAllSections	(LLVector3* inScale = NULL);
+		void queueBatchUpdate();
+		void setupSolverInput(LLFlexibleSolverInput& input);
 
 		void remapSections(LLFlexibleObjectSection *source, S32 source_sections,
 										 LLFlexibleObjectSection *dest, S32 dest_sections);
@@ -148,6 +148,11 @@ public:
 		// Global setting for update rate
 		static F32					sUpdateFactor;
 
+	private:
+		typedef std::vector<LLVolumeImplFlexible*> batch_queue_t;
+		static batch_queue_t		sBatchQueue;
+		static LLFlexibleSolverBatch sSolverBatch;
+
 };// end of class definition
 
 
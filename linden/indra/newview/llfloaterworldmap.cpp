@@ -1680,28 +1680,20 @@ void LLFloaterWorldMap::onCommitSearchResult(LLUICtrl*, void* userdata)
 	}
 	LLStringUtil::toLower(sim_name);
 
-	std::map<U64, LLSimInfo*>::const_iterator it;
-	for (it = LLWorldMap::getInstance()->mSimInfoMap.begin(); it != LLWorldMap::getInstance()->mSimInfoMap.end(); ++it)
+	LLSimInfo* info = LLWorldMap::getInstance()->simInfoFromName(sim_name);
+	if (info)
 	{
-		LLSimInfo* info = (*it).second;
-		std::string info_sim_name = info->mName;
-		LLStringUtil::toLower(info_sim_name);
+		LLVector3d pos_global = from_region_handle( info->mHandle );
+		F64 local_x = self->childGetValue("spin x");
+		F64 local_y = self->childGetValue("spin y");
+		F64 local_z = self->childGetValue("spin z");
+		pos_global.mdV[VX] += local_x;
+		pos_global.mdV[VY] += local_y;
+		pos_global.mdV[VZ] = local_z;
 
-		if (sim_name == info_sim_name)
-		{
-			LLVector3d pos_global = from_region_handle( info->mHandle );
-			F64 local_x = self->childGetValue("spin x");
-			F64 local_y = self->childGetValue("spin y");
-			F64 local_z = self->childGetValue("spin z");
-			pos_global.mdV[VX] += local_x;
-			pos_global.mdV[VY] += local_y;
-			pos_global.mdV[VZ] = local_z;
-
-			self->childSetValue("location", sim_name);
-			self->trackLocation(pos_global);
-			self->setDefaultBtn("Teleport");
-			break;
-		}
+		self->childSetValue("location", sim_name);
+		self->trackLocation(pos_global);
+		self->setDefaultBtn("Teleport");
 	}
 
 	onShowTargetBtn(self);
@@ -68,6 +68,7 @@ F32 HUD_TEXT_MAX_WIDTH = 190.f;
 const F32 HUD_TEXT_MAX_WIDTH_NO_BUBBLE = 1000.f;
 const F32 RESIZE_TIME = 0.f;
 const S32 NUM_OVERLAP_ITERATIONS = 10;
+const F32 OVERLAP_GRID_CELL_SIZE = 128.f;
 const F32 NEIGHBOR_FORCE_FRACTION = 1.f;
 const F32 POSITION_DAMPING_TC = 0.2f;
 const F32 MAX_STABLE_CAMERA_VELOCITY = 0.1f;
@@ -80,6 +81,132 @@ std::vector<LLPointer<LLHUDText> > LLHUDText::sVisibleTextObjects;
 std::vector<LLPointer<LLHUDText> > LLHUDText::sVisibleHUDTextObjects;
 BOOL LLHUDText::sDisplayText = TRUE ;
 
+// Screen-space bins for the bubbles in LLHUDText::sVisibleTextObjects,
+// by index. Only bubbles sharing a cell can overlap.
+class LLHUDTextOverlapGrid
+{
+public:
+	LLHUDTextOverlapGrid(S32 width, S32 height) :
+		mWidth(width),
+		mHeight(height),
+		mCells(width * height)
+	{
+	}
+
+	// Empties the cells but keeps their storage for the next pass
+	void clear()
+	{
+		for (std::vector<std::vector<S32> >::iterator cell_it = mCells.begin(); cell_it != mCells.end(); ++cell_it)
+		{
+			cell_it->clear();
+		}
+		mRanges.clear();
+	}
+
+	void insert(S32 index, const LLRectf& rect)
+	{
+		if (index >= (S32)mRanges.size())
+		{
+			mRanges.resize(index + 1);
+		}
+		LLRect& range = mRanges[index];
+		getCellRange(rect, range);
+		for (S32 y = range.mBottom; y <= range.mTop; y++)
+		{
+			for (S32 x = range.mLeft; x <= range.mRight; x++)
+			{
+				mCells[y * mWidth + x].push_back(index);
+			}
+		}
+	}
+
+	// Every pair of bubbles sharing a cell, in ascending order
+	void getPairs(std::vector<std::pair<S32, S32> >& pairs) const
+	{
+		for (std::vector<std::vector<S32> >::const_iterator cell_it = mCells.begin(); cell_it != mCells.end(); ++cell_it)
+		{
+			const std::vector<S32>& cell = *cell_it;
+			for (U32 a = 0; a < cell.size(); a++)
+			{
+				for (U32 b = a + 1; b < cell.size(); b++)
+				{
+					pairs.push_back(std::make_pair(cell[a], cell[b]));
+				}
+			}
+		}
+
+		// Bubbles spanning several cells show up more than once
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+	}
+
+	// Re-bins a bubble that has moved to rect, appending a pair for each
+	// bubble it meets in the cells it has just entered
+	void move(S32 index, const LLRectf& rect, std::vector<std::pair<S32, S32> >& pairs)
+	{
+		LLRect old_range = mRanges[index];
+		LLRect& range = mRanges[index];
+		getCellRange(rect, range);
+		if (range == old_range)
+		{
+			return;
+		}
+
+		for (S32 y = old_range.mBottom; y <= old_range.mTop; y++)
+		{
+			for (S32 x = old_range.mLeft; x <= old_range.mRight; x++)
+			{
+				if (!inRange(range, x, y))
+				{
+					std::vector<S32>& cell = mCells[y * mWidth + x];
+					cell.erase(std::find(cell.begin(), cell.end(), index));
+				}
+			}
+		}
+
+		std::vector<std::pair<S32, S32> > met;
+		for (S32 y = range.mBottom; y <= range.mTop; y++)
+		{
+			for (S32 x = range.mLeft; x <= range.mRight; x++)
+			{
+				if (!inRange(old_range, x, y))
+				{
+					std::vector<S32>& cell = mCells[y * mWidth + x];
+					for (std::vector<S32>::iterator it = cell.begin(); it != cell.end(); ++it)
+					{
+						met.push_back(std::make_pair(llmin(index, *it), llmax(index, *it)));
+					}
+					cell.push_back(index);
+				}
+			}
+		}
+		std::sort(met.begin(), met.end());
+		met.erase(std::unique(met.begin(), met.end()), met.end());
+		pairs.insert(pairs.end(), met.begin(), met.end());
+	}
+
+private:
+	// Cell ranges are inclusive on all four sides, unlike LLRect::pointInRect()
+	static bool inRange(const LLRect& range, S32 x, S32 y)
+	{
+		return range.mLeft <= x && x <= range.mRight
+			&& range.mBottom <= y && y <= range.mTop;
+	}
+
+	void getCellRange(const LLRectf& rect, LLRect& range) const
+	{
+		range.mLeft = llclamp(llfloor(rect.mLeft / OVERLAP_GRID_CELL_SIZE), 0, mWidth - 1);
+		range.mRight = llclamp(llfloor(rect.mRight / OVERLAP_GRID_CELL_SIZE), 0, mWidth - 1);
+		range.mBottom = llclamp(llfloor(rect.mBottom / OVERLAP_GRID_CELL_SIZE), 0, mHeight - 1);
+		range.mTop = llclamp(llfloor(rect.mTop / OVERLAP_GRID_CELL_SIZE), 0, mHeight - 1);
+	}
+
+	S32 mWidth;
+	S32 mHeight;
+	std::vector<std::vector<S32> > mCells;
+	std::vector<LLRect> mRanges;	// cells each bubble is binned in, inclusive
+};
+
 bool lltextobject_further_away::operator()(const LLPointer<LLHUDText>& lhs, const LLPointer<LLHUDText>& rhs) const
 {
 	return (lhs->getDistance() > rhs->getDistance()) ? true : false;
@@ -983,71 +1110,52 @@ void LLHUDText::updateAll()
 		return;
 	}
 
-	VisibleTextObjectIterator src_it;
-
+	S32 grid_width = llmax(1, llceil((F32)gViewerWindow->getWindowDisplayWidth() / OVERLAP_GRID_CELL_SIZE));
+	S32 grid_height = llmax(1, llceil((F32)gViewerWindow->getWindowDisplayHeight() / OVERLAP_GRID_CELL_SIZE));
+	LLHUDTextOverlapGrid grid(grid_width, grid_height);
+	std::vector<std::pair<S32, S32> > pairs;
 	for (S32 i = 0; i < NUM_OVERLAP_ITERATIONS; i++)
 	{
-		for (src_it = sVisibleTextObjects.begin(); src_it != sVisibleTextObjects.end(); ++src_it)
+		// Only bubbles sharing a grid cell can overlap. Resolve them in the
+		// order the all-pairs loop would visit them, re-binning each bubble
+		// that gets pushed so the neighbours it lands next to are checked
+		// later in the same pass.
+		grid.clear();
+		for (S32 j = 0; j < (S32)sVisibleTextObjects.size(); j++)
 		{
-			LLHUDText* src_textp = (*src_it);
-
-			if (!src_textp->mUseBubble)
+			if (sVisibleTextObjects[j]->mUseBubble)
 			{
-				continue;
+				grid.insert(j, sVisibleTextObjects[j]->mSoftScreenRect);
 			}
-			VisibleTextObjectIterator dst_it = src_it;
-			++dst_it;
-			for (; dst_it != sVisibleTextObjects.end(); ++dst_it)
-			{
-				LLHUDText* dst_textp = (*dst_it);
+		}
+		pairs.clear();
+		grid.getPairs(pairs);
 
-				if (!dst_textp->mUseBubble)
-				{
-					continue;
-				}
-				if (src_textp->mSoftScreenRect.rectInRect(&dst_textp->mSoftScreenRect))
+		// A bubble bounced between cells could keep adding pairs; stop
+		// re-binning past this and leave the rest to the next pass
+		U32 max_pairs = pairs.size() * 2 + sVisibleTextObjects.size();
+
+		BOOL any_overlap = FALSE;
+		for (U32 p = 0; p < pairs.size(); p++)
+		{
+			S32 src = pairs[p].first;
+			S32 dst = pairs[p].second;
+			if (resolveOverlap(sVisibleTextObjects[src], sVisibleTextObjects[dst]))
+			{
+				any_overlap = TRUE;
+				if (pairs.size() < max_pairs)
 				{
-					LLRectf intersect_rect = src_textp->mSoftScreenRect;
-					intersect_rect.intersectWith(dst_textp->mSoftScreenRect);
-					intersect_rect.stretch(-BUFFER_SIZE * 0.5f);
-					
-					F32 src_center_x = src_textp->mSoftScreenRect.getCenterX();
-					F32 src_center_y = src_textp->mSoftScreenRect.getCenterY();
-					F32 dst_center_x = dst_textp->mSoftScreenRect.getCenterX();
-					F32 dst_center_y = dst_textp->mSoftScreenRect.getCenterY();
-					F32 intersect_center_x = intersect_rect.getCenterX();
-					F32 intersect_center_y = intersect_rect.getCenterY();
-					LLVector2 force = lerp(LLVector2(dst_center_x - intersect_center_x, dst_center_y - intersect_center_y), 
-										LLVector2(intersect_center_x - src_center_x, intersect_center_y - src_center_y),
-										0.5f);
-					force.setVec(dst_center_x - src_center_x, dst_center_y - src_center_y);
-					force.normVec();
-
-					LLVector2 src_force = -1.f * force;
-					LLVector2 dst_force = force;
-
-					LLVector2 force_strength;
-					F32 src_mult = dst_textp->mMass / (dst_textp->mMass + src_textp->mMass); 
-					F32 dst_mult = 1.f - src_mult;
-					F32 src_aspect_ratio = src_textp->mSoftScreenRect.getWidth() / src_textp->mSoftScreenRect.getHeight();
-					F32 dst_aspect_ratio = dst_textp->mSoftScreenRect.getWidth() / dst_textp->mSoftScreenRect.getHeight();
-					src_force.mV[VY] *= src_aspect_ratio;
-					src_force.normVec();
-					dst_force.mV[VY] *= dst_aspect_ratio;
-					dst_force.normVec();
-
-					src_force.mV[VX] *= llmin(intersect_rect.getWidth() * src_mult, intersect_rect.getHeight() * SPRING_STRENGTH);
-					src_force.mV[VY] *= llmin(intersect_rect.getHeight() * src_mult, intersect_rect.getWidth() * SPRING_STRENGTH);
-					dst_force.mV[VX] *=  llmin(intersect_rect.getWidth() * dst_mult, intersect_rect.getHeight() * SPRING_STRENGTH);
-					dst_force.mV[VY] *=  llmin(intersect_rect.getHeight() * dst_mult, intersect_rect.getWidth() * SPRING_STRENGTH);
-					
-					src_textp->mTargetPositionOffset += src_force;
-					dst_textp->mTargetPositionOffset += dst_force;
-					src_textp->mTargetPositionOffset = src_textp->updateScreenPos(src_textp->mTargetPositionOffset);
-					dst_textp->mTargetPositionOffset = dst_textp->updateScreenPos(dst_textp->mTargetPositionOffset);
+					grid.move(src, sVisibleTextObjects[src]->mSoftScreenRect, pairs);
+					grid.move(dst, sVisibleTextObjects[dst]->mSoftScreenRect, pairs);
 				}
 			}
 		}
+
+		if (!any_overlap)
+		{
+			// Settled; further iterations would do nothing
+			break;
+		}
 	}
 
 	VisibleTextObjectIterator this_object_it;
@@ -1061,6 +1169,55 @@ void LLHUDText::updateAll()
 	}
 }
 
+//static
+BOOL LLHUDText::resolveOverlap(LLHUDText* src_textp, LLHUDText* dst_textp)
+{
+	if (!src_textp->mSoftScreenRect.rectInRect(&dst_textp->mSoftScreenRect))
+	{
+		return FALSE;
+	}
+
+	LLRectf intersect_rect = src_textp->mSoftScreenRect;
+	intersect_rect.intersectWith(dst_textp->mSoftScreenRect);
+	intersect_rect.stretch(-BUFFER_SIZE * 0.5f);
+	
+	F32 src_center_x = src_textp->mSoftScreenRect.getCenterX();
+	F32 src_center_y = src_textp->mSoftScreenRect.getCenterY();
+	F32 dst_center_x = dst_textp->mSoftScreenRect.getCenterX();
+	F32 dst_center_y = dst_textp->mSoftScreenRect.getCenterY();
+	F32 intersect_center_x = intersect_rect.getCenterX();
+	F32 intersect_center_y = intersect_rect.getCenterY();
+	LLVector2 force = lerp(LLVector2(dst_center_x - intersect_center_x, dst_center_y - intersect_center_y), 
+						LLVector2(intersect_center_x - src_center_x, intersect_center_y - src_center_y),
+						0.5f);
+	force.setVec(dst_center_x - src_center_x, dst_center_y - src_center_y);
+	force.normVec();
+
+	LLVector2 src_force = -1.f * force;
+	LLVector2 dst_force = force;
+
+	LLVector2 force_strength;
+	F32 src_mult = dst_textp->mMass / (dst_textp->mMass + src_textp->mMass); 
+	F32 dst_mult = 1.f - src_mult;
+	F32 src_aspect_ratio = src_textp->mSoftScreenRect.getWidth() / src_textp->mSoftScreenRect.getHeight();
+	F32 dst_aspect_ratio = dst_textp->mSoftScreenRect.getWidth() / dst_textp->mSoftScreenRect.getHeight();
+	src_force.mV[VY] *= src_aspect_ratio;
+	src_force.normVec();
+	dst_force.mV[VY] *= dst_aspect_ratio;
+	dst_force.normVec();
+
+	src_force.mV[VX] *= llmin(intersect_rect.getWidth() * src_mult, intersect_rect.getHeight() * SPRING_STRENGTH);
+	src_force.mV[VY] *= llmin(intersect_rect.getHeight() * src_mult, intersect_rect.getWidth() * SPRING_STRENGTH);
+	dst_force.mV[VX] *=  llmin(intersect_rect.getWidth() * dst_mult, intersect_rect.getHeight() * SPRING_STRENGTH);
+	dst_force.mV[VY] *=  llmin(intersect_rect.getHeight() * dst_mult, intersect_rect.getWidth() * SPRING_STRENGTH);
+	
+	src_textp->mTargetPositionOffset += src_force;
+	dst_textp->mTargetPositionOffset += dst_force;
+	src_textp->mTargetPositionOffset = src_textp->updateScreenPos(src_textp->mTargetPositionOffset);
+	dst_textp->mTargetPositionOffset = dst_textp->updateScreenPos(dst_textp->mTargetPositionOffset);
+	return TRUE;
+}
+
 void LLHUDText::setLOD(S32 lod)
 {
 	mLOD = lod;
@@ -143,6 +143,8 @@ protected:
 	/*virtual*/ void renderForSelect();
 	void renderText(BOOL for_select);
 	static void updateAll();
+	// Pushes two overlapping bubbles apart; returns FALSE if they don't overlap
+	static BOOL resolveOverlap(LLHUDText* src_textp, LLHUDText* dst_textp);
 	void setLOD(S32 lod);
 	S32 getMaxLines();
 
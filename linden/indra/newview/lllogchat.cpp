@@ -35,9 +35,364 @@
 #include "lllogchat.h"
 #include "llappviewer.h"
 #include "llfloaterchat.h"
+#include "lllogindex.h"
+#include "llthread.h"
+#include "lltimer.h"
 
 const S32 LOG_RECALL_SIZE = 2048;
 
+// How long the writer lets a burst of lines collect before writing it out
+const U32 WRITE_BATCH_DELAY_MS = 250;
+// Open log handles are closed after this long without a write
+const F64 IDLE_CLOSE_TIME = 30.0;
+const U32 MAX_OPEN_FILES = 16;
+
+// Logs are opened in binary mode and every writer appends this, so a line
+// ends the same way whichever path wrote it. Windows keeps the CRLF that
+// text mode used to produce; readers strip the '\r'.
+#if LL_WINDOWS
+const char LOG_EOL[] = "\r\n";
+#else
+const char LOG_EOL[] = "\n";
+#endif
+const U32 LOG_EOL_LENGTH = sizeof(LOG_EOL) - 1;
+
+//============================================================================
+// Background writer
+//
+// saveHistory() only queues the line. The writer keeps the most recently
+// used logs open, appends each batch with one flush per file and then
+// extends the LLLogIndex, so a crash loses at most the batch in flight and
+// never leaves the index pointing past the log. While any log is open the
+// thread keeps waking every WRITE_BATCH_DELAY_MS to close idle handles.
+
+class LLLogChatWriter : public LLThread
+{
+public:
+	LLLogChatWriter(bool threaded);
+	~LLLogChatWriter();
+
+	// MAIN THREAD
+	void queueLine(const std::string& log_path, const std::string& line);
+
+	// Any thread. Writes out everything queued so far.
+	void writePending();
+
+	// Any thread. Closes logs not written to for IDLE_CLOSE_TIME.
+	void closeIdle();
+
+	// Held around all log and index file access
+	LLMutex* getIOMutex() { return &mIOMutex; }
+
+private:
+	struct PendingLine
+	{
+		std::string mPath;
+		std::string mLine;
+		U32 mTime;
+	};
+
+	struct LogFile
+	{
+		LLFILE* mLog;
+		LLFILE* mIndex;		// NULL if the index can not be kept
+		U32 mEnd;
+		U32 mLastTime;
+		F64 mLastUsed;
+		std::vector<LLLogIndex::Record> mRecords; // written on flush
+	};
+	typedef std::map<std::string, LogFile> file_map_t;
+
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition() { return !mPending.empty() || mHasOpenFiles; }
+
+	// mIOMutex must be locked for these
+	LogFile* getFile(const std::string& log_path);
+	void flushFile(LogFile& file);
+	void closeIdleFiles(F64 now, bool all);
+
+	bool mThreaded;
+	std::vector<PendingLine> mPending;	// guarded by lockData()
+	LLMutex mIOMutex;
+	file_map_t mFiles;
+	volatile bool mHasOpenFiles;	// !mFiles.empty(), readable without mIOMutex
+	LLTimer mTimer;
+};
+
+static LLLogChatWriter* sWriter = NULL;
+
+// Keeps the writer away from the files while they are read
+class LLLogChatIOLock
+{
+public:
+	LLLogChatIOLock() : mMutex(sWriter ? sWriter->getIOMutex() : NULL)
+	{
+		if (mMutex)
+		{
+			sWriter->writePending();
+			mMutex->lock();
+		}
+	}
+	~LLLogChatIOLock()
+	{
+		if (mMutex)
+		{
+			mMutex->unlock();
+		}
+	}
+private:
+	LLMutex* mMutex;
+};
+
+LLLogChatWriter::LLLogChatWriter(bool threaded) :
+	LLThread("Chat log writer"),
+	mThreaded(threaded),
+	mIOMutex(NULL),
+	mHasOpenFiles(false)
+{
+	if (mThreaded)
+	{
+		start();
+	}
+}
+
+LLLogChatWriter::~LLLogChatWriter()
+{
+	setQuitting();
+	if (mThreaded)
+	{
+		S32 timeout = 100;
+		for ( ; timeout > 0; timeout--)
+		{
+			if (isStopped())
+			{
+				break;
+			}
+			ms_sleep(100);
+			LLThread::yield();
+		}
+		if (timeout == 0)
+		{
+			llwarns << "~LLLogChatWriter timed out!" << llendl;
+		}
+	}
+
+	writePending();
+	LLMutexLock lock(&mIOMutex);
+	closeIdleFiles(0.0, true);
+	// ~LLThread() will be called here
+}
+
+void LLLogChatWriter::queueLine(const std::string& log_path, const std::string& line)
+{
+	PendingLine pending;
+	pending.mPath = log_path;
+	pending.mLine = line;
+	pending.mTime = (U32)time_corrected();
+
+	lockData();
+	mPending.push_back(pending);
+	unlockData();
+
+	if (mThreaded && !isStopped())
+	{
+		wake();
+	}
+	else
+	{
+		writePending();
+	}
+}
+
+void LLLogChatWriter::run()
+{
+	while (!isQuitting())
+	{
+		checkPause();
+		if (isQuitting())
+		{
+			break;
+		}
+		ms_sleep(WRITE_BATCH_DELAY_MS);
+		writePending();
+		closeIdle();
+	}
+	writePending();
+}
+
+void LLLogChatWriter::writePending()
+{
+	// Take the queue under mIOMutex so batches reach the files in order
+	LLMutexLock lock(&mIOMutex);
+
+	std::vector<PendingLine> pending;
+	lockData();
+	pending.swap(mPending);
+	unlockData();
+
+	F64 now = mTimer.getElapsedTimeF64();
+
+	// By path: getFile() may evict (flush and close) a log written earlier
+	// in this batch, so look each one up again before flushing it
+	std::set<std::string> written;
+	for (std::vector<PendingLine>::iterator iter = pending.begin();
+		 iter != pending.end(); ++iter)
+	{
+		LogFile* file = getFile(iter->mPath);
+		if (!file)
+		{
+			continue;
+		}
+		fputs(iter->mLine.c_str(), file->mLog);
+		fputs(LOG_EOL, file->mLog);
+		file->mLastUsed = now;
+		written.insert(iter->mPath);
+
+		if (file->mIndex)
+		{
+			file->mEnd += (U32)iter->mLine.size() + LOG_EOL_LENGTH;
+			file->mLastTime = llmax(file->mLastTime, iter->mTime);
+			LLLogIndex::Record rec;
+			rec.mEnd = file->mEnd;
+			rec.mTime = file->mLastTime;
+			file->mRecords.push_back(rec);
+		}
+	}
+
+	for (std::set<std::string>::iterator iter = written.begin();
+		 iter != written.end(); ++iter)
+	{
+		file_map_t::iterator found = mFiles.find(*iter);
+		if (found != mFiles.end())
+		{
+			flushFile(found->second);
+		}
+	}
+
+	closeIdleFiles(now, false);
+}
+
+void LLLogChatWriter::closeIdle()
+{
+	LLMutexLock lock(&mIOMutex);
+	closeIdleFiles(mTimer.getElapsedTimeF64(), false);
+}
+
+LLLogChatWriter::LogFile* LLLogChatWriter::getFile(const std::string& log_path)
+{
+	file_map_t::iterator found = mFiles.find(log_path);
+	if (found != mFiles.end())
+	{
+		return &found->second;
+	}
+
+	if (mFiles.size() >= MAX_OPEN_FILES)
+	{
+		file_map_t::iterator oldest = mFiles.begin();
+		for (file_map_t::iterator iter = mFiles.begin(); iter != mFiles.end(); ++iter)
+		{
+			if (iter->second.mLastUsed < oldest->second.mLastUsed)
+			{
+				oldest = iter;
+			}
+		}
+		flushFile(oldest->second);
+		fclose(oldest->second.mLog);
+		if (oldest->second.mIndex)
+		{
+			fclose(oldest->second.mIndex);
+		}
+		mFiles.erase(oldest);
+		mHasOpenFiles = !mFiles.empty();
+	}
+
+	U32 end = 0;
+	U32 last_time = 0;
+	bool indexed = LLLogIndex::sync(log_path, end, last_time);
+
+	LLFILE* log = LLFile::fopen(log_path, "ab");		/*Flawfinder: ignore*/
+	if (!log)
+	{
+		llinfos << "Couldn't open chat history log!" << llendl;
+		return NULL;
+	}
+
+	LogFile& file = mFiles[log_path];
+	file.mLog = log;
+	file.mIndex = indexed ? LLFile::fopen(LLLogIndex::indexFileName(log_path), "ab") : NULL;		/*Flawfinder: ignore*/
+	file.mEnd = end;
+	file.mLastTime = last_time;
+	file.mLastUsed = 0.0;
+	mHasOpenFiles = true;
+
+	if (file.mIndex)
+	{
+		fseek(log, 0, SEEK_END);
+		long size = ftell(log);
+		if (size > (long)end)
+		{
+			// Terminate a partial line left by a crash
+			fputs(LOG_EOL, log);
+			LLLogIndex::Record rec;
+			rec.mEnd = file.mEnd = (U32)size + LOG_EOL_LENGTH;
+			rec.mTime = last_time;
+			file.mRecords.push_back(rec);
+		}
+	}
+	return &file;
+}
+
+void LLLogChatWriter::flushFile(LogFile& file)
+{
+	// Log first, so the index never covers bytes that are not on disk
+	fflush(file.mLog);
+	if (file.mIndex && !file.mRecords.empty())
+	{
+		LLLogIndex::writeRecords(file.mIndex, file.mRecords);
+		fflush(file.mIndex);
+	}
+	file.mRecords.clear();
+}
+
+void LLLogChatWriter::closeIdleFiles(F64 now, bool all)
+{
+	file_map_t::iterator iter = mFiles.begin();
+	while (iter != mFiles.end())
+	{
+		file_map_t::iterator cur = iter++;
+		LogFile& file = cur->second;
+		if (all || now - file.mLastUsed > IDLE_CLOSE_TIME)
+		{
+			flushFile(file);
+			fclose(file.mLog);
+			if (file.mIndex)
+			{
+				fclose(file.mIndex);
+			}
+			mFiles.erase(cur);
+		}
+	}
+	mHasOpenFiles = !mFiles.empty();
+}
+
+//============================================================================
+
+//static
+void LLLogChat::initClass(bool threaded)
+{
+	if (!sWriter)
+	{
+		sWriter = new LLLogChatWriter(threaded);
+	}
+}
+
+//static
+void LLLogChat::cleanupClass()
+{
+	delete sWriter;
+	sWriter = NULL;
+}
+
 //static
 std::string LLLogChat::makeLogFileName(std::string filename)
 {
@@ -92,15 +447,23 @@ void LLLogChat::saveHistory(std::string filename, std::string line)
 
 	//dont allow bad files names
 	filename = gDirUtilp->getScrubbedFileName(filename);
+	std::string log_path = LLLogChat::makeLogFileName(filename);
+
+	if (sWriter)
+	{
+		sWriter->queueLine(log_path, line);
+		return;
+	}
 
-	LLFILE* fp = LLFile::fopen(LLLogChat::makeLogFileName(filename), "a"); 		/*Flawfinder: ignore*/
+	LLFILE* fp = LLFile::fopen(log_path, "ab"); 		/*Flawfinder: ignore*/
 	if (!fp)
 	{
 		llinfos << "Couldn't open chat history log!" << llendl;
 	}
 	else
 	{
-		fprintf(fp, "%s\n", line.c_str());
+		fputs(line.c_str(), fp);
+		fputs(LOG_EOL, fp);
 		
 		fclose (fp);
 	}
@@ -116,8 +479,38 @@ void LLLogChat::loadHistory(std::string filename , void (*callback)(ELogLineType
 
 	//dont allow bad files names
 	filename = gDirUtilp->getScrubbedFileName(filename);
+	std::string log_path = makeLogFileName(filename);
+
+	LLLogChatIOLock lock;
+
+	if (!LLFile::isfile(log_path))
+	{
+		callback(LOG_EMPTY,LLStringUtil::null,userdata);
+		return;			//No previous conversation with this name.
+	}
 
-	LLFILE* fptr = LLFile::fopen(makeLogFileName(filename), "r");		/*Flawfinder: ignore*/
+	U32 end, last_time;
+	if (!LLLogIndex::sync(log_path, end, last_time))
+	{
+		loadHistoryScan(log_path, callback, userdata);
+		return;
+	}
+
+	std::vector<std::string> lines;
+	U32 start = LLLogIndex::findRecallStart(log_path, end, LOG_RECALL_SIZE);
+	LLLogIndex::readLines(log_path, start, end, lines);
+	for (std::vector<std::string>::iterator iter = lines.begin();
+		 iter != lines.end(); ++iter)
+	{
+		callback(LOG_LINE, *iter, userdata);
+	}
+	callback(LOG_END,LLStringUtil::null,userdata);
+}
+
+//static
+void LLLogChat::loadHistoryScan(const std::string& log_path, history_callback_t callback, void* userdata)
+{
+	LLFILE* fptr = LLFile::fopen(log_path, "r");		/*Flawfinder: ignore*/
 	if (!fptr)
 	{
 		//LLUIString message = LLFloaterChat::getInstance()->getString("IM_logging_string");
@@ -43,6 +43,13 @@ public:
 		LOG_LINE,
 		LOG_END
 	};
+	typedef void (*history_callback_t)(ELogLineType, std::string, void*);
+
+	// Starts the background writer. With threaded == false lines are still
+	// batched through the open-handle cache but written on the caller's thread.
+	static void initClass(bool threaded);
+	static void cleanupClass();
+
 	static std::string timestamp(bool withdate = false);
 	static std::string makeLogFileName(std::string(filename));
 	static void saveHistory(std::string filename, std::string line);
@@ -51,6 +58,7 @@ public:
 							void* userdata);
 private:
 	static std::string cleanFileName(std::string filename);
+	static void loadHistoryScan(const std::string& log_path, history_callback_t callback, void* userdata);
 };
 
 #endif
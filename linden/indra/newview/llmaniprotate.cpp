@@ -685,6 +685,13 @@ void LLManipRotate::drag( S32 x, S32 y )
 		}
 	}	
 
+	// don't stream updates on sub-object selections
+	if (gSavedSettings.getBOOL("StreamManipulatorUpdates")
+		&& !gSavedSettings.getBOOL("EditLinkedParts"))
+	{
+		LLSelectMgr::getInstance()->queueMultipleUpdate( UPD_ROTATION | UPD_POSITION );
+	}
+
 	LLSelectMgr::getInstance()->updateSelectionCenter();
 
 	// RN: just clear focus so camera doesn't follow spurious object updates
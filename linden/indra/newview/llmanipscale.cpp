@@ -799,16 +799,25 @@ void LLManipScale::renderAxisHandle( const LLVector3& start, const LLVector3& en
 
 void LLManipScale::drag( S32 x, S32 y )
 {
+	BOOL stream = gSavedSettings.getBOOL("StreamManipulatorUpdates");
 	if( (LL_FACE_MIN <= (S32)mManipPart) 
 		&& ((S32)mManipPart <= LL_FACE_MAX) )
 	{
 		dragFace( x, y );
+		if (stream)
+		{
+			sendUpdates(TRUE,TRUE,FALSE);
+		}
 	}
 	else
 	if( (LL_CORNER_MIN <= (S32)mManipPart) 
 		&& ((S32)mManipPart <= LL_CORNER_MAX) )
 	{
 		dragCorner( x, y );
+		if (stream)
+		{
+			sendUpdates(TRUE,TRUE,TRUE);
+		}
 	}
 	
 	// store changes to override updates
@@ -1199,11 +1208,6 @@ void LLManipScale::dragFace( S32 x, S32 y )
 
 void LLManipScale::sendUpdates( BOOL send_position_update, BOOL send_scale_update, BOOL corner )
 {
-	// Throttle updates to 10 per second.
-	static LLTimer	update_timer;
-	F32 elapsed_time = update_timer.getElapsedTimeF32();
-	const F32 UPDATE_DELAY = 0.1f;						//  min time between transmitted updates
-
 	if( send_scale_update || send_position_update )
 	{
 		U32 update_flags = UPD_NONE;
@@ -1218,17 +1222,14 @@ void LLManipScale::sendUpdates( BOOL send_position_update, BOOL send_scale_updat
 		// keep this up to date for sendonmouseup
 		mLastUpdateFlags = update_flags;
 
-		// enforce minimum update delay and don't stream updates on sub-object selections
-		if( elapsed_time > UPDATE_DELAY && !gSavedSettings.getBOOL("EditLinkedParts") )
-		{
-			LLSelectMgr::getInstance()->sendMultipleUpdate( update_flags );
-			update_timer.reset();
-			mSendUpdateOnMouseUp = FALSE;
-		}
-		else
+		// don't stream updates on sub-object selections; the select manager
+		// throttles the rest and merges ticks until it sends
+		if( gSavedSettings.getBOOL("StreamManipulatorUpdates")
+			&& !gSavedSettings.getBOOL("EditLinkedParts") )
 		{
-			mSendUpdateOnMouseUp = TRUE;
+			LLSelectMgr::getInstance()->queueMultipleUpdate( update_flags );
 		}
+		mSendUpdateOnMouseUp = TRUE;
 		dialog_refresh_all();
 	}
 }
@@ -784,6 +784,13 @@ BOOL LLManipTranslate::handleHover(S32 x, S32 y, MASK mask)
 		}
 	}
 
+	// don't stream updates on sub-object selections
+	if (send_update && gSavedSettings.getBOOL("StreamManipulatorUpdates")
+		&& !gSavedSettings.getBOOL("EditLinkedParts"))
+	{
+		LLSelectMgr::getInstance()->queueMultipleUpdate( UPD_POSITION );
+	}
+
 	LLSelectMgr::getInstance()->updateSelectionCenter();
 	gAgent.clearFocusObject();
 	dialog_refresh_all();		// ??? is this necessary?
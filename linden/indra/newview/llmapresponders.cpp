@@ -144,20 +144,8 @@ void LLMapLayerResponder::result(const LLSD& result)
 
 				// 			llinfos << "Map sim " << name << " image layer " << agent_flags << " ID " << image_id.getString() << llendl;
 			
-				LLSimInfo* siminfo = new LLSimInfo();
-				LLWorldMap::sim_info_map_t::iterator iter = LLWorldMap::getInstance()->mSimInfoMap.find(handle);
-				if (iter != LLWorldMap::getInstance()->mSimInfoMap.end())
-				{
-					LLSimInfo* oldinfo = iter->second;
-					for (S32 image=0; image<MAP_SIM_IMAGE_TYPES; ++image)
-					{
-						siminfo->mMapImageID[image] = oldinfo->mMapImageID[image];
-					}
-					delete oldinfo;
-				}
-				LLWorldMap::getInstance()->mSimInfoMap[handle] = siminfo;
+				LLSimInfo* siminfo = LLWorldMap::getInstance()->createSimInfoFromHandle(handle);
 
-				siminfo->mHandle = handle;
 				siminfo->mName.assign( name );
 				siminfo->mAccess = access;		/*Flawfinder: ignore*/
 				siminfo->mRegionFlags = region_flags;
@@ -208,7 +208,7 @@ LLScrollListItem* LLNameListCtrl::addElement(const LLSD& value, EAddPosition pos
 	LLScrollListCell* cell = (LLScrollListCell*)item->getColumn(mNameColumnIndex);
 	((LLScrollListText*)cell)->setText( fullname );
 
-	dirtyColumns();
+	dirtyItem(item);
 
 	// this column is resizable
 	LLScrollListColumn* columnp = getColumn(mNameColumnIndex);
@@ -84,24 +84,21 @@ const F32 DOT_SCALE = 0.75f;
 const F32 MIN_PICK_SCALE = 2.f;
 const S32 SLOP = 2;
 const S32 TRACKING_RADIUS = 3;
+const S32 MIN_LAYER_SIZE = 32;		// object layer texels per region
+const S32 MAX_LAYER_SIZE = 256;
 
 LLNetMap::LLNetMap(const std::string& name) :
 	LLPanel(name),
 	mScale(128.f),
-	mObjectMapTPM(1.f),
-	mObjectMapPixels(255.f),
 	mTargetPanX( 0.f ),
 	mTargetPanY( 0.f ),
 	mCurPanX( 0.f ),
-	mCurPanY( 0.f ),
-	mUpdateNow( FALSE )
+	mCurPanY( 0.f )
 {
 	mScale = gSavedSettings.getF32("MiniMapScale");
 	mPixelsPerMeter = mScale / LLWorld::getInstance()->getRegionWidthInMeters();
 	mDotRadius = llmax(DOT_SCALE * mPixelsPerMeter, MIN_DOT_RADIUS);
 
-	mObjectImageCenterGlobal = gAgent.getCameraPositionGlobal();
-	
 	// Register event listeners for popup menu
 	(new LLScaleMap())->registerListener(this, "MiniMap.ZoomLevel");
 	(new LLCenterMap())->registerListener(this, "MiniMap.Center");
@@ -145,22 +142,8 @@ void LLNetMap::setScale( F32 scale )
 	}
 	gSavedSettings.setF32("MiniMapScale", mScale);
 
-	if (mObjectImagep.notNull())
-	{
-		F32 width = (F32)(getRect().getWidth());
-		F32 height = (F32)(getRect().getHeight());
-		F32 diameter = sqrt(width * width + height * height);
-		F32 region_widths = diameter / mScale;
-		F32 meters = region_widths * LLWorld::getInstance()->getRegionWidthInMeters();
-		F32 num_pixels = (F32)mObjectImagep->getWidth();
-		mObjectMapTPM = num_pixels / meters;
-		mObjectMapPixels = diameter;
-	}
-
 	mPixelsPerMeter = mScale / LLWorld::getInstance()->getRegionWidthInMeters();
 	mDotRadius = llmax(DOT_SCALE * mPixelsPerMeter, MIN_DOT_RADIUS);
-
-	mUpdateNow = TRUE;
 }
 
 void LLNetMap::translatePan( F32 delta_x, F32 delta_y )
@@ -174,12 +157,14 @@ void LLNetMap::translatePan( F32 delta_x, F32 delta_y )
 
 void LLNetMap::draw()
 {
- 	static LLFrameTimer map_timer;
-
-	if (mObjectImagep.isNull())
+	// Object layers get about one texel per map pixel
+	S32 layer_size = MIN_LAYER_SIZE;
+	while ((layer_size < llround(mScale)) && (layer_size < MAX_LAYER_SIZE))
 	{
-		createObjectImage();
+		layer_size <<= 1;
 	}
+	LLNetMapLayers* layers = LLNetMapLayers::getInstance();
+	layers->update(layer_size, gSavedSettings.getS32("MiniMapUpdateBudget"));
 
 	if (gSavedSettings.getS32( "MiniMapCenter" ) != MAP_CENTER_NONE)
 	{
@@ -284,52 +269,25 @@ void LLNetMap::draw()
 				}
 			}
 			gGL.setAlphaRejectSettings(LLRender::CF_DEFAULT);
-		}
-
-		// Redraw object layer periodically
-		if (mUpdateNow || (map_timer.getElapsedTimeF32() > 0.5f))
-		{
-			mUpdateNow = FALSE;
 
-			// Locate the centre of the object layer, accounting for panning
-			LLVector3 new_center = globalPosToView(gAgent.getCameraPositionGlobal(), rotate_map);	
-			new_center.mV[0] -= mCurPanX;
-			new_center.mV[1] -= mCurPanY;
-			new_center.mV[2] = 0.f;
-			mObjectImageCenterGlobal = viewPosToGlobal(llround(new_center.mV[0]), llround(new_center.mV[1]), rotate_map);
-
-			// Create the base texture.
-			U8 *default_texture = mObjectRawImagep->getData();
-			memset( default_texture, 0, mObjectImagep->getWidth() * mObjectImagep->getHeight() * mObjectImagep->getComponents() );
-
-			// Draw objects
-			gObjectList.renderObjectsForMap(*this);
-
-			mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, mObjectImagep->getWidth(), mObjectImagep->getHeight());
-			
-			map_timer.reset();
+			// Draw object footprints
+			LLImageGL* footprints = layers->getLayerImage(regionp->getHandle());
+			if (footprints)
+			{
+				gGL.getTexUnit(0)->bind(footprints);
+				gGL.begin(LLRender::QUADS);
+					gGL.texCoord2f(0.f, 1.f);
+					gGL.vertex2f(left, top);
+					gGL.texCoord2f(0.f, 0.f);
+					gGL.vertex2f(left, bottom);
+					gGL.texCoord2f(1.f, 0.f);
+					gGL.vertex2f(right, bottom);
+					gGL.texCoord2f(1.f, 1.f);
+					gGL.vertex2f(right, top);
+				gGL.end();
+			}
 		}
 
-		LLVector3 map_center_agent = gAgent.getPosAgentFromGlobal(mObjectImageCenterGlobal);
-		map_center_agent -= gAgent.getCameraPositionAgent();
-		map_center_agent.mV[VX] *= mScale/region_width;
-		map_center_agent.mV[VY] *= mScale/region_width;
-
-		gGL.getTexUnit(0)->bind(mObjectImagep);
-		F32 image_half_width = 0.5f*mObjectMapPixels;
-		F32 image_half_height = 0.5f*mObjectMapPixels;
-
-		gGL.begin(LLRender::QUADS);
-			gGL.texCoord2f(0.f, 1.f);
-			gGL.vertex2f(map_center_agent.mV[VX] - image_half_width, image_half_height + map_center_agent.mV[VY]);
-			gGL.texCoord2f(0.f, 0.f);
-			gGL.vertex2f(map_center_agent.mV[VX] - image_half_width, map_center_agent.mV[VY] - image_half_height);
-			gGL.texCoord2f(1.f, 0.f);
-			gGL.vertex2f(image_half_width + map_center_agent.mV[VX], map_center_agent.mV[VY] - image_half_height);
-			gGL.texCoord2f(1.f, 1.f);
-			gGL.vertex2f(image_half_width + map_center_agent.mV[VX], image_half_height + map_center_agent.mV[VY]);
-		gGL.end();
-
 		gGL.popMatrix();
 
 		LLVector3d pos_global;
@@ -700,129 +658,292 @@ void LLNetMap::updateMinorDirections()
 	getChild<LLTextBox>("se_label")->setVisible(show_minors);
 }
 
-void LLNetMap::renderScaledPointGlobal( const LLVector3d& pos, const LLColor4U &color, F32 radius_meters )
+///////////////////////////////////////////////////////////////////////////////////
+// LLNetMapLayers
+
+LLNetMapLayers::LLNetMapLayers()
+:	mTexelsPerRegion(0),
+	mMaxRadius(256.f)
+{
+}
+
+void LLNetMapLayers::markDirty(LLViewerObject* objectp)
 {
-	LLVector3 local_pos;
-	local_pos.setVec( pos - mObjectImageCenterGlobal );
+	if (objectp->isOnMap())
+	{
+		mDirtyObjects.insert(objectp);
+	}
 
-	S32 diameter_pixels = llround(2 * radius_meters * mObjectMapTPM);
-	renderPoint( local_pos, color, diameter_pixels );
+	// Children only get updates of their own when they change relative
+	// to the parent, so their footprints move with it.
+	LLViewerObject::const_child_list_t& children = objectp->getChildren();
+	for (LLViewerObject::child_list_t::const_iterator iter = children.begin();
+		 iter != children.end(); ++iter)
+	{
+		LLViewerObject* childp = *iter;
+		if (childp->isOnMap())
+		{
+			mDirtyObjects.insert(childp);
+		}
+	}
 }
 
+void LLNetMapLayers::removeObject(LLViewerObject* objectp)
+{
+	mDirtyObjects.erase(objectp);
+	eraseFootprint(objectp);
+}
 
-void LLNetMap::renderPoint(const LLVector3 &pos_local, const LLColor4U &color, 
-						   S32 diameter, S32 relative_height)
+void LLNetMapLayers::clear()
 {
-	if (diameter <= 0)
+	mDirtyObjects.clear();
+	mObjectRegions.clear();
+	mLayers.clear();
+}
+
+void LLNetMapLayers::update(S32 texels_per_region, S32 budget)
+{
+	if (texels_per_region != mTexelsPerRegion)
 	{
-		return;
+		mTexelsPerRegion = texels_per_region;
+		for (layer_map_t::iterator iter = mLayers.begin(); iter != mLayers.end(); ++iter)
+		{
+			iter->second.mNeedsRebuild = TRUE;
+		}
+	}
+
+	budget = llmax(budget, 1);
+	S32 work = 0;
+	if (!mDirtyObjects.empty())
+	{
+		updateColors();
+		while (!mDirtyObjects.empty() && (work < budget))
+		{
+			LLPointer<LLViewerObject> objectp = *mDirtyObjects.begin();
+			mDirtyObjects.erase(mDirtyObjects.begin());
+			updateFootprint(objectp);
+			work++;
+		}
+	}
+
+	// Always rebuild at least one layer per frame so a region with more
+	// footprints than the budget still gets redrawn.
+	BOOL rebuilt = FALSE;
+	for (layer_map_t::iterator iter = mLayers.begin(); iter != mLayers.end(); )
+	{
+		Layer& layer = iter->second;
+		if (layer.mFootprints.empty())
+		{
+			mLayers.erase(iter++);
+			continue;
+		}
+
+		if (layer.mNeedsRebuild && (!rebuilt || (work < budget)))
+		{
+			work += rebuildLayer(layer);
+			rebuilt = TRUE;
+		}
+
+		if (layer.mNeedsUpload)
+		{
+			layer.mImagep->setSubImage(layer.mRawImagep, 0, 0, layer.mSize, layer.mSize);
+			layer.mNeedsUpload = FALSE;
+		}
+		++iter;
 	}
+}
 
-	const S32 image_width = (S32)mObjectImagep->getWidth();
-	const S32 image_height = (S32)mObjectImagep->getHeight();
+LLImageGL* LLNetMapLayers::getLayerImage(U64 region_handle) const
+{
+	layer_map_t::const_iterator iter = mLayers.find(region_handle);
+	if (iter == mLayers.end())
+	{
+		return NULL;
+	}
+	return iter->second.mImagep;
+}
 
-	S32 x_offset = llround(pos_local.mV[VX] * mObjectMapTPM + image_width / 2);
-	S32 y_offset = llround(pos_local.mV[VY] * mObjectMapTPM + image_height / 2);
+void LLNetMapLayers::updateColors()
+{
+	mAboveWaterColor = gColors.getColor("NetMapOtherOwnAboveWater");
+	mBelowWaterColor = gColors.getColor("NetMapOtherOwnBelowWater");
+	mYouOwnAboveWaterColor = gColors.getColor("NetMapYouOwnAboveWater");
+	mYouOwnBelowWaterColor = gColors.getColor("NetMapYouOwnBelowWater");
+	mGroupOwnAboveWaterColor = gColors.getColor("NetMapGroupOwnAboveWater");
+	mGroupOwnBelowWaterColor = gColors.getColor("NetMapGroupOwnBelowWater");
+	mMaxRadius = gSavedSettings.getF32("MiniMapPrimMaxRadius");
+}
 
-	if ((x_offset < 0) || (x_offset >= image_width))
+void LLNetMapLayers::updateFootprint(LLViewerObject* objectp)
+{
+	U64 region_handle;
+	Footprint footprint;
+	if (!computeFootprint(objectp, region_handle, footprint))
 	{
+		eraseFootprint(objectp);
 		return;
 	}
-	if ((y_offset < 0) || (y_offset >= image_height))
+	computeRect(footprint);
+
+	std::map<LLViewerObject*, U64>::iterator found = mObjectRegions.find(objectp);
+	if ((found != mObjectRegions.end()) && (found->second != region_handle))
+	{
+		// Crossed into another region
+		eraseFootprint(objectp);
+		found = mObjectRegions.end();
+	}
+
+	Layer& layer = mLayers[region_handle];
+	if (found == mObjectRegions.end())
 	{
+		// New footprints can go straight on top of the layer
+		mObjectRegions[objectp] = region_handle;
+		layer.mFootprints[objectp] = footprint;
+		if (!layer.mNeedsRebuild)
+		{
+			plotFootprint(layer, footprint);
+			layer.mNeedsUpload = TRUE;
+		}
 		return;
 	}
 
-	U8 *datap = mObjectRawImagep->getData();
+	Footprint& old_footprint = layer.mFootprints[objectp];
+	BOOL unchanged = (old_footprint.mLeft == footprint.mLeft)
+					&& (old_footprint.mBottom == footprint.mBottom)
+					&& (old_footprint.mRight == footprint.mRight)
+					&& (old_footprint.mTop == footprint.mTop)
+					&& (old_footprint.mColor.mAll == footprint.mColor.mAll);
+	old_footprint = footprint;
+	if (!unchanged)
+	{
+		// Whatever the old footprint covered has to be redrawn
+		layer.mNeedsRebuild = TRUE;
+	}
+}
 
-	S32 neg_radius = diameter / 2;
-	S32 pos_radius = diameter - neg_radius;
-	S32 x, y;
+void LLNetMapLayers::eraseFootprint(LLViewerObject* objectp)
+{
+	std::map<LLViewerObject*, U64>::iterator found = mObjectRegions.find(objectp);
+	if (found == mObjectRegions.end())
+	{
+		return;
+	}
+
+	layer_map_t::iterator layer_iter = mLayers.find(found->second);
+	if (layer_iter != mLayers.end())
+	{
+		layer_iter->second.mFootprints.erase(objectp);
+		layer_iter->second.mNeedsRebuild = TRUE;
+	}
+	mObjectRegions.erase(found);
+}
 
-	if (relative_height > 0)
+BOOL LLNetMapLayers::computeFootprint(LLViewerObject* objectp, U64& region_handle, Footprint& footprint) const
+{
+	LLViewerRegion* regionp = objectp->getRegion();
+	if (objectp->isDead() || !regionp || objectp->isOrphaned() || objectp->isAttachment()
+		|| !objectp->isOnMap())
 	{
-		// ...point above agent
-		S32 px, py;
+		return FALSE;
+	}
+
+	const LLVector3& scale = objectp->getScale();
+	const LLVector3& pos = objectp->getPositionRegion();
+	const F32 water_height = regionp->getWaterHeight();
+
+	F32 approx_radius = (scale.mV[VX] + scale.mV[VY]) * 0.5f * 0.5f * 1.3f;  // 1.3 is a fudge
 
-		// vertical line
-		px = x_offset;
-		for (y = -neg_radius; y < pos_radius; y++)
+	// DEV-17370 - megaprims of size > 4096 cause lag.  (go figger.)
+	approx_radius = llmin(approx_radius, mMaxRadius);
+
+	LLColor4U color = mAboveWaterColor;
+	if (objectp->permYouOwner())
+	{
+		const F32 MIN_RADIUS_FOR_OWNED_OBJECTS = 2.f;
+		if (approx_radius < MIN_RADIUS_FOR_OWNED_OBJECTS)
 		{
-			py = y_offset + y;
-			if ((py < 0) || (py >= image_height))
-			{
-				continue;
-			}
-			S32 offset = px + py * image_width;
-			((U32*)datap)[offset] = color.mAll;
+			approx_radius = MIN_RADIUS_FOR_OWNED_OBJECTS;
 		}
 
-		// top line
-		py = y_offset + pos_radius - 1;
-		for (x = -neg_radius; x < pos_radius; x++)
+		if (pos.mV[VZ] >= water_height)
 		{
-			px = x_offset + x;
-			if ((px < 0) || (px >= image_width))
-			{
-				continue;
-			}
-			S32 offset = px + py * image_width;
-			((U32*)datap)[offset] = color.mAll;
+			color = objectp->permGroupOwner() ? mGroupOwnAboveWaterColor : mYouOwnAboveWaterColor;
+		}
+		else
+		{
+			color = objectp->permGroupOwner() ? mGroupOwnBelowWaterColor : mYouOwnBelowWaterColor;
 		}
 	}
-	else
+	else if (pos.mV[VZ] < water_height)
 	{
-		// ...point level with agent
-		for (x = -neg_radius; x < pos_radius; x++)
-		{
-			S32 p_x = x_offset + x;
-			if ((p_x < 0) || (p_x >= image_width))
-			{
-				continue;
-			}
+		color = mBelowWaterColor;
+	}
 
-			for (y = -neg_radius; y < pos_radius; y++)
-			{
-				S32 p_y = y_offset + y;
-				if ((p_y < 0) || (p_y >= image_height))
-				{
-					continue;
-				}
-				S32 offset = p_x + p_y * image_width;
-				((U32*)datap)[offset] = color.mAll;
-			}
-		}
+	region_handle = regionp->getHandle();
+	footprint.mPosRegion = pos;
+	footprint.mRadius = approx_radius;
+	footprint.mColor = color;
+	return TRUE;
+}
+
+void LLNetMapLayers::computeRect(Footprint& footprint) const
+{
+	const F32 texels_per_meter = mTexelsPerRegion / LLWorld::getInstance()->getRegionWidthInMeters();
+	S32 diameter = llround(2.f * footprint.mRadius * texels_per_meter);
+	if (diameter <= 0)
+	{
+		footprint.mLeft = footprint.mBottom = footprint.mRight = footprint.mTop = 0;
+		return;
 	}
+
+	S32 x_offset = llround(footprint.mPosRegion.mV[VX] * texels_per_meter);
+	S32 y_offset = llround(footprint.mPosRegion.mV[VY] * texels_per_meter);
+	S32 neg_radius = diameter / 2;
+	S32 pos_radius = diameter - neg_radius;
+
+	footprint.mLeft = llclamp(x_offset - neg_radius, 0, mTexelsPerRegion);
+	footprint.mRight = llclamp(x_offset + pos_radius, 0, mTexelsPerRegion);
+	footprint.mBottom = llclamp(y_offset - neg_radius, 0, mTexelsPerRegion);
+	footprint.mTop = llclamp(y_offset + pos_radius, 0, mTexelsPerRegion);
 }
 
-void LLNetMap::createObjectImage()
+S32 LLNetMapLayers::rebuildLayer(Layer& layer)
 {
-	// Find the size of the side of a square that surrounds the circle that surrounds getRect().
-	// ... which is, the diagonal of the rect.
-	F32 width = getRect().getWidth();
-	F32 height = getRect().getHeight();
-	S32 square_size = llround( sqrt(width*width + height*height) );
-
-	// Find the least power of two >= the minimum size.
-	const S32 MIN_SIZE = 32;
-	const S32 MAX_SIZE = 256;
-	S32 img_size = MIN_SIZE;
-	while( (img_size*2 < square_size ) && (img_size < MAX_SIZE) )
+	if (layer.mImagep.isNull() || (layer.mSize != mTexelsPerRegion))
+	{
+		layer.mSize = mTexelsPerRegion;
+		layer.mRawImagep = new LLImageRaw(layer.mSize, layer.mSize, 4);
+		memset(layer.mRawImagep->getData(), 0, layer.mSize * layer.mSize * 4);
+		layer.mImagep = new LLImageGL(layer.mRawImagep, FALSE);
+	}
+	else
 	{
-		img_size <<= 1;
+		memset(layer.mRawImagep->getData(), 0, layer.mSize * layer.mSize * 4);
 	}
 
-	if( mObjectImagep.isNull() ||
-		(mObjectImagep->getWidth() != img_size) ||
-		(mObjectImagep->getHeight() != img_size) )
+	for (footprint_map_t::iterator iter = layer.mFootprints.begin();
+		 iter != layer.mFootprints.end(); ++iter)
 	{
-		mObjectRawImagep = new LLImageRaw(img_size, img_size, 4);
-		U8* data = mObjectRawImagep->getData();
-		memset( data, 0, img_size * img_size * 4 );
-		mObjectImagep = new LLImageGL( mObjectRawImagep, FALSE);
-		setScale(mScale);
+		computeRect(iter->second);
+		plotFootprint(layer, iter->second);
+	}
+
+	layer.mNeedsRebuild = FALSE;
+	layer.mNeedsUpload = TRUE;
+	return (S32)layer.mFootprints.size();
+}
+
+void LLNetMapLayers::plotFootprint(Layer& layer, const Footprint& footprint)
+{
+	U32* datap = (U32*)layer.mRawImagep->getData();
+	for (S32 y = footprint.mBottom; y < footprint.mTop; y++)
+	{
+		U32* rowp = datap + y * layer.mSize;
+		for (S32 x = footprint.mLeft; x < footprint.mRight; x++)
+		{
+			rowp[x] = footprint.mColor.mAll;
+		}
 	}
-	mUpdateNow = TRUE;
 }
 
 BOOL LLNetMap::handleMouseDown( S32 x, S32 y, MASK mask )
@@ -41,7 +41,11 @@
 #include "llimage.h"
 #include "llimagegl.h"
 
+#include <map>
+#include <set>
+
 class LLTextBox;
+class LLViewerObject;
 
 typedef enum e_minimap_center
 {
@@ -49,6 +53,78 @@ typedef enum e_minimap_center
 	MAP_CENTER_CAMERA = 1
 } EMiniMapCenter;
 
+//============================================================================
+// Object footprints shown on the mini map, cached as one layer per region.
+//
+// LLViewerObjectList reports objects that were created, updated or killed
+// and only those are re-plotted; everything else stays in the layer. Layers
+// are in region-local texels, so camera movement, panning and rotation only
+// change where they are drawn. update() does at most MiniMapUpdateBudget
+// footprints of work per frame, so a static scene costs one quad per region.
+
+class LLNetMapLayers : public LLSingleton<LLNetMapLayers>
+{
+public:
+	LLNetMapLayers();
+
+	// Called by LLViewerObjectList
+	void markDirty(LLViewerObject* objectp); // created, moved or changed; includes children
+	void removeObject(LLViewerObject* objectp); // killed or taken off the map
+	void clear();
+
+	// Called by LLNetMap::draw()
+	void update(S32 texels_per_region, S32 budget);
+	LLImageGL* getLayerImage(U64 region_handle) const;
+
+private:
+	struct Footprint
+	{
+		LLVector3 mPosRegion;
+		F32 mRadius;
+		LLColor4U mColor;
+		// Plotted texel rect at mTexelsPerRegion, right and top exclusive
+		S32 mLeft;
+		S32 mBottom;
+		S32 mRight;
+		S32 mTop;
+	};
+	typedef std::map<LLViewerObject*, Footprint> footprint_map_t;
+
+	struct Layer
+	{
+		Layer() : mSize(0), mNeedsRebuild(TRUE), mNeedsUpload(FALSE) {}
+
+		footprint_map_t mFootprints;
+		LLPointer<LLImageRaw> mRawImagep;
+		LLPointer<LLImageGL> mImagep;
+		S32 mSize;
+		BOOL mNeedsRebuild;	// a footprint moved or went away
+		BOOL mNeedsUpload;	// mRawImagep has changes not in mImagep
+	};
+	typedef std::map<U64, Layer> layer_map_t;
+
+	void updateColors();
+	void updateFootprint(LLViewerObject* objectp);
+	void eraseFootprint(LLViewerObject* objectp);
+	BOOL computeFootprint(LLViewerObject* objectp, U64& region_handle, Footprint& footprint) const;
+	void computeRect(Footprint& footprint) const;
+	S32 rebuildLayer(Layer& layer);
+	void plotFootprint(Layer& layer, const Footprint& footprint);
+
+	layer_map_t mLayers;
+	std::map<LLViewerObject*, U64> mObjectRegions;
+	std::set<LLPointer<LLViewerObject> > mDirtyObjects;
+	S32 mTexelsPerRegion;
+
+	LLColor4U mAboveWaterColor;
+	LLColor4U mBelowWaterColor;
+	LLColor4U mYouOwnAboveWaterColor;
+	LLColor4U mYouOwnBelowWaterColor;
+	LLColor4U mGroupOwnAboveWaterColor;
+	LLColor4U mGroupOwnBelowWaterColor;
+	F32 mMaxRadius;
+};
+
 class LLNetMap : public LLPanel
 {
 public:
@@ -67,8 +143,6 @@ public:
 	virtual BOOL	handleScrollWheel(S32 x, S32 y, S32 clicks);
 	virtual BOOL	handleToolTip( S32 x, S32 y, std::string& msg, LLRect* sticky_rect_screen );
 
-	void			renderScaledPointGlobal( const LLVector3d& pos, const LLColor4U &color, F32 radius );
-
 private:
 
 	void			setScale( F32 scale );
@@ -77,8 +151,6 @@ private:
 	void			translatePan( F32 delta_x, F32 delta_y );
 	void			setPan( F32 x, F32 y )			{ mTargetPanX = x; mTargetPanY = y; }
 
-	void renderPoint(const LLVector3 &pos, const LLColor4U &color, 
-					 S32 diameter, S32 relative_height = 0);
 	LLVector3		globalPosToView(const LLVector3d& global_pos, BOOL rotated);
 	LLVector3d		viewPosToGlobal(S32 x,S32 y, BOOL rotated);
 
@@ -89,14 +161,11 @@ private:
 
 	void			setDirectionPos( LLTextBox* text_box, F32 rotation );
 	void			updateMinorDirections();
-	void			createObjectImage();
 
 	LLHandle<LLView>	mPopupMenuHandle;
 
 	F32				mScale;					// Size of a region in pixels
 	F32				mPixelsPerMeter;		// world meters to map pixels
-	F32				mObjectMapTPM;			// texels per meter on map
-	F32				mObjectMapPixels;		// Width of object map in pixels
 	F32				mDotRadius;				// Size of avatar markers
 	F32				mTargetPanX;
 	F32				mTargetPanY;
@@ -109,11 +178,6 @@ private:
 	S32				mMouseDownX;
 	S32				mMouseDownY;
 
-	BOOL			mUpdateNow;
-	LLVector3d		mObjectImageCenterGlobal;
-	LLPointer<LLImageRaw> mObjectRawImagep;
-	LLPointer<LLImageGL>	mObjectImagep;
-
 private:
 	LLUUID				mClosestAgentToCursor;
 	LLUUID				mClosestAgentAtLastRightClick;
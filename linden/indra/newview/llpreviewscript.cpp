@@ -147,6 +147,38 @@ static bool have_script_upload_cap(LLUUID& object_id)
 	return object && (! object->getRegion()->getCapability("UpdateScriptTask").empty());
 }
 
+// Adds one row per line of compiler output to the error list.
+static void add_compile_errors(LLScrollListCtrl* error_list, const std::string& errors)
+{
+	std::string::size_type start = 0;
+	while (start < errors.size())
+	{
+		std::string::size_type end = errors.find('\n', start);
+		if (end == std::string::npos)
+		{
+			end = errors.size();
+		}
+		std::string line = errors.substr(start, end - start);
+		LLStringUtil::stripNonprintable(line);
+		start = end + 1;
+
+		LLSD row;
+		row["columns"][0]["value"] = line;
+		row["columns"][0]["font"] = "OCRA";
+		error_list->addElement(row);
+	}
+}
+
+// Puts compiled bytecode in the VFS so it can be stored under asset_id
+// without a temporary file.
+static void write_bytecode(const LLAssetID& asset_id, const std::vector<U8>& bytecode)
+{
+	LLVFile file(gVFS, asset_id, LLAssetType::AT_LSL_BYTECODE, LLVFile::APPEND);
+	S32 size = (S32)bytecode.size();
+	file.setMaxSize(size);
+	file.write(&bytecode[0], size);
+}
+
 /// ---------------------------------------------------------------------------
 /// LLScriptEdCore
 /// ---------------------------------------------------------------------------
@@ -1263,7 +1295,7 @@ void LLPreviewLSL::saveIfNeeded()
 		}
 		else if (gAssetStorage)
 		{
-			uploadAssetLegacy(filename, mItemUUID, tid);
+			uploadAssetLegacy(filename, utf8text, mItemUUID, tid);
 		}
 	}
 }
@@ -1287,6 +1319,7 @@ void LLPreviewLSL::uploadAssetViaCaps(const std::string& url,
 }
 
 void LLPreviewLSL::uploadAssetLegacy(const std::string& filename,
+									  const std::string& utf8text,
 									  const LLUUID& item_id,
 									  const LLTransactionID& tid)
 {
@@ -1300,53 +1333,17 @@ void LLPreviewLSL::uploadAssetLegacy(const std::string& filename,
 								  info);
 
 	LLAssetID asset_id = tid.makeAssetID(gAgent.getSecureSessionID());
-	std::string filepath = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,asset_id.asString());
-	std::string dst_filename = llformat("%s.lso", filepath.c_str());
-	std::string err_filename = llformat("%s.out", filepath.c_str());
 
-	const BOOL compile_to_mono = FALSE;
-	if(!lscript_compile(filename.c_str(),
-						dst_filename.c_str(),
-						err_filename.c_str(),
-						compile_to_mono,
-						asset_id.asString().c_str(),
-						gAgent.isGodlike()))
+	std::vector<U8> bytecode;
+	std::string errors;
+	if(!lscript_compile(utf8text, bytecode, errors, gAgent.isGodlike(),
+						gSavedSettings.getBOOL("LSLCompileOptimize")))
 	{
 		llinfos << "Compile failed!" << llendl;
-		//char command[256];
-		//sprintf(command, "type %s\n", err_filename.c_str());
-		//system(command);
 
-		// load the error file into the error scrolllist
-		LLFILE* fp = LLFile::fopen(err_filename, "r");
-		if(fp)
-		{
-			char buffer[MAX_STRING];		/*Flawfinder: ignore*/
-			std::string line;
-			while(!feof(fp)) 
-			{
-				if (fgets(buffer, MAX_STRING, fp) == NULL)
-				{
-					buffer[0] = '\0';
-				}
-				if(feof(fp))
-				{
-					break;
-				}
-				else
-				{
-					line.assign(buffer);
-					LLStringUtil::stripNonprintable(line);
-
-					LLSD row;
-					row["columns"][0]["value"] = line;
-					row["columns"][0]["font"] = "OCRA";
-					mScriptEd->mErrorList->addElement(row);
-				}
-			}
-			fclose(fp);
-			mScriptEd->selectFirstError();
-		}
+		// load the compiler output into the error scrolllist
+		add_compile_errors(mScriptEd->mErrorList, errors);
+		mScriptEd->selectFirstError();
 	}
 	else
 	{
@@ -1355,9 +1352,9 @@ void LLPreviewLSL::uploadAssetLegacy(const std::string& filename,
 		{
 			getWindow()->incBusyCount();
 			mPendingUploads++;
+			write_bytecode(asset_id, bytecode);
 			LLUUID* this_uuid = new LLUUID(mItemUUID);
-			gAssetStorage->storeAssetData(dst_filename,
-										  tid,
+			gAssetStorage->storeAssetData(tid,
 										  LLAssetType::AT_LSL_BYTECODE,
 										  &LLPreviewLSL::onSaveBytecodeComplete,
 										  (void**)this_uuid);
@@ -1366,8 +1363,6 @@ void LLPreviewLSL::uploadAssetLegacy(const std::string& filename,
 
 	// get rid of any temp files left lying around
 	LLFile::remove(filename);
-	LLFile::remove(err_filename);
-	LLFile::remove(dst_filename);
 }
 
 
@@ -2128,7 +2123,7 @@ void LLLiveLSLEditor::saveIfNeeded()
 	}
 	else if (gAssetStorage)
 	{
-		uploadAssetLegacy(filename, object, tid, is_running);
+		uploadAssetLegacy(filename, utf8text, object, tid, is_running);
 	}
 }
 
@@ -2149,6 +2144,7 @@ void LLLiveLSLEditor::uploadAssetViaCaps(const std::string& url,
 }
 
 void LLLiveLSLEditor::uploadAssetLegacy(const std::string& filename,
+										const std::string& utf8text,
 										LLViewerObject* object,
 										const LLTransactionID& tid,
 										BOOL is_running)
@@ -2163,55 +2159,21 @@ void LLLiveLSLEditor::uploadAssetLegacy(const std::string& filename,
 								  FALSE);
 
 	LLAssetID asset_id = tid.makeAssetID(gAgent.getSecureSessionID());
-	std::string filepath = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,asset_id.asString());
-	std::string dst_filename = llformat("%s.lso", filepath.c_str());
-	std::string err_filename = llformat("%s.out", filepath.c_str());
-
-	LLFILE *fp;
-	const BOOL compile_to_mono = FALSE;
-	if(!lscript_compile(filename.c_str(),
-						dst_filename.c_str(),
-						err_filename.c_str(),
-						compile_to_mono,
-						asset_id.asString().c_str(),
-						gAgent.isGodlike()))
-	{
-		// load the error file into the error scrolllist
+
+	std::vector<U8> bytecode;
+	std::string errors;
+	if(!lscript_compile(utf8text, bytecode, errors, gAgent.isGodlike(),
+						gSavedSettings.getBOOL("LSLCompileOptimize")))
+	{
+		// load the compiler output into the error scrolllist
 		llinfos << "Compile failed!" << llendl;
-		if(NULL != (fp = LLFile::fopen(err_filename, "r")))
-		{
-			char buffer[MAX_STRING];		/*Flawfinder: ignore*/
-			std::string line;
-			while(!feof(fp)) 
-			{
-				
-				if (fgets(buffer, MAX_STRING, fp) == NULL)
-				{
-					buffer[0] = '\0';
-				}
-				if(feof(fp))
-				{
-					break;
-				}
-				else
-				{
-					line.assign(buffer);
-					LLStringUtil::stripNonprintable(line);
-				
-					LLSD row;
-					row["columns"][0]["value"] = line;
-					row["columns"][0]["font"] = "OCRA";
-					mScriptEd->mErrorList->addElement(row);
-				}
-			}
-			fclose(fp);
-			mScriptEd->selectFirstError();
-			// don't set the asset id, because we want to save the
-			// script, even though the compile failed.
-			//mItem->setAssetUUID(LLUUID::null);
-			object->saveScript(mItem, FALSE, false);
-			dialog_refresh_all();
-		}
+		add_compile_errors(mScriptEd->mErrorList, errors);
+		mScriptEd->selectFirstError();
+		// don't set the asset id, because we want to save the
+		// script, even though the compile failed.
+		//mItem->setAssetUUID(LLUUID::null);
+		object->saveScript(mItem, FALSE, false);
+		dialog_refresh_all();
 	}
 	else
 	{
@@ -2224,23 +2186,20 @@ void LLLiveLSLEditor::uploadAssetLegacy(const std::string& filename,
 					<< mItem->getAssetUUID() << llendl;
 			getWindow()->incBusyCount();
 			mPendingUploads++;
-			LLLiveLSLSaveData* data = NULL;
-			data = new LLLiveLSLSaveData(mObjectID,
-										 mItem,
-										 is_running);
-			gAssetStorage->storeAssetData(dst_filename,
-										  tid,
+			LLLiveLSLSaveData* bytecode_data = new LLLiveLSLSaveData(mObjectID,
+																	 mItem,
+																	 is_running);
+			write_bytecode(asset_id, bytecode);
+			gAssetStorage->storeAssetData(tid,
 										  LLAssetType::AT_LSL_BYTECODE,
 										  &LLLiveLSLEditor::onSaveBytecodeComplete,
-										  (void*)data);
+										  (void*)bytecode_data);
 			dialog_refresh_all();
 		}
 	}
 
 	// get rid of any temp files left lying around
 	LLFile::remove(filename);
-	LLFile::remove(err_filename);
-	LLFile::remove(dst_filename);
 
 	// If we successfully saved it, then we should be able to check/uncheck the running box!
 	LLCheckBoxCtrl* runningCheckbox = getChild<LLCheckBoxCtrl>( "running");
@@ -181,6 +181,7 @@ protected:
 							const std::string& filename, 
 							const LLUUID& item_id);
 	void uploadAssetLegacy(const std::string& filename,
+							const std::string& utf8text,
 							const LLUUID& item_id,
 							const LLTransactionID& tid);
 
@@ -249,6 +250,7 @@ protected:
 							const LLUUID& item_id,
 							BOOL is_running);
 	void uploadAssetLegacy(const std::string& filename,
+						   const std::string& utf8text,
 						   LLViewerObject* object,
 						   const LLTransactionID& tid,
 						   BOOL is_running);
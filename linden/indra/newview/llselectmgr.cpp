@@ -96,6 +96,8 @@ const S32 OWNERSHIP_COST_PER_OBJECT = 10; // Must be the same as economy_constan
 const S32 MAX_ACTION_QUEUE_SIZE = 20;
 const S32 MAX_SILS_PER_FRAME = 50;
 const S32 MAX_OBJECTS_PER_PACKET = 254;
+const F32 PENDING_UPDATE_DELAY = 0.1f;			// min time between streamed edit updates
+const S32 MAX_PENDING_UPDATE_PACKETS = 4;		// per region, per streamed update
 
 //
 // Globals
@@ -110,6 +112,7 @@ BOOL LLSelectMgr::sRectSelectInclusive = TRUE;
 BOOL LLSelectMgr::sRenderSelectionHighlights = TRUE;
 BOOL LLSelectMgr::sRenderHiddenSelections = TRUE;
 BOOL LLSelectMgr::sRenderLightRadius = FALSE;
+U32 LLSelectMgr::sSelectionRevision = 1;
 F32	LLSelectMgr::sHighlightThickness = 0.f;
 F32	LLSelectMgr::sHighlightUScale = 0.f;
 F32	LLSelectMgr::sHighlightVScale = 0.f;
@@ -178,6 +181,7 @@ LLSelectMgr::LLSelectMgr()
 {
 	mTEMode = FALSE;
 	mLastCameraPos.clearVec();
+	mPendingUpdateType = UPD_NONE;
 
 	sHighlightThickness	= gSavedSettings.getF32("SelectionHighlightThickness");
 	sHighlightUScale	= gSavedSettings.getF32("SelectionHighlightUScale");
@@ -745,6 +749,7 @@ void LLSelectMgr::addAsIndividual(LLViewerObject *objectp, S32 face, BOOL undoab
 
 	// And make sure we don't consider it as part of a family
 	nodep->mIndividualSelection = TRUE;
+	dirtySelectionAggregates();
 
 	// Handle face selection
 	if (objectp->getNumTEs() <= 0)
@@ -2181,16 +2186,7 @@ void LLSelectMgr::adjustTexturesByScale(BOOL send_to_sim, BOOL stretch)
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetAllRootsValid()
 {
-	for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
-		 iter != getSelection()->root_end(); ++iter )
-	{
-		LLSelectNode* node = *iter;
-		if( !node->mValid )
-		{
-			return FALSE;
-		}
-	}
-	return TRUE;
+	return getSelectionAggregates().mRootsValid;
 }
 
 
@@ -2200,16 +2196,7 @@ BOOL LLSelectMgr::selectGetAllRootsValid()
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetAllValid()
 {
-	for (LLObjectSelection::iterator iter = getSelection()->begin();
-		 iter != getSelection()->end(); ++iter )
-	{
-		LLSelectNode* node = *iter;
-		if( !node->mValid )
-		{
-			return FALSE;
-		}
-	}
-	return TRUE;
+	return getSelectionAggregates().mAllValid;
 }
 
 
@@ -2313,42 +2300,18 @@ BOOL LLSelectMgr::selectGetRootsCopy()
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetCreator(LLUUID& result_id, std::string& name)
 {
-	BOOL identical = TRUE;
-	BOOL first = TRUE;
-	LLUUID first_id;
-	for (LLObjectSelection::root_object_iterator iter = getSelection()->root_object_begin();
-		 iter != getSelection()->root_object_end(); iter++ )
-	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-
-		if (first)
-		{
-			first_id = node->mPermissions->getCreator();
-			first = FALSE;
-		}
-		else
-		{
-			if ( !(first_id == node->mPermissions->getCreator() ) )
-			{
-				identical = FALSE;
-				break;
-			}
-		}
-	}
-	if (first_id.isNull())
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (aggregates.mCreatorState == AGGREGATE_INVALID || aggregates.mCreatorID.isNull())
 	{
 		return FALSE;
 	}
 	
-	result_id = first_id;
+	result_id = aggregates.mCreatorID;
 	
+	BOOL identical = (aggregates.mCreatorState == AGGREGATE_IDENTICAL);
 	if (identical)
 	{
-		gCacheName->getFullName(first_id, name);
+		gCacheName->getFullName(result_id, name);
 	}
 	else
 	{
@@ -2365,53 +2328,26 @@ BOOL LLSelectMgr::selectGetCreator(LLUUID& result_id, std::string& name)
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetOwner(LLUUID& result_id, std::string& name)
 {
-	BOOL identical = TRUE;
-	BOOL first = TRUE;
-	BOOL first_group_owned = FALSE;
-	LLUUID first_id;
-	for (LLObjectSelection::root_object_iterator iter = getSelection()->root_object_begin();
-		 iter != getSelection()->root_object_end(); iter++ )
-	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-		
-		if (first)
-		{
-			node->mPermissions->getOwnership(first_id, first_group_owned);
-			first = FALSE;
-		}
-		else
-		{
-			LLUUID owner_id;
-			BOOL is_group_owned = FALSE;
-			if (!(node->mPermissions->getOwnership(owner_id, is_group_owned))
-				|| owner_id != first_id || is_group_owned != first_group_owned)
-			{
-				identical = FALSE;
-				break;
-			}
-		}
-	}
-	if (first_id.isNull())
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (aggregates.mOwnerState == AGGREGATE_INVALID || aggregates.mOwnerID.isNull())
 	{
 		return FALSE;
 	}
 
-	result_id = first_id;
+	result_id = aggregates.mOwnerID;
 	
+	BOOL identical = (aggregates.mOwnerState == AGGREGATE_IDENTICAL);
 	if (identical)
 	{
-		BOOL public_owner = (first_id.isNull() && !first_group_owned);
+		BOOL first_group_owned = aggregates.mOwnerGroupOwned;
+		BOOL public_owner = (result_id.isNull() && !first_group_owned);
 		if (first_group_owned)
 		{
 			name.assign( "(Group Owned)");
 		}
 		else if(!public_owner)
 		{
-			gCacheName->getFullName(first_id, name);
+			gCacheName->getFullName(result_id, name);
 		}
 		else
 		{
@@ -2433,45 +2369,21 @@ BOOL LLSelectMgr::selectGetOwner(LLUUID& result_id, std::string& name)
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetLastOwner(LLUUID& result_id, std::string& name)
 {
-	BOOL identical = TRUE;
-	BOOL first = TRUE;
-	LLUUID first_id;
-	for (LLObjectSelection::root_object_iterator iter = getSelection()->root_object_begin();
-		 iter != getSelection()->root_object_end(); iter++ )
-	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-
-		if (first)
-		{
-			first_id = node->mPermissions->getLastOwner();
-			first = FALSE;
-		}
-		else
-		{
-			if ( !(first_id == node->mPermissions->getLastOwner() ) )
-			{
-				identical = FALSE;
-				break;
-			}
-		}
-	}
-	if (first_id.isNull())
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (aggregates.mLastOwnerState == AGGREGATE_INVALID || aggregates.mLastOwnerID.isNull())
 	{
 		return FALSE;
 	}
 
-	result_id = first_id;
+	result_id = aggregates.mLastOwnerID;
 	
+	BOOL identical = (aggregates.mLastOwnerState == AGGREGATE_IDENTICAL);
 	if (identical)
 	{
-		BOOL public_owner = (first_id.isNull());
+		BOOL public_owner = (result_id.isNull());
 		if(!public_owner)
 		{
-			gCacheName->getFullName(first_id, name);
+			gCacheName->getFullName(result_id, name);
 		}
 		else
 		{
@@ -2493,36 +2405,15 @@ BOOL LLSelectMgr::selectGetLastOwner(LLUUID& result_id, std::string& name)
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetGroup(LLUUID& result_id)
 {
-	BOOL identical = TRUE;
-	BOOL first = TRUE;
-	LLUUID first_id;
-	for (LLObjectSelection::root_object_iterator iter = getSelection()->root_object_begin();
-		 iter != getSelection()->root_object_end(); iter++ )
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (aggregates.mGroupState == AGGREGATE_INVALID)
 	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-
-		if (first)
-		{
-			first_id = node->mPermissions->getGroup();
-			first = FALSE;
-		}
-		else
-		{
-			if ( !(first_id == node->mPermissions->getGroup() ) )
-			{
-				identical = FALSE;
-				break;
-			}
-		}
+		return FALSE;
 	}
 
-	result_id = first_id;
+	result_id = aggregates.mGroupID;
 
-	return identical;
+	return (aggregates.mGroupState == AGGREGATE_IDENTICAL);
 }
 
 //-----------------------------------------------------------------------------
@@ -2532,22 +2423,8 @@ BOOL LLSelectMgr::selectGetGroup(LLUUID& result_id)
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectIsGroupOwned()
 {
-	BOOL found_one = FALSE;
-	for (LLObjectSelection::root_object_iterator iter = getSelection()->root_object_begin();
-		 iter != getSelection()->root_object_end(); iter++ )
-	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-		found_one = TRUE;
-		if (!node->mPermissions->isGroupOwned())
-		{
-			return FALSE;
-		}
-	}	
-	return found_one ? TRUE : FALSE;
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	return aggregates.mNumRootObjects > 0 && aggregates.mRootObjectsValid && aggregates.mAllGroupOwned;
 }
 
 //-----------------------------------------------------------------------------
@@ -2561,51 +2438,39 @@ BOOL LLSelectMgr::selectIsGroupOwned()
 //-----------------------------------------------------------------------------
 BOOL LLSelectMgr::selectGetPerm(U8 which_perm, U32* mask_on, U32* mask_off)
 {
-	U32 mask;
-	U32 mask_and	= 0xffffffff;
-	U32 mask_or		= 0x00000000;
-	BOOL all_valid	= FALSE;
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	BOOL all_valid = aggregates.mNumRoots > 0 && aggregates.mRootsValid;
 
-	for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
-		 iter != getSelection()->root_end(); iter++)
+	if (all_valid)
 	{
-		LLSelectNode* node = *iter;
-
-		if (!node->mValid)
-		{
-			all_valid = FALSE;
-			break;
-		}
-
-		all_valid = TRUE;
-		
+		U32 mask_and = 0x0;
+		U32 mask_or = 0x0;
 		switch( which_perm )
 		{
 		case PERM_BASE:
-			mask = node->mPermissions->getMaskBase();
+			mask_and = aggregates.mMaskAnd[0];
+			mask_or = aggregates.mMaskOr[0];
 			break;
 		case PERM_OWNER:
-			mask = node->mPermissions->getMaskOwner();
+			mask_and = aggregates.mMaskAnd[1];
+			mask_or = aggregates.mMaskOr[1];
 			break;
 		case PERM_GROUP:
-			mask = node->mPermissions->getMaskGroup();
+			mask_and = aggregates.mMaskAnd[2];
+			mask_or = aggregates.mMaskOr[2];
 			break;
 		case PERM_EVERYONE:
-			mask = node->mPermissions->getMaskEveryone();
+			mask_and = aggregates.mMaskAnd[3];
+			mask_or = aggregates.mMaskOr[3];
 			break;
 		case PERM_NEXT_OWNER:
-			mask = node->mPermissions->getMaskNextOwner();
+			mask_and = aggregates.mMaskAnd[4];
+			mask_or = aggregates.mMaskOr[4];
 			break;
 		default:
-			mask = 0x0;
 			break;
 		}
-		mask_and &= mask;
-		mask_or	 |= mask;
-	}
 
-	if (all_valid)
-	{
 		// ...TRUE through all ANDs means all TRUE
 		*mask_on  = mask_and;
 
@@ -2630,29 +2495,13 @@ BOOL LLSelectMgr::selectGetOwnershipCost(S32* out_cost)
 
 BOOL LLSelectMgr::selectGetPermissions(LLPermissions& result_perm)
 {
-	BOOL first = TRUE;
-	LLPermissions perm;
-	for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
-		 iter != getSelection()->root_end(); iter++ )
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (!aggregates.mRootsValid)
 	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-
-		if (first)
-		{
-			perm = *(node->mPermissions);
-			first = FALSE;
-		}
-		else
-		{
-			perm.accumulate(*(node->mPermissions));
-		}
+		return FALSE;
 	}
 
-	result_perm = perm;
+	result_perm = aggregates.mPermissions;
 
 	return TRUE;
 }
@@ -2823,42 +2672,13 @@ void LLSelectMgr::selectGetAggregateSaleInfo(U32 &num_for_sale,
 											 S32 &total_sale_price,
 											 S32 &individual_sale_price)
 {
-	num_for_sale = 0;
-	is_for_sale_mixed = FALSE;
-	is_sale_price_mixed = FALSE;
-	total_sale_price = 0;
-	individual_sale_price = 0;
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	num_for_sale = aggregates.mNumForSale;
+	is_for_sale_mixed = aggregates.mForSaleMixed;
+	is_sale_price_mixed = aggregates.mSalePriceMixed;
+	total_sale_price = aggregates.mTotalSalePrice;
+	individual_sale_price = aggregates.mFirstSalePrice;
 
-
-	// Empty set.
-	if (getSelection()->root_begin() == getSelection()->root_end())
-		return;
-	
-	LLSelectNode *node = *(getSelection()->root_begin());
-	const BOOL first_node_for_sale = node->mSaleInfo.isForSale();
-	const S32 first_node_sale_price = node->mSaleInfo.getSalePrice();
-	
-	for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
-		 iter != getSelection()->root_end(); iter++)
-	{
-		LLSelectNode* node = *iter;
-		const BOOL node_for_sale = node->mSaleInfo.isForSale();
-		const S32 node_sale_price = node->mSaleInfo.getSalePrice();
-		
-		// Set mixed if the fields don't match the first node's fields.
-		if (node_for_sale != first_node_for_sale) 
-			is_for_sale_mixed = TRUE;
-		if (node_sale_price != first_node_sale_price)
-			is_sale_price_mixed = TRUE;
-		
-		if (node_for_sale)
-		{
-			total_sale_price += node_sale_price;
-			num_for_sale ++;
-		}
-	}
-	
-	individual_sale_price = first_node_sale_price;
 	if (is_for_sale_mixed)
 	{
 		is_sale_price_mixed = TRUE;
@@ -2870,34 +2690,31 @@ void LLSelectMgr::selectGetAggregateSaleInfo(U32 &num_for_sale,
 // accumulated sale info.
 BOOL LLSelectMgr::selectGetSaleInfo(LLSaleInfo& result_sale_info)
 {
-	BOOL first = TRUE;
-	LLSaleInfo sale_info;
-	for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
-		 iter != getSelection()->root_end(); iter++ )
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (!aggregates.mRootsValid)
 	{
-		LLSelectNode* node = *iter;	
-		if (!node->mValid)
-		{
-			return FALSE;
-		}
-
-		if (first)
-		{
-			sale_info = node->mSaleInfo;
-			first = FALSE;
-		}
-		else
-		{
-			sale_info.accumulate(node->mSaleInfo);
-		}
+		return FALSE;
 	}
 
-	result_sale_info = sale_info;
+	result_sale_info = aggregates.mSaleInfo;
 
 	return TRUE;
 }
 
 BOOL LLSelectMgr::selectGetAggregatePermissions(LLAggregatePermissions& result_perm)
+{
+	const LLSelectionAggregates& aggregates = getSelectionAggregates();
+	if (!aggregates.mRootsValid)
+	{
+		return FALSE;
+	}
+
+	result_perm = aggregates.mAggregatePerm;
+
+	return TRUE;
+}
+
+BOOL LLSelectMgr::selectGetAggregateTexturePermissions(LLAggregatePermissions& result_perm)
 {
 	BOOL first = TRUE;
 	LLAggregatePermissions perm;
@@ -2910,14 +2727,15 @@ BOOL LLSelectMgr::selectGetAggregatePermissions(LLAggregatePermissions& result_p
 			return FALSE;
 		}
 
+		LLAggregatePermissions t_perm = node->getObject()->permYouOwner() ? node->mAggregateTexturePermOwner : node->mAggregateTexturePerm;
 		if (first)
 		{
-			perm = node->mAggregatePerm;
+			perm = t_perm;
 			first = FALSE;
 		}
 		else
 		{
-			perm.aggregate(node->mAggregatePerm);
+			perm.aggregate(t_perm);
 		}
 	}
 
@@ -2926,34 +2744,188 @@ BOOL LLSelectMgr::selectGetAggregatePermissions(LLAggregatePermissions& result_p
 	return TRUE;
 }
 
-BOOL LLSelectMgr::selectGetAggregateTexturePermissions(LLAggregatePermissions& result_perm)
+// Agreement of one field across the root objects, in selection order. The
+// per-query loops these replace returned as soon as they met a node without
+// properties, unless an earlier node had already disagreed, so the state
+// only moves while it is still AGGREGATE_IDENTICAL.
+// static
+void LLSelectMgr::updateAggregateState(EAggregateState& state, BOOL valid, BOOL same)
 {
-	BOOL first = TRUE;
-	LLAggregatePermissions perm;
-	for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
-		 iter != getSelection()->root_end(); iter++ )
+	if (state == AGGREGATE_IDENTICAL)
 	{
-		LLSelectNode* node = *iter;	
+		if (!valid)
+		{
+			state = AGGREGATE_INVALID;
+		}
+		else if (!same)
+		{
+			state = AGGREGATE_MIXED;
+		}
+	}
+}
+
+const LLSelectMgr::LLSelectionAggregates& LLSelectMgr::getSelectionAggregates()
+{
+	LLObjectSelection* selection = getSelection().get();
+	LLSelectionAggregates& agg = mAggregates;
+	if (agg.mRevision == sSelectionRevision && agg.mSelection == selection)
+	{
+		return agg;
+	}
+	// Taken before walking the nodes: spotting a dead object while walking
+	// bumps the revision, and the next call has to walk again.
+	agg.mRevision = sSelectionRevision;
+	agg.mSelection = selection;
+
+	agg.mAllValid = TRUE;
+	for (LLObjectSelection::iterator iter = selection->begin();
+		 iter != selection->end(); iter++)
+	{
+		if (!(*iter)->mValid)
+		{
+			agg.mAllValid = FALSE;
+			break;
+		}
+	}
+
+	// Creator, owner and group look at every root object, including
+	// individually selected ones.
+	agg.mCreatorState = AGGREGATE_IDENTICAL;
+	agg.mOwnerState = AGGREGATE_IDENTICAL;
+	agg.mLastOwnerState = AGGREGATE_IDENTICAL;
+	agg.mGroupState = AGGREGATE_IDENTICAL;
+	agg.mNumRootObjects = 0;
+	agg.mRootObjectsValid = TRUE;
+	agg.mAllGroupOwned = TRUE;
+	agg.mCreatorID.setNull();
+	agg.mOwnerID.setNull();
+	agg.mOwnerGroupOwned = FALSE;
+	agg.mLastOwnerID.setNull();
+	agg.mGroupID.setNull();
+	for (LLObjectSelection::root_object_iterator iter = selection->root_object_begin();
+		 iter != selection->root_object_end(); iter++)
+	{
+		LLSelectNode* node = *iter;
+		BOOL valid = node->mValid;
+		const LLPermissions* perm = node->mPermissions;
+		if (!valid)
+		{
+			agg.mRootObjectsValid = FALSE;
+		}
+		else if (!perm->isGroupOwned())
+		{
+			agg.mAllGroupOwned = FALSE;
+		}
+
+		if (agg.mNumRootObjects++ == 0)
+		{
+			if (valid)
+			{
+				agg.mCreatorID = perm->getCreator();
+				perm->getOwnership(agg.mOwnerID, agg.mOwnerGroupOwned);
+				agg.mLastOwnerID = perm->getLastOwner();
+				agg.mGroupID = perm->getGroup();
+			}
+			updateAggregateState(agg.mCreatorState, valid, TRUE);
+			updateAggregateState(agg.mOwnerState, valid, TRUE);
+			updateAggregateState(agg.mLastOwnerState, valid, TRUE);
+			updateAggregateState(agg.mGroupState, valid, TRUE);
+		}
+		else
+		{
+			LLUUID owner_id;
+			BOOL is_group_owned = FALSE;
+			BOOL same_owner = valid && perm->getOwnership(owner_id, is_group_owned)
+				&& owner_id == agg.mOwnerID && is_group_owned == agg.mOwnerGroupOwned;
+			updateAggregateState(agg.mCreatorState, valid, valid && perm->getCreator() == agg.mCreatorID);
+			updateAggregateState(agg.mOwnerState, valid, same_owner);
+			updateAggregateState(agg.mLastOwnerState, valid, valid && perm->getLastOwner() == agg.mLastOwnerID);
+			updateAggregateState(agg.mGroupState, valid, valid && perm->getGroup() == agg.mGroupID);
+		}
+	}
+	// Permissions and sale info look at roots that are not individually
+	// selected.
+	agg.mNumRoots = 0;
+	agg.mRootsValid = TRUE;
+	for (S32 i = 0; i < 5; i++)
+	{
+		agg.mMaskAnd[i] = 0xffffffff;
+		agg.mMaskOr[i] = 0x00000000;
+	}
+	agg.mPermissions = LLPermissions();
+	agg.mSaleInfo = LLSaleInfo();
+	agg.mAggregatePerm = LLAggregatePermissions();
+	agg.mNumForSale = 0;
+	agg.mForSaleMixed = FALSE;
+	agg.mSalePriceMixed = FALSE;
+	agg.mTotalSalePrice = 0;
+	agg.mFirstSalePrice = 0;
+	BOOL first_for_sale = FALSE;
+	for (LLObjectSelection::root_iterator iter = selection->root_begin();
+		 iter != selection->root_end(); iter++)
+	{
+		LLSelectNode* node = *iter;
+		const LLPermissions* perm = node->mPermissions;
+		BOOL first = (agg.mNumRoots++ == 0);
+
+		// sale totals count every root, valid or not
+		const BOOL node_for_sale = node->mSaleInfo.isForSale();
+		const S32 node_sale_price = node->mSaleInfo.getSalePrice();
+		if (first)
+		{
+			first_for_sale = node_for_sale;
+			agg.mFirstSalePrice = node_sale_price;
+		}
+		if (node_for_sale != first_for_sale)
+		{
+			agg.mForSaleMixed = TRUE;
+		}
+		if (node_sale_price != agg.mFirstSalePrice)
+		{
+			agg.mSalePriceMixed = TRUE;
+		}
+		if (node_for_sale)
+		{
+			agg.mTotalSalePrice += node_sale_price;
+			agg.mNumForSale++;
+		}
+
 		if (!node->mValid)
 		{
-			return FALSE;
+			agg.mRootsValid = FALSE;
+		}
+		if (!agg.mRootsValid)
+		{
+			// the rest is only reported when every root is valid
+			continue;
 		}
 
-		LLAggregatePermissions t_perm = node->getObject()->permYouOwner() ? node->mAggregateTexturePermOwner : node->mAggregateTexturePerm;
+		agg.mMaskAnd[0] &= perm->getMaskBase();
+		agg.mMaskOr[0] |= perm->getMaskBase();
+		agg.mMaskAnd[1] &= perm->getMaskOwner();
+		agg.mMaskOr[1] |= perm->getMaskOwner();
+		agg.mMaskAnd[2] &= perm->getMaskGroup();
+		agg.mMaskOr[2] |= perm->getMaskGroup();
+		agg.mMaskAnd[3] &= perm->getMaskEveryone();
+		agg.mMaskOr[3] |= perm->getMaskEveryone();
+		agg.mMaskAnd[4] &= perm->getMaskNextOwner();
+		agg.mMaskOr[4] |= perm->getMaskNextOwner();
+
 		if (first)
 		{
-			perm = t_perm;
-			first = FALSE;
+			agg.mPermissions = *perm;
+			agg.mSaleInfo = node->mSaleInfo;
+			agg.mAggregatePerm = node->mAggregatePerm;
 		}
 		else
 		{
-			perm.aggregate(t_perm);
+			agg.mPermissions.accumulate(*perm);
+			agg.mSaleInfo.accumulate(node->mSaleInfo);
+			agg.mAggregatePerm.aggregate(node->mAggregatePerm);
 		}
 	}
 
-	result_perm = perm;
-
-	return TRUE;
+	return agg;
 }
 
 
@@ -3155,6 +3127,15 @@ void LLSelectMgr::packDuplicateOnRayHead(void *user_data)
 void LLSelectMgr::sendMultipleUpdate(U32 type)
 {
 	if (type == UPD_NONE) return;
+
+	// this supersedes any streamed update still waiting for its turn
+	mPendingUpdateType &= ~type;
+	if (!(mPendingUpdateType & (UPD_POSITION | UPD_ROTATION | UPD_SCALE)))
+	{
+		mPendingUpdateType = UPD_NONE;
+		mPendingUpdateStart.clear();
+	}
+
 	// send individual updates when selecting textures or individual objects
 	ESendType send_type = (!gSavedSettings.getBOOL("EditLinkedParts") && !getTEMode()) ? SEND_ONLY_ROOTS : SEND_ROOTS_FIRST;
 	if (send_type == SEND_ONLY_ROOTS)
@@ -3171,6 +3152,158 @@ void LLSelectMgr::sendMultipleUpdate(U32 type)
 		send_type);
 }
 
+void LLSelectMgr::queueMultipleUpdate(U32 type)
+{
+	mPendingUpdateType |= type;
+}
+
+// Sends what queueMultipleUpdate() asked for, at most every
+// PENDING_UPDATE_DELAY seconds.  Each object block only carries the
+// components that differ from what the simulator was last sent, and objects
+// with nothing new are left out.  Past MAX_PENDING_UPDATE_PACKETS to a
+// region the rest wait for the next call, which starts that region's list
+// at the first node left over so every node gets its turn during a drag.
+void LLSelectMgr::sendPendingUpdates()
+{
+	if (mPendingUpdateType == UPD_NONE
+		|| mPendingUpdateTimer.getElapsedTimeF32() < PENDING_UPDATE_DELAY)
+	{
+		return;
+	}
+	mPendingUpdateTimer.reset();
+
+	U32 type = mPendingUpdateType;
+	BOOL linked_sets = !gSavedSettings.getBOOL("EditLinkedParts") && !getTEMode();
+	if (linked_sets)
+	{
+		// tell simulator to apply to whole linked sets
+		type |= UPD_LINKED_SETS;
+	}
+
+	// Same order as sendMultipleUpdate(), but gathered per region so a
+	// selection spanning a border doesn't split packets at every crossing.
+	typedef std::map<LLViewerRegion*, std::vector<LLSelectNode*> > region_node_map_t;
+	region_node_map_t region_nodes;
+	if (linked_sets)
+	{
+		for (LLObjectSelection::root_iterator iter = getSelection()->root_begin();
+			 iter != getSelection()->root_end(); iter++)
+		{
+			LLViewerObject* object = (*iter)->getObject();
+			if (object && object->getRegion())
+			{
+				region_nodes[object->getRegion()].push_back(*iter);
+			}
+		}
+	}
+	else
+	{
+		// roots first, then children
+		for (S32 pass = 0; pass < 2; pass++)
+		{
+			for (LLObjectSelection::iterator iter = getSelection()->begin();
+				 iter != getSelection()->end(); iter++)
+			{
+				LLViewerObject* object = (*iter)->getObject();
+				if (object && object->getRegion()
+					&& object->isRootEdit() == (pass == 0))
+				{
+					region_nodes[object->getRegion()].push_back(*iter);
+				}
+			}
+		}
+	}
+
+	BOOL deferred = FALSE;
+	for (region_node_map_t::iterator region_iter = region_nodes.begin();
+		 region_iter != region_nodes.end(); ++region_iter)
+	{
+		LLViewerRegion* regionp = region_iter->first;
+		std::vector<LLSelectNode*>& nodes = region_iter->second;
+		U32 count = nodes.size();
+		U32 first = 0;
+		std::map<U64, U32>::iterator start_iter = mPendingUpdateStart.find(regionp->getHandle());
+		if (start_iter != mPendingUpdateStart.end())
+		{
+			// the selection may have changed since, so just wrap
+			first = start_iter->second % count;
+			mPendingUpdateStart.erase(start_iter);
+		}
+		S32 packets_sent = 0;
+		S32 objects_in_this_packet = 0;
+		BOOL started = FALSE;
+		for (U32 n = 0; n < count; n++)
+		{
+			U32 index = (first + n) % count;
+			LLSelectNode* node = nodes[index];
+			LLViewerObject* object = node->getObject();
+
+			U32 node_type = type;
+			if ((node_type & UPD_POSITION)
+				&& (!(node->mSentUpdateMask & UPD_POSITION) || object->getPosition() == node->mSentPositionLocal))
+			{
+				node_type &= ~UPD_POSITION;
+			}
+			if ((node_type & UPD_ROTATION)
+				&& (!(node->mSentUpdateMask & UPD_ROTATION) || object->getRotation() == node->mSentRotation))
+			{
+				node_type &= ~UPD_ROTATION;
+			}
+			if ((node_type & UPD_SCALE)
+				&& (!(node->mSentUpdateMask & UPD_SCALE) || object->getScale() == node->mSentScale))
+			{
+				node_type &= ~(UPD_SCALE | UPD_UNIFORM);
+			}
+			if (!(node_type & (UPD_POSITION | UPD_ROTATION | UPD_SCALE)))
+			{
+				// nothing new, or not part of an edit that saved its transform
+				continue;
+			}
+
+			if (started
+				&& (gMessageSystem->isSendFull(NULL)
+					|| objects_in_this_packet >= MAX_OBJECTS_PER_PACKET))
+			{
+				gMessageSystem->sendReliable(regionp->getHost());
+				packets_sent++;
+				started = FALSE;
+			}
+			if (!started)
+			{
+				if (packets_sent >= MAX_PENDING_UPDATE_PACKETS)
+				{
+					mPendingUpdateStart[regionp->getHandle()] = index;
+					deferred = TRUE;
+					break;
+				}
+				gMessageSystem->newMessage("MultipleObjectUpdate");
+				packAgentAndSessionID(&type);
+				objects_in_this_packet = 0;
+				started = TRUE;
+			}
+
+			packMultipleUpdate(node, &node_type);
+			++objects_in_this_packet;
+
+			// allow the simulator's echo of this update through
+			node->mLastPositionLocal.setVec(0,0,0);
+			node->mLastRotation = LLQuaternion();
+			node->mLastScale.setVec(0,0,0);
+		}
+
+		if (started)
+		{
+			gMessageSystem->sendReliable(regionp->getHost());
+		}
+	}
+
+	if (!deferred)
+	{
+		mPendingUpdateType = UPD_NONE;
+		mPendingUpdateStart.clear();
+	}
+}
+
 // static
 void LLSelectMgr::packMultipleUpdate(LLSelectNode* node, void *user_data)
 {
@@ -3193,6 +3326,7 @@ void LLSelectMgr::packMultipleUpdate(LLSelectNode* node, void *user_data)
 	{
 		htonmemcpy(&data[offset], &(object->getPosition().mV), MVT_LLVector3, 12); 
 		offset += 12;
+		node->mSentPositionLocal = object->getPosition();
 	}
 	if (type & UPD_ROTATION)
 	{
@@ -3200,13 +3334,16 @@ void LLSelectMgr::packMultipleUpdate(LLSelectNode* node, void *user_data)
 		LLVector3 vec = quat.packToVector3();
 		htonmemcpy(&data[offset], &(vec.mV), MVT_LLQuaternion, 12); 
 		offset += 12;
+		node->mSentRotation = quat;
 	}
 	if (type & UPD_SCALE)
 	{
 		//llinfos << "Sending object scale " << object->getScale() << llendl;
 		htonmemcpy(&data[offset], &(object->getScale().mV), MVT_LLVector3, 12); 
 		offset += 12;
+		node->mSentScale = object->getScale();
 	}
+	node->mSentUpdateMask |= type & (UPD_POSITION | UPD_ROTATION | UPD_SCALE);
 	gMessageSystem->addBinaryDataFast(_PREHASH_Data, data, offset);
 }
 
@@ -3737,6 +3874,7 @@ void LLSelectMgr::saveSelectedObjectTextures()
 		}
 	} func;
 	getSelection()->applyToNodes(&func);	
+	dirtySelectionAggregates();
 
 	// request object properties message to get updated permissions data
 	sendSelect();
@@ -3804,6 +3942,13 @@ void LLSelectMgr::saveSelectedObjectTransform(EActionType action_type)
 		
 			selectNode->mSavedScale = object->getScale();
 			selectNode->saveTextureScaleRatios();
+
+			// the simulator agrees with us at this point, so streamed
+			// updates of the edit only need to carry what moves away from it
+			selectNode->mSentPositionLocal = object->getPosition();
+			selectNode->mSentRotation = object->getRotation();
+			selectNode->mSentScale = object->getScale();
+			selectNode->mSentUpdateMask = UPD_POSITION | UPD_ROTATION | UPD_SCALE;
 			return true;
 		}
 	} func(action_type);
@@ -4395,6 +4540,7 @@ void LLSelectMgr::processObjectProperties(LLMessageSystem* msg, void** user_data
 			}
 
 			node->mValid = TRUE;
+			dirtySelectionAggregates();
 			node->mPermissions->init(creator_id, owner_id,
 									 last_owner_id, group_id);
 			node->mPermissions->initMasks(base_mask, owner_mask, everyone_mask, group_mask, next_owner_mask);
@@ -4505,6 +4651,7 @@ void LLSelectMgr::processObjectPropertiesFamily(LLMessageSystem* msg, void** use
 	if (node)
 	{
 		node->mValid = TRUE;
+		dirtySelectionAggregates();
 		node->mPermissions->init(LLUUID::null, owner_id,
 								 last_owner_id, group_id);
 		node->mPermissions->initMasks(base_mask, owner_mask, everyone_mask, group_mask, next_owner_mask);
@@ -4978,6 +5125,7 @@ LLSelectNode::LLSelectNode(LLViewerObject* object, BOOL glow)
 	mPermissions(new LLPermissions()),
 	mInventorySerial(0),
 	mSilhouetteExists(FALSE),
+	mSentUpdateMask(UPD_NONE),
 	mDuplicated(FALSE),
 	mTESelectMask(0),
 	mLastTESelected(0),
@@ -5012,6 +5160,10 @@ LLSelectNode::LLSelectNode(const LLSelectNode& nodep)
 	mSavedPositionGlobal = nodep.mSavedPositionGlobal;
 	mSavedScale = nodep.mSavedScale;
 	mSavedRotation = nodep.mSavedRotation;
+	mSentPositionLocal = nodep.mSentPositionLocal;
+	mSentRotation = nodep.mSentRotation;
+	mSentScale = nodep.mSentScale;
+	mSentUpdateMask = nodep.mSentUpdateMask;
 	mDuplicated = nodep.mDuplicated;
 	mDuplicatePos = nodep.mDuplicatePos;
 	mDuplicateRot = nodep.mDuplicateRot;
@@ -5094,6 +5246,7 @@ LLViewerObject* LLSelectNode::getObject()
 	else if (mObject->isDead())
 	{
 		mObject = NULL;
+		LLSelectMgr::dirtySelectionAggregates();
 	}
 	return mObject;
 }
@@ -5101,6 +5254,7 @@ LLViewerObject* LLSelectNode::getObject()
 void LLSelectNode::setObject(LLViewerObject* object)
 {
 	mObject = object;
+	LLSelectMgr::dirtySelectionAggregates();
 }
 
 void LLSelectNode::saveColors()
@@ -5859,6 +6013,7 @@ void LLObjectSelection::addNode(LLSelectNode *nodep)
 	llassert_always(nodep->getObject() && !nodep->getObject()->isDead());
 	mList.push_front(nodep);
 	mSelectNodeMap[nodep->getObject()] = nodep;
+	LLSelectMgr::dirtySelectionAggregates();
 }
 
 void LLObjectSelection::addNodeAtEnd(LLSelectNode *nodep)
@@ -5866,12 +6021,14 @@ void LLObjectSelection::addNodeAtEnd(LLSelectNode *nodep)
 	llassert_always(nodep->getObject() && !nodep->getObject()->isDead());
 	mList.push_back(nodep);
 	mSelectNodeMap[nodep->getObject()] = nodep;
+	LLSelectMgr::dirtySelectionAggregates();
 }
 
 void LLObjectSelection::moveNodeToFront(LLSelectNode *nodep)
 {
 	mList.remove(nodep);
 	mList.push_front(nodep);
+	LLSelectMgr::dirtySelectionAggregates();
 }
 
 void LLObjectSelection::removeNode(LLSelectNode *nodep)
@@ -5891,6 +6048,7 @@ void LLObjectSelection::deleteAllNodes()
 	mList.clear();
 	mSelectNodeMap.clear();
 	mPrimaryObject = NULL;
+	LLSelectMgr::dirtySelectionAggregates();
 }
 
 LLSelectNode* LLObjectSelection::findNode(LLViewerObject* objectp)
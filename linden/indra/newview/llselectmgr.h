@@ -172,6 +172,10 @@ public:
 	LLVector3		mLastScale;
 	LLQuaternion	mSavedRotation;			// for interactively modifying object rotation
 	LLQuaternion	mLastRotation;
+	LLVector3		mSentPositionLocal;		// last transform the simulator was sent, so streamed edits only carry what changed
+	LLQuaternion	mSentRotation;
+	LLVector3		mSentScale;
+	U32				mSentUpdateMask;		// which of the above are known (UPD_POSITION, UPD_ROTATION, UPD_SCALE)
 	BOOL			mDuplicated;
 	LLVector3d		mDuplicatePos;
 	LLQuaternion	mDuplicateRot;
@@ -342,6 +346,7 @@ public:
 	static BOOL					sRenderSelectionHighlights;	// do we show selection silhouettes?
 	static BOOL					sRenderHiddenSelections;	// do we show selection silhouettes that are occluded?
 	static BOOL					sRenderLightRadius;	// do we show the radius of selected lights?
+	static U32					sSelectionRevision;	// bumped when anything the cached selection aggregates depend on changes
 	static F32					sHighlightThickness;
 	static F32					sHighlightUScale;
 	static F32					sHighlightVScale;
@@ -585,6 +590,10 @@ public:
 	// with the aggregate permissions for texture inventory items of the selection.
 	BOOL selectGetAggregateTexturePermissions(LLAggregatePermissions& ag_perm);
 
+	// Call when select nodes are added, removed or reordered, when their
+	// properties arrive, or when a selected object is linked or dies.
+	static void dirtySelectionAggregates() { ++sSelectionRevision; }
+
 	LLPermissions* findObjectPermissions(const LLViewerObject* object);
 
 	void selectDelete();							// Delete on simulator
@@ -601,6 +610,10 @@ public:
 								BOOL select_copy);
 
 	void sendMultipleUpdate(U32 type);	// Position, rotation, scale all in one
+	// For manipulator drags: merges ticks until the next sendPendingUpdates(),
+	// which sends only the components that changed since they were last sent.
+	void queueMultipleUpdate(U32 type);
+	void sendPendingUpdates();			// called once per frame
 	void sendOwner(const LLUUID& owner_id, const LLUUID& group_id, BOOL override = FALSE);
 	void sendGroup(const LLUUID& group_id);
 
@@ -716,8 +729,64 @@ private:
 	LLBBox					mSavedSelectionBBox;
 
 	LLFrameTimer			mEffectsTimer;
+	U32						mPendingUpdateType;		// UPD_* flags queued by queueMultipleUpdate()
+	LLFrameTimer			mPendingUpdateTimer;
+	std::map<U64, U32>		mPendingUpdateStart;	// per region handle, node the next streamed send starts at
 	BOOL					mForceSelection;
 
+	// Results of the selectGet*() queries that only look at select node
+	// data. Build and edit panels ask for these every frame, so they are
+	// gathered in one pass over the selection and kept until
+	// sSelectionRevision moves on.
+	enum EAggregateState
+	{
+		AGGREGATE_IDENTICAL,	// all nodes seen so far agree
+		AGGREGATE_MIXED,		// a valid node disagreed with the first one
+		AGGREGATE_INVALID		// hit a node with no properties before any disagreement
+	};
+	struct LLSelectionAggregates
+	{
+		LLSelectionAggregates() : mRevision(0), mSelection(NULL) {}
+
+		U32					mRevision;
+		LLObjectSelection*	mSelection;
+
+		// over all nodes
+		BOOL				mAllValid;
+
+		// over root objects
+		S32					mNumRootObjects;
+		BOOL				mRootObjectsValid;
+		BOOL				mAllGroupOwned;
+		EAggregateState		mCreatorState;
+		LLUUID				mCreatorID;
+		EAggregateState		mOwnerState;
+		LLUUID				mOwnerID;
+		BOOL				mOwnerGroupOwned;
+		EAggregateState		mLastOwnerState;
+		LLUUID				mLastOwnerID;
+		EAggregateState		mGroupState;
+		LLUUID				mGroupID;
+
+		// over roots
+		S32					mNumRoots;
+		BOOL				mRootsValid;
+		U32					mMaskAnd[5];	// PERM_BASE, PERM_OWNER, PERM_GROUP, PERM_EVERYONE, PERM_NEXT_OWNER
+		U32					mMaskOr[5];
+		LLPermissions		mPermissions;
+		LLSaleInfo			mSaleInfo;
+		LLAggregatePermissions mAggregatePerm;
+		U32					mNumForSale;
+		BOOL				mForSaleMixed;
+		BOOL				mSalePriceMixed;
+		S32					mTotalSalePrice;
+		S32					mFirstSalePrice;
+	};
+	const LLSelectionAggregates& getSelectionAggregates();
+	static void updateAggregateState(EAggregateState& state, BOOL valid, BOOL same);
+
+	LLSelectionAggregates	mAggregates;
+
 	LLAnimPauseRequest		mPauseRequest;
 
 	static std::set<LLUUID> sObjectPropertiesFamilyRequests;
@@ -940,6 +940,7 @@ LLSpatialGroup::LLSpatialGroup(OctreeNode* node, LLSpatialPartition* part) :
 	mBuilt(0.f),
 	mOctreeNode(node),
 	mSpatialPartition(part),
+	mCullPlaneHint(0),
 	mVertexBuffer(NULL), 
 	mBufferUsage(GL_STATIC_DRAW_ARB),
 	mVisible(0),
@@ -1527,7 +1528,7 @@ public:
 	
 	virtual S32 frustumCheck(const LLSpatialGroup* group)
 	{
-		S32 res = mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+		S32 res = mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1], group->mCullPlaneHint);
 		if (res != 0)
 		{
 			res = llmin(res, AABBSphereIntersect(group->mExtents[0], group->mExtents[1], mCamera->getOrigin(), mCamera->mFrustumCornerDist));
@@ -1602,7 +1603,7 @@ public:
 
 	virtual S32 frustumCheck(const LLSpatialGroup* group)
 	{
-		return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+		return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1], group->mCullPlaneHint);
 	}
 
 	virtual S32 frustumCheckObjects(const LLSpatialGroup* group)
@@ -1911,6 +1912,27 @@ S32 LLSpatialPartition::cull(LLCamera &camera, std::vector<LLDrawable *>* result
 	return 0;
 }
 
+BOOL LLSpatialPartition::getRootExtents(LLVector3& min, LLVector3& max)
+{
+	if (mOctree->getElementCount() == 0 && mOctree->getChildCount() == 0)
+	{
+		return FALSE;
+	}
+
+	LLSpatialGroup* group = (LLSpatialGroup*) mOctree->getListener(0);
+	{
+		BOOL temp = sFreezeState;
+		sFreezeState = FALSE;
+		LLFastTimer ftm(LLFastTimer::FTM_CULL_REBOUND);
+		group->rebound();
+		sFreezeState = temp;
+	}
+
+	min = group->mBounds[0] - group->mBounds[1];
+	max = group->mBounds[0] + group->mBounds[1];
+	return TRUE;
+}
+
 BOOL earlyFail(LLCamera* camera, LLSpatialGroup* group)
 {
 	const F32 vel = SG_OCCLUSION_FUDGE*2.f;
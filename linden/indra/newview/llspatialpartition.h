@@ -289,6 +289,9 @@ public:
 	LLVector3 mObjectExtents[2];
 	LLVector3 mObjectBounds[2];
 
+	// Frustum plane that last rejected this group (see LLCamera::AABBInFrustumNoFarClip)
+	mutable U8 mCullPlaneHint;
+
 	LLPointer<LLVertexBuffer> mVertexBuffer;
 	F32*					mOcclusionVerts;
 	GLuint					mOcclusionQuery;
@@ -367,6 +370,7 @@ public:
 	void resetVertexBuffers();
 	BOOL isOcclusionEnabled();
 	BOOL getVisibleExtents(LLCamera& camera, LLVector3& visMin, LLVector3& visMax);
+	BOOL getRootExtents(LLVector3& min, LLVector3& max); // rebounds the root, returns FALSE if empty
 
 public:
 	LLSpatialGroup::OctreeNode* mOctree;
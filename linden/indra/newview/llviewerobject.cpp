@@ -524,6 +524,11 @@ void LLViewerObject::addChild(LLViewerObject *childp)
 	childp->setParent(this);
 	mChildList.push_back(childp);
 
+	if (childp->isSelected())
+	{
+		// which selected nodes count as roots just changed
+		LLSelectMgr::dirtySelectionAggregates();
+	}
 }
 
 void LLViewerObject::removeChild(LLViewerObject *childp)
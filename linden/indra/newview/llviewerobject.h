@@ -481,6 +481,7 @@ public:
 	
 	friend class LLViewerObjectList;
 	friend class LLViewerMediaList;
+	friend class LLNetMapLayers;
 
 public:
 	//counter-translation
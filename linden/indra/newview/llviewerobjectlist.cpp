@@ -240,6 +240,7 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
 	}
 
 	updateActive(objectp);
+	LLNetMapLayers::getInstance()->markDirty(objectp);
 
 	if(!just_created)
 		primbackup::getInstance()->prim_update(objectp);
@@ -288,12 +289,8 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 {
 	LLFastTimer t(LLFastTimer::FTM_PROCESS_OBJECTS);	
 	
-	LLVector3d camera_global = gAgent.getCameraPositionGlobal();
 	LLViewerObject *objectp;
 	S32			num_objects;
-	U32			local_id;
-	LLPCode		pcode = 0;
-	LLUUID		fullid;
 	S32			i;
 
 	// figure out which simulator these are from and get it's index
@@ -342,106 +339,20 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		return;
 	}
 
-	U8 compressed_dpbuffer[2048];
-	LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, 2048);
-	LLDataPacker *cached_dpp = NULL;
-	
-	for (i = 0; i < num_objects; i++)
+	// Decode stage: pull ids and compressed payloads out of every block
+	// before any object is looked up or touched.
+	S32 num_blocks = decodeObjectUpdate(mesgsys, regionp, update_type, cached, compressed);
+
+	// Apply stage
+	for (S32 block_num = 0; block_num < num_blocks; block_num++)
 	{
-		LLTimer update_timer;
+		LLObjectUpdateBlock& block = mUpdateBlocks[block_num];
+		const LLUUID& fullid = block.mFullID;
+		const U32 local_id = block.mLocalID;
+		LLPCode pcode = block.mPCode;
+		i = block.mBlock;
 		BOOL justCreated = FALSE;
 
-		if (cached)
-		{
-			U32 id;
-			U32 crc;
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, id, i);
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
-		
-			// Lookup data packer and add this id to cache miss lists if necessary.
-			cached_dpp = regionp->getDP(id, crc);
-			if (cached_dpp)
-			{
-				cached_dpp->reset();
-				cached_dpp->unpackUUID(fullid, "ID");
-				cached_dpp->unpackU32(local_id, "LocalID");
-				cached_dpp->unpackU8(pcode, "PCode");
-			}
-			else
-			{
-				continue; // no data packer, skip this object
-			}
-		}
-		else if (compressed)
-		{
-			U8							compbuffer[2048];
-			S32							uncompressed_length = 2048;
-			S32							compressed_length;
-			
-			compressed_dp.reset();
-
-			U32 flags = 0;
-			if (update_type != OUT_TERSE_IMPROVED)
-			{
-				mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
-			}
-			
-			if (flags & FLAGS_ZLIB_COMPRESSED)
-			{
-				compressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
-				mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compbuffer, 0, i);
-				uncompressed_length = 2048;
-				uncompress(compressed_dpbuffer, (unsigned long *)&uncompressed_length,
-						   compbuffer, compressed_length);
-				compressed_dp.assignBuffer(compressed_dpbuffer, uncompressed_length);
-			}
-			else
-			{
-				uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
-				mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compressed_dpbuffer, 0, i);
-				compressed_dp.assignBuffer(compressed_dpbuffer, uncompressed_length);
-			}
-
-
-			if (update_type != OUT_TERSE_IMPROVED)
-			{
-				compressed_dp.unpackUUID(fullid, "ID");
-				compressed_dp.unpackU32(local_id, "LocalID");
-				compressed_dp.unpackU8(pcode, "PCode");
-			}
-			else
-			{
-				compressed_dp.unpackU32(local_id, "LocalID");
-				getUUIDFromLocal(fullid,
-								 local_id,
-								 gMessageSystem->getSenderIP(),
-								 gMessageSystem->getSenderPort());
-				if (fullid.isNull())
-				{
-					//llwarns << "update for unknown localid " << local_id << " host " << gMessageSystem->getSender() << llendl;
-					mNumUnknownUpdates++;
-				}
-			}
-		}
-		else if (update_type != OUT_FULL)
-		{
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
-			getUUIDFromLocal(fullid,
-							local_id,
-							gMessageSystem->getSenderIP(),
-							gMessageSystem->getSenderPort());
-			if (fullid.isNull())
-			{
-				//llwarns << "update for unknown localid " << local_id << " host " << gMessageSystem->getSender() << llendl;
-				mNumUnknownUpdates++;
-			}
-		}
-		else
-		{
-			mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, fullid, i);
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
-		//	llinfos << "Full Update, obj " << local_id << ", global ID" << fullid << "from " << mesgsys->getSender() << llendl;
-		}
 		objectp = findObject(fullid);
 
 		// This looks like it will break if the local_id of the object doesn't change
@@ -489,8 +400,6 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 // 					llinfos << "terse update for an unknown object:" << fullid << llendl;
 					continue;
 				}
-
-				mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, pcode, i);
 			}
 #ifdef IGNORE_DEAD
 			if (mDeadObjects.find(fullid) != mDeadObjects.end())
@@ -522,16 +431,16 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 			{
 				objectp->mLocalID = local_id;
 			}
-			processUpdateCore(objectp, user_data, i, update_type, &compressed_dp, justCreated);
+			processUpdateCore(objectp, user_data, i, update_type, &block.mCompressedDP, justCreated);
 			if (update_type != OUT_TERSE_IMPROVED)
 			{
-				objectp->mRegionp->cacheFullUpdate(objectp, compressed_dp);
+				objectp->mRegionp->cacheFullUpdate(objectp, block.mCompressedDP);
 			}
 		}
 		else if (cached)
 		{
 			objectp->mLocalID = local_id;
-			processUpdateCore(objectp, user_data, i, update_type, cached_dpp, justCreated);
+			processUpdateCore(objectp, user_data, i, update_type, block.mCachedDP, justCreated);
 		}
 		else
 		{
@@ -546,6 +455,119 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 	LLVOAvatar::cullAvatarsByPixelArea();
 }
 
+S32 LLViewerObjectList::decodeObjectUpdate(LLMessageSystem *mesgsys,
+										   LLViewerRegion *regionp,
+										   const EObjectUpdateType update_type,
+										   bool cached, bool compressed)
+{
+	S32 num_objects = mesgsys->getNumberOfBlocksFast(_PREHASH_ObjectData);
+	if ((S32)mUpdateBlocks.size() < num_objects)
+	{
+		mUpdateBlocks.resize(num_objects);
+	}
+
+	S32 num_blocks = 0;
+	for (S32 i = 0; i < num_objects; i++)
+	{
+		LLObjectUpdateBlock& block = mUpdateBlocks[num_blocks];
+		block.mBlock = i;
+		block.mFullID.setNull();
+		block.mLocalID = 0;
+		block.mPCode = 0;
+		block.mCachedDP = NULL;
+
+		if (cached)
+		{
+			U32 id;
+			U32 crc;
+			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, id, i);
+			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
+		
+			// Lookup data packer and add this id to cache miss lists if necessary.
+			block.mCachedDP = regionp->getDP(id, crc);
+			if (!block.mCachedDP)
+			{
+				continue; // no data packer, skip this object
+			}
+			block.mCachedDP->reset();
+			block.mCachedDP->unpackUUID(block.mFullID, "ID");
+			block.mCachedDP->unpackU32(block.mLocalID, "LocalID");
+			block.mCachedDP->unpackU8(block.mPCode, "PCode");
+		}
+		else if (compressed)
+		{
+			U8							compbuffer[2048];
+			S32							uncompressed_length = 2048;
+			S32							compressed_length;
+
+			U32 flags = 0;
+			if (update_type != OUT_TERSE_IMPROVED)
+			{
+				mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+			}
+			
+			if (flags & FLAGS_ZLIB_COMPRESSED)
+			{
+				compressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+				mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compbuffer, 0, i);
+				uncompressed_length = 2048;
+				uncompress(block.mCompressedData, (unsigned long *)&uncompressed_length,
+						   compbuffer, compressed_length);
+			}
+			else
+			{
+				uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+				mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, block.mCompressedData, 0, i);
+			}
+			block.mCompressedDP.assignBuffer(block.mCompressedData, uncompressed_length);
+
+			if (update_type != OUT_TERSE_IMPROVED)
+			{
+				block.mCompressedDP.unpackUUID(block.mFullID, "ID");
+				block.mCompressedDP.unpackU32(block.mLocalID, "LocalID");
+				block.mCompressedDP.unpackU8(block.mPCode, "PCode");
+			}
+			else
+			{
+				block.mCompressedDP.unpackU32(block.mLocalID, "LocalID");
+				getUUIDFromLocal(block.mFullID,
+								 block.mLocalID,
+								 gMessageSystem->getSenderIP(),
+								 gMessageSystem->getSenderPort());
+				if (block.mFullID.isNull())
+				{
+					//llwarns << "update for unknown localid " << local_id << " host " << gMessageSystem->getSender() << llendl;
+					mNumUnknownUpdates++;
+					continue;
+				}
+			}
+		}
+		else if (update_type != OUT_FULL)
+		{
+			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, block.mLocalID, i);
+			getUUIDFromLocal(block.mFullID,
+							block.mLocalID,
+							gMessageSystem->getSenderIP(),
+							gMessageSystem->getSenderPort());
+			if (block.mFullID.isNull())
+			{
+				//llwarns << "update for unknown localid " << local_id << " host " << gMessageSystem->getSender() << llendl;
+				mNumUnknownUpdates++;
+				continue;
+			}
+		}
+		else
+		{
+			mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, block.mFullID, i);
+			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, block.mLocalID, i);
+			mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, block.mPCode, i);
+		//	llinfos << "Full Update, obj " << local_id << ", global ID" << fullid << "from " << mesgsys->getSender() << llendl;
+		}
+		num_blocks++;
+	}
+	return num_blocks;
+}
+
 void LLViewerObjectList::processCompressedObjectUpdate(LLMessageSystem *mesgsys,
 											 void **user_data,
 											 const EObjectUpdateType update_type)
@@ -836,6 +858,7 @@ void LLViewerObjectList::cleanupReferences(LLViewerObject *objectp)
 	if (objectp->isOnMap())
 	{
 		mMapObjects.removeObj(objectp);
+		LLNetMapLayers::getInstance()->removeObject(objectp);
 	}
 
 	// Don't clean up mObject references, these will be cleaned up more efficiently later!
@@ -939,6 +962,7 @@ void LLViewerObjectList::killAllObjects()
 		llwarns << "Some objects still on map object list!" << llendl;
 		mMapObjects.clear();
 	}
+	LLNetMapLayers::getInstance()->clear();
 }
 
 void LLViewerObjectList::cleanDeadObjects(BOOL use_timer)
@@ -1040,81 +1064,16 @@ void LLViewerObjectList::shiftObjects(const LLVector3 &offset)
 	LLWorld::getInstance()->shiftRegions(offset);
 }
 
-void LLViewerObjectList::renderObjectsForMap(LLNetMap &netmap)
+void LLViewerObjectList::addToMap(LLViewerObject *objectp)
 {
-	LLColor4 above_water_color = gColors.getColor( "NetMapOtherOwnAboveWater" );
-	LLColor4 below_water_color = gColors.getColor( "NetMapOtherOwnBelowWater" );
-	LLColor4 you_own_above_water_color = 
-						gColors.getColor( "NetMapYouOwnAboveWater" );
-	LLColor4 you_own_below_water_color = 
-						gColors.getColor( "NetMapYouOwnBelowWater" );
-	LLColor4 group_own_above_water_color = 
-						gColors.getColor( "NetMapGroupOwnAboveWater" );
-	LLColor4 group_own_below_water_color = 
-						gColors.getColor( "NetMapGroupOwnBelowWater" );
-
-	F32 max_radius = gSavedSettings.getF32("MiniMapPrimMaxRadius");
-
-	for (S32 i = 0; i < mMapObjects.count(); i++)
-	{
-		LLViewerObject* objectp = mMapObjects[i];
-		if (!objectp->getRegion() || objectp->isOrphaned() || objectp->isAttachment())
-		{
-			continue;
-		}
-		const LLVector3& scale = objectp->getScale();
-		const LLVector3d pos = objectp->getPositionGlobal();
-		const F64 water_height = F64( objectp->getRegion()->getWaterHeight() );
-		// LLWorld::getInstance()->getWaterHeight();
-
-		F32 approx_radius = (scale.mV[VX] + scale.mV[VY]) * 0.5f * 0.5f * 1.3f;  // 1.3 is a fudge
-
-		// DEV-17370 - megaprims of size > 4096 cause lag.  (go figger.)
-		approx_radius = llmin(approx_radius, max_radius);
-
-		LLColor4U color = above_water_color;
-		if( objectp->permYouOwner() )
-		{
-			const F32 MIN_RADIUS_FOR_OWNED_OBJECTS = 2.f;
-			if( approx_radius < MIN_RADIUS_FOR_OWNED_OBJECTS )
-			{
-				approx_radius = MIN_RADIUS_FOR_OWNED_OBJECTS;
-			}
-
-			if( pos.mdV[VZ] >= water_height )
-			{
-				if ( objectp->permGroupOwner() )
-				{
-					color = group_own_above_water_color;
-				}
-				else
-				{
-				color = you_own_above_water_color;
-			}
-			}
-			else
-			{
-				if ( objectp->permGroupOwner() )
-				{
-					color = group_own_below_water_color;
-				}
-			else
-			{
-				color = you_own_below_water_color;
-			}
-		}
-		}
-		else
-		if( pos.mdV[VZ] < water_height )
-		{
-			color = below_water_color;
-		}
+	mMapObjects.put(objectp);
+	LLNetMapLayers::getInstance()->markDirty(objectp);
+}
 
-		netmap.renderScaledPointGlobal( 
-			pos, 
-			color,
-			approx_radius );
-	}
+void LLViewerObjectList::removeFromMap(LLViewerObject *objectp)
+{
+	mMapObjects.removeObj(objectp);
+	LLNetMapLayers::getInstance()->removeObject(objectp);
 }
 
 void LLViewerObjectList::renderObjectBounds(const LLVector3 &center)
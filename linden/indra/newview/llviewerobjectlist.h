@@ -40,12 +40,12 @@
 #include "llstat.h"
 #include "lldarrayptr.h"
 #include "llstring.h"
+#include "lldatapacker.h"
 
 // project includes
 #include "llviewerobject.h"
 
 class LLCamera;
-class LLNetMap;
 class LLDebugBeacon;
 
 const U32 CLOSE_BIN_SIZE = 10;
@@ -58,6 +58,20 @@ const U32 GL_NAME_PARCEL_WALL = 1;
 
 const U32 GL_NAME_INDEX_OFFSET = 10;
 
+// One ObjectData block of an object update message, as pulled out by the
+// decode stage of LLViewerObjectList::processObjectUpdate(). The apply
+// stage reads ids and compressed payloads from here instead of the message.
+struct LLObjectUpdateBlock
+{
+	S32 mBlock;			// block number in the message
+	LLUUID mFullID;
+	U32 mLocalID;
+	LLPCode mPCode;
+	LLDataPacker* mCachedDP;	// region cache entry, for cached updates
+	LLDataPackerBinaryBuffer mCompressedDP;	// over mCompressedData, header already read
+	U8 mCompressedData[2048];
+};
+
 class LLViewerObjectList
 {
 public:
@@ -94,7 +108,6 @@ public:
 
 	void shiftObjects(const LLVector3 &offset);
 
-	void renderObjectsForMap(LLNetMap &netmap);
 	void renderObjectBounds(const LLVector3 &center);
 
 	void addDebugBeacon(const LLVector3 &pos_agent, const std::string &string,
@@ -189,6 +202,9 @@ public:
 	S32 mNumUnknownKills;
 	S32 mNumDeadObjects;
 protected:
+	// Fills mUpdateBlocks, dropping blocks that can't be applied; returns the count.
+	S32 decodeObjectUpdate(LLMessageSystem *mesgsys, LLViewerRegion *regionp, EObjectUpdateType update_type, bool cached, bool compressed);
+
 	LLDynamicArray<U64>	mOrphanParents;	// LocalID/ip,port of orphaned objects
 	LLDynamicArray<OrphanInfo> mOrphanChildren;	// UUID's of orphaned objects
 	S32 mNumOrphans;
@@ -198,6 +214,8 @@ protected:
 
 	LLDynamicArrayPtr<LLPointer<LLViewerObject> > mMapObjects;
 
+	std::vector<LLObjectUpdateBlock> mUpdateBlocks; // only grows; reused by every update message
+
 	typedef std::map<LLUUID, LLPointer<LLViewerObject> > vo_map;
 	vo_map mDeadObjects;	// Need to keep multiple entries per UUID
 
@@ -268,15 +286,5 @@ inline LLViewerObject *LLViewerObjectList::getObject(const S32 index)
 	return objectp;
 }
 
-inline void LLViewerObjectList::addToMap(LLViewerObject *objectp)
-{
-	mMapObjects.put(objectp);
-}
-
-inline void LLViewerObjectList::removeFromMap(LLViewerObject *objectp)
-{
-	mMapObjects.removeObj(objectp);
-}
-
 
 #endif // LL_VIEWER_OBJECT_LIST_H
@@ -467,6 +467,13 @@ public:
 			
 			ypos += y_inc;
 
+			addText(xpos,ypos, llformat("%d/%d Text runs cached/laid out, %d Glyph quads",
+				LLFontGL::sRunCacheHits, LLFontGL::sRunCacheMisses, LLFontGL::sGlyphQuads));
+
+			ypos += y_inc;
+
+			LLFontGL::sRunCacheHits = LLFontGL::sRunCacheMisses = LLFontGL::sGlyphQuads = 0;
+
 			LLVertexBuffer::sBindCount = LLImageGL::sBindCount = 
 				LLVertexBuffer::sSetCount = LLImageGL::sUniqueCount = 
 				gPipeline.mNumVisibleNodes = LLPipeline::sVisibleLightCount = 0;
@@ -186,6 +186,200 @@ private:
 	int mRetries;
 };
 
+/** 
+ * Element and attribute names the protocol parser acts on.  Expat hands
+ * every name to the parser, so they are looked up through a hash of the
+ * lower-cased name rather than a chain of stricmp() calls.
+ */
+enum EVivoxName
+{
+	VIVOX_UNKNOWN = 0,
+	VIVOX_RESPONSE,
+	VIVOX_EVENT,
+	VIVOX_REQUEST_ID,
+	VIVOX_ACTION,
+	VIVOX_TYPE,
+	VIVOX_INPUT_XML,
+	VIVOX_CAPTURE_DEVICES,
+	VIVOX_RENDER_DEVICES,
+	VIVOX_BUDDIES,
+	VIVOX_BLOCK_RULES,
+	VIVOX_AUTO_ACCEPT_RULES,
+	VIVOX_RETURN_CODE,
+	VIVOX_SESSION_HANDLE,
+	VIVOX_SESSION_GROUP_HANDLE,
+	VIVOX_STATUS_CODE,
+	VIVOX_STATUS_STRING,
+	VIVOX_PARTICIPANT_URI,
+	VIVOX_VOLUME,
+	VIVOX_ENERGY,
+	VIVOX_IS_MODERATOR_MUTED,
+	VIVOX_IS_SPEAKING,
+	VIVOX_ALIAS,
+	VIVOX_NUMBER_OF_ALIASES,
+	VIVOX_APPLICATION,
+	VIVOX_CONNECTOR_HANDLE,
+	VIVOX_VERSION_ID,
+	VIVOX_ACCOUNT_HANDLE,
+	VIVOX_STATE,
+	VIVOX_URI,
+	VIVOX_IS_CHANNEL,
+	VIVOX_INCOMING,
+	VIVOX_ENABLED,
+	VIVOX_NAME,
+	VIVOX_AUDIO_MEDIA,
+	VIVOX_CHANNEL_NAME,
+	VIVOX_DISPLAY_NAME,
+	VIVOX_ACCOUNT_NAME,
+	VIVOX_PARTICIPANT_TYPE,
+	VIVOX_IS_LOCALLY_MUTED,
+	VIVOX_MIC_ENERGY,
+	VIVOX_CHANNEL_URI,
+	VIVOX_BUDDY_URI,
+	VIVOX_PRESENCE,
+	VIVOX_DEVICE,
+	VIVOX_CAPTURE_DEVICE,
+	VIVOX_RENDER_DEVICE,
+	VIVOX_BUDDY,
+	VIVOX_BLOCK_RULE,
+	VIVOX_BLOCK_MASK,
+	VIVOX_PRESENCE_ONLY,
+	VIVOX_AUTO_ACCEPT_RULE,
+	VIVOX_AUTO_ACCEPT_MASK,
+	VIVOX_AUTO_ADD_AS_BUDDY,
+	VIVOX_MESSAGE_HEADER,
+	VIVOX_MESSAGE_BODY,
+	VIVOX_NOTIFICATION_TYPE,
+	VIVOX_HAS_TEXT,
+	VIVOX_HAS_AUDIO,
+	VIVOX_HAS_VIDEO,
+	VIVOX_TERMINATED,
+	VIVOX_SUBSCRIPTION_HANDLE,
+	VIVOX_SUBSCRIPTION_TYPE
+};
+
+static const struct
+{
+	const char *mName;
+	EVivoxName mID;
+} sVivoxNames[] =
+{
+	{ "Response", VIVOX_RESPONSE },
+	{ "Event", VIVOX_EVENT },
+	{ "requestId", VIVOX_REQUEST_ID },
+	{ "action", VIVOX_ACTION },
+	{ "type", VIVOX_TYPE },
+	{ "InputXml", VIVOX_INPUT_XML },
+	{ "CaptureDevices", VIVOX_CAPTURE_DEVICES },
+	{ "RenderDevices", VIVOX_RENDER_DEVICES },
+	{ "Buddies", VIVOX_BUDDIES },
+	{ "BlockRules", VIVOX_BLOCK_RULES },
+	{ "AutoAcceptRules", VIVOX_AUTO_ACCEPT_RULES },
+	{ "ReturnCode", VIVOX_RETURN_CODE },
+	{ "SessionHandle", VIVOX_SESSION_HANDLE },
+	{ "SessionGroupHandle", VIVOX_SESSION_GROUP_HANDLE },
+	{ "StatusCode", VIVOX_STATUS_CODE },
+	{ "StatusString", VIVOX_STATUS_STRING },
+	{ "ParticipantURI", VIVOX_PARTICIPANT_URI },
+	{ "Volume", VIVOX_VOLUME },
+	{ "Energy", VIVOX_ENERGY },
+	{ "IsModeratorMuted", VIVOX_IS_MODERATOR_MUTED },
+	{ "IsSpeaking", VIVOX_IS_SPEAKING },
+	{ "Alias", VIVOX_ALIAS },
+	{ "NumberOfAliases", VIVOX_NUMBER_OF_ALIASES },
+	{ "Application", VIVOX_APPLICATION },
+	{ "ConnectorHandle", VIVOX_CONNECTOR_HANDLE },
+	{ "VersionID", VIVOX_VERSION_ID },
+	{ "AccountHandle", VIVOX_ACCOUNT_HANDLE },
+	{ "State", VIVOX_STATE },
+	{ "URI", VIVOX_URI },
+	{ "IsChannel", VIVOX_IS_CHANNEL },
+	{ "Incoming", VIVOX_INCOMING },
+	{ "Enabled", VIVOX_ENABLED },
+	{ "Name", VIVOX_NAME },
+	{ "AudioMedia", VIVOX_AUDIO_MEDIA },
+	{ "ChannelName", VIVOX_CHANNEL_NAME },
+	{ "DisplayName", VIVOX_DISPLAY_NAME },
+	{ "AccountName", VIVOX_ACCOUNT_NAME },
+	{ "ParticipantType", VIVOX_PARTICIPANT_TYPE },
+	{ "IsLocallyMuted", VIVOX_IS_LOCALLY_MUTED },
+	{ "MicEnergy", VIVOX_MIC_ENERGY },
+	{ "ChannelURI", VIVOX_CHANNEL_URI },
+	{ "BuddyURI", VIVOX_BUDDY_URI },
+	{ "Presence", VIVOX_PRESENCE },
+	{ "Device", VIVOX_DEVICE },
+	{ "CaptureDevice", VIVOX_CAPTURE_DEVICE },
+	{ "RenderDevice", VIVOX_RENDER_DEVICE },
+	{ "Buddy", VIVOX_BUDDY },
+	{ "BlockRule", VIVOX_BLOCK_RULE },
+	{ "BlockMask", VIVOX_BLOCK_MASK },
+	{ "PresenceOnly", VIVOX_PRESENCE_ONLY },
+	{ "AutoAcceptRule", VIVOX_AUTO_ACCEPT_RULE },
+	{ "AutoAcceptMask", VIVOX_AUTO_ACCEPT_MASK },
+	{ "AutoAddAsBuddy", VIVOX_AUTO_ADD_AS_BUDDY },
+	{ "MessageHeader", VIVOX_MESSAGE_HEADER },
+	{ "MessageBody", VIVOX_MESSAGE_BODY },
+	{ "NotificationType", VIVOX_NOTIFICATION_TYPE },
+	{ "HasText", VIVOX_HAS_TEXT },
+	{ "HasAudio", VIVOX_HAS_AUDIO },
+	{ "HasVideo", VIVOX_HAS_VIDEO },
+	{ "Terminated", VIVOX_TERMINATED },
+	{ "SubscriptionHandle", VIVOX_SUBSCRIPTION_HANDLE },
+	{ "SubscriptionType", VIVOX_SUBSCRIPTION_TYPE },
+};
+
+class LLVivoxNameTable
+{
+public:
+	LLVivoxNameTable()
+	{
+		for (S32 i = 0; i < TABLE_SIZE; i++)
+		{
+			mSlots[i] = -1;
+		}
+		for (S32 i = 0; i < (S32)(sizeof(sVivoxNames) / sizeof(sVivoxNames[0])); i++)
+		{
+			U32 slot = hash(sVivoxNames[i].mName);
+			while (mSlots[slot] != -1)
+			{
+				slot = (slot + 1) & (TABLE_SIZE - 1);
+			}
+			mSlots[slot] = i;
+		}
+	}
+
+	EVivoxName lookup(const char *name) const
+	{
+		U32 slot = hash(name);
+		while (mSlots[slot] != -1)
+		{
+			if (!stricmp(name, sVivoxNames[mSlots[slot]].mName))
+			{
+				return sVivoxNames[mSlots[slot]].mID;
+			}
+			slot = (slot + 1) & (TABLE_SIZE - 1);
+		}
+		return VIVOX_UNKNOWN;
+	}
+
+private:
+	// FNV-1a of the lower-cased name, folded into the table
+	static U32 hash(const char *name)
+	{
+		U32 h = 2166136261U;
+		for (; *name; ++name)
+		{
+			h = (h ^ (U8)tolower((U8)*name)) * 16777619U;
+		}
+		return h & (TABLE_SIZE - 1);
+	}
+
+	enum { TABLE_SIZE = 256 };	// power of two, over four times the number of names
+	S32 mSlots[TABLE_SIZE];		// index into sVivoxNames, or -1
+};
+
+static const LLVivoxNameTable sVivoxNameTable;
+
 /** 
  * @class LLVivoxProtocolParser
  * @brief This class helps construct new LLIOPipe specializations
@@ -215,6 +409,8 @@ protected:
 		LLPumpIO* pump);
 	//@}
 	
+	// Tail of a message whose delimiter hasn't arrived yet.  Messages that
+	// fit in one buffer segment are parsed in place and never copied here.
 	std::string 	mInput;
 	
 	// Expat control members
@@ -275,9 +471,16 @@ protected:
 	std::string		textBuffer;
 	bool			accumulateText;
 	
+	// ParticipantUpdatedEvents waiting to be handed to the voice client.
+	// The entries are reused, so only the first mNumParticipantUpdates are live.
+	std::vector<LLVoiceClient::participantUpdate>	mParticipantUpdates;
+	S32				mNumParticipantUpdates;
+	
 	void			reset();
 
-	void			processResponse(std::string tag);
+	void			parseMessage(const char *message, S32 length);
+	void			processResponse(const char *tag);
+	void			flushParticipantUpdates();
 
 static void XMLCALL ExpatStartTag(void *data, const char *el, const char **attr);
 static void XMLCALL ExpatEndTag(void *data, const char *el);
@@ -293,6 +496,7 @@ LLVivoxProtocolParser::LLVivoxProtocolParser()
 {
 	parser = NULL;
 	parser = XML_ParserCreate(NULL);
+	mNumParticipantUpdates = 0;
 	
 	reset();
 }
@@ -336,41 +540,80 @@ LLIOPipe::EStatus LLVivoxProtocolParser::process_impl(
 	LLSD& context,
 	LLPumpIO* pump)
 {
-	LLBufferStream istr(channels, buffer.get());
-	std::ostringstream ostr;
-	while (istr.good())
+	// Read the input channel straight out of the buffer segments, erasing
+	// each one once it has been consumed.
+	LLBufferArray::segment_iterator_t seg_iter = buffer->beginSegment();
+	LLBufferArray::segment_iterator_t seg_end = buffer->endSegment();
+	while (seg_iter != seg_end)
 	{
-		char buf[1024];
-		istr.read(buf, sizeof(buf));
-		mInput.append(buf, istr.gcount());
-	}
-	
-	// Look for input delimiter(s) in the input buffer.  If one is found, send the message to the xml parser.
-	int start = 0;
-	int delim;
-	while((delim = mInput.find("\n\n\n", start)) != std::string::npos)
-	{	
-		
-		// Reset internal state of the LLVivoxProtocolParser (no effect on the expat parser)
-		reset();
-		
-		XML_ParserReset(parser, NULL);
-		XML_SetElementHandler(parser, ExpatStartTag, ExpatEndTag);
-		XML_SetCharacterDataHandler(parser, ExpatCharHandler);
-		XML_SetUserData(parser, this);	
-		XML_Parse(parser, mInput.data() + start, delim - start, false);
-		
-		// If this message isn't set to be squelched, output the raw XML received.
-		if(!squelchDebugOutput)
+		if (!(*seg_iter).isOnChannel(channels.in()))
 		{
-			LL_DEBUGS("Voice") << "parsing: " << mInput.substr(start, delim - start) << LL_ENDL;
+			++seg_iter;
+			continue;
 		}
-		
-		start = delim + 3;
+
+		const char *pos = (const char *)(*seg_iter).data();
+		const char *end = pos + (*seg_iter).size();
+
+		// The "\n\n\n" input delimiter may straddle the previous segment.
+		if (!mInput.empty())
+		{
+			S32 trailing = 0;
+			while (trailing < 2 && trailing < (S32)mInput.size()
+				   && mInput[mInput.size() - 1 - trailing] == '\n')
+			{
+				trailing++;
+			}
+			S32 needed = 3 - trailing;
+			if (trailing > 0 && end - pos >= needed
+				&& std::count(pos, pos + needed, '\n') == needed)
+			{
+				parseMessage(mInput.data(), mInput.size() - trailing);
+				mInput.clear();
+				pos += needed;
+			}
+		}
+
+		// Look for input delimiter(s) in the segment.  Each complete message
+		// is sent to the xml parser.
+		const char *scan = pos;
+		while (scan < end)
+		{
+			const char *delim = (const char *)memchr(scan, '\n', end - scan);
+			if (!delim || end - delim < 3)
+			{
+				break;
+			}
+			if (delim[1] != '\n')
+			{
+				scan = delim + 1;
+			}
+			else if (delim[2] != '\n')
+			{
+				scan = delim + 2;
+			}
+			else
+			{
+				if (mInput.empty())
+				{
+					parseMessage(pos, delim - pos);
+				}
+				else
+				{
+					mInput.append(pos, delim - pos);
+					parseMessage(mInput.data(), mInput.size());
+					mInput.clear();
+				}
+				pos = scan = delim + 3;
+			}
+		}
+		mInput.append(pos, end - pos);
+
+		buffer->eraseSegment(seg_iter++);
 	}
-	
-	if(start != 0)
-		mInput = mInput.substr(start);
+
+	// Hand over whatever this read produced in one go.
+	flushParticipantUpdates();
 
 	LL_DEBUGS("VivoxProtocolParser") << "at end, mInput is: " << mInput << LL_ENDL;
 	
@@ -384,6 +627,24 @@ LLIOPipe::EStatus LLVivoxProtocolParser::process_impl(
 	return STATUS_OK;
 }
 
+void LLVivoxProtocolParser::parseMessage(const char *message, S32 length)
+{
+	// Reset internal state of the LLVivoxProtocolParser (no effect on the expat parser)
+	reset();
+	
+	XML_ParserReset(parser, NULL);
+	XML_SetElementHandler(parser, ExpatStartTag, ExpatEndTag);
+	XML_SetCharacterDataHandler(parser, ExpatCharHandler);
+	XML_SetUserData(parser, this);	
+	XML_Parse(parser, message, length, false);
+	
+	// If this message isn't set to be squelched, output the raw XML received.
+	if(!squelchDebugOutput)
+	{
+		LL_DEBUGS("Voice") << "parsing: " << std::string(message, length) << LL_ENDL;
+	}
+}
+
 void XMLCALL LLVivoxProtocolParser::ExpatStartTag(void *data, const char *el, const char **attr)
 {
 	if (data)
@@ -425,11 +686,12 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 	// only accumulate text if we're not ignoring tags.
 	accumulateText = !ignoringTags;
 	
+	EVivoxName name = sVivoxNameTable.lookup(tag);
 	if (responseDepth == 0)
 	{	
-		isEvent = !stricmp("Event", tag);
+		isEvent = (name == VIVOX_EVENT);
 		
-		if (!stricmp("Response", tag) || isEvent)
+		if (name == VIVOX_RESPONSE || isEvent)
 		{
 			// Grab the attributes
 			while (*attr)
@@ -437,17 +699,19 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 				const char	*key = *attr++;
 				const char	*value = *attr++;
 				
-				if (!stricmp("requestId", key))
+				switch (sVivoxNameTable.lookup(key))
 				{
+				case VIVOX_REQUEST_ID:
 					requestId = value;
-				}
-				else if (!stricmp("action", key))
-				{
+					break;
+				case VIVOX_ACTION:
 					actionString = value;
-				}
-				else if (!stricmp("type", key))
-				{
+					break;
+				case VIVOX_TYPE:
 					eventTypeString = value;
+					break;
+				default:
+					break;
 				}
 			}
 		}
@@ -463,36 +727,34 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 		{
 			LL_DEBUGS("VivoxProtocolParser") << tag << " (" << responseDepth << ")"  << LL_ENDL;
 	
-			// Ignore the InputXml stuff so we don't get confused
-			if (!stricmp("InputXml", tag))
+			switch (name)
 			{
+			case VIVOX_INPUT_XML:
+				// Ignore the InputXml stuff so we don't get confused
 				ignoringTags = true;
 				ignoreDepth = responseDepth;
 				accumulateText = false;
 
 				LL_DEBUGS("VivoxProtocolParser") << "starting ignore, ignoreDepth is " << ignoreDepth << LL_ENDL;
-			}
-			else if (!stricmp("CaptureDevices", tag))
-			{
+				break;
+			case VIVOX_CAPTURE_DEVICES:
 				gVoiceClient->clearCaptureDevices();
-			}
-			else if (!stricmp("RenderDevices", tag))
-			{
+				break;
+			case VIVOX_RENDER_DEVICES:
 				gVoiceClient->clearRenderDevices();
-			}
-			else if (!stricmp("Buddies", tag))
-			{
+				break;
+			case VIVOX_BUDDIES:
 				gVoiceClient->deleteAllBuddies();
-			}
-			else if (!stricmp("BlockRules", tag))
-			{
+				break;
+			case VIVOX_BLOCK_RULES:
 				gVoiceClient->deleteAllBlockRules();
-			}
-			else if (!stricmp("AutoAcceptRules", tag))
-			{
+				break;
+			case VIVOX_AUTO_ACCEPT_RULES:
 				gVoiceClient->deleteAllAutoAcceptRules();
+				break;
+			default:
+				break;
 			}
-			
 		}
 	}
 	responseDepth++;
@@ -525,124 +787,151 @@ void LLVivoxProtocolParser::EndTag(const char *tag)
 		LL_DEBUGS("VivoxProtocolParser") << "processing tag " << tag << " (depth = " << responseDepth << ")" << LL_ENDL;
 
 		// Closing a tag. Finalize the text we've accumulated and reset
-		if (!stricmp("ReturnCode", tag))
+		switch (sVivoxNameTable.lookup(tag))
+		{
+		case VIVOX_RETURN_CODE:
 			returnCode = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("SessionHandle", tag))
+			break;
+		case VIVOX_SESSION_HANDLE:
 			sessionHandle = string;
-		else if (!stricmp("SessionGroupHandle", tag))
+			break;
+		case VIVOX_SESSION_GROUP_HANDLE:
 			sessionGroupHandle = string;
-		else if (!stricmp("StatusCode", tag))
+			break;
+		case VIVOX_STATUS_CODE:
 			statusCode = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("StatusString", tag))
+			break;
+		case VIVOX_STATUS_STRING:
+		case VIVOX_PRESENCE:
 			statusString = string;
-		else if (!stricmp("ParticipantURI", tag))
+			break;
+		case VIVOX_PARTICIPANT_URI:
+		case VIVOX_URI:
+		case VIVOX_CHANNEL_URI:
+		case VIVOX_BUDDY_URI:
 			uriString = string;
-		else if (!stricmp("Volume", tag))
+			break;
+		case VIVOX_VOLUME:
 			volume = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("Energy", tag))
+			break;
+		case VIVOX_ENERGY:
+		case VIVOX_MIC_ENERGY:
 			energy = (F32)strtod(string.c_str(), NULL);
-		else if (!stricmp("IsModeratorMuted", tag))
+			break;
+		case VIVOX_IS_MODERATOR_MUTED:
 			isModeratorMuted = !stricmp(string.c_str(), "true");
-		else if (!stricmp("IsSpeaking", tag))
+			break;
+		case VIVOX_IS_SPEAKING:
 			isSpeaking = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Alias", tag))
+			break;
+		case VIVOX_ALIAS:
 			alias = string;
-		else if (!stricmp("NumberOfAliases", tag))
+			break;
+		case VIVOX_NUMBER_OF_ALIASES:
 			numberOfAliases = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("Application", tag))
+			break;
+		case VIVOX_APPLICATION:
 			applicationString = string;
-		else if (!stricmp("ConnectorHandle", tag))
+			break;
+		case VIVOX_CONNECTOR_HANDLE:
 			connectorHandle = string;
-		else if (!stricmp("VersionID", tag))
+			break;
+		case VIVOX_VERSION_ID:
 			versionID = string;
-		else if (!stricmp("AccountHandle", tag))
+			break;
+		case VIVOX_ACCOUNT_HANDLE:
 			accountHandle = string;
-		else if (!stricmp("State", tag))
+			break;
+		case VIVOX_STATE:
 			state = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("URI", tag))
-			uriString = string;
-		else if (!stricmp("IsChannel", tag))
+			break;
+		case VIVOX_IS_CHANNEL:
 			isChannel = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Incoming", tag))
+			break;
+		case VIVOX_INCOMING:
 			incoming = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Enabled", tag))
+			break;
+		case VIVOX_ENABLED:
 			enabled = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Name", tag))
+			break;
+		case VIVOX_NAME:
+		case VIVOX_CHANNEL_NAME:
+		case VIVOX_ACCOUNT_NAME:
 			nameString = string;
-		else if (!stricmp("AudioMedia", tag))
+			break;
+		case VIVOX_AUDIO_MEDIA:
 			audioMediaString = string;
-		else if (!stricmp("ChannelName", tag))
-			nameString = string;
-		else if (!stricmp("DisplayName", tag))
+			break;
+		case VIVOX_DISPLAY_NAME:
 			displayNameString = string;
-		else if (!stricmp("AccountName", tag))
-			nameString = string;
-		else if (!stricmp("ParticipantType", tag))
+			break;
+		case VIVOX_PARTICIPANT_TYPE:
 			participantType = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("IsLocallyMuted", tag))
+			break;
+		case VIVOX_IS_LOCALLY_MUTED:
 			isLocallyMuted = !stricmp(string.c_str(), "true");
-		else if (!stricmp("MicEnergy", tag))
-			energy = (F32)strtod(string.c_str(), NULL);
-		else if (!stricmp("ChannelName", tag))
-			nameString = string;
-		else if (!stricmp("ChannelURI", tag))
-			uriString = string;
-		else if (!stricmp("BuddyURI", tag))
-			uriString = string;
-		else if (!stricmp("Presence", tag))
-			statusString = string;
-		else if (!stricmp("Device", tag))
-		{
+			break;
+		case VIVOX_DEVICE:
 			// This closing tag shouldn't clear the accumulated text.
 			clearbuffer = false;
-		}
-		else if (!stricmp("CaptureDevice", tag))
-		{
+			break;
+		case VIVOX_CAPTURE_DEVICE:
 			gVoiceClient->addCaptureDevice(textBuffer);
-		}
-		else if (!stricmp("RenderDevice", tag))
-		{
+			break;
+		case VIVOX_RENDER_DEVICE:
 			gVoiceClient->addRenderDevice(textBuffer);
-		}
-		else if (!stricmp("Buddy", tag))
-		{
+			break;
+		case VIVOX_BUDDY:
 			gVoiceClient->processBuddyListEntry(uriString, displayNameString);
-		}
-		else if (!stricmp("BlockRule", tag))
-		{
+			break;
+		case VIVOX_BLOCK_RULE:
 			gVoiceClient->addBlockRule(blockMask, presenceOnly);
-		}
-		else if (!stricmp("BlockMask", tag))
+			break;
+		case VIVOX_BLOCK_MASK:
 			blockMask = string;
-		else if (!stricmp("PresenceOnly", tag))
+			break;
+		case VIVOX_PRESENCE_ONLY:
 			presenceOnly = string;
-		else if (!stricmp("AutoAcceptRule", tag))
-		{
+			break;
+		case VIVOX_AUTO_ACCEPT_RULE:
 			gVoiceClient->addAutoAcceptRule(autoAcceptMask, autoAddAsBuddy);
-		}
-		else if (!stricmp("AutoAcceptMask", tag))
+			break;
+		case VIVOX_AUTO_ACCEPT_MASK:
 			autoAcceptMask = string;
-		else if (!stricmp("AutoAddAsBuddy", tag))
+			break;
+		case VIVOX_AUTO_ADD_AS_BUDDY:
 			autoAddAsBuddy = string;
-		else if (!stricmp("MessageHeader", tag))
+			break;
+		case VIVOX_MESSAGE_HEADER:
 			messageHeader = string;
-		else if (!stricmp("MessageBody", tag))
+			break;
+		case VIVOX_MESSAGE_BODY:
 			messageBody = string;
-		else if (!stricmp("NotificationType", tag))
+			break;
+		case VIVOX_NOTIFICATION_TYPE:
 			notificationType = string;
-		else if (!stricmp("HasText", tag))
+			break;
+		case VIVOX_HAS_TEXT:
 			hasText = !stricmp(string.c_str(), "true");
-		else if (!stricmp("HasAudio", tag))
+			break;
+		case VIVOX_HAS_AUDIO:
 			hasAudio = !stricmp(string.c_str(), "true");
-		else if (!stricmp("HasVideo", tag))
+			break;
+		case VIVOX_HAS_VIDEO:
 			hasVideo = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Terminated", tag))
+			break;
+		case VIVOX_TERMINATED:
 			terminated = !stricmp(string.c_str(), "true");
-		else if (!stricmp("SubscriptionHandle", tag))
+			break;
+		case VIVOX_SUBSCRIPTION_HANDLE:
 			subscriptionHandle = string;
-		else if (!stricmp("SubscriptionType", tag))
+			break;
+		case VIVOX_SUBSCRIPTION_TYPE:
 			subscriptionType = string;
-		
+			break;
+		default:
+			break;
+		}
 
 		if(clearbuffer)
 		{
@@ -675,7 +964,7 @@ void LLVivoxProtocolParser::CharData(const char *buffer, int length)
 
 // --------------------------------------------------------------------------------
 
-void LLVivoxProtocolParser::processResponse(std::string tag)
+void LLVivoxProtocolParser::processResponse(const char *tag)
 {
 	LL_DEBUGS("VivoxProtocolParser") << tag << LL_ENDL;
 
@@ -686,6 +975,41 @@ void LLVivoxProtocolParser::processResponse(std::string tag)
 	if(returnCode == 0)
 		statusCode = 0;
 		
+	if (isEvent && !stricmp(eventTypeString.c_str(), "ParticipantUpdatedEvent"))
+	{
+		/*
+		<Event type="ParticipantUpdatedEvent">
+			<SessionGroupHandle>c1_m1000xFnPP04IpREWNkuw1cOXlhw==_sg0</SessionGroupHandle>
+			<SessionHandle>c1_m1000xFnPP04IpREWNkuw1cOXlhw==0</SessionHandle>
+			<ParticipantUri>sip:xFnPP04IpREWNkuw1cOXlhw==@bhr.vivox.com</ParticipantUri>
+			<IsModeratorMuted>false</IsModeratorMuted>
+			<IsSpeaking>true</IsSpeaking>
+			<Volume>44</Volume>
+			<Energy>0.0879437</Energy>
+		</Event>
+		*/
+		
+		// These happen so often that logging them is pretty useless.
+		squelchDebugOutput = true;
+		
+		if (mNumParticipantUpdates == (S32)mParticipantUpdates.size())
+		{
+			mParticipantUpdates.resize(mNumParticipantUpdates + 1);
+		}
+		LLVoiceClient::participantUpdate &update = mParticipantUpdates[mNumParticipantUpdates++];
+		update.mSessionHandle = sessionHandle;
+		update.mURI = uriString;
+		update.mIsModeratorMuted = isModeratorMuted;
+		update.mIsSpeaking = isSpeaking;
+		update.mVolume = volume;
+		update.mEnergy = energy;
+		return;
+	}
+
+	// Anything else may add or remove participants, so the updates that
+	// arrived before it go first.
+	flushParticipantUpdates();
+
 	if (isEvent)
 	{
 		const char *eventTypeCstr = eventTypeString.c_str();
@@ -768,25 +1092,6 @@ void LLVivoxProtocolParser::processResponse(std::string tag)
 			*/
 			gVoiceClient->participantRemovedEvent(sessionHandle, sessionGroupHandle, uriString, alias, nameString);
 		}
-		else if (!stricmp(eventTypeCstr, "ParticipantUpdatedEvent"))
-		{
-			/*
-			<Event type="ParticipantUpdatedEvent">
-				<SessionGroupHandle>c1_m1000xFnPP04IpREWNkuw1cOXlhw==_sg0</SessionGroupHandle>
-				<SessionHandle>c1_m1000xFnPP04IpREWNkuw1cOXlhw==0</SessionHandle>
-				<ParticipantUri>sip:xFnPP04IpREWNkuw1cOXlhw==@bhr.vivox.com</ParticipantUri>
-				<IsModeratorMuted>false</IsModeratorMuted>
-				<IsSpeaking>true</IsSpeaking>
-				<Volume>44</Volume>
-				<Energy>0.0879437</Energy>
-			</Event>
-			*/
-			
-			// These happen so often that logging them is pretty useless.
-			squelchDebugOutput = true;
-			
-			gVoiceClient->participantUpdatedEvent(sessionHandle, sessionGroupHandle, uriString, alias, isModeratorMuted, isSpeaking, volume, energy);
-		}
 		else if (!stricmp(eventTypeCstr, "AuxAudioPropertiesEvent"))
 		{
 			gVoiceClient->auxAudioPropertiesEvent(energy);
@@ -984,6 +1289,17 @@ void LLVivoxProtocolParser::processResponse(std::string tag)
 	}
 }
 
+// --------------------------------------------------------------------------------
+
+void LLVivoxProtocolParser::flushParticipantUpdates()
+{
+	if (mNumParticipantUpdates > 0)
+	{
+		gVoiceClient->participantUpdatedEvents(&mParticipantUpdates[0], mNumParticipantUpdates);
+		mNumParticipantUpdates = 0;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
 class LLVoiceClientMuteListObserver : public LLMuteListObserver
@@ -4428,47 +4744,52 @@ void LLVoiceClient::participantRemovedEvent(
 }
 
 
-void LLVoiceClient::participantUpdatedEvent(
-		std::string &sessionHandle, 
-		std::string &sessionGroupHandle, 
-		std::string &uriString, 
-		std::string &alias, 
-		bool isModeratorMuted, 
-		bool isSpeaking, 
-		int volume, 
-		F32 energy)
+void LLVoiceClient::participantUpdatedEvents(const participantUpdate *updates, S32 count)
 {
-	sessionState *session = findSession(sessionHandle);
-	if(session)
+	sessionState *session = NULL;
+	const std::string *session_handle = NULL;
+	for (S32 i = 0; i < count; i++)
 	{
-		participantState *participant = session->findParticipant(uriString);
-		
-		if(participant)
+		const participantUpdate &update = updates[i];
+
+		// A run of updates nearly always belongs to one session.
+		if (!session_handle || *session_handle != update.mSessionHandle)
 		{
-			participant->mIsSpeaking = isSpeaking;
-			participant->mIsModeratorMuted = isModeratorMuted;
+			session_handle = &update.mSessionHandle;
+			session = findSession(update.mSessionHandle);
+		}
 
-			// SLIM SDK: convert range: ensure that energy is set to zero if is_speaking is false
-			if (isSpeaking)
+		if(session)
+		{
+			participantState *participant = session->findParticipant(update.mURI);
+			
+			if(participant)
 			{
-				participant->mSpeakingTimeout.reset();
-				participant->mPower = energy;
+				participant->mIsSpeaking = update.mIsSpeaking;
+				participant->mIsModeratorMuted = update.mIsModeratorMuted;
+
+				// SLIM SDK: convert range: ensure that energy is set to zero if is_speaking is false
+				if (update.mIsSpeaking)
+				{
+					participant->mSpeakingTimeout.reset();
+					participant->mPower = update.mEnergy;
+				}
+				else
+				{
+					participant->mPower = 0.0f;
+				}
+				participant->mVolume = update.mVolume;
 			}
 			else
 			{
-				participant->mPower = 0.0f;
+				LL_WARNS("Voice") << "unknown participant: " << update.mURI << LL_ENDL;
 			}
-			participant->mVolume = volume;
 		}
 		else
 		{
-			LL_WARNS("Voice") << "unknown participant: " << uriString << LL_ENDL;
+			LL_INFOS("Voice") << "unknown session " << update.mSessionHandle << LL_ENDL;
 		}
 	}
-	else
-	{
-		LL_INFOS("Voice") << "unknown session " << sessionHandle << LL_ENDL;
-	}
 }
 
 void LLVoiceClient::buddyPresenceEvent(
@@ -157,7 +157,17 @@ class LLVoiceClient: public LLSingleton<LLVoiceClient>
 		void sessionRemovedEvent(std::string &sessionHandle, std::string &sessionGroupHandle);
 		void participantAddedEvent(std::string &sessionHandle, std::string &sessionGroupHandle, std::string &uriString, std::string &alias, std::string &nameString, std::string &displayNameString, int participantType);
 		void participantRemovedEvent(std::string &sessionHandle, std::string &sessionGroupHandle, std::string &uriString, std::string &alias, std::string &nameString);
-		void participantUpdatedEvent(std::string &sessionHandle, std::string &sessionGroupHandle, std::string &uriString, std::string &alias, bool isModeratorMuted, bool isSpeaking, int volume, F32 energy);
+		struct participantUpdate
+		{
+			std::string mSessionHandle;
+			std::string mURI;
+			bool mIsModeratorMuted;
+			bool mIsSpeaking;
+			int mVolume;
+			F32 mEnergy;
+		};
+		// ParticipantUpdatedEvents arrive in floods, so the parser hands over each run of them at once.
+		void participantUpdatedEvents(const participantUpdate *updates, S32 count);
 		void auxAudioPropertiesEvent(F32 energy);
 		void buddyPresenceEvent(std::string &uriString, std::string &alias, std::string &statusString, std::string &applicationString);
 		void messageEvent(std::string &sessionHandle, std::string &uriString, std::string &alias, std::string &messageHeader, std::string &messageBody, std::string &applicationString);
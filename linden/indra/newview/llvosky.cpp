@@ -547,14 +547,15 @@ void LLVOSky::createSkyTexture(const S32 side, const S32 tile)
 	S32 tile_x_pos = tile_x * sTileResX;
 	S32 tile_y_pos = tile_y * sTileResY;
 
-	S32 x, y;
-	for (y = tile_y_pos; y < (tile_y_pos + sTileResY); ++y)
+	SkyColorConstants constants;
+	initSkyColorConstants(constants);
+
+	// Pixels (x, y) to (x, y + sTileResY) are contiguous, do them as one batch
+	for (S32 x = tile_x_pos; x < (tile_x_pos + sTileResX); ++x)
 	{
-		for (x = tile_x_pos; x < (tile_x_pos + sTileResX); ++x)
-		{
-			mSkyTex[side].setPixel(calcSkyColorInDir(mSkyTex[side].getDir(x, y)), x, y);
-			mShinyTex[side].setPixel(calcSkyColorInDir(mSkyTex[side].getDir(x, y), true), x, y);
-		}
+		const S32 offset = x * sResolution + tile_y_pos;
+		calcSkyColorsInDirs(constants, mSkyTex[side].mSkyDirs + offset, sTileResY,
+							mSkyTex[side].mSkyData + offset, mShinyTex[side].mSkyData + offset);
 	}
 }
 
@@ -925,6 +926,171 @@ LLColor3 LLVOSky::calcSkyColorWLFrag(LLVector3 & Pn, LLColor3 & vary_HazeColor,
 	return res;
 }
 
+void LLVOSky::initSkyColorConstants(SkyColorConstants& constants) const
+{
+	const F32 saturation = 0.3f;
+
+	constants.mUseWindLight = gPipeline.canUseWindLightShaders();
+
+	// Below the horizon, as in calcSkyColorInDir()
+	constants.mFogColor = LLColor4(llmax(mFogColor[0],0.2f), llmax(mFogColor[1],0.2f), llmax(mFogColor[2],0.22f),0.f);
+	LLColor3 desat_fog = LLColor3(mFogColor);
+	F32 brightness = desat_fog.brightness();
+	// So that shiny somewhat shows up at night.
+	if (brightness < 0.15f)
+	{
+		brightness = 0.15f;
+		desat_fog = smear(0.15f);
+	}
+	LLColor3 greyscale = smear(brightness);
+	desat_fog = desat_fog * saturation + greyscale * (1.0f - saturation);
+	constants.mShinyFogColor = constants.mUseWindLight ? LLColor4(desat_fog * 0.5f, 0.f) : LLColor4(desat_fog, 0.f);
+
+	// Above the horizon, as in calcSkyColorWLVert()
+	constants.mLightNorm = LLVector3(lightnorm);
+
+	LLColor3 light_atten =
+		(blue_density * 1.0 + smear(haze_density * 0.25f)) * (density_multiplier * max_y);
+	constants.mNegLightAtten = light_atten * -1.f;
+
+	LLColor3 total_density = blue_density + smear(haze_density);
+	constants.mNegTotalDensity = total_density * -1.f;
+	constants.mBlueTerm = blue_horizon * componentDiv(blue_density, total_density);
+	constants.mHazeTerm = haze_horizon.mV[0] * componentDiv(smear(haze_density), total_density);
+
+	constants.mCloudAmbient = ambient + (LLColor3::white - ambient) * cloud_shadow * 0.5f;
+	constants.mCloudSunScale = 1.f - cloud_shadow;
+
+	LLColor3 sunlight = sunlight_color;
+	F32 inv_sun_path = llmax(0.f, lightnorm[1] * 2.f);
+	inv_sun_path = 1.f / inv_sun_path;
+	componentMultBy(sunlight, componentExp(constants.mNegLightAtten * inv_sun_path));
+	constants.mGroundLighting = sunlight + ambient;
+}
+
+#if LL_MSVC && __MSVC_VER__ < 8
+#pragma optimize("p", on)
+#endif
+
+void LLVOSky::calcSkyColorsInDirs(const SkyColorConstants& constants, const LLVector3* dirs, S32 count,
+								  LLColor4* sky_colors, LLColor4* shiny_colors) const
+{
+	const F32 saturation = 0.3f;
+	// Eric's original: 
+	// LLColor3 dark_brown(0.143f, 0.129f, 0.114f);
+	const LLColor3 dark_brown(0.082f, 0.076f, 0.066f);
+	const LLColor3 brown(0.430f, 0.386f, 0.322f);
+
+	for (S32 i = 0; i < count; ++i)
+	{
+		const LLVector3& dir = dirs[i];
+		if (dir.mV[VZ] < -0.02f)
+		{
+			F32 x = 1.0f-fabsf(-0.1f-dir.mV[VZ]);
+			x *= x;
+			const F32 red = x*x;
+			const F32 green = powf(x, 2.5f);
+			const F32 blue = x*x*x;
+			sky_colors[i].setVec(constants.mFogColor.mV[0] * red,
+								 constants.mFogColor.mV[1] * green,
+								 constants.mFogColor.mV[2] * blue,
+								 0.f);
+			shiny_colors[i].setVec(constants.mShinyFogColor.mV[0] * red,
+								   constants.mShinyFogColor.mV[1] * green,
+								   constants.mShinyFogColor.mV[2] * blue,
+								   0.f);
+			continue;
+		}
+
+		// undo OGL_TO_CFR_ROTATION and negate vertical direction.
+		LLVector3 Pn = LLVector3(-dir[1] , -dir[2], -dir[0]);
+
+		// project the direction ray onto the sky dome.
+		F32 phi = acos(Pn[1]);
+		F32 sinA = sin(F_PI - phi);
+		F32 Plen = dome_radius * sin(F_PI + phi + asin(dome_offset_ratio * sinA)) / sinA;
+
+		Pn *= Plen;
+
+		// Set altitude
+		if (Pn[1] > 0.f)
+		{
+			Pn *= (max_y / Pn[1]);
+		}
+		else
+		{
+			Pn *= (-32000.f / Pn[1]);
+		}
+
+		Plen = Pn.length();
+		Pn /= Plen;
+
+		// Sunlight along this ray
+		LLColor3 sunlight = sunlight_color;
+		F32 inv_sun_path = llmax(F_APPROXIMATELY_ZERO, llmax(0.f, Pn[1]) * 1.0f + constants.mLightNorm[1]);
+		inv_sun_path = 1.f / inv_sun_path;
+		componentMultBy(sunlight, componentExp(constants.mNegLightAtten * inv_sun_path));
+
+		// Transparency
+		LLColor3 transparency = componentExp(constants.mNegTotalDensity * (Plen * density_multiplier));
+
+		// Haze glow, 0 at the sun and increasing away from it
+		F32 haze_glow = Pn * constants.mLightNorm;
+		haze_glow = 1.f - haze_glow;
+		haze_glow = llmax(haze_glow, .001f);
+		haze_glow *= glow.mV[0];
+		haze_glow = pow(haze_glow, glow.mV[2]);
+		haze_glow += .25f;
+
+		// Haze color above cloud
+		LLColor3 haze_color = (constants.mBlueTerm * (sunlight + ambient)
+				+ componentMult(constants.mHazeTerm, sunlight * haze_glow + ambient)
+			 );
+
+		// Haze color below cloud
+		sunlight *= constants.mCloudSunScale;
+		LLColor3 additive_color_below_cloud = (constants.mBlueTerm * (sunlight + constants.mCloudAmbient)
+				+ componentMult(constants.mHazeTerm, sunlight * haze_glow + constants.mCloudAmbient)
+			 );
+
+		// Final atmosphere additive
+		componentMultBy(haze_color, LLColor3::white - transparency);
+
+		// At horizon, blend high altitude sky color towards the darker color below the clouds
+		transparency = componentSqrt(transparency);
+		haze_color +=
+			componentMult(additive_color_below_cloud - haze_color, LLColor3::white - componentSqrt(transparency));
+
+		if (Pn[1] < 0.f)
+		{
+			F32 haze_brightness = haze_color.brightness();
+
+			if (Pn[1] < -0.05f)
+			{
+				haze_color = colorMix(dark_brown, brown, -Pn[1] * 0.9f) * constants.mGroundLighting * haze_brightness;
+			}
+			
+			if (Pn[1] > -0.1f)
+			{
+				haze_color = colorMix(LLColor3::white * haze_brightness, haze_color, fabs((Pn[1] + 0.05f) * -20.f));
+			}
+		}
+
+		// calcSkyColorWLFrag() discards its gamma step, leaving just the saturate
+		LLColor3 sky_color = constants.mUseWindLight ? haze_color : componentSaturate(haze_color * 2.0f);
+		sky_colors[i] = LLColor4(sky_color, 0.f);
+
+		F32 brightness = sky_color.brightness();
+		LLColor3 shiny_color = sky_color * saturation + smear(brightness) * (1.0f - saturation);
+		shiny_color *= (0.5f + 0.5f * brightness);
+		shiny_colors[i] = LLColor4(shiny_color, 0.f);
+	}
+}
+
+#if LL_MSVC && __MSVC_VER__ < 8
+#pragma optimize("p", off)
+#endif
+
 LLColor3 LLVOSky::createDiffuseFromWL(LLColor3 diffuse, LLColor3 ambient, LLColor3 sundiffuse, LLColor3 sunambient)
 {
 	return componentMult(diffuse, sundiffuse) * 4.0f +
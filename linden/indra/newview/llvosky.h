@@ -459,6 +459,28 @@ public:
 							LLColor3 & vary_CloudColorAmbient, F32 & vary_CloudDensity, 
 							LLVector2 vary_HorizontalProjection[2]);
 
+	// Terms of calcSkyColorInDir() that don't depend on the direction,
+	// gathered once per tile so its pixels can be evaluated as a batch.
+	struct SkyColorConstants
+	{
+		LLColor4 mFogColor;			// below the horizon
+		LLColor4 mShinyFogColor;
+		LLVector3 mLightNorm;
+		LLColor3 mNegLightAtten;	// sunlight attenuation through the atmosphere, negated
+		LLColor3 mNegTotalDensity;	// blue_density + haze_density, negated
+		LLColor3 mBlueTerm;			// blue_horizon * blue weight
+		LLColor3 mHazeTerm;			// haze_horizon * haze weight
+		LLColor3 mCloudAmbient;		// ambient raised by cloud cover
+		LLColor3 mGroundLighting;	// ambient plus sunlight at ground level
+		F32 mCloudSunScale;			// sunlight left under the clouds
+		BOOL mUseWindLight;
+	};
+	void initSkyColorConstants(SkyColorConstants& constants) const;
+	// Same results as calcSkyColorInDir(dir) and calcSkyColorInDir(dir, true)
+	// for every direction, computing the scattering once for both.
+	void calcSkyColorsInDirs(const SkyColorConstants& constants, const LLVector3* dirs, S32 count,
+							 LLColor4* sky_colors, LLColor4* shiny_colors) const;
+
 public:
 	enum
 	{
@@ -116,6 +116,7 @@ LLWorldMap::LLWorldMap() :
 	mTelehubCoverageMap(NULL),
 	mNeighborMapWidth(0),
 	mNeighborMapHeight(0),
+	mSimNameMapDirty(false),
 	mSLURLRegionName(),
 	mSLURLRegionHandle(0),
 	mSLURL(),
@@ -148,6 +149,8 @@ void LLWorldMap::reset()
 {
 	for_each(mSimInfoMap.begin(), mSimInfoMap.end(), DeletePairedPointer());
 	mSimInfoMap.clear();
+	mSimNameMap.clear();
+	mSimNameMapDirty = false;
 
 	for (S32 m=0; m<MAP_SIM_IMAGE_TYPES; ++m)
 	{
@@ -249,21 +252,119 @@ LLSimInfo* LLWorldMap::simInfoFromHandle(const U64 handle)
 
 LLSimInfo* LLWorldMap::simInfoFromName(const std::string& sim_name)
 {
-	LLSimInfo* sim_info = NULL;
-	if (!sim_name.empty())
+	if (sim_name.empty())
 	{
-		for (sim_info_map_t::iterator it = mSimInfoMap.begin(); it != mSimInfoMap.end(); ++it)
+		return NULL;
+	}
+
+	if (mSimNameMapDirty)
+	{
+		rebuildSimNameMap();
+	}
+
+	std::string key = sim_name;
+	LLStringUtil::toLower(key);
+	sim_name_map_t::iterator it = mSimNameMap.find(key);
+	if (it != mSimNameMap.end())
+	{
+		return (*it).second;
+	}
+	return NULL;
+}
+
+void LLWorldMap::rebuildSimNameMap()
+{
+	mSimNameMap.clear();
+	for (sim_info_map_t::iterator it = mSimInfoMap.begin(); it != mSimInfoMap.end(); ++it)
+	{
+		LLSimInfo* sim_info = (*it).second;
+		if (sim_info && !sim_info->mName.empty())
 		{
-			sim_info = (*it).second;
-			if (sim_info
-				&& (0 == LLStringUtil::compareInsensitive(sim_name, sim_info->mName)) )
+			std::string key = sim_info->mName;
+			LLStringUtil::toLower(key);
+			// insert() keeps the first entry, so the lowest handle wins
+			mSimNameMap.insert(std::make_pair(key, sim_info));
+		}
+	}
+	mSimNameMapDirty = false;
+}
+
+LLSimInfo* LLWorldMap::createSimInfoFromHandle(const U64 handle)
+{
+	LLSimInfo* siminfo = new LLSimInfo();
+	sim_info_map_t::iterator iter = mSimInfoMap.find(handle);
+	if (iter != mSimInfoMap.end())
+	{
+		LLSimInfo* oldinfo = iter->second;
+		for (S32 image=0; image<MAP_SIM_IMAGE_TYPES; ++image)
+		{
+			siminfo->mMapImageID[image] = oldinfo->mMapImageID[image];
+		}
+		delete oldinfo;
+		iter->second = siminfo;
+	}
+	else
+	{
+		mSimInfoMap[handle] = siminfo;
+	}
+	siminfo->mHandle = handle;
+
+	// The caller fills in the name, so defer indexing until the next lookup.
+	mSimNameMapDirty = true;
+	return siminfo;
+}
+
+void LLWorldMap::getSimsInRect(U32 x_min, U32 y_min, U32 x_max, U32 y_max, std::vector<LLSimInfo*>& sims) const
+{
+	if (x_min > x_max || y_min > y_max)
+	{
+		return;
+	}
+
+	// Handles sort by x, then y, so each column of the rectangle is one
+	// contiguous run of the map.  Empty columns are skipped by jumping to
+	// the next handle that exists.
+	U32 x = x_min;
+	while (true)
+	{
+		sim_info_map_t::const_iterator it = mSimInfoMap.lower_bound(to_region_handle(x, y_min));
+		if (it == mSimInfoMap.end())
+		{
+			break;
+		}
+
+		U32 sim_x, sim_y;
+		from_region_handle((*it).first, &sim_x, &sim_y);
+		if (sim_x > x_max)
+		{
+			break;
+		}
+		if (sim_x != x)
+		{
+			// Nothing left in this column; carry on from the next one with sims.
+			x = sim_x;
+			if (sim_y < y_min)
+			{
+				continue;
+			}
+		}
+
+		for ( ; it != mSimInfoMap.end(); ++it)
+		{
+			from_region_handle((*it).first, &sim_x, &sim_y);
+			if (sim_x != x || sim_y > y_max)
 			{
 				break;
 			}
-			sim_info = NULL;
+			sims.push_back((*it).second);
 		}
+
+		if (x >= x_max)
+		{
+			break;
+		}
+		++x;
 	}
-	return sim_info;
 }
 
 bool LLWorldMap::simNameFromPosGlobal(const LLVector3d& pos_global, std::string & outSimName )
@@ -614,20 +715,8 @@ void LLWorldMap::processMapBlockReply(LLMessageSystem* msg, void**)
 
 // 			llinfos << "Map sim " << name << " image layer " << agent_flags << " ID " << image_id.getString() << llendl;
 			
-			LLSimInfo* siminfo = new LLSimInfo();
-			sim_info_map_t::iterator iter = LLWorldMap::getInstance()->mSimInfoMap.find(handle);
-			if (iter != LLWorldMap::getInstance()->mSimInfoMap.end())
-			{
-				LLSimInfo* oldinfo = iter->second;
-				for (S32 image=0; image<MAP_SIM_IMAGE_TYPES; ++image)
-				{
-					siminfo->mMapImageID[image] = oldinfo->mMapImageID[image];
-				}
-				delete oldinfo;
-			}
-			LLWorldMap::getInstance()->mSimInfoMap[handle] = siminfo;
+			LLSimInfo* siminfo = LLWorldMap::getInstance()->createSimInfoFromHandle(handle);
 
-			siminfo->mHandle = handle;
 			siminfo->mName.assign( name );
 			siminfo->mAccess = accesscode;
 			siminfo->mRegionFlags = region_flags;
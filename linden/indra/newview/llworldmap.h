@@ -141,6 +141,14 @@ public:
 	// Returns simulator information for named sim, or NULL if non-existent
 	LLSimInfo* simInfoFromName(const std::string& sim_name);
 
+	// Creates a fresh sim info for the region, replacing (and deleting) any
+	// existing one but carrying over its map image IDs.
+	LLSimInfo* createSimInfoFromHandle(const U64 handle);
+
+	// Appends the sims whose origin lies inside the given rectangle, in
+	// global meters, inclusive. Sims are returned in handle order.
+	void getSimsInRect(U32 x_min, U32 y_min, U32 x_max, U32 y_max, std::vector<LLSimInfo*>& sims) const;
+
 	// Gets simulator name for a global position, returns true if it was found
 	bool simNameFromPosGlobal(const LLVector3d& pos_global, std::string& outSimName );
 
@@ -218,8 +226,16 @@ public:
 	S32		mNeighborMapHeight;
 
 private:
+	void rebuildSimNameMap();
+
 	LLTimer	mRequestTimer;
 
+	// Lower-cased sim name to simulator info, rebuilt lazily after sims
+	// are added.  Duplicate names resolve to the lowest handle.
+	typedef std::map<std::string, LLSimInfo*> sim_name_map_t;
+	sim_name_map_t mSimNameMap;
+	bool mSimNameMapDirty;
+
 	// search for named region for url processing
 	std::string mSLURLRegionName;
 	U64 mSLURLRegionHandle;
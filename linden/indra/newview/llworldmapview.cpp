@@ -114,6 +114,19 @@ std::map<std::string,std::string> LLWorldMapView::sStringsMap;
 // Updates for agent locations.
 #define AGENTS_UPDATE_TIME 60.0 // in seconds
 
+// Clamps a global map coordinate to the range a region handle can hold.
+static U32 clamp_map_meters(F64 meters)
+{
+	if (meters <= 0.0)
+	{
+		return 0;
+	}
+	if (meters >= (F64)U32_MAX)
+	{
+		return U32_MAX;
+	}
+	return (U32)meters;
+}
 
 
 void LLWorldMapView::initClass()
@@ -301,7 +314,10 @@ void LLWorldMapView::draw()
 
 	F64 current_time = LLTimer::getElapsedSeconds();
 
-	mVisibleRegions.clear();
+	// Keep last frame's regions so the ones that scroll out of view can
+	// drop their texture priority below.
+	handle_list_t last_visible_regions;
+	last_visible_regions.swap(mVisibleRegions);
 	
 	// animate pan if necessary
 	sPanX = lerp(sPanX, sTargetPanX, LLCriticalDamp::getInterpolant(0.1f));
@@ -439,22 +455,29 @@ void LLWorldMapView::draw()
 	const S32 MIN_REQUEST_PER_TICK = 1;
 	S32 textures_requested_this_tick = 0;
 
-	for (LLWorldMap::sim_info_map_t::iterator it = LLWorldMap::getInstance()->mSimInfoMap.begin();
-		 it != LLWorldMap::getInstance()->mSimInfoMap.end(); ++it)
+	// Only look at sims whose origin can fall inside the view. The low side
+	// is extended by one region to catch sims that straddle the edge.
+	std::vector<LLSimInfo*> sims_in_view;
+	if (gMapScale >= SIM_MAP_SCALE)
 	{
-		U64 handle = (*it).first;
-		LLSimInfo* info = (*it).second;
+		F64 meters_per_pixel = REGION_WIDTH_METERS / gMapScale;
+		F64 min_x = camera_global.mdV[VX] + (-sPanX - half_width) * meters_per_pixel - REGION_WIDTH_METERS;
+		F64 max_x = camera_global.mdV[VX] + (width - sPanX - half_width) * meters_per_pixel;
+		F64 min_y = camera_global.mdV[VY] + (-sPanY - half_height) * meters_per_pixel - REGION_WIDTH_METERS;
+		F64 max_y = camera_global.mdV[VY] + (height - sPanY - half_height) * meters_per_pixel;
+		LLWorldMap::getInstance()->getSimsInRect(clamp_map_meters(min_x), clamp_map_meters(min_y),
+												 clamp_map_meters(max_x), clamp_map_meters(max_y),
+												 sims_in_view);
+	}
+
+	for (std::vector<LLSimInfo*>::iterator it = sims_in_view.begin(); it != sims_in_view.end(); ++it)
+	{
+		LLSimInfo* info = *it;
+		U64 handle = info->mHandle;
 
 		LLViewerImage* simimage = info->mCurrentImage;
 		LLViewerImage* overlayimage = info->mOverlayImage;
 
-		if (gMapScale < SIM_MAP_SCALE)
-		{
-			if (simimage != NULL) simimage->setBoostLevel(0);
-			if (overlayimage != NULL) overlayimage->setBoostLevel(0);
-			continue;
-		}
-		
 		LLVector3d origin_global = from_region_handle(handle);
 		LLVector3d camera_global = gAgent.getCameraPositionGlobal();
 
@@ -485,6 +508,13 @@ void LLWorldMapView::draw()
 			(simimage != NULL) &&
 			(simimage->getHasGLTexture());
 
+		// Sims out of view aren't visited, so their fade is stale; snap it
+		// as if seen for the first time.
+		if (!std::binary_search(last_visible_regions.begin(), last_visible_regions.end(), handle))
+		{
+			info->mAlpha = -1.f;
+		}
+
 		if (sim_visible)
 		{
 			// Fade in
@@ -756,6 +786,19 @@ void LLWorldMapView::draw()
 	}
 	// #endif used to be here
 
+	for (handle_list_t::iterator iter = last_visible_regions.begin(); iter != last_visible_regions.end(); ++iter)
+	{
+		if (std::binary_search(mVisibleRegions.begin(), mVisibleRegions.end(), *iter))
+		{
+			continue;
+		}
+		LLSimInfo* info = LLWorldMap::getInstance()->simInfoFromHandle(*iter);
+		if (info)
+		{
+			if (info->mCurrentImage.notNull()) info->mCurrentImage->setBoostLevel(0);
+			if (info->mOverlayImage.notNull()) info->mOverlayImage->setBoostLevel(0);
+		}
+	}
 
 	// there used to be an #if 1 here, but it was uncommented; perhaps marking a block of code?
 	// Draw background rectangle
@@ -931,18 +974,36 @@ void LLWorldMapView::drawGenericItem(const LLItemInfo& item, LLUIImagePtr image)
 void LLWorldMapView::drawImage(const LLVector3d& global_pos, LLUIImagePtr image, const LLColor4& color)
 {
 	LLVector3 pos_map = globalPosToView( global_pos );
-	image->draw(llround(pos_map.mV[VX] - image->getWidth() /2.f),
-				llround(pos_map.mV[VY] - image->getHeight()/2.f),
-				color);
+	S32 x = llround(pos_map.mV[VX] - image->getWidth() /2.f);
+	S32 y = llround(pos_map.mV[VY] - image->getHeight()/2.f);
+
+	// Most items are off screen at close zoom; don't bother the renderer with them.
+	if (x + image->getWidth() < 0 || x > getRect().getWidth() ||
+		y + image->getHeight() < 0 || y > getRect().getHeight())
+	{
+		return;
+	}
+
+	image->draw(x, y, color);
 }
 
 void LLWorldMapView::drawImageStack(const LLVector3d& global_pos, LLUIImagePtr image, U32 count, F32 offset, const LLColor4& color)
 {
 	LLVector3 pos_map = globalPosToView( global_pos );
+	S32 x = llround(pos_map.mV[VX] - image->getWidth() /2.f);
+	F32 y = pos_map.mV[VY] - image->getHeight()/2.f;
+	F32 stack_top = y + image->getHeight() + (count > 0 ? (count - 1) * offset : 0.f);
+
+	if (x + image->getWidth() < 0 || x > getRect().getWidth() ||
+		stack_top < 0.f || y > (F32)getRect().getHeight())
+	{
+		return;
+	}
+
 	for(U32 i=0; i<count; i++)
 	{
-		image->draw(llround(pos_map.mV[VX] - image->getWidth() /2.f),
-					llround(pos_map.mV[VY] - image->getHeight()/2.f + i*offset),
+		image->draw(x,
+					llround(y + i*offset),
 					color);
 	}
 }
@@ -64,6 +64,7 @@
 #include "lldrawpoolwater.h"
 #include "llface.h"
 #include "llfeaturemanager.h"
+#include "llflexibleobject.h"
 #include "llfloatertelehub.h"
 #include "llframestats.h"
 #include "llgldbg.h"
@@ -1402,6 +1403,37 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 			camera.disableUserClipPlane();
 		}
 
+		// Test the union of the region's partition roots first, so regions
+		// behind the camera cost one box test instead of one per partition.
+		LLVector3 region_min, region_max;
+		BOOL region_has_bounds = FALSE;
+		for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+		{
+			LLSpatialPartition* part = region->getSpatialPartition(i);
+			LLVector3 part_min, part_max;
+			if (part && hasRenderType(part->mDrawableType) &&
+				part->getRootExtents(part_min, part_max))
+			{
+				if (!region_has_bounds)
+				{
+					region_min = part_min;
+					region_max = part_max;
+					region_has_bounds = TRUE;
+				}
+				else
+				{
+					update_min_max(region_min, region_max, part_min);
+					update_min_max(region_min, region_max, part_max);
+				}
+			}
+		}
+
+		if (!region_has_bounds ||
+			!camera.AABBInFrustumNoFarClip((region_min + region_max) * 0.5f, (region_max - region_min) * 0.5f))
+		{
+			continue;
+		}
+
 		for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
 		{
 			LLSpatialPartition* part = region->getSpatialPartition(i);
@@ -1579,6 +1611,10 @@ void LLPipeline::updateGeom(F32 max_dtime)
 	// for now, only LLVOVolume does this to throttle LOD changes
 	LLVOVolume::preUpdateGeom();
 
+	// step all flexible objects due for a rebuild at once, before the queues
+	// below rebuild their paths one by one
+	LLVolumeImplFlexible::updateClass();
+
 	// Iterate through all drawables on the priority build queue,
 	for (LLDrawable::drawable_list_t::iterator iter = mBuildQ1.begin();
 		 iter != mBuildQ1.end();)
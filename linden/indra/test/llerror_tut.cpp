@@ -49,6 +49,7 @@ namespace
 
 #include "llerrorcontrol.h"
 #include "llsd.h"
+#include "llapr.h"
 
 namespace
 {
@@ -750,6 +751,46 @@ namespace tut
 		ensure_message_contains(8, "big easy");
 		ensure_message_count(9);
 	}
+
+	template<> template<>
+	void ErrorTestObject::test<15>()
+		// messages written by the async log writer arrive complete and in order
+	{
+		if (!gLogMutexp)
+		{
+			ll_init_apr();
+		}
+
+		LLError::setAsyncLogging(true);
+		ensure("async logging enabled", LLError::getAsyncLogging());
+
+		for (int i = 0; i < 20; ++i)
+		{
+			llinfos << "queued message " << i << llendl;
+		}
+		LLError::flushAsyncLog();
+
+		ensure_message_count(20);
+		for (int i = 0; i < 20; ++i)
+		{
+			std::ostringstream expected;
+			expected << "queued message " << i;
+			ensure_message_contains(i, expected.str());
+		}
+
+		// errors flush the queue before the error itself is written
+		llinfos << "before the error" << llendl;
+		llerrs << "async error" << llendl;
+		ensure("fatal called", fatalWasCalled);
+		ensure_message_contains(20, "before the error");
+		ensure_message_contains(21, "error");
+		ensure_message_contains(22, "async error");
+		ensure_message_count(23);
+
+		LLError::setAsyncLogging(false);
+		ensure("async logging disabled", !LLError::getAsyncLogging());
+		ensure_equals("nothing dropped", LLError::asyncLogDroppedCount(), 0U);
+	}
 }	
 
 /* Tests left:
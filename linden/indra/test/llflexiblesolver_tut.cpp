@@ -0,0 +1,248 @@
+/** 
+ * @file llflexiblesolver_tut.cpp
+ * @brief Tests for the batched flexible object solver
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "lltut.h"
+#include "llflexiblesolver.h"
+#include "llrand.h"
+
+namespace tut
+{
+	struct flexible_solver_object
+	{
+		struct Flexi
+		{
+			LLFlexibleObjectData mAttributes;
+			LLFlexibleObjectSection mSections[FLEXIBLE_OBJECT_MAX_NODES];
+			LLVector3 mAnchor;
+			LLQuaternion mRotation;
+			F32 mLength;
+		};
+
+		// A straight chain hanging off the anchor, as
+		// LLVolumeImplFlexible::setAttributesOfAllSections() leaves it.
+		void init(Flexi& flexi, S32 lod)
+		{
+			flexi.mAttributes.setSimulateLOD(lod);
+			flexi.mAttributes.setTension(ll_frand(FLEXIBLE_OBJECT_MAX_TENSION));
+			flexi.mAttributes.setAirFriction(ll_frand(FLEXIBLE_OBJECT_MAX_AIR_FRICTION));
+			flexi.mAttributes.setGravity(ll_frand(FLEXIBLE_OBJECT_MAX_GRAVITY*2.f) - FLEXIBLE_OBJECT_MAX_GRAVITY);
+			flexi.mAttributes.setWindSensitivity(ll_frand() < 0.5f ? 0.f : ll_frand(FLEXIBLE_OBJECT_MAX_WIND_SENSITIVITY));
+			LLVector3 force(ll_frand(2.f)-1.f, ll_frand(2.f)-1.f, ll_frand(2.f)-1.f);
+			flexi.mAttributes.setUserForce(force);
+
+			flexi.mAnchor.setVec(ll_frand(256.f), ll_frand(256.f), ll_frand(64.f));
+			flexi.mRotation.setQuat(ll_frand(F_TWO_PI), ll_frand(), ll_frand(), ll_frand());
+			flexi.mLength = 0.1f + ll_frand(4.f);
+
+			S32 num_sections = 1 << lod;
+			LLVector3 direction = LLVector3::z_axis * flexi.mRotation;
+			for (S32 i = 0; i <= num_sections; ++i)
+			{
+				LLFlexibleObjectSection& section = flexi.mSections[i];
+				section.mPosition = flexi.mAnchor + direction * (flexi.mLength * i / num_sections);
+				section.mDirection = direction;
+				section.mdPosition = direction;
+				section.mVelocity.setVec(0.f, 0.f, 0.f);
+				section.mRotation = LLQuaternion::DEFAULT;
+			}
+		}
+
+		// One frame of input, with the anchor wobbling and a made up wind
+		// field so every term of the step is exercised.
+		void setup(const Flexi& flexi, S32 frame, F32 dt, LLFlexibleSolverInput& input)
+		{
+			S32 num_sections = 1 << flexi.mAttributes.getSimulateLOD();
+			LLQuaternion wobble(0.3f * sinf(frame * 0.2f), LLVector3::x_axis);
+			LLQuaternion rotation = wobble * flexi.mRotation;
+
+			input.mNumSections = num_sections;
+			input.mSectionLength = flexi.mLength / num_sections;
+			input.mAnchorDirection = LLVector3::z_axis * rotation;
+			input.mAnchorPosition = flexi.mAnchor + LLVector3(0.f, 0.f, 0.1f * cosf(frame * 0.3f));
+			input.mAnchorRotation = rotation;
+			input.setCoefficients(flexi.mAttributes, dt);
+			for (S32 i = 1; i <= num_sections; ++i)
+			{
+				const LLVector3& p = flexi.mSections[i].mPosition;
+				LLVector3 wind(sinf(p.mV[VX] + frame), cosf(p.mV[VY] - frame), 0.2f * sinf(p.mV[VZ]));
+				input.mWind[i] = wind * 5.f * input.mWindFactor;
+			}
+		}
+
+		void ensure_close(const std::string& msg, const LLVector3& a, const LLVector3& b, F32 tolerance)
+		{
+			std::ostringstream out;
+			out << msg << " " << a << " vs " << b;
+			ensure(out.str(), dist_vec(a, b) <= tolerance);
+		}
+
+		void ensure_close(const std::string& msg, const LLQuaternion& a, const LLQuaternion& b, F32 tolerance)
+		{
+			// q and -q are the same rotation
+			F32 d = llabs(dot(a, b));
+			ensure(msg, d >= 1.f - tolerance);
+		}
+
+		void ensure_same(const std::string& msg, const Flexi& a, const Flexi& b, F32 tolerance)
+		{
+			S32 num_sections = 1 << a.mAttributes.getSimulateLOD();
+			for (S32 i = 0; i <= num_sections; ++i)
+			{
+				std::ostringstream section;
+				section << msg << " section " << i;
+				ensure_close(section.str() + " position", a.mSections[i].mPosition, b.mSections[i].mPosition, tolerance);
+				ensure_close(section.str() + " velocity", a.mSections[i].mVelocity, b.mSections[i].mVelocity, tolerance);
+				ensure_close(section.str() + " direction", a.mSections[i].mDirection, b.mSections[i].mDirection, tolerance);
+				ensure_close(section.str() + " derivative", a.mSections[i].mdPosition, b.mSections[i].mdPosition, tolerance * 10.f);
+				ensure_close(section.str() + " rotation", a.mSections[i].mRotation, b.mSections[i].mRotation, tolerance);
+			}
+		}
+	};
+	typedef test_group<flexible_solver_object> flexible_solver_t;
+	typedef flexible_solver_t::object flexible_solver_object_t;
+	tut::flexible_solver_t tut_flexible_solver("flexible_solver");
+
+	template<> template<>
+	void flexible_solver_object_t::test<1>()
+	{
+		// With no forces and a stationary anchor a straight chain stays put
+		Flexi flexi;
+		init(flexi, FLEXIBLE_OBJECT_MAX_SECTIONS);
+		flexi.mAttributes.setGravity(0.f);
+		flexi.mAttributes.setWindSensitivity(0.f);
+		LLVector3 zero;
+		flexi.mAttributes.setUserForce(zero);
+
+		for (S32 frame = 0; frame < 30; ++frame)
+		{
+			LLFlexibleSolverInput input;
+			input.mNumSections = 1 << FLEXIBLE_OBJECT_MAX_SECTIONS;
+			input.mSectionLength = flexi.mLength / input.mNumSections;
+			input.mAnchorPosition = flexi.mAnchor;
+			input.mAnchorDirection = LLVector3::z_axis * flexi.mRotation;
+			input.mAnchorRotation = flexi.mRotation;
+			input.setCoefficients(flexi.mAttributes, 1.f/30.f);
+			LLFlexibleSolver::integrate(input, flexi.mSections);
+		}
+
+		LLVector3 tip = flexi.mAnchor + (LLVector3::z_axis * flexi.mRotation) * flexi.mLength;
+		ensure_close("tip", flexi.mSections[1 << FLEXIBLE_OBJECT_MAX_SECTIONS].mPosition, tip, 0.001f);
+	}
+
+	template<> template<>
+	void flexible_solver_object_t::test<2>()
+	{
+		// Sections always end up one section length apart
+		Flexi flexi;
+		init(flexi, 2);
+		flexi.mAttributes.setGravity(FLEXIBLE_OBJECT_MAX_GRAVITY);
+
+		LLFlexibleSolverInput input;
+		for (S32 frame = 0; frame < 60; ++frame)
+		{
+			setup(flexi, frame, 1.f/30.f, input);
+			LLFlexibleSolver::integrate(input, flexi.mSections);
+		}
+
+		for (S32 i = 1; i <= 4; ++i)
+		{
+			F32 length = dist_vec(flexi.mSections[i].mPosition, flexi.mSections[i-1].mPosition);
+			ensure_approximately_equals("section length", length, input.mSectionLength, 16);
+		}
+	}
+
+	template<> template<>
+	void flexible_solver_object_t::test<3>()
+	{
+		// The batch follows the scalar solver over many frames, for a mix of
+		// section counts in one batch
+		const S32 COUNT = 37;
+		std::vector<Flexi> scalar(COUNT);
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			init(scalar[i], i % (FLEXIBLE_OBJECT_MAX_SECTIONS+1));
+		}
+		std::vector<Flexi> batched(scalar);
+		std::vector<LLQuaternion> scalar_end(COUNT);
+
+		LLFlexibleSolverBatch batch;
+		for (S32 frame = 0; frame < 120; ++frame)
+		{
+			F32 dt = (frame % 7 == 0) ? 0.2f : 1.f/(20.f + frame % 40);
+
+			batch.clear();
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				LLFlexibleSolverInput input;
+				setup(scalar[i], frame, dt, input);
+				LLFlexibleSolver::integrate(input, scalar[i].mSections);
+				scalar_end[i] = input.mEndRotation;
+
+				setup(batched[i], frame, dt, input);
+				ensure_equals("handle", batch.add(input, batched[i].mSections), i);
+			}
+			ensure_equals("count", batch.getCount(), COUNT);
+			batch.solve();
+
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				std::ostringstream msg;
+				msg << "frame " << frame << " object " << i;
+				ensure_same(msg.str(), scalar[i], batched[i], 0.001f);
+				ensure_close(msg.str() + " end rotation", scalar_end[i], batch.getEndRotation(i), 0.001f);
+			}
+		}
+	}
+
+	template<> template<>
+	void flexible_solver_object_t::test<4>()
+	{
+		// An empty batch, and a cleared one, are harmless
+		LLFlexibleSolverBatch batch;
+		batch.solve();
+		ensure_equals("empty", batch.getCount(), 0);
+
+		Flexi flexi;
+		init(flexi, 1);
+		Flexi before = flexi;
+		LLFlexibleSolverInput input;
+		setup(flexi, 0, 1.f/30.f, input);
+		batch.add(input, flexi.mSections);
+		batch.clear();
+		batch.solve();
+		ensure_equals("cleared", batch.getCount(), 0);
+		ensure_same("untouched", before, flexi, 1.e-6f);
+	}
+}
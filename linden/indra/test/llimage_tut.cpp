@@ -0,0 +1,184 @@
+/** 
+ * @file llimage_tut.cpp
+ * @brief LLImageRaw scaling test cases.
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llimage.h"
+#include "llrand.h"
+#include "lltut.h"
+
+namespace tut
+{
+	struct image_data
+	{
+		// Deterministic noise so failures are reproducible
+		LLPointer<LLImageRaw> makeNoise(U16 width, U16 height, S8 components)
+		{
+			LLPointer<LLImageRaw> image = new LLImageRaw(width, height, components);
+			U8* data = image->getData();
+			U32 seed = 12345;
+			for (S32 i = 0; i < width * height * components; i++)
+			{
+				seed = seed * 1103515245 + 12345;
+				data[i] = (U8)(seed >> 16);
+			}
+			return image;
+		}
+
+		LLPointer<LLImageRaw> clone(LLImageRaw* src)
+		{
+			LLPointer<LLImageRaw> image = new LLImageRaw(src->getWidth(), src->getHeight(), src->getComponents());
+			image->copyUnscaled(src);
+			return image;
+		}
+
+		S32 maxDifference(LLImageRaw* a, LLImageRaw* b)
+		{
+			S32 diff = 0;
+			for (S32 i = 0; i < a->getDataSize(); i++)
+			{
+				S32 d = (S32)a->getData()[i] - (S32)b->getData()[i];
+				diff = llmax(diff, d < 0 ? -d : d);
+			}
+			return diff;
+		}
+	};
+
+	typedef test_group<image_data> image_test;
+	typedef image_test::object image_object;
+	tut::image_test tut_image("image");
+
+	template<> template<>
+	void image_object::test<1>()
+	{
+		// Box filter golden values: averaging pairs of pixels
+		LLPointer<LLImageRaw> image = new LLImageRaw(4, 1, 4);
+		const U8 pixels[16] = { 10, 20, 30, 255,  30, 40, 50, 255,
+								0, 0, 0, 0,  100, 200, 50, 128 };
+		memcpy(image->getData(), pixels, sizeof(pixels));		/* Flawfinder: ignore */
+		image->scale(2, 1);
+		ensure_equals("width", (S32)image->getWidth(), 2);
+		const U8 expected[8] = { 20, 30, 40, 255,  50, 100, 25, 64 };
+		for (S32 i = 0; i < 8; i++)
+		{
+			ensure("box average within 1", llabs((S32)image->getData()[i] - (S32)expected[i]) <= 1);
+		}
+	}
+
+	template<> template<>
+	void image_object::test<2>()
+	{
+		// SIMD and scalar box filters agree to rounding
+		if (!LLImageRaw::isSSE2Compiled())
+		{
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+			fail("llimage_sse2.cpp was built without SSE2 code generation");
+#else
+			llinfos << "Skipping SSE2 box filter test: not an x86 build" << llendl;
+			return;
+#endif
+		}
+
+		bool use_simd = LLImageRaw::getUseSIMD();
+		LLPointer<LLImageRaw> scalar = makeNoise(133, 77, 4);
+		LLPointer<LLImageRaw> simd = clone(scalar);
+
+		LLImageRaw::setUseSIMD(false);
+		scalar->scale(64, 32);
+		LLImageRaw::setUseSIMD(true);
+		simd->scale(64, 32);
+		LLImageRaw::setUseSIMD(use_simd);
+
+		ensure_equals("same size", simd->getDataSize(), scalar->getDataSize());
+		ensure("SIMD matches scalar", maxDifference(simd, scalar) <= 1);
+	}
+
+	template<> template<>
+	void image_object::test<3>()
+	{
+		// Every filter preserves a constant image
+		const LLImageRaw::EScaleFilter filters[3] = {
+			LLImageRaw::SCALE_FILTER_BOX,
+			LLImageRaw::SCALE_FILTER_BILINEAR,
+			LLImageRaw::SCALE_FILTER_LANCZOS };
+		for (S32 f = 0; f < 3; f++)
+		{
+			LLPointer<LLImageRaw> down = new LLImageRaw(100, 60, 3);
+			down->clear(17, 130, 250);
+			down->scale(32, 16, TRUE, filters[f]);
+			LLPointer<LLImageRaw> up = new LLImageRaw(10, 6, 3);
+			up->clear(17, 130, 250);
+			up->scale(64, 32, TRUE, filters[f]);
+
+			LLPointer<LLImageRaw> expected = new LLImageRaw(32, 16, 3);
+			expected->clear(17, 130, 250);
+			ensure("constant downscale", maxDifference(down, expected) <= 1);
+			expected = new LLImageRaw(64, 32, 3);
+			expected->clear(17, 130, 250);
+			ensure("constant upscale", maxDifference(up, expected) <= 1);
+		}
+	}
+
+	template<> template<>
+	void image_object::test<4>()
+	{
+		// A linear ramp stays (close to) linear under bilinear and Lanczos
+		LLPointer<LLImageRaw> ramp = new LLImageRaw(32, 1, 1);
+		for (S32 x = 0; x < 32; x++)
+		{
+			ramp->getData()[x] = (U8)(x * 8);
+		}
+		LLPointer<LLImageRaw> bilinear = clone(ramp);
+		bilinear->scale(128, 1, TRUE, LLImageRaw::SCALE_FILTER_BILINEAR);
+		LLPointer<LLImageRaw> lanczos = clone(ramp);
+		lanczos->scale(128, 1, TRUE, LLImageRaw::SCALE_FILTER_LANCZOS);
+
+		// Away from the edges the ramp is 2 per output pixel, starting at
+		// input pixel centers
+		for (S32 x = 16; x < 112; x++)
+		{
+			F32 expected = ((x + 0.5f) * 0.25f - 0.5f) * 8.f;
+			ensure("bilinear ramp", fabsf(bilinear->getData()[x] - expected) <= 1.f);
+			ensure("lanczos ramp", fabsf(lanczos->getData()[x] - expected) <= 2.f);
+		}
+	}
+
+	template<> template<>
+	void image_object::test<5>()
+	{
+		LLPointer<LLImageRaw> image = makeNoise(300, 100, 4);
+		image->biasedScaleToPowerOfTwo(512, LLImageRaw::SCALE_FILTER_LANCZOS);
+		ensure_equals("pow2 width", (S32)image->getWidth(), 256);
+		ensure_equals("pow2 height", (S32)image->getHeight(), 64);
+	}
+}
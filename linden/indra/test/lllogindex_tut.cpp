@@ -0,0 +1,212 @@
+/** 
+ * @file lllogindex_tut.cpp
+ * @brief LLLogIndex test cases.
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+
+#include "llfile.h"
+#include "lllogindex.h"
+#include "lluuid.h"
+#include "lltut.h"
+
+namespace tut
+{
+	struct logindex_data
+	{
+		logindex_data()
+		{
+			LLUUID random;
+			random.generate();
+			mLogFile = "log-index-test-" + random.asString() + ".txt";
+			mIndexFile = LLLogIndex::indexFileName(mLogFile);
+		}
+
+		~logindex_data()
+		{
+			LLFile::remove(mLogFile);
+			LLFile::remove(mIndexFile);
+		}
+
+		void writeLog(const std::string& text, const char* mode)
+		{
+			LLFILE* fp = LLFile::fopen(mLogFile, mode);
+			ensure("log opened", fp != NULL);
+			fwrite(text.data(), 1, text.size(), fp);
+			fclose(fp);
+		}
+
+		U32 recordCount()
+		{
+			LLFILE* fp = LLFile::fopen(mIndexFile, "rb");
+			ensure("index opened", fp != NULL);
+			U32 count = LLLogIndex::recordCount(fp);
+			fclose(fp);
+			return count;
+		}
+
+		LLLogIndex::Record record(U32 i)
+		{
+			LLLogIndex::Record rec;
+			LLFILE* fp = LLFile::fopen(mIndexFile, "rb");
+			ensure("index opened", fp != NULL);
+			ensure("record read", LLLogIndex::readRecord(fp, i, rec));
+			fclose(fp);
+			return rec;
+		}
+
+		std::string mLogFile;
+		std::string mIndexFile;
+	};
+	typedef test_group<logindex_data> logindex_test;
+	typedef logindex_test::object logindex_object;
+	tut::logindex_test tut_logindex("LLLogIndex");
+
+	template<> template<>
+	void logindex_object::test<1>()
+	{
+		// the index sits next to the log
+		ensure_equals("txt replaced", LLLogIndex::indexFileName("/logs/Some Body.txt"), std::string("/logs/Some Body.idx"));
+		ensure_equals("other kept", LLLogIndex::indexFileName("/logs/chat"), std::string("/logs/chat.idx"));
+	}
+
+	template<> template<>
+	void logindex_object::test<2>()
+	{
+		// one record per complete line, holding the offset past its newline
+		writeLog("one\ntwo\r\nthree\n", "wb");
+		U32 end, last_time;
+		ensure("synced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("end", end, (U32)15);
+		ensure_equals("records", recordCount(), (U32)3);
+		ensure_equals("first end", record(0).mEnd, (U32)4);
+		ensure_equals("second end", record(1).mEnd, (U32)9);
+		ensure_equals("third end", record(2).mEnd, (U32)15);
+
+		// a second sync with nothing new leaves the index alone
+		ensure("resynced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("records unchanged", recordCount(), (U32)3);
+		ensure_equals("end unchanged", end, (U32)15);
+	}
+
+	template<> template<>
+	void logindex_object::test<3>()
+	{
+		// an unterminated last line is not indexed until it is finished
+		writeLog("one\npart", "wb");
+		U32 end, last_time;
+		ensure("synced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("end before partial", end, (U32)4);
+		ensure_equals("one record", recordCount(), (U32)1);
+
+		writeLog("ial\n", "ab");
+		ensure("resynced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("end after partial", end, (U32)12);
+		ensure_equals("two records", recordCount(), (U32)2);
+	}
+
+	template<> template<>
+	void logindex_object::test<4>()
+	{
+		// a log that shrank under its index gets a fresh index
+		writeLog("a long first line\nsecond\n", "wb");
+		U32 end, last_time;
+		ensure("synced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("two records", recordCount(), (U32)2);
+
+		writeLog("x\n", "wb");
+		ensure("rebuilt", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("end", end, (U32)2);
+		ensure_equals("one record", recordCount(), (U32)1);
+		ensure_equals("record end", record(0).mEnd, (U32)2);
+
+		// and an index without a log is removed
+		LLFile::remove(mLogFile);
+		ensure("synced without log", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("no end", end, (U32)0);
+		ensure("index removed", !LLFile::isfile(mIndexFile));
+	}
+
+	template<> template<>
+	void logindex_object::test<5>()
+	{
+		// times written by the logger survive a resync and carry forward
+		// onto lines the index has not seen yet
+		writeLog("one\ntwo\n", "wb");
+		LLFILE* idx = LLFile::fopen(mIndexFile, "wb");
+		ensure("index created", idx != NULL);
+		std::vector<LLLogIndex::Record> records;
+		LLLogIndex::Record rec;
+		rec.mEnd = 4;
+		rec.mTime = 1000;
+		records.push_back(rec);
+		rec.mEnd = 8;
+		rec.mTime = 2000;
+		records.push_back(rec);
+		ensure("records written", LLLogIndex::writeRecords(idx, records));
+		fclose(idx);
+
+		writeLog("three\n", "ab");
+		U32 end, last_time;
+		ensure("synced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("end", end, (U32)14);
+		ensure_equals("last time", last_time, (U32)2000);
+		ensure_equals("records", recordCount(), (U32)3);
+		ensure_equals("first time kept", record(0).mTime, (U32)1000);
+		ensure_equals("new line stamped", record(2).mTime, (U32)2000);
+	}
+
+	template<> template<>
+	void logindex_object::test<6>()
+	{
+		// recall starts at the oldest line inside the window, always
+		// includes the newest line and strips line endings on the way out
+		writeLog("0123456789\r\nabc\r\ndef\r\n", "wb");
+		U32 end, last_time;
+		ensure("synced", LLLogIndex::sync(mLogFile, end, last_time));
+		ensure_equals("end", end, (U32)22);
+
+		ensure_equals("window of two lines", LLLogIndex::findRecallStart(mLogFile, end, 10), (U32)12);
+		ensure_equals("whole log", LLLogIndex::findRecallStart(mLogFile, end, 100), (U32)0);
+		ensure_equals("newest line only", LLLogIndex::findRecallStart(mLogFile, end, 1), (U32)17);
+
+		std::vector<std::string> lines;
+		LLLogIndex::readLines(mLogFile, 12, end, lines);
+		ensure_equals("line count", lines.size(), (size_t)2);
+		ensure_equals("first line", lines[0], std::string("abc"));
+		ensure_equals("second line", lines[1], std::string("def"));
+
+		lines.clear();
+		LLLogIndex::readLines(mLogFile, end, end, lines);
+		ensure("empty range", lines.empty());
+	}
+}
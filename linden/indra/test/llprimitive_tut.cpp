@@ -0,0 +1,347 @@
+/** 
+ * @file llprimitive_tut.cpp
+ * @brief Tests for LLPrimitive texture entry packing
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "lltut.h"
+#include "llprimitive.h"
+#include "lldatapacker.h"
+#include "llrand.h"
+
+namespace tut
+{
+	struct primitive_te_object
+	{
+		// Per-field arrays as the TE messages used them before LLTEContents
+		struct LegacyFields
+		{
+			U8		image_ids[LLTEContents::MAX_TES*16];
+			U8		colors[LLTEContents::MAX_TES*4];
+			F32		scale_s[LLTEContents::MAX_TES];
+			F32		scale_t[LLTEContents::MAX_TES];
+			S16		offset_s[LLTEContents::MAX_TES];
+			S16		offset_t[LLTEContents::MAX_TES];
+			S16		image_rot[LLTEContents::MAX_TES];
+			U8		bump[LLTEContents::MAX_TES];
+			U8		media_flags[LLTEContents::MAX_TES];
+			U8		glow[LLTEContents::MAX_TES];
+		};
+
+		// The original packTEMessage() encoding, field by field
+		S32 legacy_pack(const LLTEContents& contents, U8* packed_buffer)
+		{
+			LegacyFields fields;
+			for (S32 i = 0; i < contents.mFaceCount; i++)
+			{
+				const LLTEContents::Face& face = contents.mFaces[i];
+				memcpy(&fields.image_ids[i*16], face.mImageID, 16);
+				memcpy(&fields.colors[i*4], face.mColor, 4);
+				fields.scale_s[i] = face.mScaleS;
+				fields.scale_t[i] = face.mScaleT;
+				fields.offset_s[i] = face.mOffsetS;
+				fields.offset_t[i] = face.mOffsetT;
+				fields.image_rot[i] = face.mRotation;
+				fields.bump[i] = face.mBump;
+				fields.media_flags[i] = face.mMediaFlags;
+				fields.glow[i] = face.mGlow;
+			}
+
+			U8* cur_ptr = packed_buffer;
+			S32 last_face_index = contents.mFaceCount - 1;
+			if (last_face_index > -1)
+			{
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.image_ids, sizeof(LLUUID),last_face_index, MVT_LLUUID);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.colors, 4 ,last_face_index, MVT_U8);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.scale_s, 4 ,last_face_index, MVT_F32);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.scale_t, 4 ,last_face_index, MVT_F32);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.offset_s, 2 ,last_face_index, MVT_S16Array);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.offset_t, 2 ,last_face_index, MVT_S16Array);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.image_rot, 2 ,last_face_index, MVT_S16Array);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.bump, 1 ,last_face_index, MVT_U8);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.media_flags, 1 ,last_face_index, MVT_U8);
+				*cur_ptr++ = 0;
+				cur_ptr += mPrim.packTEField(cur_ptr, (U8 *)fields.glow, 1 ,last_face_index, MVT_U8);
+			}
+			return (S32)(cur_ptr - packed_buffer);
+		}
+
+		// The original unpackTEMessage() decoding, field by field. It reads
+		// past the end of short blobs, so the buffer is zero padded.
+		void legacy_unpack(const U8* blob, S32 size, U8 face_count, LegacyFields& fields)
+		{
+			std::vector<U8> padded(size + 512, 0);
+			if (size)
+			{
+				memcpy(&padded[0], blob, size);
+			}
+			U8* packed_buffer = &padded[0];
+			U8* cur_ptr = packed_buffer;
+
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.image_ids, 16, face_count, MVT_LLUUID);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.colors, 4, face_count, MVT_U8);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.scale_s, 4, face_count, MVT_F32);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.scale_t, 4, face_count, MVT_F32);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.offset_s, 2, face_count, MVT_S16Array);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.offset_t, 2, face_count, MVT_S16Array);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.image_rot, 2, face_count, MVT_S16Array);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.bump, 1, face_count, MVT_U8);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.media_flags, 1, face_count, MVT_U8);
+			cur_ptr++;
+			cur_ptr += mPrim.unpackTEField(cur_ptr, packed_buffer+size, (U8 *)fields.glow, 1, face_count, MVT_U8);
+		}
+
+		void ensure_same(const std::string& msg, const LLTEContents::Face& face, const LegacyFields& fields, S32 i)
+		{
+			ensure(msg + " image", !memcmp(face.mImageID, &fields.image_ids[i*16], 16));
+			ensure(msg + " color", !memcmp(face.mColor, &fields.colors[i*4], 4));
+			ensure(msg + " scale s", !memcmp(&face.mScaleS, &fields.scale_s[i], 4));
+			ensure(msg + " scale t", !memcmp(&face.mScaleT, &fields.scale_t[i], 4));
+			ensure_equals(msg + " offset s", face.mOffsetS, fields.offset_s[i]);
+			ensure_equals(msg + " offset t", face.mOffsetT, fields.offset_t[i]);
+			ensure_equals(msg + " rotation", face.mRotation, fields.image_rot[i]);
+			ensure_equals(msg + " bump", face.mBump, fields.bump[i]);
+			ensure_equals(msg + " media", face.mMediaFlags, fields.media_flags[i]);
+			ensure_equals(msg + " glow", face.mGlow, fields.glow[i]);
+		}
+
+		void ensure_same(const std::string& msg, const LLTEContents& a, const LLTEContents& b)
+		{
+			ensure_equals(msg + " face count", a.mFaceCount, b.mFaceCount);
+			for (S32 i = 0; i < a.mFaceCount; i++)
+			{
+				const LLTEContents::Face& fa = a.mFaces[i];
+				const LLTEContents::Face& fb = b.mFaces[i];
+				std::ostringstream face;
+				face << msg << " face " << i;
+				ensure(face.str() + " image", !memcmp(fa.mImageID, fb.mImageID, 16));
+				ensure(face.str() + " color", !memcmp(fa.mColor, fb.mColor, 4));
+				ensure_equals(face.str() + " scale s", fa.mScaleS, fb.mScaleS);
+				ensure_equals(face.str() + " scale t", fa.mScaleT, fb.mScaleT);
+				ensure_equals(face.str() + " offset s", fa.mOffsetS, fb.mOffsetS);
+				ensure_equals(face.str() + " offset t", fa.mOffsetT, fb.mOffsetT);
+				ensure_equals(face.str() + " rotation", fa.mRotation, fb.mRotation);
+				ensure_equals(face.str() + " bump", fa.mBump, fb.mBump);
+				ensure_equals(face.str() + " media", fa.mMediaFlags, fb.mMediaFlags);
+				ensure_equals(face.str() + " glow", fa.mGlow, fb.mGlow);
+			}
+		}
+
+		// Texture entries drawn from small palettes, so faces share values
+		// the way real builds do and the exception lists get exercised.
+		void randomize(LLPrimitive& prim, U8 face_count)
+		{
+			static const char* textures[] =
+			{
+				"89556747-24cb-43ed-920b-47caed15465f",
+				"5748decc-f629-461c-9a36-a35a221fe21f",
+				"8dcd4a48-2d37-4909-9f78-f7a9eb4ef903",
+				"c228d1cf-4b5d-4ba8-84f4-899a0796aa97"
+			};
+
+			prim.setNumTEs(face_count);
+			S32 palette = 1 + ll_rand(4);
+			for (U8 i = 0; i < face_count; i++)
+			{
+				prim.setTETexture(i, LLUUID(textures[ll_rand(palette)]));
+				prim.setTEColor(i, LLColor4(ll_rand(palette) / 3.f, 1.f, ll_frand(), ll_rand(palette) ? 1.f : 0.5f));
+				prim.setTEScale(i, 1.f + ll_rand(palette), ll_rand(palette) ? 1.f : ll_frand(10.f));
+				prim.setTEOffset(i, ll_rand(palette) * 0.25f - 0.5f, ll_frand(2.f) - 1.f);
+				prim.setTERotation(i, ll_rand(palette) * F_PI_BY_TWO);
+				prim.setTEBumpShinyFullbright(i, (U8)ll_rand(palette));
+				prim.setTEMediaTexGen(i, ll_rand(palette) ? 0 : 0x20);
+				prim.setTEGlow(i, ll_rand(palette) ? 0.f : ll_frand());
+			}
+		}
+
+		LLPrimitive mPrim;
+	};
+	typedef test_group<primitive_te_object> primitive_te_t;
+	typedef primitive_te_t::object primitive_te_object_t;
+	tut::primitive_te_t tut_primitive_te("primitive_te");
+
+	template<> template<>
+	void primitive_te_object_t::test<1>()
+	{
+		// LLTEContents packs byte for byte what packTEField() produces
+		U8 packed[LLTEContents::MAX_TE_BUFFER];
+		U8 legacy[LLTEContents::MAX_TE_BUFFER];
+		for (S32 n = 0; n < 300; n++)
+		{
+			LLPrimitive prim;
+			randomize(prim, (U8)(n % (LLTEContents::MAX_TES+1)));
+			LLTEContents contents;
+			prim.getTEContents(contents);
+
+			S32 size = contents.pack(packed);
+			S32 legacy_size = legacy_pack(contents, legacy);
+			std::ostringstream msg;
+			msg << "prim " << n;
+			ensure_equals(msg.str() + " size", size, legacy_size);
+			ensure(msg.str() + " bytes", !memcmp(packed, legacy, size));
+		}
+	}
+
+	template<> template<>
+	void primitive_te_object_t::test<2>()
+	{
+		// packTEMessage() / unpackTEMessage() round trip
+		U8 buffer[LLTEContents::MAX_TE_BUFFER + 4];
+		for (S32 n = 0; n < 300; n++)
+		{
+			U8 face_count = (U8)(1 + n % LLTEContents::MAX_TES);
+			LLPrimitive source;
+			randomize(source, face_count);
+
+			LLDataPackerBinaryBuffer out(buffer, sizeof(buffer));
+			source.packTEMessage(out);
+
+			LLPrimitive dest;
+			dest.setNumTEs(face_count);
+			LLDataPackerBinaryBuffer in(buffer, out.getCurrentSize());
+			S32 changed = dest.unpackTEMessage(in);
+
+			LLTEContents expected, actual;
+			source.getTEContents(expected);
+			dest.getTEContents(actual);
+			std::ostringstream msg;
+			msg << "prim " << n;
+			ensure_same(msg.str(), expected, actual);
+			ensure(msg.str() + " reports a change", changed != 0);
+		}
+	}
+
+	template<> template<>
+	void primitive_te_object_t::test<3>()
+	{
+		// Fuzz: random and corrupted blobs decode exactly as the per-field
+		// decoder does, with bytes past the end reading as zero
+		U8 packed[LLTEContents::MAX_TE_BUFFER];
+		for (S32 n = 0; n < 2000; n++)
+		{
+			std::vector<U8> blob;
+			U8 face_count = (U8)ll_rand(LLTEContents::MAX_TES + 1);
+			if (n % 2)
+			{
+				// A valid blob, truncated and with some bytes flipped
+				LLPrimitive prim;
+				randomize(prim, (U8)(1 + ll_rand(LLTEContents::MAX_TES)));
+				LLTEContents contents;
+				prim.getTEContents(contents);
+				S32 size = contents.pack(packed);
+				blob.assign(packed, packed + ll_rand(size + 1));
+				for (S32 flips = ll_rand(4); flips > 0 && !blob.empty(); flips--)
+				{
+					blob[ll_rand(blob.size())] ^= (U8)(1 << ll_rand(8));
+				}
+			}
+			else
+			{
+				// Noise, heavy on terminators and continuation bytes
+				S32 size = ll_rand(300);
+				for (S32 i = 0; i < size; i++)
+				{
+					S32 kind = ll_rand(4);
+					blob.push_back(kind == 0 ? 0 : (kind == 1 ? (U8)(0x80 | ll_rand(0x80)) : (U8)ll_rand(256)));
+				}
+			}
+
+			const U8* data = blob.empty() ? NULL : &blob[0];
+			LLTEContents contents;
+			contents.unpack(data, blob.size(), face_count);
+
+			LegacyFields fields;
+			legacy_unpack(data, blob.size(), face_count, fields);
+
+			ensure_equals("face count", contents.mFaceCount, face_count);
+			for (S32 i = 0; i < face_count; i++)
+			{
+				std::ostringstream msg;
+				msg << "blob " << n << " face " << i;
+				ensure_same(msg.str(), contents.mFaces[i], fields, i);
+			}
+		}
+	}
+
+	template<> template<>
+	void primitive_te_object_t::test<4>()
+	{
+		// An unchanged blob is skipped, until a texture entry is set locally
+		U8 buffer[LLTEContents::MAX_TE_BUFFER + 4];
+		LLPrimitive source;
+		randomize(source, 8);
+		source.setTEColor(3, LLColor4(0.f, 0.f, 1.f, 1.f));
+
+		LLDataPackerBinaryBuffer out(buffer, sizeof(buffer));
+		source.packTEMessage(out);
+		S32 size = out.getCurrentSize();
+
+		LLPrimitive dest;
+		dest.setNumTEs(8);
+		LLDataPackerBinaryBuffer first(buffer, size);
+		ensure("first update applies", dest.unpackTEMessage(first) != 0);
+
+		LLDataPackerBinaryBuffer again(buffer, size);
+		ensure_equals("repeat update is a no-op", dest.unpackTEMessage(again), 0);
+
+		dest.setTEColor(3, LLColor4(1.f, 0.f, 0.f, 1.f));
+		LLDataPackerBinaryBuffer after_edit(buffer, size);
+		ensure_equals("update after a local edit applies", dest.unpackTEMessage(after_edit), TEM_CHANGE_COLOR);
+		ensure("color restored", dest.getTE(3)->getColor() == source.getTE(3)->getColor());
+
+		dest.setNumTEs(9);
+		LLDataPackerBinaryBuffer after_resize(buffer, size);
+		dest.unpackTEMessage(after_resize);
+		LLTEContents expected, actual;
+		source.getTEContents(expected);
+		dest.getTEContents(actual);
+		ensure_equals("faces after resize", actual.mFaceCount, 9);
+		actual.mFaceCount = 8;
+		ensure_same("after resize", expected, actual);
+	}
+}
@@ -759,6 +759,53 @@ namespace tut
 		ensure("type is a string", v.isString());
 	}
 
+	template<> template<>
+	void SDTestObject::test<15>()
+		// values built inside an arena scope outlive it
+	{
+		SDCleanupCheck check;
+
+		LLSD v;
+		{
+			LLSDArenaScope arena;
+			ensure("arena active", arena.isActive());
+
+			v["name"] = "Hippo";
+			v["count"] = 42;
+			v["list"].append(1.5);
+			v["list"].append(true);
+		}
+
+		ensure_equals("string survives", v["name"].asString(), std::string("Hippo"));
+		ensure_equals("integer survives", v["count"].asInteger(), 42);
+		ensure_equals("array size", v["list"].size(), 2);
+		ensure("boolean survives", v["list"][1].asBoolean());
+
+		// copy-on-write still applies to arena values
+		LLSD w = v;
+		w["name"] = "Rhino";
+		ensure_equals("original untouched", v["name"].asString(), std::string("Hippo"));
+		ensure_equals("copy changed", w["name"].asString(), std::string("Rhino"));
+	}
+
+	template<> template<>
+	void SDTestObject::test<16>()
+		// nested scopes fall back to the outer arena or the heap
+	{
+		SDCleanupCheck check;
+
+		LLSDArenaScope outer;
+		ensure("outer active", outer.isActive());
+		{
+			LLSDArenaScope inner;
+			ensure("inner not active", !inner.isActive());
+			LLSD v = 7;
+			ensure_equals("value in nested scope", v.asInteger(), 7);
+		}
+		LLSD v = "after";
+		ensure_equals("value after nested scope", v.asString(), std::string("after"));
+	}
+
 	/* TO DO:
 		conversion of undefined to UUID, Date, URI and Binary
 		conversion of undefined to map and array
@@ -0,0 +1,203 @@
+/** 
+ * @file lltracerecorder_tut.cpp
+ * @brief LLTraceRecorder test cases.
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "llfile.h"
+#include "lltracerecorder.h"
+#include "lluuid.h"
+#include "lltut.h"
+
+namespace tut
+{
+	struct trace_data
+	{
+		trace_data()
+		{
+			LLTraceRecorder::initClass();
+
+			LLUUID random;
+			random.generate();
+			mTraceFile = "trace-test-" + random.asString() + ".trace";
+			mJSONFile = mTraceFile + ".json";
+		}
+
+		~trace_data()
+		{
+			LLTraceRecorder::stopSession();
+			LLFile::remove(mTraceFile);
+			LLFile::remove(mJSONFile);
+		}
+
+		std::string readFile(const std::string& filename)
+		{
+			std::ifstream istr(filename.c_str());
+			std::ostringstream ostr;
+			ostr << istr.rdbuf();
+			return ostr.str();
+		}
+
+		// Counts the begin and end events in a converted trace
+		void countEvents(const std::string& json, S32& begins, S32& ends)
+		{
+			begins = 0;
+			ends = 0;
+			for (size_t pos = json.find("\"ph\":\""); pos != std::string::npos; pos = json.find("\"ph\":\"", pos + 1))
+			{
+				char type = json[pos + 6];
+				if (type == 'B')
+				{
+					begins++;
+				}
+				else if (type == 'E')
+				{
+					ends++;
+				}
+			}
+		}
+
+		std::string mTraceFile;
+		std::string mJSONFile;
+	};
+	typedef test_group<trace_data> trace_test;
+	typedef trace_test::object trace_object;
+	tut::trace_test tut_trace("LLTraceRecorder");
+
+	template<> template<>
+	void trace_object::test<1>()
+	{
+		// names are registered once and never get the reserved id
+		U16 a = LLTraceRecorder::registerName("trace test zone a");
+		U16 b = LLTraceRecorder::registerName("trace test zone b");
+		ensure("nonzero id", a != 0);
+		ensure("distinct ids", a != b);
+		ensure_equals("same name same id", (S32)LLTraceRecorder::registerName("trace test zone a"), (S32)a);
+	}
+
+	template<> template<>
+	void trace_object::test<2>()
+	{
+		// zones only record while a session is open
+		U16 id = LLTraceRecorder::registerName("trace test recorded");
+		ensure("not recording", !LLTraceRecorder::isRecording());
+		{
+			LLTraceZone zone(id);
+		}
+
+		ensure("session started", LLTraceRecorder::startSession(mTraceFile));
+		ensure("recording", LLTraceRecorder::isRecording());
+		LLTraceRecorder::setThreadName("trace test thread");
+		{
+			LLTraceZone outer(id);
+			LLTraceZone inner(LLTraceRecorder::registerName("trace test inner"));
+		}
+		LLTraceRecorder::stopSession();
+		ensure("stopped", !LLTraceRecorder::isRecording());
+
+		ensure("converted", LLTraceRecorder::convertToChromeTrace(mTraceFile, mJSONFile));
+		std::string json = readFile(mJSONFile);
+		ensure("has zone name", json.find("\"trace test recorded\"") != std::string::npos);
+		ensure("has nested zone", json.find("\"trace test inner\"") != std::string::npos);
+		ensure("has thread name", json.find("\"trace test thread\"") != std::string::npos);
+		ensure("has begin", json.find("\"ph\":\"B\"") != std::string::npos);
+		ensure("has end", json.find("\"ph\":\"E\"") != std::string::npos);
+
+		// two zones, each a begin and an end
+		S32 count = 0;
+		for (size_t pos = json.find("\"ph\":\""); pos != std::string::npos; pos = json.find("\"ph\":\"", pos + 1))
+		{
+			char type = json[pos + 6];
+			if (type == 'B' || type == 'E')
+			{
+				count++;
+			}
+		}
+		ensure_equals("event count", count, 4);
+	}
+
+	template<> template<>
+	void trace_object::test<3>()
+	{
+		// garbage is rejected rather than converted
+		{
+			std::ofstream ostr(mTraceFile.c_str());
+			ostr << "not a trace";
+		}
+		ensure("rejects bad file", !LLTraceRecorder::convertToChromeTrace(mTraceFile, mJSONFile));
+	}
+
+	template<> template<>
+	void trace_object::test<4>()
+	{
+		// a full buffer drops whole zones, never half of one
+		U16 outer_id = LLTraceRecorder::registerName("trace test overflow outer");
+		U16 inner_id = LLTraceRecorder::registerName("trace test overflow inner");
+		ensure("session started", LLTraceRecorder::startSession(mTraceFile));
+		for (S32 i = 0; i < 20000; i++)
+		{
+			LLTraceZone outer(outer_id);
+			LLTraceZone inner(inner_id);
+		}
+		LLTraceRecorder::stopSession();
+
+		ensure("converted", LLTraceRecorder::convertToChromeTrace(mTraceFile, mJSONFile));
+		S32 begins, ends;
+		countEvents(readFile(mJSONFile), begins, ends);
+		ensure("some zones kept", begins > 0);
+		ensure("some zones dropped", begins < 40000);
+		ensure_equals("every begin has its end", begins, ends);
+	}
+
+	template<> template<>
+	void trace_object::test<5>()
+	{
+		// an end without its begin is left out of the JSON
+		U16 id = LLTraceRecorder::registerName("trace test orphan");
+		ensure("session started", LLTraceRecorder::startSession(mTraceFile));
+		LLTraceRecorder::end(id);
+		{
+			LLTraceZone zone(id);
+		}
+		LLTraceRecorder::stopSession();
+
+		ensure("converted", LLTraceRecorder::convertToChromeTrace(mTraceFile, mJSONFile));
+		S32 begins, ends;
+		countEvents(readFile(mJSONFile), begins, ends);
+		ensure_equals("one begin", begins, 1);
+		ensure_equals("one end", ends, 1);
+	}
+}
@@ -0,0 +1,236 @@
+/** 
+ * @file lscript_compile_tut.cpp
+ * @brief LSL compiler optimization tests
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "lltut.h"
+#include "lltimer.h"
+#include "llfile.h"
+#include "lluuid.h"
+#include "lscript_rt_interface.h"
+#include "lscript_execute.h"
+
+namespace tut
+{
+	// Compiles source and runs its default state_entry to completion.
+	static LLScriptExecuteLSL2* compile_and_run(const std::string& source, BOOL optimize, U32& bytecode_size)
+	{
+		std::vector<U8> bytecode;
+		std::string errors;
+		BOOL compiled = lscript_compile(source, bytecode, errors, FALSE, optimize);
+		ensure(errors.c_str(), compiled);
+		bytecode_size = (U32)bytecode.size();
+
+		LLScriptExecuteLSL2* execute = new LLScriptExecuteLSL2(&bytecode[0], bytecode_size);
+		const char* error = NULL;
+		U32 events_processed = 0;
+		for (S32 i = 0; i < 8; i++)
+		{
+			LLTimer timer;
+			execute->runQuanta(FALSE, LLUUID::null, &error, 1.f, events_processed, timer);
+		}
+		return execute;
+	}
+
+	// Compares the global variable block of two runs of the same script.
+	static bool same_globals(LLScriptExecuteLSL2* a, LLScriptExecuteLSL2* b)
+	{
+		S32 a_start = get_register(a->mBuffer, LREG_GVR);
+		S32 a_size = get_register(a->mBuffer, LREG_GFR) - a_start;
+		S32 b_start = get_register(b->mBuffer, LREG_GVR);
+		S32 b_size = get_register(b->mBuffer, LREG_GFR) - b_start;
+		return a_size == b_size && !memcmp(a->mBuffer + a_start, b->mBuffer + b_start, a_size);
+	}
+
+	struct lscript_compile_data
+	{
+	};
+	typedef test_group<lscript_compile_data> lscript_compile_test;
+	typedef lscript_compile_test::object lscript_compile_object;
+	tut::lscript_compile_test lscript_compile_testcase("lscript_compile");
+
+	template<> template<>
+	void lscript_compile_object::test<1>()
+	{
+		// Optimized and unoptimized byte code leave the same state behind
+		const std::string source =
+			"integer gInt;\n"
+			"float gFloat;\n"
+			"integer gMixed;\n"
+			"vector gVec;\n"
+			"rotation gRot;\n"
+			"default\n"
+			"{\n"
+			"	state_entry()\n"
+			"	{\n"
+			"		gInt = (3 + 4) * 5 - (7 << 2) + (-9 / 2) % 3 + ~1 + !0 + (-7) / -1;\n"
+			"		gFloat = 1.5 * 2 + 4 / 2.0 - (float)3 + -(0.25) + 1.0 / 3.0;\n"
+			"		gMixed = (integer)(7.9 * 2) + (10 > 3) + (2.0 == 2) + (5 & 3 | 8 ^ 1) + (-1 >> 1);\n"
+			"		gVec = <1, 2.5, -3>;\n"
+			"		gRot = <0, 0, 0.5 * 2, (float)1>;\n"
+			"	}\n"
+			"}\n";
+
+		U32 plain_size = 0;
+		U32 optimized_size = 0;
+		LLScriptExecuteLSL2* plain = compile_and_run(source, FALSE, plain_size);
+		LLScriptExecuteLSL2* optimized = compile_and_run(source, TRUE, optimized_size);
+
+		ensure_equals("no faults", plain->getFaults(), (S32)LSRF_INVALID);
+		ensure_equals("same faults", optimized->getFaults(), plain->getFaults());
+		ensure("same globals", same_globals(plain, optimized));
+		ensure("smaller byte code", optimized_size < plain_size);
+
+		std::vector<U8> bytecode;
+		std::string errors;
+		ensure("compiles", lscript_compile(source, bytecode, errors));
+		LLScriptExecuteLSL2 fresh(&bytecode[0], (U32)bytecode.size());
+		ensure_equals("same layout", (U32)bytecode.size(), plain_size);
+		ensure("state_entry ran", !same_globals(plain, &fresh));
+
+		delete plain;
+		delete optimized;
+	}
+
+	template<> template<>
+	void lscript_compile_object::test<2>()
+	{
+		// Expressions that fault at run time are not folded
+		const std::string source =
+			"integer gInt;\n"
+			"default\n"
+			"{\n"
+			"	state_entry()\n"
+			"	{\n"
+			"		gInt = 1 / 0;\n"
+			"	}\n"
+			"}\n";
+
+		U32 plain_size = 0;
+		U32 optimized_size = 0;
+		LLScriptExecuteLSL2* plain = compile_and_run(source, FALSE, plain_size);
+		LLScriptExecuteLSL2* optimized = compile_and_run(source, TRUE, optimized_size);
+
+		ensure_equals("math fault", plain->getFaults(), (S32)LSRF_MATH);
+		ensure_equals("same faults", optimized->getFaults(), plain->getFaults());
+		ensure_equals("nothing folded", optimized_size, plain_size);
+
+		delete plain;
+		delete optimized;
+	}
+
+	template<> template<>
+	void lscript_compile_object::test<3>()
+	{
+		// The in-memory compile produces the same byte code as the file one
+		const std::string source =
+			"integer gCount;\n"
+			"string gName = \"test\";\n"
+			"default\n"
+			"{\n"
+			"	state_entry()\n"
+			"	{\n"
+			"		gCount = llStringLength(gName) + 2;\n"
+			"	}\n"
+			"}\n";
+
+		LLUUID random;
+		random.generate();
+		std::ostringstream prefix;
+		prefix << "/tmp/lscript-compile-test-" << random;
+		std::string src_filename = prefix.str() + ".lsl";
+		std::string dst_filename = prefix.str() + ".lso";
+		std::string err_filename = prefix.str() + ".out";
+
+		LLFILE* fp = LLFile::fopen(src_filename, "wb");
+		ensure("source written", fp != NULL);
+		fwrite(source.data(), 1, source.size(), fp);
+		fclose(fp);
+
+		ensure("file compile", lscript_compile(src_filename.c_str(), dst_filename.c_str(),
+											   err_filename.c_str(), FALSE, "", FALSE));
+
+		std::vector<U8> file_bytecode;
+		fp = LLFile::fopen(dst_filename, "rb");
+		ensure("byte code written", fp != NULL);
+		U8 buffer[1024];
+		size_t count;
+		while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+		{
+			file_bytecode.insert(file_bytecode.end(), buffer, buffer + count);
+		}
+		fclose(fp);
+
+		LLFile::remove(src_filename);
+		LLFile::remove(dst_filename);
+		LLFile::remove(err_filename);
+
+		std::vector<U8> bytecode;
+		std::string errors;
+		ensure("memory compile", lscript_compile(source, bytecode, errors));
+		ensure("no diagnostics", errors.empty());
+		ensure_equals("same size", bytecode.size(), file_bytecode.size());
+		ensure("same byte code", bytecode == file_bytecode);
+	}
+
+	template<> template<>
+	void lscript_compile_object::test<4>()
+	{
+		// Errors come back as text and don't leak into the next compile
+		std::vector<U8> bytecode;
+		std::string errors;
+		const std::string bad_source =
+			"default\n"
+			"{\n"
+			"	state_entry()\n"
+			"	{\n"
+			"		undeclared = 1;\n"
+			"	}\n"
+			"}\n";
+		ensure("bad source fails", !lscript_compile(bad_source, bytecode, errors));
+		ensure("no byte code", bytecode.empty());
+		ensure("error reported", errors.find("ERROR") != std::string::npos);
+		ensure("error has position", errors.find("(") == 0);
+
+		const std::string good_source =
+			"default\n"
+			"{\n"
+			"	state_entry()\n"
+			"	{\n"
+			"	}\n"
+			"}\n";
+		ensure("good source compiles", lscript_compile(good_source, bytecode, errors));
+		ensure("errors cleared", errors.empty());
+		ensure("byte code produced", !bytecode.empty());
+	}
+}